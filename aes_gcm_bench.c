@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <doca_log.h>
+#include <doca_error.h>
+
+#include "aes_gcm_bench.h"
+#include "aes_gcm_device_group.h"
+#include "aes_gcm_hugepage.h"
+#include "aes_gcm_poller.h"
+
+DOCA_LOG_REGISTER(AES_GCM::BENCH);
+
+/*
+ * qsort() comparator of latencies
+ *
+ * @a [in]: First latency
+ * @b [in]: Second latency
+ * @return: negative, zero or positive as a is lower, equal or greater than b
+ */
+static int compare_latency(const void *a, const void *b)
+{
+	uint64_t lhs = *(const uint64_t *)a, rhs = *(const uint64_t *)b;
+
+	return (lhs > rhs) - (lhs < rhs);
+}
+
+/*
+ * Get a percentile of sorted latencies
+ *
+ * @latencies [in]: Sorted latencies
+ * @num_latencies [in]: Number of latencies, at least one
+ * @percentile [in]: Percentile, between 0 and 100
+ * @return: the latency at the percentile
+ */
+static uint64_t percentile_ns(const uint64_t *latencies, size_t num_latencies, double percentile)
+{
+	size_t idx = (size_t)((percentile / 100.0) * (double)num_latencies);
+
+	return latencies[(idx < num_latencies) ? idx : (num_latencies - 1)];
+}
+
+/*
+ * Hand the bulk jobs that completed back to the poller, with fresh IVs
+ *
+ * @cfg [in]: Configuration parameters
+ * @poller [in]: The poller
+ * @bulk [in]: Bulk jobs
+ * @flags [in]: Completion flags of the bulk jobs
+ * @num_bulk [in]: Number of bulk jobs
+ * @bulk_counter [in/out]: Number of bulk jobs handed off so far
+ * @return: DOCA_SUCCESS on success and the error of a failed bulk job otherwise
+ */
+static doca_error_t refill_bulk(const struct aes_gcm_cfg *cfg,
+				struct aes_gcm_poller *poller,
+				struct aes_gcm_job *bulk,
+				struct aes_gcm_poll_flag *flags,
+				uint32_t num_bulk,
+				uint64_t *bulk_counter)
+{
+	uint32_t i;
+
+	for (i = 0; i < num_bulk; i++) {
+		if (!atomic_load_explicit(&flags[i].done, memory_order_acquire))
+			continue;
+		if (bulk[i].result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Bulk job failed: %s", doca_error_get_descr(bulk[i].result));
+			return bulk[i].result;
+		}
+		/* The message IVs are the counters below cfg->latency_bench */
+		aes_gcm_derive_iv(cfg->iv, cfg->iv_length, cfg->latency_bench + *bulk_counter, bulk[i].iv);
+		if (!aes_gcm_poller_submit(poller, &bulk[i], &flags[i]))
+			break;
+		(*bulk_counter)++;
+	}
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_latency_bench(struct aes_gcm_cfg *cfg)
+{
+	struct aes_gcm_device_group *group = NULL;
+	struct aes_gcm_group_key key = {0};
+	struct aes_gcm_mem src_mem = {0}, dst_mem = {0};
+	struct aes_gcm_poller *poller = NULL;
+	struct aes_gcm_poll_flag flag, *bulk_flags = NULL;
+	struct aes_gcm_job job, *bulk = NULL;
+	uint64_t *latencies = NULL;
+	uint64_t start_ns, sum_ns = 0, bulk_counter = 0;
+	size_t msg_size, src_len, dst_len, bulk_len = 0, num_warmup, num_samples = 0, num_rejected = 0, i;
+	uint32_t num_bulk = cfg->bench_bulk;
+	doca_error_t result, tmp_result;
+
+	msg_size = (cfg->chunk_size != 0) ? cfg->chunk_size : AES_GCM_BENCH_DEFAULT_MSG_SIZE;
+	src_len = cfg->aad_size + msg_size;
+	dst_len = src_len + cfg->tag_size;
+	num_warmup = cfg->latency_bench / 10;
+
+	if (num_bulk >= AES_GCM_POLLER_RING_SIZE) {
+		num_bulk = AES_GCM_POLLER_RING_SIZE - 1;
+		DOCA_LOG_WARN("Background load limited to %u bulk jobs", num_bulk);
+	}
+	if (num_bulk == 0) {
+		/* A single message in flight, the members must not batch anything for it */
+		cfg->queue_depth = 1;
+		cfg->queue_depth_set = true;
+	}
+	result = aes_gcm_device_group_create(cfg, AES_GCM_MODE_ENCRYPT, &group);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create device group: %s", doca_error_get_descr(result));
+		return result;
+	}
+	/* The devices are measured, small messages must not be taken by the CPU */
+	group->cpu_crossover = 0;
+
+	if (num_bulk != 0) {
+		bulk_len = AES_GCM_BENCH_BULK_SIZE;
+		if (bulk_len + cfg->tag_size > group->max_buf_size)
+			bulk_len = group->max_buf_size - cfg->tag_size;
+	}
+
+	latencies = calloc(cfg->latency_bench, sizeof(*latencies));
+	poller = aligned_alloc(AES_GCM_CACHE_LINE_SIZE, sizeof(*poller));
+	if (num_bulk != 0) {
+		bulk = calloc(num_bulk, sizeof(*bulk));
+		bulk_flags = aligned_alloc(AES_GCM_CACHE_LINE_SIZE, num_bulk * sizeof(*bulk_flags));
+	}
+	if (latencies == NULL || poller == NULL || (num_bulk != 0 && (bulk == NULL || bulk_flags == NULL))) {
+		result = DOCA_ERROR_NO_MEMORY;
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(result));
+		goto free_buffers;
+	}
+
+	/* The bulk jobs share one source after the message, each one has its own destination after the message's */
+	result = aes_gcm_mem_alloc(cfg->hugepages, src_len + bulk_len, &src_mem);
+	if (result != DOCA_SUCCESS)
+		goto free_buffers;
+	result = aes_gcm_mem_alloc(cfg->hugepages, dst_len + num_bulk * (bulk_len + cfg->tag_size), &dst_mem);
+	if (result != DOCA_SUCCESS)
+		goto free_buffers;
+
+	for (i = 0; i < num_bulk; i++) {
+		bulk[i].src = (uint8_t *)src_mem.addr + src_len;
+		bulk[i].src_len = bulk_len;
+		bulk[i].dst = (uint8_t *)dst_mem.addr + dst_len + i * (bulk_len + cfg->tag_size);
+		bulk[i].dst_len = bulk_len + cfg->tag_size;
+		bulk[i].iv_length = cfg->iv_length;
+		bulk[i].tag_size = cfg->tag_size;
+		bulk[i].priority = AES_GCM_PRIORITY_BULK;
+		atomic_init(&bulk_flags[i].done, true);
+	}
+
+	result = aes_gcm_device_group_start(group,
+					    src_mem.addr,
+					    src_len + bulk_len,
+					    dst_mem.addr,
+					    dst_len + num_bulk * (bulk_len + cfg->tag_size));
+	if (result != DOCA_SUCCESS)
+		goto free_buffers;
+
+	result = aes_gcm_device_group_key_create(group, cfg->raw_key, cfg->raw_key_type, &key);
+	if (result != DOCA_SUCCESS)
+		goto free_buffers;
+
+	result = aes_gcm_poller_start(poller, group, &key, cfg->poll_cpu);
+	if (result != DOCA_SUCCESS)
+		goto destroy_key;
+
+	DOCA_LOG_INFO("Measuring %u messages of %zu bytes, after %zu warmup messages",
+		      cfg->latency_bench - (uint32_t)num_warmup,
+		      msg_size,
+		      num_warmup);
+	if (num_bulk != 0)
+		DOCA_LOG_INFO("Background load of %u bulk jobs of %zu bytes, %u task slots per device reserved",
+			      num_bulk,
+			      bulk_len,
+			      cfg->priority_reserve);
+
+	for (i = 0; i < cfg->latency_bench; i++) {
+		result = refill_bulk(cfg, poller, bulk, bulk_flags, num_bulk, &bulk_counter);
+		if (result != DOCA_SUCCESS)
+			break;
+
+		memset(&job, 0, sizeof(job));
+		job.src = src_mem.addr;
+		job.src_len = src_len;
+		job.dst = dst_mem.addr;
+		job.dst_len = dst_len;
+		aes_gcm_derive_iv(cfg->iv, cfg->iv_length, i, job.iv);
+		job.iv_length = cfg->iv_length;
+		job.tag_size = cfg->tag_size;
+		job.aad_size = cfg->aad_size;
+		job.priority = AES_GCM_PRIORITY_HIGH;
+
+		start_ns = aes_gcm_get_time_ns();
+		if (cfg->deadline_us != 0)
+			job.deadline_ns = start_ns + cfg->deadline_us * 1000ULL;
+		/* The bulk jobs leave a ring slot free for the message */
+		(void)aes_gcm_poller_submit(poller, &job, &flag);
+		aes_gcm_poller_wait(&flag);
+		if (job.result == DOCA_ERROR_TIME_OUT) {
+			num_rejected++;
+			continue;
+		}
+		if (job.result != DOCA_SUCCESS) {
+			result = job.result;
+			DOCA_LOG_ERR("Message %zu failed: %s", i, doca_error_get_descr(result));
+			break;
+		}
+		if (i >= num_warmup) {
+			latencies[num_samples] = aes_gcm_get_time_ns() - start_ns;
+			sum_ns += latencies[num_samples++];
+		}
+	}
+	aes_gcm_poller_stop(poller);
+
+	if (num_rejected > 0)
+		DOCA_LOG_INFO("%zu messages were rejected after waiting over %u us in the queue",
+			      num_rejected,
+			      cfg->deadline_us);
+	if (num_bulk != 0)
+		DOCA_LOG_INFO("Background load ran %lu bulk jobs", bulk_counter);
+	if (num_samples > 0) {
+		qsort(latencies, num_samples, sizeof(*latencies), compare_latency);
+		DOCA_LOG_INFO("Latency of %zu messages: p50 %.2f us, p99 %.2f us, p99.9 %.2f us, max %.2f us, "
+			      "mean %.2f us",
+			      num_samples,
+			      percentile_ns(latencies, num_samples, 50) / 1e3,
+			      percentile_ns(latencies, num_samples, 99) / 1e3,
+			      percentile_ns(latencies, num_samples, 99.9) / 1e3,
+			      latencies[num_samples - 1] / 1e3,
+			      ((double)sum_ns / num_samples) / 1e3);
+		DOCA_LOG_INFO("Progress thread made %lu polls, %lu of them empty",
+			      poller->num_polls,
+			      poller->num_empty_polls);
+	}
+
+destroy_key:
+	tmp_result = aes_gcm_device_group_key_destroy(group, &key);
+	DOCA_ERROR_PROPAGATE(result, tmp_result);
+free_buffers:
+	tmp_result = aes_gcm_device_group_destroy(group);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to destroy device group: %s", doca_error_get_descr(tmp_result));
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+	aes_gcm_mem_free(&dst_mem);
+	aes_gcm_mem_free(&src_mem);
+	free(bulk_flags);
+	free(bulk);
+	free(poller);
+	free(latencies);
+
+	return result;
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_BENCH_H_
+#define AES_GCM_BENCH_H_
+
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+
+#define AES_GCM_BENCH_DEFAULT_MSG_SIZE 64     /* Message size when no chunk size is given */
+#define AES_GCM_BENCH_BULK_SIZE (1024 * 1024) /* Payload of the background bulk jobs */
+
+/*
+ * Run the small message latency benchmark
+ *
+ * Messages of cfg->chunk_size bytes (AES_GCM_BENCH_DEFAULT_MSG_SIZE when unset), plus cfg->aad_size bytes of AAD, are
+ * encrypted one at a time: the submitter hands each message to a busy-polling progress thread and spins on its
+ * completion flag. The round trip of cfg->latency_bench messages is reported as p50/p99/p99.9, after a warmup of
+ * one tenth of the messages.
+ *
+ * With cfg->bench_bulk set, that many bulk jobs are kept queued behind the messages as background load. The messages
+ * are high priority jobs, they take the cfg->priority_reserve task slots the bulk jobs leave free on every device, and
+ * the messages that wait longer than cfg->deadline_us in the queue are rejected and counted instead of measured.
+ *
+ * @cfg [in]: Configuration parameters
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_latency_bench(struct aes_gcm_cfg *cfg);
+
+#endif /* AES_GCM_BENCH_H_ */
@@ -0,0 +1,494 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/random.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <doca_log.h>
+#include <doca_error.h>
+
+#include "aes_gcm_block.h"
+#include "aes_gcm_device_group.h"
+#include "aes_gcm_hugepage.h"
+
+DOCA_LOG_REGISTER(AES_GCM::BLOCK);
+
+/* Open block table */
+struct block_table {
+	int fd;					  /* Table file descriptor */
+	struct aes_gcm_block_table_header header; /* Table header */
+	size_t entry_size;			  /* Generation and tag size */
+};
+
+/* Sector range of a run and the files it moves between */
+struct block_run {
+	struct block_table table;	    /* Block table */
+	int image_fd;			    /* Block image */
+	int plain_fd;			    /* Plaintext input on encrypt, output on decrypt */
+	uint64_t first_sector;		    /* First sector of the range */
+	uint64_t num_sectors;		    /* Number of sectors in the range */
+	uint8_t *entries;		    /* Table entries of the current batch */
+	struct aes_gcm_job *jobs;	    /* Jobs of the current batch */
+	uint8_t *src;			    /* Registered source, one sector and tag per slot */
+	uint8_t *dst;			    /* Registered destination, one sector and tag per slot */
+	struct aes_gcm_device_group *group; /* Device group */
+	struct aes_gcm_group_key key;	    /* Group key */
+};
+
+/*
+ * Open the block table, creating it on the first write
+ *
+ * @cfg [in]: Configuration parameters
+ * @mode [in]: AES-GCM mode - encrypt/decrypt
+ * @table [out]: The open table
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t table_open(const struct aes_gcm_cfg *cfg, enum aes_gcm_mode mode, struct block_table *table)
+{
+	struct aes_gcm_block_table_header *header = &table->header;
+	ssize_t n;
+
+	table->fd = open(cfg->tag_index_path, (mode == AES_GCM_MODE_ENCRYPT) ? (O_RDWR | O_CREAT) : O_RDONLY, 0644);
+	if (table->fd < 0) {
+		DOCA_LOG_ERR("Unable to open block table %s: %s", cfg->tag_index_path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+	table->entry_size = sizeof(uint32_t) + cfg->tag_size;
+
+	n = pread(table->fd, header, sizeof(*header), 0);
+	if (n == 0 && mode == AES_GCM_MODE_ENCRYPT) {
+		memset(header, 0, sizeof(*header));
+		memcpy(header->magic, AES_GCM_BLOCK_TABLE_MAGIC, sizeof(header->magic));
+		header->version = AES_GCM_BLOCK_TABLE_VERSION;
+		header->sector_size = cfg->sector_size;
+		header->tag_size = cfg->tag_size;
+		/* Every image of a key needs its own nonce, a shared one would repeat the IVs of its sectors */
+		if (getrandom(header->nonce, sizeof(header->nonce), 0) != sizeof(header->nonce)) {
+			DOCA_LOG_ERR("Unable to draw the nonce of block table %s: %s",
+				     cfg->tag_index_path,
+				     strerror(errno));
+			return DOCA_ERROR_OPERATING_SYSTEM;
+		}
+		DOCA_LOG_INFO("Creating block table %s for %u bytes sectors", cfg->tag_index_path, cfg->sector_size);
+		return aes_gcm_file_io(table->fd, header, sizeof(*header), 0, true);
+	}
+
+	if (n != sizeof(*header) || memcmp(header->magic, AES_GCM_BLOCK_TABLE_MAGIC, sizeof(header->magic)) != 0 ||
+	    header->version != AES_GCM_BLOCK_TABLE_VERSION) {
+		DOCA_LOG_ERR("File %s is not a block table", cfg->tag_index_path);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	if (header->sector_size != cfg->sector_size || header->tag_size != cfg->tag_size) {
+		DOCA_LOG_ERR("Block table %s holds %u bytes tags of %u bytes sectors, expected %u bytes tags of %u "
+			     "bytes sectors",
+			     cfg->tag_index_path,
+			     header->tag_size,
+			     header->sector_size,
+			     cfg->tag_size,
+			     cfg->sector_size);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Grow the block table and the image to hold a number of sectors, new sectors are never written
+ *
+ * @run [in]: The run
+ * @sector_size [in]: Sector size
+ * @num_sectors [in]: Number of sectors to hold
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t grow_image(struct block_run *run, uint32_t sector_size, uint64_t num_sectors)
+{
+	struct block_table *table = &run->table;
+	struct stat st;
+
+	if (fstat(run->image_fd, &st) != 0 || (uint64_t)st.st_size < num_sectors * sector_size) {
+		if (ftruncate(run->image_fd, num_sectors * sector_size) != 0) {
+			DOCA_LOG_ERR("Failed to grow the block image to %lu sectors: %s", num_sectors, strerror(errno));
+			return DOCA_ERROR_IO_FAILED;
+		}
+	}
+
+	if (num_sectors <= table->header.num_sectors)
+		return DOCA_SUCCESS;
+
+	/* The file hole reads back as generation 0 entries */
+	if (ftruncate(table->fd, sizeof(table->header) + (num_sectors * table->entry_size)) != 0) {
+		DOCA_LOG_ERR("Failed to grow the block table to %lu sectors: %s", num_sectors, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+	table->header.num_sectors = num_sectors;
+	return aes_gcm_file_io(table->fd, &table->header, sizeof(table->header), 0, true);
+}
+
+/*
+ * Open the files of a run and resolve its sector range
+ *
+ * @cfg [in]: Configuration parameters
+ * @mode [in]: AES-GCM mode - encrypt/decrypt
+ * @run [in/out]: The run
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t open_run(const struct aes_gcm_cfg *cfg, enum aes_gcm_mode mode, struct block_run *run)
+{
+	uint64_t available;
+	struct stat st;
+	doca_error_t result;
+
+	result = table_open(cfg, mode, &run->table);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	run->first_sector = cfg->first_sector;
+	if (mode == AES_GCM_MODE_ENCRYPT) {
+		run->plain_fd = open(cfg->file_path, O_RDONLY);
+		if (run->plain_fd < 0 || fstat(run->plain_fd, &st) != 0) {
+			DOCA_LOG_ERR("Unable to open input file %s: %s", cfg->file_path, strerror(errno));
+			return DOCA_ERROR_IO_FAILED;
+		}
+		if (st.st_size % cfg->sector_size != 0) {
+			DOCA_LOG_ERR("Input file of %ld bytes is not made of whole %u bytes sectors",
+				     (long)st.st_size,
+				     cfg->sector_size);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		available = st.st_size / cfg->sector_size;
+		run->image_fd = open(cfg->block_image_path, O_RDWR | O_CREAT, 0644);
+	} else {
+		available = (run->first_sector < run->table.header.num_sectors) ?
+				    (run->table.header.num_sectors - run->first_sector) :
+				    0;
+		run->plain_fd = open(cfg->output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (run->plain_fd < 0) {
+			DOCA_LOG_ERR("Unable to open output file %s: %s", cfg->output_path, strerror(errno));
+			return DOCA_ERROR_IO_FAILED;
+		}
+		run->image_fd = open(cfg->block_image_path, O_RDONLY);
+	}
+	if (run->image_fd < 0) {
+		DOCA_LOG_ERR("Unable to open block image %s: %s", cfg->block_image_path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	run->num_sectors = (cfg->num_sectors != 0) ? cfg->num_sectors : available;
+	if (run->num_sectors == 0 || run->num_sectors > available) {
+		DOCA_LOG_ERR("%lu sectors from sector %lu were requested, the %s holds %lu of them",
+			     cfg->num_sectors,
+			     run->first_sector,
+			     (mode == AES_GCM_MODE_ENCRYPT) ? "input" : "image",
+			     available);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	if (mode == AES_GCM_MODE_ENCRYPT)
+		return grow_image(run, cfg->sector_size, run->first_sector + run->num_sectors);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Set up the jobs of a batch, reading its sectors
+ *
+ * @cfg [in]: Configuration parameters
+ * @mode [in]: AES-GCM mode - encrypt/decrypt
+ * @run [in]: The run, the table entries of the batch must be loaded
+ * @done [in]: Sectors of the range processed so far
+ * @nb_sectors [in]: Number of sectors in the batch
+ * @nb_jobs [out]: Number of jobs, decryption skips the sectors that were never written
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t prepare_batch(const struct aes_gcm_cfg *cfg,
+				  enum aes_gcm_mode mode,
+				  struct block_run *run,
+				  uint64_t done,
+				  size_t nb_sectors,
+				  size_t *nb_jobs)
+{
+	size_t slot_size = (size_t)cfg->sector_size + cfg->tag_size;
+	uint64_t sector;
+	uint32_t generation;
+	uint8_t *entry;
+	struct aes_gcm_job *job;
+	doca_error_t result;
+	size_t i;
+
+	/* Plaintext sectors are read back to back and encrypted from where they landed */
+	if (mode == AES_GCM_MODE_ENCRYPT) {
+		result = aes_gcm_file_io(run->plain_fd,
+					 run->src,
+					 nb_sectors * cfg->sector_size,
+					 done * cfg->sector_size,
+					 false);
+		if (result != DOCA_SUCCESS)
+			return result;
+	}
+
+	*nb_jobs = 0;
+	for (i = 0; i < nb_sectors; i++) {
+		sector = run->first_sector + done + i;
+		entry = run->entries + (i * run->table.entry_size);
+		memcpy(&generation, entry, sizeof(generation));
+
+		if (mode == AES_GCM_MODE_DECRYPT && generation == 0) {
+			memset(run->dst + (i * cfg->sector_size), 0, cfg->sector_size);
+			continue;
+		}
+
+		job = &run->jobs[(*nb_jobs)++];
+		if (mode == AES_GCM_MODE_ENCRYPT) {
+			if (generation == UINT32_MAX) {
+				DOCA_LOG_ERR("Sector %lu was written %u times, the image must be rekeyed",
+					     sector,
+					     generation);
+				return DOCA_ERROR_NOT_PERMITTED;
+			}
+			generation++;
+			memcpy(entry, &generation, sizeof(generation));
+			job->src = run->src + (i * cfg->sector_size);
+			job->src_len = cfg->sector_size;
+			job->dst = run->dst + (i * slot_size);
+			job->dst_len = slot_size;
+		} else {
+			/* The tag follows the ciphertext, as the devices expect */
+			job->src = run->src + (i * slot_size);
+			job->src_len = slot_size;
+			result = aes_gcm_file_io(run->image_fd,
+						 job->src,
+						 cfg->sector_size,
+						 sector * cfg->sector_size,
+						 false);
+			if (result != DOCA_SUCCESS)
+				return result;
+			memcpy((uint8_t *)job->src + cfg->sector_size, entry + sizeof(generation), cfg->tag_size);
+			job->dst = run->dst + (i * cfg->sector_size);
+			job->dst_len = cfg->sector_size;
+		}
+		aes_gcm_block_derive_iv(run->table.header.nonce, sector, generation, job->iv);
+		job->iv_length = MAX_AES_GCM_IV_LENGTH;
+		job->tag_size = cfg->tag_size;
+		job->aad_size = 0;
+		job->user_data = (void *)(uintptr_t)sector;
+	}
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Write out a completed batch
+ *
+ * Encryption moves the tags to the table entries and the ciphertexts back to back, then makes the table entries
+ * durable before it writes the image. A crash in between leaves sectors that fail authentication, but never a bumped
+ * generation that was not recorded and would be used again. Decryption writes the plaintext sectors to the output.
+ *
+ * @cfg [in]: Configuration parameters
+ * @mode [in]: AES-GCM mode - encrypt/decrypt
+ * @run [in]: The run
+ * @done [in]: Sectors of the range processed so far
+ * @nb_sectors [in]: Number of sectors in the batch
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t complete_batch(const struct aes_gcm_cfg *cfg,
+				   enum aes_gcm_mode mode,
+				   struct block_run *run,
+				   uint64_t done,
+				   size_t nb_sectors)
+{
+	size_t slot_size = (size_t)cfg->sector_size + cfg->tag_size;
+	off_t entries_offset;
+	doca_error_t result;
+	size_t i;
+
+	if (mode == AES_GCM_MODE_DECRYPT)
+		return aes_gcm_file_io(run->plain_fd,
+				       run->dst,
+				       nb_sectors * cfg->sector_size,
+				       done * cfg->sector_size,
+				       true);
+
+	for (i = 0; i < nb_sectors; i++)
+		memcpy(run->entries + (i * run->table.entry_size) + sizeof(uint32_t),
+		       run->dst + (i * slot_size) + cfg->sector_size,
+		       cfg->tag_size);
+	for (i = 1; i < nb_sectors; i++)
+		memmove(run->dst + (i * cfg->sector_size), run->dst + (i * slot_size), cfg->sector_size);
+
+	entries_offset = sizeof(run->table.header) + ((run->first_sector + done) * run->table.entry_size);
+	result = aes_gcm_file_io(run->table.fd, run->entries, nb_sectors * run->table.entry_size, entries_offset, true);
+	if (result != DOCA_SUCCESS)
+		return result;
+	if (fdatasync(run->table.fd) != 0) {
+		DOCA_LOG_ERR("Failed to sync block table: %s", strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	return aes_gcm_file_io(run->image_fd,
+			       run->dst,
+			       nb_sectors * cfg->sector_size,
+			       (run->first_sector + done) * cfg->sector_size,
+			       true);
+}
+
+void aes_gcm_block_derive_iv(const uint8_t *nonce, uint64_t sector, uint32_t generation, uint8_t *iv)
+{
+	uint32_t i;
+
+	aes_gcm_derive_iv(nonce, MAX_AES_GCM_IV_LENGTH, sector, iv);
+	for (i = 0; i < sizeof(generation); i++)
+		iv[i] ^= (uint8_t)(generation >> (8 * (sizeof(generation) - 1 - i)));
+}
+
+bool aes_gcm_block_is_requested(const struct aes_gcm_cfg *cfg)
+{
+	return cfg->block_image_path[0] != '\0';
+}
+
+doca_error_t aes_gcm_block_run(struct aes_gcm_cfg *cfg, enum aes_gcm_mode mode)
+{
+	struct block_run run = {.table.fd = -1, .image_fd = -1, .plain_fd = -1};
+	struct aes_gcm_mem src_mem = {0}, dst_mem = {0};
+	size_t slot_size = (size_t)cfg->sector_size + cfg->tag_size;
+	size_t batch_sectors, nb_sectors, nb_jobs, i;
+	uint64_t done, start_ns;
+	doca_error_t result, tmp_result;
+
+	if (cfg->tag_index_path[0] == '\0') {
+		DOCA_LOG_ERR("Block images keep their tags in a block table, --tag-index must be set");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	result = open_run(cfg, mode, &run);
+	if (result != DOCA_SUCCESS)
+		goto close_files;
+
+	result = aes_gcm_device_group_create(cfg, mode, &run.group);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create device group: %s", doca_error_get_descr(result));
+		goto close_files;
+	}
+
+	if (slot_size > run.group->max_buf_size) {
+		DOCA_LOG_ERR("Sector and tag of %zu bytes > max buffer size %lu", slot_size, run.group->max_buf_size);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto destroy_group;
+	}
+
+	batch_sectors = (run.num_sectors < AES_GCM_BLOCK_BATCH_SECTORS) ? run.num_sectors : AES_GCM_BLOCK_BATCH_SECTORS;
+	run.entries = calloc(batch_sectors, run.table.entry_size);
+	run.jobs = calloc(batch_sectors, sizeof(*run.jobs));
+	if (run.entries == NULL || run.jobs == NULL) {
+		result = DOCA_ERROR_NO_MEMORY;
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(result));
+		goto destroy_group;
+	}
+
+	/* The batch buffers are registered once and reused by every batch */
+	result = aes_gcm_mem_alloc(cfg->hugepages, batch_sectors * slot_size, &src_mem);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+	result = aes_gcm_mem_alloc(cfg->hugepages, batch_sectors * slot_size, &dst_mem);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+	run.src = src_mem.addr;
+	run.dst = dst_mem.addr;
+
+	result = aes_gcm_device_group_start(run.group, run.src, src_mem.size, run.dst, dst_mem.size);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+
+	result = aes_gcm_device_group_key_create(run.group, cfg->raw_key, cfg->raw_key_type, &run.key);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+
+	DOCA_LOG_INFO("%s sectors %lu to %lu of %s on %u devices",
+		      (mode == AES_GCM_MODE_ENCRYPT) ? "Encrypting" : "Decrypting",
+		      run.first_sector,
+		      run.first_sector + run.num_sectors - 1,
+		      cfg->block_image_path,
+		      run.group->num_members);
+
+	start_ns = aes_gcm_get_time_ns();
+	for (done = 0; done < run.num_sectors; done += nb_sectors) {
+		nb_sectors = (run.num_sectors - done < batch_sectors) ? (run.num_sectors - done) : batch_sectors;
+
+		result = aes_gcm_file_io(run.table.fd,
+					 run.entries,
+					 nb_sectors * run.table.entry_size,
+					 sizeof(run.table.header) + ((run.first_sector + done) * run.table.entry_size),
+					 false);
+		if (result != DOCA_SUCCESS)
+			goto destroy_key;
+
+		result = prepare_batch(cfg, mode, &run, done, nb_sectors, &nb_jobs);
+		if (result != DOCA_SUCCESS)
+			goto destroy_key;
+
+		aes_gcm_device_group_submit_burst(run.group, &run.key, run.jobs, nb_jobs);
+		aes_gcm_device_group_wait(run.group);
+
+		for (i = 0; i < nb_jobs; i++) {
+			if (run.jobs[i].result != DOCA_SUCCESS) {
+				result = run.jobs[i].result;
+				DOCA_LOG_ERR("Sector %lu failed: %s",
+					     (uint64_t)(uintptr_t)run.jobs[i].user_data,
+					     doca_error_get_descr(result));
+				goto destroy_key;
+			}
+		}
+
+		result = complete_batch(cfg, mode, &run, done, nb_sectors);
+		if (result != DOCA_SUCCESS)
+			goto destroy_key;
+	}
+	aes_gcm_device_group_report(run.group, aes_gcm_get_time_ns() - start_ns);
+
+	if (mode == AES_GCM_MODE_ENCRYPT && (fdatasync(run.image_fd) != 0 || fdatasync(run.table.fd) != 0)) {
+		DOCA_LOG_ERR("Failed to flush the block image: %s", strerror(errno));
+		result = DOCA_ERROR_IO_FAILED;
+		goto destroy_key;
+	}
+	DOCA_LOG_INFO("%lu sectors were %s successfully",
+		      run.num_sectors,
+		      (mode == AES_GCM_MODE_ENCRYPT) ? "encrypted into the block image" : "decrypted");
+
+destroy_key:
+	tmp_result = aes_gcm_device_group_key_destroy(run.group, &run.key);
+	DOCA_ERROR_PROPAGATE(result, tmp_result);
+destroy_group:
+	free(run.jobs);
+	free(run.entries);
+	tmp_result = aes_gcm_device_group_destroy(run.group);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to destroy device group: %s", doca_error_get_descr(tmp_result));
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+	aes_gcm_mem_free(&dst_mem);
+	aes_gcm_mem_free(&src_mem);
+close_files:
+	if (run.plain_fd >= 0)
+		close(run.plain_fd);
+	if (run.image_fd >= 0)
+		close(run.image_fd);
+	if (run.table.fd >= 0)
+		close(run.table.fd);
+
+	return result;
+}
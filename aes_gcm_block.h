@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+
+#ifndef AES_GCM_BLOCK_H_
+#define AES_GCM_BLOCK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+
+#define AES_GCM_BLOCK_TABLE_MAGIC "AGBT" /* Block table file magic */
+#define AES_GCM_BLOCK_TABLE_VERSION 1	 /* Block table file format version */
+#define AES_GCM_BLOCK_BATCH_SECTORS 256	 /* Max sectors in flight in one batch */
+
+/*
+ * Block table file header, followed by num_sectors entries in sector order, in host byte order
+ *
+ * An entry is the uint32_t write generation of the sector followed by its tag. Generation 0 marks a sector that was
+ * never written, it reads back as zeros.
+ */
+struct aes_gcm_block_table_header {
+	char magic[4];			      /* AES_GCM_BLOCK_TABLE_MAGIC, not NULL terminated */
+	uint32_t version;		      /* AES_GCM_BLOCK_TABLE_VERSION */
+	uint32_t sector_size;		      /* Sector size of the image */
+	uint32_t tag_size;		      /* Size of every tag */
+	uint64_t num_sectors;		      /* Number of sectors and entries */
+	uint8_t nonce[MAX_AES_GCM_IV_LENGTH]; /* Per image nonce, the IV of every sector is derived from it */
+	uint32_t reserved;		      /* Must be 0 */
+};
+
+/*
+ * Derive the IV of a sector write
+ *
+ * The sector number is XORed into the last 8 bytes of the nonce, like aes_gcm_derive_iv(), and the write generation
+ * into the first 4 bytes, so rewriting a sector never reuses an IV under the same key.
+ *
+ * @nonce [in]: Per image nonce, MAX_AES_GCM_IV_LENGTH bytes
+ * @sector [in]: Sector number
+ * @generation [in]: Write generation of the sector, starting at 1
+ * @iv [out]: The IV, MAX_AES_GCM_IV_LENGTH bytes
+ */
+void aes_gcm_block_derive_iv(const uint8_t *nonce, uint64_t sector, uint32_t generation, uint8_t *iv);
+
+/*
+ * Check if the configuration asks for the block image mode
+ *
+ * @cfg [in]: Configuration parameters
+ * @return: true if the run should go through aes_gcm_block_run()
+ */
+bool aes_gcm_block_is_requested(const struct aes_gcm_cfg *cfg);
+
+/*
+ * Encrypt sectors into, or decrypt sectors out of, the block image cfg->block_image_path
+ *
+ * The image is a sequence of cfg->sector_size bytes sectors, each encrypted on its own with the IV derived from the
+ * table nonce, the sector number and its write generation. Tags and generations live in the block table at
+ * cfg->tag_index_path, created with a random nonce on the first write, cfg->iv is not used. Only the sectors from
+ * cfg->first_sector on are touched, cfg->num_sectors of them or up to the end of the input or image,
+ * AES_GCM_BLOCK_BATCH_SECTORS at a time over a device group.
+ * Encryption reads the plaintext sectors from cfg->file_path and writes them in place in the image, growing it as
+ * needed. Decryption writes the plaintext of the sectors to cfg->output_path.
+ *
+ * @cfg [in]: Configuration parameters
+ * @mode [in]: AES-GCM mode - encrypt/decrypt
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_block_run(struct aes_gcm_cfg *cfg, enum aes_gcm_mode mode);
+
+#endif /* AES_GCM_BLOCK_H_ */
@@ -0,0 +1,632 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <doca_log.h>
+#include <doca_error.h>
+
+#include "aes_gcm_calibrate.h"
+#include "aes_gcm_device_group.h"
+#include "aes_gcm_hugepage.h"
+#include "aes_gcm_sw.h"
+
+DOCA_LOG_REGISTER(AES_GCM::CALIBRATE);
+
+#define TUNING_PROFILE_VERSION 1		 /* Profile file format version */
+#define CALIBRATE_POINT_NS (50 * 1000 * 1000ULL) /* Measurement time of a sweep point */
+#define CALIBRATE_JOBS_PER_SLOT 8		 /* Jobs of a measurement round per task slot */
+#define CALIBRATE_DST_SLOTS 32			 /* Destination buffers, the jobs beyond them share one */
+#define CALIBRATE_TOLERANCE 0.05		 /* Throughput given up for a smaller chunk size or depth */
+
+/* Swept chunk sizes and queue depths, in ascending order */
+static const uint32_t calibrate_chunk_sizes[] = {1024, 4096, 16384, 65536, 262144, 1048576};
+static const uint32_t calibrate_queue_depths[] = {1, 4, 16, 64, 256};
+
+#define NUM_CHUNK_SIZES (sizeof(calibrate_chunk_sizes) / sizeof(calibrate_chunk_sizes[0]))
+#define NUM_QUEUE_DEPTHS (sizeof(calibrate_queue_depths) / sizeof(calibrate_queue_depths[0]))
+#define MAX_CHUNK_SIZE (calibrate_chunk_sizes[NUM_CHUNK_SIZES - 1])
+
+/* Sweep results of a device, in Gb/s, 0 where a point was not measured */
+struct calibrate_sweep {
+	double dev_gbps[NUM_QUEUE_DEPTHS][NUM_CHUNK_SIZES]; /* Device throughput per queue depth and chunk size */
+	double cpu_gbps[NUM_CHUNK_SIZES];		    /* Single core throughput per chunk size */
+};
+
+/* Device group and buffers of the sweep of one queue depth */
+struct calibrate_run {
+	const struct aes_gcm_cfg *cfg;	    /* Configuration parameters */
+	struct aes_gcm_device_group *group; /* Device group holding the calibrated device */
+	struct aes_gcm_group_key key;	    /* Group key */
+	struct aes_gcm_job *jobs;	    /* Jobs of a measurement round */
+	size_t num_jobs;		    /* Jobs per measurement round */
+	char *src;			    /* Source buffer, shared by all jobs */
+	char *dst;			    /* Destination buffers */
+	size_t num_slots;		    /* Number of destination buffers */
+	size_t slot_size;		    /* Destination buffer size */
+};
+
+const struct aes_gcm_tuning *aes_gcm_tuning_lookup(const struct aes_gcm_tuning_profile *profile,
+						   const char *pci_addr,
+						   const char *ibdev_name,
+						   const char *fw_version)
+{
+	const struct aes_gcm_tuning *entry;
+	uint32_t i;
+
+	for (i = 0; i < profile->num_entries; i++) {
+		entry = &profile->entries[i];
+		if (strcmp(entry->pci_addr, pci_addr) == 0 && strcmp(entry->ibdev_name, ibdev_name) == 0 &&
+		    strcmp(entry->fw_version, fw_version) == 0)
+			return entry;
+	}
+	return NULL;
+}
+
+/*
+ * Store the tuning of a device in the profile, replacing the entry of the same PCI address
+ *
+ * @profile [in]: Device tuning profile
+ * @tuning [in]: Device tuning
+ */
+static void tuning_profile_store(struct aes_gcm_tuning_profile *profile, const struct aes_gcm_tuning *tuning)
+{
+	uint32_t i;
+
+	for (i = 0; i < profile->num_entries; i++) {
+		if (strcmp(profile->entries[i].pci_addr, tuning->pci_addr) == 0)
+			break;
+	}
+	if (i == AES_GCM_TUNING_MAX_ENTRIES) {
+		DOCA_LOG_WARN("Tuning profile is full, device %s is not saved", tuning->pci_addr);
+		return;
+	}
+	if (i == profile->num_entries)
+		profile->num_entries++;
+	profile->entries[i] = *tuning;
+	profile->dirty = true;
+}
+
+doca_error_t aes_gcm_tuning_profile_load(const char *path, struct aes_gcm_tuning_profile *profile)
+{
+	struct aes_gcm_tuning *entry;
+	struct stat st;
+	FILE *file;
+	int fd, version;
+
+	memset(profile, 0, sizeof(*profile));
+
+	fd = open(path, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+	if (fd < 0) {
+		if (errno == ENOENT)
+			return DOCA_SUCCESS;
+		DOCA_LOG_WARN("Unable to open tuning profile %s: %s", path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	/* The profile sizes the chunks and task slots, only trust a file no other user could have written */
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_uid != geteuid() ||
+	    (st.st_mode & (S_IWGRP | S_IWOTH)) != 0) {
+		DOCA_LOG_WARN("Ignoring tuning profile %s, it is not a private file of the current user", path);
+		close(fd);
+		return DOCA_SUCCESS;
+	}
+
+	file = fdopen(fd, "r");
+	if (file == NULL) {
+		DOCA_LOG_WARN("Unable to open tuning profile %s: %s", path, strerror(errno));
+		close(fd);
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	if (fscanf(file, "version %d\n", &version) != 1 || version != TUNING_PROFILE_VERSION) {
+		DOCA_LOG_WARN("Ignoring tuning profile %s with unknown format", path);
+		fclose(file);
+		return DOCA_SUCCESS;
+	}
+
+	while (profile->num_entries < AES_GCM_TUNING_MAX_ENTRIES) {
+		entry = &profile->entries[profile->num_entries];
+		if (fscanf(file,
+			   "%12s %63s %63s %u %u %u %lf\n",
+			   entry->pci_addr,
+			   entry->ibdev_name,
+			   entry->fw_version,
+			   &entry->chunk_size,
+			   &entry->queue_depth,
+			   &entry->cpu_crossover,
+			   &entry->peak_gbps) != 7)
+			break;
+		/* A hand edited entry must not leave a device without task slots */
+		if (entry->queue_depth == 0)
+			continue;
+		profile->num_entries++;
+	}
+
+	fclose(file);
+	DOCA_LOG_DBG("Loaded %u devices from tuning profile %s", profile->num_entries, path);
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_tuning_profile_save(const char *path, struct aes_gcm_tuning_profile *profile)
+{
+	char tmp_path[MAX_FILE_NAME + 8], dir_path[MAX_FILE_NAME];
+	const struct aes_gcm_tuning *entry;
+	FILE *file;
+	uint32_t i;
+	int fd;
+
+	if (!profile->dirty)
+		return DOCA_SUCCESS;
+
+	/* The default directory is private to the user running the sample, create it on first use */
+	snprintf(dir_path, sizeof(dir_path), "%s", path);
+	if (mkdir(dirname(dir_path), 0700) != 0 && errno != EEXIST) {
+		DOCA_LOG_ERR("Unable to create the directory of tuning profile %s: %s", path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	snprintf(tmp_path, sizeof(tmp_path), "%s.XXXXXX", path);
+	fd = mkstemp(tmp_path);
+	if (fd < 0) {
+		DOCA_LOG_ERR("Unable to write tuning profile %s: %s", path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+	file = fdopen(fd, "w");
+	if (file == NULL) {
+		DOCA_LOG_ERR("Unable to write tuning profile %s: %s", tmp_path, strerror(errno));
+		close(fd);
+		remove(tmp_path);
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	fprintf(file, "version %d\n", TUNING_PROFILE_VERSION);
+	for (i = 0; i < profile->num_entries; i++) {
+		entry = &profile->entries[i];
+		fprintf(file,
+			"%s %s %s %u %u %u %.3f\n",
+			entry->pci_addr,
+			entry->ibdev_name,
+			entry->fw_version,
+			entry->chunk_size,
+			entry->queue_depth,
+			entry->cpu_crossover,
+			entry->peak_gbps);
+	}
+
+	if (fclose(file) != 0 || rename(tmp_path, path) != 0) {
+		DOCA_LOG_ERR("Unable to write tuning profile %s: %s", path, strerror(errno));
+		remove(tmp_path);
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	profile->dirty = false;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Encrypt one round of synthetic jobs of the same size on the device group and wait for all of them
+ *
+ * @run [in]: Sweep of the current queue depth
+ * @chunk_size [in]: Source size of the jobs
+ * @bytes [in/out]: Source bytes processed, the round is added to it
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t run_round(struct calibrate_run *run, uint32_t chunk_size, uint64_t *bytes)
+{
+	struct aes_gcm_job *job;
+	size_t i;
+
+	for (i = 0; i < run->num_jobs; i++) {
+		job = &run->jobs[i];
+		memset(job, 0, sizeof(*job));
+		job->src = run->src;
+		job->src_len = chunk_size;
+		job->dst = run->dst + ((i % run->num_slots) * run->slot_size);
+		job->dst_len = run->slot_size;
+		aes_gcm_derive_iv(run->cfg->iv, run->cfg->iv_length, i, job->iv);
+		job->iv_length = run->cfg->iv_length;
+		job->tag_size = run->cfg->tag_size;
+	}
+	aes_gcm_device_group_submit_burst(run->group, &run->key, run->jobs, run->num_jobs);
+	aes_gcm_device_group_wait(run->group);
+
+	for (i = 0; i < run->num_jobs; i++) {
+		if (run->jobs[i].result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Calibration job of %u bytes failed: %s",
+				     chunk_size,
+				     doca_error_get_descr(run->jobs[i].result));
+			return run->jobs[i].result;
+		}
+	}
+	*bytes += (uint64_t)run->num_jobs * chunk_size;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Measure the throughput of the device group at one chunk size, after a warmup round
+ *
+ * @run [in]: Sweep of the current queue depth
+ * @chunk_size [in]: Source size of the jobs
+ * @gbps [out]: Throughput in Gb/s
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t measure_device(struct calibrate_run *run, uint32_t chunk_size, double *gbps)
+{
+	uint64_t bytes = 0, start_ns, elapsed_ns;
+	doca_error_t result;
+
+	result = run_round(run, chunk_size, &bytes);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	bytes = 0;
+	start_ns = aes_gcm_get_time_ns();
+	do {
+		result = run_round(run, chunk_size, &bytes);
+		if (result != DOCA_SUCCESS)
+			return result;
+		elapsed_ns = aes_gcm_get_time_ns() - start_ns;
+	} while (elapsed_ns < CALIBRATE_POINT_NS);
+
+	*gbps = ((double)bytes * 8) / (double)elapsed_ns;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Measure the single core throughput of the CPU at one chunk size
+ *
+ * @cfg [in]: Configuration parameters
+ * @src [in]: Source buffer, at least chunk_size bytes
+ * @dst [in]: Destination buffer, at least chunk_size + cfg->tag_size bytes
+ * @chunk_size [in]: Source size of the jobs
+ * @gbps [out]: Throughput in Gb/s
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t measure_cpu(const struct aes_gcm_cfg *cfg, char *src, char *dst, uint32_t chunk_size, double *gbps)
+{
+	struct aes_gcm_job job = {0};
+	uint32_t key_len = (cfg->raw_key_type == DOCA_AES_GCM_KEY_128) ? 16 : 32;
+	uint64_t bytes = 0, start_ns, elapsed_ns;
+	size_t out_len;
+	doca_error_t result;
+
+	job.mode = AES_GCM_MODE_ENCRYPT;
+	job.src = src;
+	job.src_len = chunk_size;
+	job.dst = dst;
+	job.dst_len = (size_t)chunk_size + cfg->tag_size;
+	memcpy(job.iv, cfg->iv, cfg->iv_length);
+	job.iv_length = cfg->iv_length;
+	job.tag_size = cfg->tag_size;
+
+	start_ns = aes_gcm_get_time_ns();
+	do {
+		result = aes_gcm_sw_run_job(cfg->raw_key, key_len, &job, &out_len);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Calibration job of %u bytes failed on the CPU: %s",
+				     chunk_size,
+				     doca_error_get_descr(result));
+			return result;
+		}
+		bytes += chunk_size;
+		elapsed_ns = aes_gcm_get_time_ns() - start_ns;
+	} while (elapsed_ns < CALIBRATE_POINT_NS);
+
+	*gbps = ((double)bytes * 8) / (double)elapsed_ns;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Sweep the chunk sizes on a device at one queue depth
+ *
+ * @dev_cfg [in]: Configuration parameters, restricted to the calibrated device
+ * @depth_idx [in]: Index of the queue depth in calibrate_queue_depths
+ * @src [in]: Source buffer, MAX_CHUNK_SIZE bytes
+ * @dst [in]: Destination buffers, CALIBRATE_DST_SLOTS of MAX_CHUNK_SIZE + tag size bytes
+ * @sweep [in/out]: Sweep results, the row of the queue depth is filled
+ * @too_deep [out]: The device has less task slots than the queue depth, nothing was measured
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t sweep_queue_depth(struct aes_gcm_cfg *dev_cfg,
+				      size_t depth_idx,
+				      char *src,
+				      char *dst,
+				      struct calibrate_sweep *sweep,
+				      bool *too_deep)
+{
+	struct calibrate_run run = {0};
+	uint32_t queue_depth = calibrate_queue_depths[depth_idx];
+	size_t i;
+	doca_error_t result, tmp_result;
+
+	*too_deep = false;
+	run.cfg = dev_cfg;
+	run.src = src;
+	run.dst = dst;
+	run.slot_size = (size_t)MAX_CHUNK_SIZE + dev_cfg->tag_size;
+	run.num_slots = (queue_depth < CALIBRATE_DST_SLOTS) ? queue_depth : CALIBRATE_DST_SLOTS;
+	run.num_jobs = (size_t)queue_depth * CALIBRATE_JOBS_PER_SLOT;
+
+	dev_cfg->queue_depth = queue_depth;
+	result = aes_gcm_device_group_create(dev_cfg, AES_GCM_MODE_ENCRYPT, &run.group);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create device group: %s", doca_error_get_descr(result));
+		return result;
+	}
+	if (run.group->members[0].max_inflight < queue_depth) {
+		*too_deep = true;
+		goto destroy_group;
+	}
+
+	run.jobs = calloc(run.num_jobs, sizeof(*run.jobs));
+	if (run.jobs == NULL) {
+		result = DOCA_ERROR_NO_MEMORY;
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(result));
+		goto destroy_group;
+	}
+
+	result = aes_gcm_device_group_start(run.group, src, MAX_CHUNK_SIZE, dst, CALIBRATE_DST_SLOTS * run.slot_size);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+
+	result = aes_gcm_device_group_key_create(run.group, dev_cfg->raw_key, dev_cfg->raw_key_type, &run.key);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+
+	for (i = 0; i < NUM_CHUNK_SIZES && calibrate_chunk_sizes[i] <= run.group->max_buf_size; i++) {
+		result = measure_device(&run, calibrate_chunk_sizes[i], &sweep->dev_gbps[depth_idx][i]);
+		if (result != DOCA_SUCCESS)
+			break;
+	}
+
+	tmp_result = aes_gcm_device_group_key_destroy(run.group, &run.key);
+	DOCA_ERROR_PROPAGATE(result, tmp_result);
+destroy_group:
+	tmp_result = aes_gcm_device_group_destroy(run.group);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to destroy device group: %s", doca_error_get_descr(tmp_result));
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+	free(run.jobs);
+	return result;
+}
+
+/*
+ * Pick the tuning of a device from its sweep results
+ *
+ * @sweep [in]: Sweep results
+ * @tuning [in/out]: Device tuning, the identity fields are left as they are
+ */
+static void derive_tuning(const struct calibrate_sweep *sweep, struct aes_gcm_tuning *tuning)
+{
+	double peak = 0, chunk_peak;
+	size_t depth, chunk, i;
+
+	for (depth = 0; depth < NUM_QUEUE_DEPTHS; depth++) {
+		for (chunk = 0; chunk < NUM_CHUNK_SIZES; chunk++) {
+			if (sweep->dev_gbps[depth][chunk] > peak)
+				peak = sweep->dev_gbps[depth][chunk];
+		}
+	}
+
+	/* Smaller chunks spread a file over more tasks, take the smallest one close enough to the peak */
+	for (chunk = 0; chunk < NUM_CHUNK_SIZES - 1; chunk++) {
+		chunk_peak = 0;
+		for (depth = 0; depth < NUM_QUEUE_DEPTHS; depth++) {
+			if (sweep->dev_gbps[depth][chunk] > chunk_peak)
+				chunk_peak = sweep->dev_gbps[depth][chunk];
+		}
+		if (chunk_peak >= (1 - CALIBRATE_TOLERANCE) * peak)
+			break;
+	}
+	chunk_peak = 0;
+	for (depth = 0; depth < NUM_QUEUE_DEPTHS; depth++) {
+		if (sweep->dev_gbps[depth][chunk] > chunk_peak)
+			chunk_peak = sweep->dev_gbps[depth][chunk];
+	}
+
+	/* A deeper queue only adds latency once the device is saturated */
+	for (depth = 0; depth < NUM_QUEUE_DEPTHS - 1; depth++) {
+		if (sweep->dev_gbps[depth][chunk] >= (1 - CALIBRATE_TOLERANCE) * chunk_peak)
+			break;
+	}
+
+	tuning->chunk_size = calibrate_chunk_sizes[chunk];
+	tuning->queue_depth = calibrate_queue_depths[depth];
+	tuning->peak_gbps = peak;
+
+	/* The CPU keeps the jobs below the size from which the device stays ahead of it */
+	tuning->cpu_crossover = 0;
+	for (i = NUM_CHUNK_SIZES; i > 0; i--) {
+		if (sweep->dev_gbps[depth][i - 1] == 0)
+			continue;
+		if (sweep->dev_gbps[depth][i - 1] < sweep->cpu_gbps[i - 1]) {
+			tuning->cpu_crossover = calibrate_chunk_sizes[(i < NUM_CHUNK_SIZES) ? i : (i - 1)];
+			break;
+		}
+	}
+}
+
+/*
+ * Log the sweep results of a device, one line per chunk size
+ *
+ * @pci_addr [in]: Device PCI address
+ * @sweep [in]: Sweep results
+ */
+static void log_sweep(const char *pci_addr, const struct calibrate_sweep *sweep)
+{
+	char line[256];
+	size_t depth, chunk;
+	int len;
+
+	for (chunk = 0; chunk < NUM_CHUNK_SIZES; chunk++) {
+		len = 0;
+		for (depth = 0; depth < NUM_QUEUE_DEPTHS; depth++)
+			len += snprintf(line + len,
+					sizeof(line) - len,
+					" qd%u %.2f",
+					calibrate_queue_depths[depth],
+					sweep->dev_gbps[depth][chunk]);
+		DOCA_LOG_INFO("Calibration: device %s chunk %u:%s, cpu %.2f Gb/s",
+			      pci_addr,
+			      calibrate_chunk_sizes[chunk],
+			      line,
+			      sweep->cpu_gbps[chunk]);
+	}
+}
+
+/*
+ * Sweep a single device and pick its tuning
+ *
+ * @cfg [in]: Configuration parameters
+ * @emulated [in]: The device is an emulated one
+ * @tuning [in/out]: Device tuning, the identity fields must be set
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t calibrate_device(const struct aes_gcm_cfg *cfg, bool emulated, struct aes_gcm_tuning *tuning)
+{
+	struct aes_gcm_cfg *dev_cfg;
+	struct calibrate_sweep *sweep;
+	struct aes_gcm_mem src_mem = {0}, dst_mem = {0};
+	size_t slot_size = (size_t)MAX_CHUNK_SIZE + cfg->tag_size;
+	size_t i;
+	bool too_deep = false;
+	doca_error_t result;
+
+	dev_cfg = malloc(sizeof(*dev_cfg));
+	sweep = calloc(1, sizeof(*sweep));
+	if (dev_cfg == NULL || sweep == NULL) {
+		result = DOCA_ERROR_NO_MEMORY;
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(result));
+		goto free_sweep;
+	}
+
+	/* Each device is measured alone, with a fixed queue depth and without any CPU help */
+	*dev_cfg = *cfg;
+	if (emulated) {
+		dev_cfg->emu.num_devices = 1;
+	} else {
+		dev_cfg->all_devices = false;
+		strcpy(dev_cfg->pci_addresses[0], tuning->pci_addr);
+		dev_cfg->num_pci_addresses = 1;
+	}
+	dev_cfg->latency_target_us = 0;
+	dev_cfg->cpu_fallback = false;
+	dev_cfg->aad_size = 0;
+
+	result = aes_gcm_mem_alloc(cfg->hugepages, MAX_CHUNK_SIZE, &src_mem);
+	if (result != DOCA_SUCCESS)
+		goto free_sweep;
+	result = aes_gcm_mem_alloc(cfg->hugepages, CALIBRATE_DST_SLOTS * slot_size, &dst_mem);
+	if (result != DOCA_SUCCESS)
+		goto free_sweep;
+	memset(src_mem.addr, 0xa5, MAX_CHUNK_SIZE);
+	memset(dst_mem.addr, 0, CALIBRATE_DST_SLOTS * slot_size);
+
+	DOCA_LOG_INFO("Calibrating device %s, firmware %s", tuning->pci_addr, tuning->fw_version);
+	for (i = 0; i < NUM_QUEUE_DEPTHS && !too_deep; i++) {
+		result = sweep_queue_depth(dev_cfg, i, src_mem.addr, dst_mem.addr, sweep, &too_deep);
+		if (result != DOCA_SUCCESS)
+			goto free_sweep;
+	}
+	for (i = 0; i < NUM_CHUNK_SIZES; i++) {
+		result = measure_cpu(dev_cfg,
+				     src_mem.addr,
+				     dst_mem.addr,
+				     calibrate_chunk_sizes[i],
+				     &sweep->cpu_gbps[i]);
+		if (result != DOCA_SUCCESS)
+			goto free_sweep;
+	}
+
+	log_sweep(tuning->pci_addr, sweep);
+	derive_tuning(sweep, tuning);
+	DOCA_LOG_INFO("Device %s tuned: chunk size %u, queue depth %u, CPU under %u bytes, peak %.2f Gb/s",
+		      tuning->pci_addr,
+		      tuning->chunk_size,
+		      tuning->queue_depth,
+		      tuning->cpu_crossover,
+		      tuning->peak_gbps);
+
+free_sweep:
+	aes_gcm_mem_free(&dst_mem);
+	aes_gcm_mem_free(&src_mem);
+	free(sweep);
+	free(dev_cfg);
+	return result;
+}
+
+doca_error_t aes_gcm_calibrate(const struct aes_gcm_cfg *cfg)
+{
+	struct aes_gcm_tuning devices[AES_GCM_MAX_DEVICES] = {0};
+	struct aes_gcm_device_group *group = NULL;
+	struct aes_gcm_tuning_profile *profile;
+	struct aes_gcm_group_member *member;
+	uint32_t num_devices, i;
+	doca_error_t result;
+
+	/* A first group resolves the requested devices and their identity */
+	result = aes_gcm_device_group_create(cfg, AES_GCM_MODE_ENCRYPT, &group);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create device group: %s", doca_error_get_descr(result));
+		return result;
+	}
+	num_devices = group->num_members;
+	for (i = 0; i < num_devices; i++) {
+		member = &group->members[i];
+		strcpy(devices[i].pci_addr, member->pci_addr);
+		strcpy(devices[i].ibdev_name, member->ibdev_name);
+		strcpy(devices[i].fw_version, member->fw_version);
+	}
+	result = aes_gcm_device_group_destroy(group);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to destroy device group: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	profile = calloc(1, sizeof(*profile));
+	if (profile == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(DOCA_ERROR_NO_MEMORY));
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	/* Devices that are not calibrated now keep their previous tuning */
+	(void)aes_gcm_tuning_profile_load(cfg->tuning_profile_path, profile);
+
+	for (i = 0; i < num_devices; i++) {
+		result = calibrate_device(cfg, cfg->emu.num_devices > 0, &devices[i]);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to calibrate device %s: %s",
+				     devices[i].pci_addr,
+				     doca_error_get_descr(result));
+			goto free_profile;
+		}
+		tuning_profile_store(profile, &devices[i]);
+	}
+
+	result = aes_gcm_tuning_profile_save(cfg->tuning_profile_path, profile);
+	if (result == DOCA_SUCCESS)
+		DOCA_LOG_INFO("Saved the tuning of %u devices to %s", num_devices, cfg->tuning_profile_path);
+
+free_profile:
+	free(profile);
+	return result;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+
+#ifndef AES_GCM_CALIBRATE_H_
+#define AES_GCM_CALIBRATE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <doca_dev.h>
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+#include "aes_gcm_startup.h"
+
+#define AES_GCM_TUNING_MAX_ENTRIES 32 /* Max number of devices in the tuning profile */
+
+/* Tuning of a device, as measured by the calibration sweep */
+struct aes_gcm_tuning {
+	char pci_addr[DOCA_DEVINFO_PCI_ADDR_SIZE];     /* Device PCI address */
+	char ibdev_name[DOCA_DEVINFO_IBDEV_NAME_SIZE]; /* Device IB name */
+	char fw_version[AES_GCM_FW_VERSION_SIZE];      /* Device firmware version */
+	uint32_t chunk_size;			       /* Smallest chunk size reaching the peak throughput */
+	uint32_t queue_depth;			       /* Smallest queue depth reaching the peak at that chunk size */
+	uint32_t cpu_crossover;			       /* Jobs with a smaller source complete sooner on the CPU */
+	double peak_gbps;			       /* Peak throughput of the sweep, in Gb/s */
+};
+
+/* Device tuning profile, entries are keyed by PCI address, IB device name and firmware version */
+struct aes_gcm_tuning_profile {
+	struct aes_gcm_tuning entries[AES_GCM_TUNING_MAX_ENTRIES]; /* Calibrated devices */
+	uint32_t num_entries;					   /* Number of calibrated devices */
+	bool dirty;						   /* Profile changed since it was loaded */
+};
+
+/*
+ * Load the device tuning profile, a missing file results in an empty profile
+ *
+ * @path [in]: Profile file path
+ * @profile [out]: The loaded profile
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_tuning_profile_load(const char *path, struct aes_gcm_tuning_profile *profile);
+
+/*
+ * Save the device tuning profile if it changed, the file is replaced atomically
+ *
+ * @path [in]: Profile file path
+ * @profile [in]: The profile to save
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_tuning_profile_save(const char *path, struct aes_gcm_tuning_profile *profile);
+
+/*
+ * Find the tuning of a device, a device whose firmware changed since it was calibrated is not found
+ *
+ * @profile [in]: Device tuning profile
+ * @pci_addr [in]: Device PCI address
+ * @ibdev_name [in]: Device IB name
+ * @fw_version [in]: Device firmware version
+ * @return: the device tuning or NULL
+ */
+const struct aes_gcm_tuning *aes_gcm_tuning_lookup(const struct aes_gcm_tuning_profile *profile,
+						   const char *pci_addr,
+						   const char *ibdev_name,
+						   const char *fw_version);
+
+/*
+ * Calibrate the devices of the configuration and save their tuning to cfg->tuning_profile_path
+ *
+ * Each device is swept on its own: synthetic jobs of every chunk size up to 1 MB are encrypted at every queue depth
+ * up to 256 for a short while, and the same chunk sizes are encrypted on the CPU. The tuning keeps the smallest chunk
+ * size and queue depth within 5% of the peak throughput, and the source size from which the device outpaces the CPU.
+ * Later device groups load the queue depth and the crossover on their own, see aes_gcm_device_group_create(); the
+ * chunk size is part of the output format, so it is only reported.
+ *
+ * @cfg [in]: Configuration parameters
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_calibrate(const struct aes_gcm_cfg *cfg);
+
+#endif /* AES_GCM_CALIBRATE_H_ */
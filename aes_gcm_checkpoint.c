@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <doca_log.h>
+#include <doca_error.h>
+
+#include "aes_gcm_checkpoint.h"
+
+DOCA_LOG_REGISTER(AES_GCM::CHECKPOINT);
+
+/*
+ * Size of the tags stored after a checkpoint header
+ *
+ * @checkpoint [in]: Checkpoint header
+ * @return: tags size in bytes
+ */
+static size_t checkpoint_tags_size(const struct aes_gcm_checkpoint *checkpoint)
+{
+	return checkpoint->detached ? (checkpoint->done_chunks * checkpoint->tag_size) : 0;
+}
+
+doca_error_t aes_gcm_checkpoint_save(const char *path,
+				     const struct aes_gcm_checkpoint *checkpoint,
+				     const uint8_t *tags)
+{
+	char tmp_path[MAX_FILE_NAME + 8], dir_path[MAX_FILE_NAME];
+	size_t tags_size = checkpoint_tags_size(checkpoint);
+	doca_error_t result;
+	bool renamed = false;
+	int fd, dir_fd;
+
+	/* An unpredictable temporary name next to the checkpoint, on the same file system for rename() */
+	snprintf(tmp_path, sizeof(tmp_path), "%s.XXXXXX", path);
+	fd = mkstemp(tmp_path);
+	if (fd < 0) {
+		DOCA_LOG_ERR("Unable to create a temporary file for checkpoint %s: %s", path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	result = aes_gcm_file_io(fd, (void *)checkpoint, sizeof(*checkpoint), 0, true);
+	if (result == DOCA_SUCCESS && tags_size != 0)
+		result = aes_gcm_file_io(fd, (void *)tags, tags_size, sizeof(*checkpoint), true);
+
+	/* The new checkpoint must be on disk before it replaces the old one */
+	if (result == DOCA_SUCCESS && fdatasync(fd) != 0)
+		result = DOCA_ERROR_IO_FAILED;
+	if (close(fd) != 0 && result == DOCA_SUCCESS)
+		result = DOCA_ERROR_IO_FAILED;
+	if (result == DOCA_SUCCESS) {
+		if (rename(tmp_path, path) == 0)
+			renamed = true;
+		else
+			result = DOCA_ERROR_IO_FAILED;
+	}
+
+	/* The rename is only durable once the directory entry reaches the disk */
+	if (renamed) {
+		snprintf(dir_path, sizeof(dir_path), "%s", path);
+		dir_fd = open(dirname(dir_path), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		if (dir_fd < 0 || fsync(dir_fd) != 0)
+			result = DOCA_ERROR_IO_FAILED;
+		if (dir_fd >= 0)
+			close(dir_fd);
+	}
+
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to write checkpoint %s: %s", path, strerror(errno));
+		if (!renamed)
+			remove(tmp_path);
+	}
+	return result;
+}
+
+doca_error_t aes_gcm_checkpoint_load(const char *path, struct aes_gcm_checkpoint *checkpoint, uint8_t **tags)
+{
+	size_t tags_size;
+	struct stat st;
+	doca_error_t result;
+	int fd;
+
+	*tags = NULL;
+	fd = open(path, O_RDONLY);
+	if (fd < 0 && errno == ENOENT)
+		return DOCA_ERROR_NOT_FOUND;
+	if (fd < 0 || fstat(fd, &st) != 0) {
+		DOCA_LOG_ERR("Unable to open checkpoint %s: %s", path, strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	result = DOCA_ERROR_INVALID_VALUE;
+	if ((size_t)st.st_size < sizeof(*checkpoint) ||
+	    aes_gcm_file_io(fd, checkpoint, sizeof(*checkpoint), 0, false) != DOCA_SUCCESS ||
+	    memcmp(checkpoint->magic, AES_GCM_CHECKPOINT_MAGIC, sizeof(checkpoint->magic)) != 0 ||
+	    checkpoint->version != AES_GCM_CHECKPOINT_VERSION || checkpoint->done_chunks > checkpoint->num_chunks ||
+	    (size_t)st.st_size != sizeof(*checkpoint) + checkpoint_tags_size(checkpoint)) {
+		DOCA_LOG_ERR("File %s is not a valid checkpoint", path);
+		goto close_file;
+	}
+
+	tags_size = checkpoint_tags_size(checkpoint);
+	if (tags_size != 0) {
+		*tags = malloc(tags_size);
+		if (*tags == NULL) {
+			result = DOCA_ERROR_NO_MEMORY;
+			DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(result));
+			goto close_file;
+		}
+		result = aes_gcm_file_io(fd, *tags, tags_size, sizeof(*checkpoint), false);
+		if (result != DOCA_SUCCESS) {
+			free(*tags);
+			*tags = NULL;
+			goto close_file;
+		}
+	}
+	result = DOCA_SUCCESS;
+
+close_file:
+	close(fd);
+	return result;
+}
+
+void aes_gcm_checkpoint_remove(const char *path)
+{
+	if (remove(path) != 0 && errno != ENOENT)
+		DOCA_LOG_WARN("Unable to remove checkpoint %s: %s", path, strerror(errno));
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_CHECKPOINT_H_
+#define AES_GCM_CHECKPOINT_H_
+
+#include <stdint.h>
+
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+
+#define AES_GCM_CHECKPOINT_MAGIC "AGCK"		     /* Checkpoint file magic */
+#define AES_GCM_CHECKPOINT_VERSION 1		     /* Checkpoint file format version */
+#define AES_GCM_CHECKPOINT_INTERVAL_NS 1000000000ULL /* Min time between two checkpoints of a run */
+
+/*
+ * Checkpoint file header, in host byte order. On detached runs it is followed by the tags of the done_chunks first
+ * chunks, tag_size bytes each in chunk order.
+ *
+ * The IV of chunk i is derived from iv and i, so the IV counter of the next chunk to process is done_chunks.
+ */
+struct aes_gcm_checkpoint {
+	char magic[4];			   /* AES_GCM_CHECKPOINT_MAGIC, not NULL terminated */
+	uint32_t version;		   /* AES_GCM_CHECKPOINT_VERSION */
+	uint32_t mode;			   /* AES-GCM mode - encrypt/decrypt */
+	uint32_t detached;		   /* Tags are kept in a tag index rather than in the output */
+	uint32_t tag_size;		   /* Size of every tag */
+	uint32_t aad_size;		   /* AAD bytes at the head of every chunk */
+	uint32_t iv_length;		   /* Base IV length */
+	uint8_t iv[MAX_AES_GCM_IV_LENGTH]; /* Base IV the chunk IVs are derived from */
+	uint64_t in_chunk_size;		   /* Input bytes per chunk */
+	uint64_t out_chunk_size;	   /* Output capacity per chunk */
+	uint64_t file_size;		   /* Input file size */
+	uint64_t num_chunks;		   /* Number of chunks of the input */
+	uint64_t done_chunks;		   /* Watermark: chunks 0 to done_chunks - 1 are in the output */
+	uint64_t output_size;		   /* Output bytes of the done chunks */
+};
+
+/*
+ * Save a checkpoint, atomically and durably: the file is replaced by a complete and synced copy or left untouched
+ *
+ * @path [in]: Checkpoint file path
+ * @checkpoint [in]: Checkpoint header
+ * @tags [in]: Tags of the done chunks, NULL unless checkpoint->detached
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_checkpoint_save(const char *path,
+				     const struct aes_gcm_checkpoint *checkpoint,
+				     const uint8_t *tags);
+
+/*
+ * Load a checkpoint
+ *
+ * @path [in]: Checkpoint file path
+ * @checkpoint [out]: Checkpoint header
+ * @tags [out]: Tags of the done chunks, to be freed by the caller, NULL unless checkpoint->detached
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR_NOT_FOUND if there is no checkpoint, DOCA_ERROR_INVALID_VALUE if the
+ * file is not a valid checkpoint and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_checkpoint_load(const char *path, struct aes_gcm_checkpoint *checkpoint, uint8_t **tags);
+
+/*
+ * Remove the checkpoint of a finished run
+ *
+ * @path [in]: Checkpoint file path
+ */
+void aes_gcm_checkpoint_remove(const char *path);
+
+#endif /* AES_GCM_CHECKPOINT_H_ */
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <string.h>
+
+#ifdef AES_GCM_HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef AES_GCM_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include <doca_log.h>
+#include <doca_error.h>
+
+#include "aes_gcm_codec.h"
+
+DOCA_LOG_REGISTER(AES_GCM::CODEC);
+
+/*
+ * Store codec - get the worst case compressed size
+ *
+ * @src_len [in]: Uncompressed size
+ * @return: max compressed size
+ */
+static size_t store_compress_bound(size_t src_len)
+{
+	return src_len;
+}
+
+/*
+ * Store codec - copy the payload
+ *
+ * @src [in]: Uncompressed data
+ * @src_len [in]: Uncompressed size
+ * @dst [out]: Compressed data
+ * @dst_capacity [in]: dst size
+ * @dst_len [out]: Compressed size
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t store_compress(const void *src, size_t src_len, void *dst, size_t dst_capacity, size_t *dst_len)
+{
+	if (src_len > dst_capacity)
+		return DOCA_ERROR_NO_MEMORY;
+	memcpy(dst, src, src_len);
+	*dst_len = src_len;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Store codec - copy the payload back
+ *
+ * @src [in]: Compressed data
+ * @src_len [in]: Compressed size
+ * @dst [out]: Uncompressed data
+ * @dst_len [in]: Expected uncompressed size
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t store_decompress(const void *src, size_t src_len, void *dst, size_t dst_len)
+{
+	if (src_len != dst_len)
+		return DOCA_ERROR_INVALID_VALUE;
+	memcpy(dst, src, src_len);
+	return DOCA_SUCCESS;
+}
+
+#ifdef AES_GCM_HAVE_LZ4
+/*
+ * LZ4 codec - get the worst case compressed size
+ *
+ * @src_len [in]: Uncompressed size
+ * @return: max compressed size
+ */
+static size_t lz4_compress_bound(size_t src_len)
+{
+	return LZ4_compressBound((int)src_len);
+}
+
+/*
+ * LZ4 codec - compress a buffer
+ *
+ * @src [in]: Uncompressed data
+ * @src_len [in]: Uncompressed size
+ * @dst [out]: Compressed data
+ * @dst_capacity [in]: dst size
+ * @dst_len [out]: Compressed size
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t lz4_compress(const void *src, size_t src_len, void *dst, size_t dst_capacity, size_t *dst_len)
+{
+	int ret;
+
+	ret = LZ4_compress_default(src, dst, (int)src_len, (int)dst_capacity);
+	if (ret <= 0) {
+		DOCA_LOG_ERR("LZ4 compression of %zu bytes failed", src_len);
+		return DOCA_ERROR_UNEXPECTED;
+	}
+	*dst_len = ret;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * LZ4 codec - decompress a buffer
+ *
+ * @src [in]: Compressed data
+ * @src_len [in]: Compressed size
+ * @dst [out]: Uncompressed data
+ * @dst_len [in]: Expected uncompressed size
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t lz4_decompress(const void *src, size_t src_len, void *dst, size_t dst_len)
+{
+	int ret;
+
+	ret = LZ4_decompress_safe(src, dst, (int)src_len, (int)dst_len);
+	if (ret < 0 || (size_t)ret != dst_len) {
+		DOCA_LOG_ERR("LZ4 decompression of %zu bytes failed", src_len);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+#endif /* AES_GCM_HAVE_LZ4 */
+
+#ifdef AES_GCM_HAVE_ZSTD
+/*
+ * Zstandard codec - get the worst case compressed size
+ *
+ * @src_len [in]: Uncompressed size
+ * @return: max compressed size
+ */
+static size_t zstd_compress_bound(size_t src_len)
+{
+	return ZSTD_compressBound(src_len);
+}
+
+/*
+ * Zstandard codec - compress a buffer
+ *
+ * @src [in]: Uncompressed data
+ * @src_len [in]: Uncompressed size
+ * @dst [out]: Compressed data
+ * @dst_capacity [in]: dst size
+ * @dst_len [out]: Compressed size
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t zstd_compress(const void *src, size_t src_len, void *dst, size_t dst_capacity, size_t *dst_len)
+{
+	size_t ret;
+
+	ret = ZSTD_compress(dst, dst_capacity, src, src_len, ZSTD_CLEVEL_DEFAULT);
+	if (ZSTD_isError(ret)) {
+		DOCA_LOG_ERR("Zstandard compression of %zu bytes failed: %s", src_len, ZSTD_getErrorName(ret));
+		return DOCA_ERROR_UNEXPECTED;
+	}
+	*dst_len = ret;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Zstandard codec - decompress a buffer
+ *
+ * @src [in]: Compressed data
+ * @src_len [in]: Compressed size
+ * @dst [out]: Uncompressed data
+ * @dst_len [in]: Expected uncompressed size
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t zstd_decompress(const void *src, size_t src_len, void *dst, size_t dst_len)
+{
+	size_t ret;
+
+	ret = ZSTD_decompress(dst, dst_len, src, src_len);
+	if (ZSTD_isError(ret) || ret != dst_len) {
+		DOCA_LOG_ERR("Zstandard decompression of %zu bytes failed", src_len);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+#endif /* AES_GCM_HAVE_ZSTD */
+
+/* Built-in codecs */
+static const struct aes_gcm_codec codecs[] = {
+	{"store", AES_GCM_CODEC_STORE, store_compress_bound, store_compress, store_decompress},
+#ifdef AES_GCM_HAVE_LZ4
+	{"lz4", AES_GCM_CODEC_LZ4, lz4_compress_bound, lz4_compress, lz4_decompress},
+#endif
+#ifdef AES_GCM_HAVE_ZSTD
+	{"zstd", AES_GCM_CODEC_ZSTD, zstd_compress_bound, zstd_compress, zstd_decompress},
+#endif
+};
+
+const struct aes_gcm_codec *aes_gcm_codec_find(const char *name)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof(codecs) / sizeof(codecs[0]); i++) {
+		if (strcmp(codecs[i].name, name) == 0)
+			return &codecs[i];
+	}
+	return NULL;
+}
+
+const struct aes_gcm_codec *aes_gcm_codec_get(uint32_t id)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof(codecs) / sizeof(codecs[0]); i++) {
+		if ((uint32_t)codecs[i].id == id)
+			return &codecs[i];
+	}
+	return NULL;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_CODEC_H_
+#define AES_GCM_CODEC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <doca_error.h>
+
+/* Compression codec identifiers, as recorded in the frame header */
+enum aes_gcm_codec_id {
+	AES_GCM_CODEC_STORE = 0, /* Payload stored as is */
+	AES_GCM_CODEC_LZ4 = 1,	 /* LZ4 block format */
+	AES_GCM_CODEC_ZSTD = 2,	 /* Zstandard frame format */
+};
+
+/*
+ * Compression codec
+ *
+ * The compression stage only goes through these callbacks, so an offloaded codec (e.g. a DOCA compress context) can
+ * be added to the codec table without changing the pipeline.
+ */
+struct aes_gcm_codec {
+	const char *name;	  /* Codec name, as given on the command line */
+	enum aes_gcm_codec_id id; /* Codec identifier */
+	/*
+	 * Get the worst case compressed size
+	 *
+	 * @src_len [in]: Uncompressed size
+	 * @return: max compressed size
+	 */
+	size_t (*compress_bound)(size_t src_len);
+	/*
+	 * Compress a buffer
+	 *
+	 * @src [in]: Uncompressed data
+	 * @src_len [in]: Uncompressed size
+	 * @dst [out]: Compressed data
+	 * @dst_capacity [in]: dst size, at least compress_bound(src_len)
+	 * @dst_len [out]: Compressed size
+	 * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+	 */
+	doca_error_t (*compress)(const void *src, size_t src_len, void *dst, size_t dst_capacity, size_t *dst_len);
+	/*
+	 * Decompress a buffer
+	 *
+	 * @src [in]: Compressed data
+	 * @src_len [in]: Compressed size
+	 * @dst [out]: Uncompressed data
+	 * @dst_len [in]: Expected uncompressed size
+	 * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+	 */
+	doca_error_t (*decompress)(const void *src, size_t src_len, void *dst, size_t dst_len);
+};
+
+/*
+ * Find a codec by name
+ *
+ * @name [in]: Codec name
+ * @return: the codec, or NULL if it is unknown or was not built in
+ */
+const struct aes_gcm_codec *aes_gcm_codec_find(const char *name);
+
+/*
+ * Find a codec by identifier
+ *
+ * @id [in]: Codec identifier, as read from a frame header
+ * @return: the codec, or NULL if it is unknown or was not built in
+ */
+const struct aes_gcm_codec *aes_gcm_codec_get(uint32_t id);
+
+#endif /* AES_GCM_CODEC_H_ */
@@ -11,6 +11,7 @@
  *
  */
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -18,15 +19,22 @@
 #include <time.h>
 #include <ctype.h>
 
+#include <doca_buf.h>
+#include <doca_buf_inventory.h>
 #include <doca_ctx.h>
 #include <doca_log.h>
 #include <doca_error.h>
+#include <doca_mmap.h>
 #include <doca_pe.h>
 #include <doca_argp.h>
 #include <doca_aes_gcm.h>
 
 #include "../common.h"
 #include "aes_gcm_common.h"
+#include "aes_gcm_emu.h"
+#include "aes_gcm_hugepage.h"
+#include "aes_gcm_metrics.h"
+#include "aes_gcm_tenant.h"
 
 DOCA_LOG_REGISTER(AES_GCM::COMMON);
 
@@ -46,6 +54,48 @@ void init_aes_gcm_params(struct aes_gcm_cfg *aes_gcm_cfg)
 	aes_gcm_cfg->iv_length = MAX_AES_GCM_IV_LENGTH;
 	aes_gcm_cfg->tag_size = AES_GCM_AUTH_TAG_96_SIZE_IN_BYTES;
 	aes_gcm_cfg->aad_size = 0;
+	strcpy(aes_gcm_cfg->pci_addresses[0], aes_gcm_cfg->pci_address);
+	aes_gcm_cfg->num_pci_addresses = 1;
+	aes_gcm_cfg->all_devices = false;
+	aes_gcm_cfg->chunk_size = 0;
+	strcpy(aes_gcm_cfg->caps_cache_path, AES_GCM_DEFAULT_CAPS_CACHE);
+	aes_gcm_cfg->queue_depth = AES_GCM_DEFAULT_QUEUE_DEPTH;
+	aes_gcm_cfg->queue_depth_set = false;
+	aes_gcm_cfg->latency_target_us = 0;
+	aes_gcm_cfg->verify_only = false;
+	aes_gcm_cfg->tag_index_path[0] = '\0';
+	aes_gcm_cfg->compress_codec[0] = '\0';
+	aes_gcm_emu_model_init(&aes_gcm_cfg->emu);
+	aes_gcm_cfg->no_numa = false;
+	aes_gcm_cfg->hugepages = AES_GCM_HUGEPAGE_OFF;
+	aes_gcm_cfg->low_latency = false;
+	aes_gcm_cfg->poll_cpu = -1;
+	aes_gcm_cfg->latency_bench = 0;
+	aes_gcm_cfg->submit_burst = 1;
+	aes_gcm_cfg->submit_burst_timeout_us = AES_GCM_DEFAULT_BURST_TIMEOUT_US;
+	aes_gcm_cfg->records = false;
+	aes_gcm_cfg->tls_secret_len = 0;
+	aes_gcm_cfg->tls_verify = false;
+	aes_gcm_cfg->block_image_path[0] = '\0';
+	aes_gcm_cfg->sector_size = AES_GCM_DEFAULT_SECTOR_SIZE;
+	aes_gcm_cfg->first_sector = 0;
+	aes_gcm_cfg->num_sectors = 0;
+	aes_gcm_cfg->cpu_fallback = false;
+	aes_gcm_cfg->metrics_path[0] = '\0';
+	aes_gcm_cfg->metrics_port = 0;
+	strcpy(aes_gcm_cfg->tuning_profile_path, AES_GCM_DEFAULT_TUNING_PROFILE);
+	aes_gcm_cfg->calibrate = false;
+	aes_gcm_cfg->gmac_manifest_path[0] = '\0';
+	aes_gcm_cfg->dst_buffers = AES_GCM_DST_FULL;
+	aes_gcm_cfg->sparse = false;
+	aes_gcm_cfg->checkpoint_path[0] = '\0';
+	aes_gcm_cfg->resume = false;
+	aes_gcm_cfg->priority_reserve = 0;
+	aes_gcm_cfg->deadline_us = 0;
+	aes_gcm_cfg->bench_bulk = 0;
+	aes_gcm_cfg->num_tenants = 0;
+	aes_gcm_cfg->relay_listen[0] = '\0';
+	aes_gcm_cfg->relay_target[0] = '\0';
 }
 
 /*
@@ -82,6 +132,8 @@ static doca_error_t parse_hex_to_bytes(const char *hex_str, size_t hex_str_size,
 /*
  * ARGP Callback - Handle PCI device address parameter
  *
+ * A comma separated list of addresses builds a device group, the first address is also used as the single device
+ *
  * @param [in]: Input parameter
  * @config [in/out]: Program configuration context
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
@@ -90,15 +142,33 @@ static doca_error_t pci_address_callback(void *param, void *config)
 {
 	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
 	char *pci_address = (char *)param;
+	char *next;
 	int len;
 
-	len = strnlen(pci_address, DOCA_DEVINFO_PCI_ADDR_SIZE);
-	if (len == DOCA_DEVINFO_PCI_ADDR_SIZE) {
-		DOCA_LOG_ERR("Entered device PCI address exceeding the maximum size of %d",
-			     DOCA_DEVINFO_PCI_ADDR_SIZE - 1);
-		return DOCA_ERROR_INVALID_VALUE;
-	}
-	strncpy(aes_gcm_cfg->pci_address, pci_address, len + 1);
+	aes_gcm_cfg->num_pci_addresses = 0;
+	do {
+		next = strchr(pci_address, ',');
+		len = (next != NULL) ? (int)(next - pci_address) : (int)strnlen(pci_address, DOCA_DEVINFO_PCI_ADDR_SIZE);
+		if (len == 0) {
+			DOCA_LOG_ERR("Entered an empty device PCI address, the list must not have empty entries");
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		if (len >= DOCA_DEVINFO_PCI_ADDR_SIZE) {
+			DOCA_LOG_ERR("Entered device PCI address exceeding the maximum size of %d",
+				     DOCA_DEVINFO_PCI_ADDR_SIZE - 1);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		if (aes_gcm_cfg->num_pci_addresses == AES_GCM_MAX_DEVICES) {
+			DOCA_LOG_ERR("Entered more than %d device PCI addresses", AES_GCM_MAX_DEVICES);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		memcpy(aes_gcm_cfg->pci_addresses[aes_gcm_cfg->num_pci_addresses], pci_address, len);
+		aes_gcm_cfg->pci_addresses[aes_gcm_cfg->num_pci_addresses][len] = '\0';
+		aes_gcm_cfg->num_pci_addresses++;
+		pci_address = (next != NULL) ? next + 1 : NULL;
+	} while (pci_address != NULL);
+
+	strcpy(aes_gcm_cfg->pci_address, aes_gcm_cfg->pci_addresses[0]);
 	return DOCA_SUCCESS;
 }
 
@@ -244,197 +314,1669 @@ static doca_error_t aad_callback(void *param, void *config)
 }
 
 /*
- * Register the command line parameters for the sample.
+ * ARGP Callback - Handle all devices parameter
  *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
-doca_error_t register_aes_gcm_params(void)
+static doca_error_t all_devices_callback(void *param, void *config)
 {
-	doca_error_t result;
-	struct doca_argp_param *pci_param, *file_param, *output_param, *raw_key_param, *iv_param, *tag_size_param,
-		*aad_size_param;
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
 
-	result = doca_argp_param_create(&pci_param);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
-		return result;
-	}
-	doca_argp_param_set_short_name(pci_param, "p");
-	doca_argp_param_set_long_name(pci_param, "pci-addr");
-	doca_argp_param_set_description(pci_param, "DOCA device PCI device address - default: 03:00.0");
-	doca_argp_param_set_callback(pci_param, pci_address_callback);
-	doca_argp_param_set_type(pci_param, DOCA_ARGP_TYPE_STRING);
-	result = doca_argp_register_param(pci_param);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
-		return result;
-	}
+	aes_gcm_cfg->all_devices = *(bool *)param;
+	return DOCA_SUCCESS;
+}
 
-	result = doca_argp_param_create(&file_param);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
-		return result;
-	}
-	doca_argp_param_set_short_name(file_param, "f");
-	doca_argp_param_set_long_name(file_param, "file");
-	doca_argp_param_set_description(file_param, "Input file to encrypt/decrypt");
-	doca_argp_param_set_mandatory(file_param);
-	doca_argp_param_set_callback(file_param, file_callback);
-	doca_argp_param_set_type(file_param, DOCA_ARGP_TYPE_STRING);
-	result = doca_argp_register_param(file_param);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
-		return result;
-	}
+/*
+ * ARGP Callback - Handle chunk size parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t chunk_size_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	int chunk_size = *(int *)param;
 
-	result = doca_argp_param_create(&output_param);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
-		return result;
-	}
-	doca_argp_param_set_short_name(output_param, "o");
-	doca_argp_param_set_long_name(output_param, "output");
-	doca_argp_param_set_description(output_param, "Output file - default: /tmp/out.txt");
-	doca_argp_param_set_callback(output_param, output_callback);
-	doca_argp_param_set_type(output_param, DOCA_ARGP_TYPE_STRING);
-	result = doca_argp_register_param(output_param);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
-		return result;
+	if (chunk_size < 0) {
+		DOCA_LOG_ERR("Invalid chunk size %d, chunk size must not be negative", chunk_size);
+		return DOCA_ERROR_INVALID_VALUE;
 	}
+	aes_gcm_cfg->chunk_size = chunk_size;
+	return DOCA_SUCCESS;
+}
 
-	result = doca_argp_param_create(&raw_key_param);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
-		return result;
-	}
-	doca_argp_param_set_short_name(raw_key_param, "k");
-	doca_argp_param_set_long_name(raw_key_param, "key");
-	doca_argp_param_set_description(
-		raw_key_param,
-		"Raw key to encrypt/decrypt with, represented in hex format (32 characters for 128-bit key, and 64 for 256-bit key) - default: 256-bit key, equals to zero");
-	doca_argp_param_set_callback(raw_key_param, raw_key_callback);
-	doca_argp_param_set_type(raw_key_param, DOCA_ARGP_TYPE_STRING);
-	result = doca_argp_register_param(raw_key_param);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
-		return result;
-	}
+/*
+ * ARGP Callback - Handle queue depth parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t queue_depth_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	int queue_depth = *(int *)param;
 
-	result = doca_argp_param_create(&iv_param);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
-		return result;
-	}
-	doca_argp_param_set_short_name(iv_param, "i");
-	doca_argp_param_set_long_name(iv_param, "iv");
-	doca_argp_param_set_description(
-		iv_param,
-		"Initialization vector, represented in hex format (0-24 characters for 0-96-bit IV) - default: 96-bit IV, equals to zero");
-	doca_argp_param_set_callback(iv_param, iv_callback);
-	doca_argp_param_set_type(iv_param, DOCA_ARGP_TYPE_STRING);
-	result = doca_argp_register_param(iv_param);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
-		return result;
+	if (queue_depth <= 0) {
+		DOCA_LOG_ERR("Invalid queue depth %d, queue depth must be positive", queue_depth);
+		return DOCA_ERROR_INVALID_VALUE;
 	}
+	aes_gcm_cfg->queue_depth = queue_depth;
+	aes_gcm_cfg->queue_depth_set = true;
+	return DOCA_SUCCESS;
+}
 
-	result = doca_argp_param_create(&tag_size_param);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
-		return result;
-	}
-	doca_argp_param_set_short_name(tag_size_param, "t");
-	doca_argp_param_set_long_name(tag_size_param, "tag-size");
-	doca_argp_param_set_description(
-		tag_size_param,
-		"Authentication tag size. Tag size is in bytes and can be 12B or 16B - default: 12");
-	doca_argp_param_set_callback(tag_size_param, tag_callback);
-	doca_argp_param_set_type(tag_size_param, DOCA_ARGP_TYPE_INT);
-	result = doca_argp_register_param(tag_size_param);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
-		return result;
-	}
+/*
+ * ARGP Callback - Handle latency target parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t latency_target_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	int latency_target = *(int *)param;
 
-	result = doca_argp_param_create(&aad_size_param);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
-		return result;
-	}
-	doca_argp_param_set_short_name(aad_size_param, "a");
-	doca_argp_param_set_long_name(aad_size_param, "aad-size");
-	doca_argp_param_set_description(aad_size_param, "Additional authenticated data size - default: 0");
-	doca_argp_param_set_callback(aad_size_param, aad_callback);
-	doca_argp_param_set_type(aad_size_param, DOCA_ARGP_TYPE_INT);
-	result = doca_argp_register_param(aad_size_param);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
-		return result;
+	if (latency_target < 0) {
+		DOCA_LOG_ERR("Invalid latency target %d, latency target must not be negative", latency_target);
+		return DOCA_ERROR_INVALID_VALUE;
 	}
+	aes_gcm_cfg->latency_target_us = latency_target;
+	return DOCA_SUCCESS;
+}
 
+/*
+ * ARGP Callback - Handle capabilities cache parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t caps_cache_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	char *file = (char *)param;
+	int len;
+
+	len = strnlen(file, MAX_FILE_NAME);
+	if (len == MAX_FILE_NAME) {
+		DOCA_LOG_ERR("Invalid file name length, max %d", USER_MAX_FILE_NAME);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	strcpy(aes_gcm_cfg->caps_cache_path, file);
 	return DOCA_SUCCESS;
 }
 
-/**
- * Callback triggered whenever AES-GCM state changes
+/*
+ * ARGP Callback - Handle verify parameter
  *
- * @user_data [in]: User data associated with the AES-GCM context. Will hold struct aes_gcm_resources *
- * @ctx [in]: The AES-GCM context that had a state change
- * @prev_state [in]: Previous context state
- * @next_state [in]: Next context state (context is already in this state when the callback is called)
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
-static void aes_gcm_state_changed_callback(const union doca_data user_data,
-					   struct doca_ctx *ctx,
-					   enum doca_ctx_states prev_state,
-					   enum doca_ctx_states next_state)
+static doca_error_t verify_callback(void *param, void *config)
 {
-	(void)ctx;
-	(void)prev_state;
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
 
-	struct aes_gcm_resources *resources = (struct aes_gcm_resources *)user_data.ptr;
+	aes_gcm_cfg->verify_only = *(bool *)param;
+	return DOCA_SUCCESS;
+}
 
-	switch (next_state) {
-	case DOCA_CTX_STATE_IDLE:
-		DOCA_LOG_INFO("AES-GCM context has been stopped");
-		/* We can stop progressing the PE */
-		resources->run_pe_progress = false;
-		break;
-	case DOCA_CTX_STATE_STARTING:
-		/**
-		 * The context is in starting state, this is unexpected for AES-GCM.
-		 */
-		DOCA_LOG_ERR("AES-GCM context entered into starting state. Unexpected transition");
-		break;
-	case DOCA_CTX_STATE_RUNNING:
-		DOCA_LOG_INFO("AES-GCM context is running");
-		break;
-	case DOCA_CTX_STATE_STOPPING:
-		/**
-		 * doca_ctx_stop() has been called.
-		 * In this sample, this happens either due to a failure encountered, in which case doca_pe_progress()
-		 * will cause any inflight task to be flushed, or due to the successful compilation of the sample flow.
-		 * In both cases, in this sample, doca_pe_progress() will eventually transition the context to idle
-		 * state.
-		 */
-		DOCA_LOG_INFO("AES-GCM context entered into stopping state. Any inflight tasks will be flushed");
-		break;
-	default:
-		break;
+/*
+ * ARGP Callback - Handle tag index parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t tag_index_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	char *file = (char *)param;
+	int len;
+
+	len = strnlen(file, MAX_FILE_NAME);
+	if (len == MAX_FILE_NAME) {
+		DOCA_LOG_ERR("Invalid file name length, max %d", USER_MAX_FILE_NAME);
+		return DOCA_ERROR_INVALID_VALUE;
 	}
+	strcpy(aes_gcm_cfg->tag_index_path, file);
+	return DOCA_SUCCESS;
 }
 
-doca_error_t allocate_aes_gcm_resources(const char *pci_addr, uint32_t max_bufs, struct aes_gcm_resources *resources)
+/*
+ * ARGP Callback - Handle compress parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t compress_callback(void *param, void *config)
 {
-	struct program_core_objects *state = NULL;
-	union doca_data ctx_user_data = {0};
-	doca_error_t result, tmp_result;
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	char *codec = (char *)param;
 
-	resources->state = malloc(sizeof(*resources->state));
-	if (resources->state == NULL) {
-		result = DOCA_ERROR_NO_MEMORY;
-		DOCA_LOG_ERR("Failed to allocate DOCA program core objects: %s", doca_error_get_descr(result));
-		return result;
+	if (strnlen(codec, AES_GCM_CODEC_NAME_SIZE) == AES_GCM_CODEC_NAME_SIZE) {
+		DOCA_LOG_ERR("Invalid codec name length, max %d", AES_GCM_CODEC_NAME_SIZE - 1);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	strcpy(aes_gcm_cfg->compress_codec, codec);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle emulate parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t emulate_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+
+	return aes_gcm_emu_model_parse((char *)param, &aes_gcm_cfg->emu);
+}
+
+/*
+ * ARGP Callback - Handle no-numa parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t no_numa_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+
+	aes_gcm_cfg->no_numa = *(bool *)param;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle hugepages parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t hugepages_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+
+	if (aes_gcm_hugepage_policy_parse((char *)param, &aes_gcm_cfg->hugepages) != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Invalid hugepage policy %s, expected off, thp, 2m or 1g", (char *)param);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle low-latency parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t low_latency_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+
+	aes_gcm_cfg->low_latency = *(bool *)param;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle poll-cpu parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t poll_cpu_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+
+	int poll_cpu = *(int *)param;
+
+	if (poll_cpu < -1) {
+		DOCA_LOG_ERR("Invalid progress thread core %d", poll_cpu);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	aes_gcm_cfg->poll_cpu = poll_cpu;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle latency-bench parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t latency_bench_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+
+	int iterations = *(int *)param;
+
+	if (iterations < 0) {
+		DOCA_LOG_ERR("Invalid number of benchmark iterations %d", iterations);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	aes_gcm_cfg->latency_bench = iterations;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle submit burst parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t submit_burst_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	int submit_burst = *(int *)param;
+
+	if (submit_burst <= 0) {
+		DOCA_LOG_ERR("Invalid submit burst %d, burst size must be positive", submit_burst);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	aes_gcm_cfg->submit_burst = submit_burst;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle submit burst timeout parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t submit_burst_timeout_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	int timeout_us = *(int *)param;
+
+	if (timeout_us < 0) {
+		DOCA_LOG_ERR("Invalid submit burst timeout %d, timeout must not be negative", timeout_us);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	aes_gcm_cfg->submit_burst_timeout_us = timeout_us;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle records parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t records_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+
+	aes_gcm_cfg->records = *(bool *)param;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle TLS traffic secret parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t tls_secret_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	char *secret = (char *)param;
+	int len;
+
+	len = strnlen(secret, (AES_GCM_TLS_MAX_SECRET_SIZE * 2) + 1);
+	if (len != 64 && len != (AES_GCM_TLS_MAX_SECRET_SIZE * 2)) {
+		DOCA_LOG_ERR("Invalid string length %d to represent a traffic secret, string length should be 64 or %d",
+			     len,
+			     AES_GCM_TLS_MAX_SECRET_SIZE * 2);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	aes_gcm_cfg->tls_secret_len = len / 2;
+	return parse_hex_to_bytes(secret, len, aes_gcm_cfg->tls_secret);
+}
+
+/*
+ * ARGP Callback - Handle TLS verify parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t tls_verify_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+
+	aes_gcm_cfg->tls_verify = *(bool *)param;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle block image parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t block_image_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	char *file = (char *)param;
+	int len;
+
+	len = strnlen(file, MAX_FILE_NAME);
+	if (len == MAX_FILE_NAME) {
+		DOCA_LOG_ERR("Invalid file name length, max %d", USER_MAX_FILE_NAME);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	strcpy(aes_gcm_cfg->block_image_path, file);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle sector size parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t sector_size_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	int sector_size = *(int *)param;
+
+	if (sector_size <= 0) {
+		DOCA_LOG_ERR("Invalid sector size %d, sector size must be positive", sector_size);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	aes_gcm_cfg->sector_size = sector_size;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle sectors parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t sectors_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	char *range = (char *)param;
+	char *end;
+
+	errno = 0;
+	aes_gcm_cfg->first_sector = strtoull(range, &end, 10);
+	aes_gcm_cfg->num_sectors = 0;
+	if (*end == ':')
+		aes_gcm_cfg->num_sectors = strtoull(end + 1, &end, 10);
+	if (errno != 0 || end == range || *end != '\0') {
+		DOCA_LOG_ERR("Invalid sector range %s, expected <first>[:<count>]", range);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle CPU fallback parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t cpu_fallback_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+
+	aes_gcm_cfg->cpu_fallback = *(bool *)param;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle metrics file parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t metrics_file_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	char *file = (char *)param;
+	int len;
+
+	len = strnlen(file, MAX_FILE_NAME);
+	if (len == MAX_FILE_NAME) {
+		DOCA_LOG_ERR("Invalid file name length, max %d", USER_MAX_FILE_NAME);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	strcpy(aes_gcm_cfg->metrics_path, file);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle metrics port parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t metrics_port_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	int port = *(int *)param;
+
+	if (port <= 0 || port > UINT16_MAX) {
+		DOCA_LOG_ERR("Invalid metrics port %d", port);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	aes_gcm_cfg->metrics_port = (uint16_t)port;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle tuning-profile parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t tuning_profile_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	char *file = (char *)param;
+	int len;
+
+	len = strnlen(file, MAX_FILE_NAME);
+	if (len == MAX_FILE_NAME) {
+		DOCA_LOG_ERR("Invalid file name length, max %d", USER_MAX_FILE_NAME);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	strcpy(aes_gcm_cfg->tuning_profile_path, file);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle calibrate parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t calibrate_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+
+	aes_gcm_cfg->calibrate = *(bool *)param;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle gmac parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t gmac_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	char *file = (char *)param;
+	int len;
+
+	len = strnlen(file, MAX_FILE_NAME);
+	if (len == MAX_FILE_NAME) {
+		DOCA_LOG_ERR("Invalid file name length, max %d", USER_MAX_FILE_NAME);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	strcpy(aes_gcm_cfg->gmac_manifest_path, file);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle dst-buffers parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t dst_buffers_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	char *dst_buffers = (char *)param;
+
+	if (strcmp(dst_buffers, "full") == 0) {
+		aes_gcm_cfg->dst_buffers = AES_GCM_DST_FULL;
+	} else if (strcmp(dst_buffers, "in-place") == 0) {
+		aes_gcm_cfg->dst_buffers = AES_GCM_DST_IN_PLACE;
+	} else if (strcmp(dst_buffers, "ping-pong") == 0) {
+		aes_gcm_cfg->dst_buffers = AES_GCM_DST_PING_PONG;
+	} else {
+		DOCA_LOG_ERR("Invalid destination buffers %s, expected full, in-place or ping-pong", dst_buffers);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle sparse parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t sparse_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+
+	aes_gcm_cfg->sparse = *(bool *)param;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle checkpoint parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t checkpoint_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	char *file = (char *)param;
+	int len;
+
+	len = strnlen(file, MAX_FILE_NAME);
+	if (len == MAX_FILE_NAME) {
+		DOCA_LOG_ERR("Invalid file name length, max %d", USER_MAX_FILE_NAME);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	strcpy(aes_gcm_cfg->checkpoint_path, file);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle resume parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t resume_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+
+	aes_gcm_cfg->resume = *(bool *)param;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle priority reserve parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t priority_reserve_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	int reserve = *(int *)param;
+
+	if (reserve < 0) {
+		DOCA_LOG_ERR("Invalid number of reserved task slots %d", reserve);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	aes_gcm_cfg->priority_reserve = reserve;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle deadline parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t deadline_us_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	int deadline_us = *(int *)param;
+
+	if (deadline_us < 0) {
+		DOCA_LOG_ERR("Invalid job deadline %d", deadline_us);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	aes_gcm_cfg->deadline_us = deadline_us;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle bench bulk parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t bench_bulk_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	int num_jobs = *(int *)param;
+
+	if (num_jobs < 0) {
+		DOCA_LOG_ERR("Invalid number of bulk jobs %d", num_jobs);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	aes_gcm_cfg->bench_bulk = num_jobs;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle tenants parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t tenants_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+
+	return aes_gcm_tenants_parse((char *)param, aes_gcm_cfg->tenants, &aes_gcm_cfg->num_tenants);
+}
+
+/*
+ * ARGP Callback - Handle relay listen parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t relay_listen_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	char *addr = (char *)param;
+
+	if (strnlen(addr, AES_GCM_ADDR_SIZE) == AES_GCM_ADDR_SIZE) {
+		DOCA_LOG_ERR("Invalid address length, max %d", AES_GCM_ADDR_SIZE - 1);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	strcpy(aes_gcm_cfg->relay_listen, addr);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle relay target parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t relay_target_callback(void *param, void *config)
+{
+	struct aes_gcm_cfg *aes_gcm_cfg = (struct aes_gcm_cfg *)config;
+	char *addr = (char *)param;
+
+	if (strnlen(addr, AES_GCM_ADDR_SIZE) == AES_GCM_ADDR_SIZE) {
+		DOCA_LOG_ERR("Invalid address length, max %d", AES_GCM_ADDR_SIZE - 1);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	strcpy(aes_gcm_cfg->relay_target, addr);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Register the command line parameters for the sample.
+ *
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t register_aes_gcm_params(void)
+{
+	doca_error_t result;
+	struct doca_argp_param *pci_param, *file_param, *output_param, *raw_key_param, *iv_param, *tag_size_param,
+		*aad_size_param, *all_devices_param, *chunk_size_param, *caps_cache_param,
+		*queue_depth_param, *latency_target_param, *verify_param, *tag_index_param, *compress_param, *emulate_param,
+		*no_numa_param, *hugepages_param, *low_latency_param, *poll_cpu_param, *latency_bench_param,
+		*submit_burst_param, *submit_burst_timeout_param, *records_param, *tls_secret_param, *tls_verify_param,
+		*block_image_param, *sector_size_param, *sectors_param, *cpu_fallback_param, *metrics_file_param,
+		*metrics_port_param, *tuning_profile_param, *calibrate_param, *gmac_param, *dst_buffers_param,
+		*sparse_param, *checkpoint_param, *resume_param, *priority_reserve_param, *deadline_us_param,
+		*bench_bulk_param, *tenants_param, *relay_listen_param, *relay_target_param;
+
+	result = doca_argp_param_create(&pci_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(pci_param, "p");
+	doca_argp_param_set_long_name(pci_param, "pci-addr");
+	doca_argp_param_set_description(
+		pci_param,
+		"DOCA device PCI device address, a comma separated list opens a device group - default: 03:00.0");
+	doca_argp_param_set_callback(pci_param, pci_address_callback);
+	doca_argp_param_set_type(pci_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(pci_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&file_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(file_param, "f");
+	doca_argp_param_set_long_name(file_param, "file");
+	doca_argp_param_set_description(file_param, "Input file to encrypt/decrypt");
+	doca_argp_param_set_mandatory(file_param);
+	doca_argp_param_set_callback(file_param, file_callback);
+	doca_argp_param_set_type(file_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(file_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&output_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(output_param, "o");
+	doca_argp_param_set_long_name(output_param, "output");
+	doca_argp_param_set_description(output_param, "Output file - default: /tmp/out.txt");
+	doca_argp_param_set_callback(output_param, output_callback);
+	doca_argp_param_set_type(output_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(output_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&raw_key_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(raw_key_param, "k");
+	doca_argp_param_set_long_name(raw_key_param, "key");
+	doca_argp_param_set_description(
+		raw_key_param,
+		"Raw key to encrypt/decrypt with, represented in hex format (32 characters for 128-bit key, and 64 for 256-bit key) - default: 256-bit key, equals to zero");
+	doca_argp_param_set_callback(raw_key_param, raw_key_callback);
+	doca_argp_param_set_type(raw_key_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(raw_key_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&iv_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(iv_param, "i");
+	doca_argp_param_set_long_name(iv_param, "iv");
+	doca_argp_param_set_description(
+		iv_param,
+		"Initialization vector, represented in hex format (0-24 characters for 0-96-bit IV) - default: 96-bit IV, equals to zero");
+	doca_argp_param_set_callback(iv_param, iv_callback);
+	doca_argp_param_set_type(iv_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(iv_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&tag_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(tag_size_param, "t");
+	doca_argp_param_set_long_name(tag_size_param, "tag-size");
+	doca_argp_param_set_description(
+		tag_size_param,
+		"Authentication tag size. Tag size is in bytes and can be 12B or 16B - default: 12");
+	doca_argp_param_set_callback(tag_size_param, tag_callback);
+	doca_argp_param_set_type(tag_size_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(tag_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&aad_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(aad_size_param, "a");
+	doca_argp_param_set_long_name(aad_size_param, "aad-size");
+	doca_argp_param_set_description(aad_size_param, "Additional authenticated data size - default: 0");
+	doca_argp_param_set_callback(aad_size_param, aad_callback);
+	doca_argp_param_set_type(aad_size_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(aad_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&all_devices_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(all_devices_param, "all-devices");
+	doca_argp_param_set_description(all_devices_param,
+					"Balance the chunks across every AES-GCM capable device - default: false");
+	doca_argp_param_set_callback(all_devices_param, all_devices_callback);
+	doca_argp_param_set_type(all_devices_param, DOCA_ARGP_TYPE_BOOLEAN);
+	result = doca_argp_register_param(all_devices_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&chunk_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(chunk_size_param, "c");
+	doca_argp_param_set_long_name(chunk_size_param, "chunk-size");
+	doca_argp_param_set_description(
+		chunk_size_param,
+		"Split the file into chunks of this many plaintext bytes, each chunk gets its own IV and tag - default: 0 (single chunk)");
+	doca_argp_param_set_callback(chunk_size_param, chunk_size_callback);
+	doca_argp_param_set_type(chunk_size_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(chunk_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&caps_cache_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(caps_cache_param, "caps-cache");
+	doca_argp_param_set_description(
+		caps_cache_param,
+		"Device capabilities cache file used to skip device probing on startup - only trusted when owned by the current user - default: /var/cache/doca_aes_gcm/caps.cache");
+	doca_argp_param_set_callback(caps_cache_param, caps_cache_callback);
+	doca_argp_param_set_type(caps_cache_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(caps_cache_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&queue_depth_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(queue_depth_param, "q");
+	doca_argp_param_set_long_name(queue_depth_param, "queue-depth");
+	doca_argp_param_set_description(
+		queue_depth_param,
+		"Max number of tasks in flight per device, the task pool of every device is sized to it - default: 16");
+	doca_argp_param_set_callback(queue_depth_param, queue_depth_callback);
+	doca_argp_param_set_type(queue_depth_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(queue_depth_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&latency_target_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(latency_target_param, "latency-target");
+	doca_argp_param_set_description(
+		latency_target_param,
+		"Task completion latency target in microseconds, the tasks in flight per device adapt up to the queue depth to meet it - default: 0 (fixed queue depth)");
+	doca_argp_param_set_callback(latency_target_param, latency_target_callback);
+	doca_argp_param_set_type(latency_target_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(latency_target_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&verify_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(verify_param, "verify");
+	doca_argp_param_set_description(
+		verify_param,
+		"Decrypt only: check the authentication tags chunk by chunk without writing the plaintext - default: false");
+	doca_argp_param_set_callback(verify_param, verify_callback);
+	doca_argp_param_set_type(verify_param, DOCA_ARGP_TYPE_BOOLEAN);
+	result = doca_argp_register_param(verify_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&tag_index_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(tag_index_param, "tag-index");
+	doca_argp_param_set_description(
+		tag_index_param,
+		"Keep the tags in this side index file, the output (encrypt) or input (decrypt) file then holds only the ciphertext");
+	doca_argp_param_set_callback(tag_index_param, tag_index_callback);
+	doca_argp_param_set_type(tag_index_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(tag_index_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&compress_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(compress_param, "compress");
+	doca_argp_param_set_description(
+		compress_param,
+		"Compress every chunk before encryption (lz4, zstd or store), decrypt restores the original data - default: off");
+	doca_argp_param_set_callback(compress_param, compress_callback);
+	doca_argp_param_set_type(compress_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(compress_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&emulate_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(emulate_param, "emulate");
+	doca_argp_param_set_description(
+		emulate_param,
+		"Run on emulated devices, as a comma separated list of devices=N, latency_us, bandwidth_mbps, max_tasks, max_buf_size, error_rate, doorbell_error_rate, fail_after and seed settings - default: off");
+	doca_argp_param_set_callback(emulate_param, emulate_callback);
+	doca_argp_param_set_type(emulate_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(emulate_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&no_numa_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(no_numa_param, "no-numa");
+	doca_argp_param_set_description(no_numa_param,
+					"Do not bind the registered memory and the progress thread to the devices NUMA node");
+	doca_argp_param_set_callback(no_numa_param, no_numa_callback);
+	doca_argp_param_set_type(no_numa_param, DOCA_ARGP_TYPE_BOOLEAN);
+	result = doca_argp_register_param(no_numa_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&hugepages_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(hugepages_param, "hugepages");
+	doca_argp_param_set_description(
+		hugepages_param,
+		"Back the registered memory with huge pages: off, thp, 2m or 1g, falling back to smaller pages - default: off");
+	doca_argp_param_set_callback(hugepages_param, hugepages_callback);
+	doca_argp_param_set_type(hugepages_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(hugepages_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&low_latency_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(low_latency_param, "low-latency");
+	doca_argp_param_set_description(
+		low_latency_param,
+		"Spin on progress instead of sleeping between empty progress calls while waiting for the devices, on the thread running the flow - only --latency-bench uses a pinned progress thread");
+	doca_argp_param_set_callback(low_latency_param, low_latency_callback);
+	doca_argp_param_set_type(low_latency_param, DOCA_ARGP_TYPE_BOOLEAN);
+	result = doca_argp_register_param(low_latency_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&poll_cpu_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(poll_cpu_param, "poll-cpu");
+	doca_argp_param_set_description(
+		poll_cpu_param,
+		"Core to pin the progress thread of --latency-bench to - default: the cores of the devices NUMA node");
+	doca_argp_param_set_callback(poll_cpu_param, poll_cpu_callback);
+	doca_argp_param_set_type(poll_cpu_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(poll_cpu_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&latency_bench_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(latency_bench_param, "latency-bench");
+	doca_argp_param_set_description(
+		latency_bench_param,
+		"Measure the round trip latency of this many messages of --chunk-size bytes (64 by default) on a busy-polling progress thread and report p50/p99/p99.9, encrypt only");
+	doca_argp_param_set_callback(latency_bench_param, latency_bench_callback);
+	doca_argp_param_set_type(latency_bench_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(latency_bench_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&submit_burst_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(submit_burst_param, "submit-burst");
+	doca_argp_param_set_description(
+		submit_burst_param,
+		"Tasks submitted per doorbell, the last task of a burst rings it for the whole burst - default: 1");
+	doca_argp_param_set_callback(submit_burst_param, submit_burst_callback);
+	doca_argp_param_set_type(submit_burst_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(submit_burst_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&submit_burst_timeout_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(submit_burst_timeout_param, "submit-burst-timeout");
+	doca_argp_param_set_description(
+		submit_burst_timeout_param,
+		"Microseconds a partial burst waits before its doorbell is rung anyway - default: 50");
+	doca_argp_param_set_callback(submit_burst_timeout_param, submit_burst_timeout_callback);
+	doca_argp_param_set_type(submit_burst_timeout_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(submit_burst_timeout_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&records_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(records_param, "records");
+	doca_argp_param_set_description(
+		records_param,
+		"Treat the input as uint32 length-prefixed records, each encrypted on its own with its own IV and tag");
+	doca_argp_param_set_callback(records_param, records_callback);
+	doca_argp_param_set_type(records_param, DOCA_ARGP_TYPE_BOOLEAN);
+	result = doca_argp_register_param(records_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&tls_secret_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(tls_secret_param, "tls-secret");
+	doca_argp_param_set_description(
+		tls_secret_param,
+		"TLS 1.3 traffic secret in hex, 32 bytes (AES_128_GCM_SHA256) or 48 bytes (AES_256_GCM_SHA384)");
+	doca_argp_param_set_callback(tls_secret_param, tls_secret_callback);
+	doca_argp_param_set_type(tls_secret_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(tls_secret_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&tls_verify_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(tls_verify_param, "tls-verify");
+	doca_argp_param_set_description(
+		tls_verify_param,
+		"Check every TLS record sealed or opened by the devices against the software AES-GCM");
+	doca_argp_param_set_callback(tls_verify_param, tls_verify_callback);
+	doca_argp_param_set_type(tls_verify_param, DOCA_ARGP_TYPE_BOOLEAN);
+	result = doca_argp_register_param(tls_verify_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&block_image_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(block_image_param, "block-image");
+	doca_argp_param_set_description(
+		block_image_param,
+		"Encrypted sector image updated or read in place, its tags and generations are kept in --tag-index");
+	doca_argp_param_set_callback(block_image_param, block_image_callback);
+	doca_argp_param_set_type(block_image_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(block_image_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&sector_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(sector_size_param, "sector-size");
+	doca_argp_param_set_description(sector_size_param, "Block image sector size in bytes - default: 4096");
+	doca_argp_param_set_callback(sector_size_param, sector_size_callback);
+	doca_argp_param_set_type(sector_size_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(sector_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&sectors_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(sectors_param, "sectors");
+	doca_argp_param_set_description(
+		sectors_param,
+		"Block image sectors to process as <first>[:<count>], by default up to the end of the input or image");
+	doca_argp_param_set_callback(sectors_param, sectors_callback);
+	doca_argp_param_set_type(sectors_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(sectors_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&cpu_fallback_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(cpu_fallback_param, "cpu-fallback");
+	doca_argp_param_set_description(
+		cpu_fallback_param,
+		"Run the jobs that failed on every device, or found no device left, with the software AES-GCM");
+	doca_argp_param_set_callback(cpu_fallback_param, cpu_fallback_callback);
+	doca_argp_param_set_type(cpu_fallback_param, DOCA_ARGP_TYPE_BOOLEAN);
+	result = doca_argp_register_param(cpu_fallback_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&metrics_file_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(metrics_file_param, "metrics-file");
+	doca_argp_param_set_description(
+		metrics_file_param,
+		"Refresh the metrics in this file every second, in the Prometheus text format - default: off");
+	doca_argp_param_set_callback(metrics_file_param, metrics_file_callback);
+	doca_argp_param_set_type(metrics_file_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(metrics_file_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&metrics_port_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(metrics_port_param, "metrics-port");
+	doca_argp_param_set_description(
+		metrics_port_param,
+		"Serve the metrics in the Prometheus text format on http://127.0.0.1:<port>/metrics - default: off");
+	doca_argp_param_set_callback(metrics_port_param, metrics_port_callback);
+	doca_argp_param_set_type(metrics_port_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(metrics_port_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&tuning_profile_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(tuning_profile_param, "tuning-profile");
+	doca_argp_param_set_description(
+		tuning_profile_param,
+		"Device tuning profile file, written by --calibrate and applied to the devices it knows on startup - only trusted when owned by the current user - default: /var/cache/doca_aes_gcm/tuning");
+	doca_argp_param_set_callback(tuning_profile_param, tuning_profile_callback);
+	doca_argp_param_set_type(tuning_profile_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(tuning_profile_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&calibrate_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(calibrate_param, "calibrate");
+	doca_argp_param_set_description(
+		calibrate_param,
+		"Sweep chunk sizes and queue depths on every device, compare them with the CPU and save the tuning to --tuning-profile, encrypt only - default: false");
+	doca_argp_param_set_callback(calibrate_param, calibrate_callback);
+	doca_argp_param_set_type(calibrate_param, DOCA_ARGP_TYPE_BOOLEAN);
+	result = doca_argp_register_param(calibrate_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&gmac_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(gmac_param, "gmac");
+	doca_argp_param_set_description(
+		gmac_param,
+		"Authenticate without encrypting: write the tags of the file chunks to this manifest (encrypt) or check the file against it (decrypt), no output file is written - default: off");
+	doca_argp_param_set_callback(gmac_param, gmac_callback);
+	doca_argp_param_set_type(gmac_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(gmac_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&dst_buffers_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(dst_buffers_param, "dst-buffers");
+	doca_argp_param_set_description(
+		dst_buffers_param,
+		"Destination memory of the chunked flow: full, in-place over the input, or ping-pong windows - default: full");
+	doca_argp_param_set_callback(dst_buffers_param, dst_buffers_callback);
+	doca_argp_param_set_type(dst_buffers_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(dst_buffers_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&sparse_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(sparse_param, "sparse");
+	doca_argp_param_set_description(
+		sparse_param,
+		"Skip the holes of a sparse input: encrypt only its data extents into a sparse container, decrypt recreates the sparse file - default: false");
+	doca_argp_param_set_callback(sparse_param, sparse_callback);
+	doca_argp_param_set_type(sparse_param, DOCA_ARGP_TYPE_BOOLEAN);
+	result = doca_argp_register_param(sparse_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&checkpoint_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(checkpoint_param, "checkpoint");
+	doca_argp_param_set_description(
+		checkpoint_param,
+		"Write the output of the chunked flow as it goes and record the progress in this checkpoint file about every second, removed once the file is done - default: off");
+	doca_argp_param_set_callback(checkpoint_param, checkpoint_callback);
+	doca_argp_param_set_type(checkpoint_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(checkpoint_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&resume_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(resume_param, "resume");
+	doca_argp_param_set_description(
+		resume_param,
+		"Verify the output against the --checkpoint file and continue after its last chunk, start over when there is none - default: false");
+	doca_argp_param_set_callback(resume_param, resume_callback);
+	doca_argp_param_set_type(resume_param, DOCA_ARGP_TYPE_BOOLEAN);
+	result = doca_argp_register_param(resume_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&priority_reserve_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(priority_reserve_param, "priority-reserve");
+	doca_argp_param_set_description(
+		priority_reserve_param,
+		"Task slots per device that bulk jobs leave free for the high priority jobs - default: 0");
+	doca_argp_param_set_callback(priority_reserve_param, priority_reserve_callback);
+	doca_argp_param_set_type(priority_reserve_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(priority_reserve_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&deadline_us_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(deadline_us_param, "deadline-us");
+	doca_argp_param_set_description(
+		deadline_us_param,
+		"Reject the latency benchmark messages that waited longer than this in the queue, in microseconds - default: no limit");
+	doca_argp_param_set_callback(deadline_us_param, deadline_us_callback);
+	doca_argp_param_set_type(deadline_us_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(deadline_us_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&bench_bulk_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(bench_bulk_param, "bench-bulk");
+	doca_argp_param_set_description(
+		bench_bulk_param,
+		"Keep this many bulk jobs of 1MB queued as background load during the latency benchmark - default: 0");
+	doca_argp_param_set_callback(bench_bulk_param, bench_bulk_callback);
+	doca_argp_param_set_type(bench_bulk_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(bench_bulk_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&tenants_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(tenants_param, "tenants");
+	doca_argp_param_set_description(
+		tenants_param,
+		"Share the devices between record tenants, picked by the first header byte of a record, as a semicolon separated list of tenants made of comma separated weight, mbps and ops settings - default: off");
+	doca_argp_param_set_callback(tenants_param, tenants_callback);
+	doca_argp_param_set_type(tenants_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(tenants_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&relay_listen_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(relay_listen_param, "relay-listen");
+	doca_argp_param_set_description(
+		relay_listen_param,
+		"Run as a TCP relay listening on [host:]port, sealing the client streams into TLS records in encrypt mode and opening them in decrypt mode, needs --relay-target and --tls-secret");
+	doca_argp_param_set_callback(relay_listen_param, relay_listen_callback);
+	doca_argp_param_set_type(relay_listen_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(relay_listen_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&relay_target_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(relay_target_param, "relay-target");
+	doca_argp_param_set_description(
+		relay_target_param,
+		"Address the relay connects every client to, host:port - the decrypting relay in front of the service in encrypt mode, the service itself in decrypt mode");
+	doca_argp_param_set_callback(relay_target_param, relay_target_callback);
+	doca_argp_param_set_type(relay_target_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(relay_target_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	return DOCA_SUCCESS;
+}
+
+/**
+ * Callback triggered whenever AES-GCM state changes
+ *
+ * @user_data [in]: User data associated with the AES-GCM context. Will hold struct aes_gcm_resources *
+ * @ctx [in]: The AES-GCM context that had a state change
+ * @prev_state [in]: Previous context state
+ * @next_state [in]: Next context state (context is already in this state when the callback is called)
+ */
+static void aes_gcm_state_changed_callback(const union doca_data user_data,
+					   struct doca_ctx *ctx,
+					   enum doca_ctx_states prev_state,
+					   enum doca_ctx_states next_state)
+{
+	(void)ctx;
+	(void)prev_state;
+
+	struct aes_gcm_resources *resources = (struct aes_gcm_resources *)user_data.ptr;
+
+	switch (next_state) {
+	case DOCA_CTX_STATE_IDLE:
+		DOCA_LOG_INFO("AES-GCM context has been stopped");
+		/* We can stop progressing the PE */
+		resources->run_pe_progress = false;
+		break;
+	case DOCA_CTX_STATE_STARTING:
+		/**
+		 * The context is in starting state, this is unexpected for AES-GCM.
+		 */
+		DOCA_LOG_ERR("AES-GCM context entered into starting state. Unexpected transition");
+		break;
+	case DOCA_CTX_STATE_RUNNING:
+		DOCA_LOG_INFO("AES-GCM context is running");
+		break;
+	case DOCA_CTX_STATE_STOPPING:
+		/**
+		 * doca_ctx_stop() has been called.
+		 * In this sample, this happens either due to a failure encountered, in which case doca_pe_progress()
+		 * will cause any inflight task to be flushed, or due to the successful compilation of the sample flow.
+		 * In both cases, in this sample, doca_pe_progress() will eventually transition the context to idle
+		 * state.
+		 */
+		DOCA_LOG_INFO("AES-GCM context entered into stopping state. Any inflight tasks will be flushed");
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+ * Create the AES-GCM context and the core objects on an opened device
+ *
+ * @max_bufs [in]: Maximum number of buffers for DOCA Inventory
+ * @resources [in/out]: DOCA AES-GCM resources, state->dev must be opened
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t init_aes_gcm_resources(uint32_t max_bufs, struct aes_gcm_resources *resources)
+{
+	struct program_core_objects *state = resources->state;
+	union doca_data ctx_user_data = {0};
+	uint64_t start_ns = aes_gcm_get_time_ns();
+	doca_error_t result, tmp_result;
+
+	if (resources->num_tasks == 0)
+		resources->num_tasks = NUM_AES_GCM_TASKS;
+	resources->num_free_tasks = 0;
+	resources->free_tasks = calloc(resources->num_tasks, sizeof(*resources->free_tasks));
+	if (resources->free_tasks == NULL) {
+		result = DOCA_ERROR_NO_MEMORY;
+		DOCA_LOG_ERR("Failed to allocate task pool: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_aes_gcm_create(state->dev, &resources->aes_gcm);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to create AES-GCM engine: %s", doca_error_get_descr(result));
+		goto free_task_pool;
+	}
+
+	state->ctx = doca_aes_gcm_as_ctx(resources->aes_gcm);
+
+	result = create_core_objects(state, max_bufs);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to create DOCA core objects: %s", doca_error_get_descr(result));
+		goto destroy_aes_gcm;
+	}
+
+	result = doca_pe_connect_ctx(state->pe, state->ctx);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to set progress engine for PE: %s", doca_error_get_descr(result));
+		goto destroy_core_objects;
+	}
+
+	result = doca_ctx_set_state_changed_cb(state->ctx, aes_gcm_state_changed_callback);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to set AES-GCM state change callback: %s", doca_error_get_descr(result));
+		goto destroy_core_objects;
+	}
+
+	if (resources->mode == AES_GCM_MODE_ENCRYPT)
+		result = doca_aes_gcm_task_encrypt_set_conf(resources->aes_gcm,
+							    encrypt_completed_callback,
+							    encrypt_error_callback,
+							    resources->num_tasks);
+	else
+		result = doca_aes_gcm_task_decrypt_set_conf(resources->aes_gcm,
+							    decrypt_completed_callback,
+							    decrypt_error_callback,
+							    resources->num_tasks);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to set configurations for AES-GCM task: %s", doca_error_get_descr(result));
+		goto destroy_core_objects;
+	}
+
+	/* Include resources in user data of context to be used in callbacks */
+	ctx_user_data.ptr = resources;
+	doca_ctx_set_user_data(state->ctx, ctx_user_data);
+
+	resources->startup_ns[AES_GCM_STARTUP_CTX_CREATE] = aes_gcm_get_time_ns() - start_ns;
+	return result;
+
+destroy_core_objects:
+	tmp_result = destroy_core_objects(state);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to destroy DOCA core objects: %s", doca_error_get_descr(tmp_result));
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+destroy_aes_gcm:
+	tmp_result = doca_aes_gcm_destroy(resources->aes_gcm);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to destroy DOCA AES-GCM: %s", doca_error_get_descr(tmp_result));
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+	resources->aes_gcm = NULL;
+free_task_pool:
+	free(resources->free_tasks);
+	resources->free_tasks = NULL;
+
+	return result;
+}
+
+doca_error_t allocate_aes_gcm_resources(const char *pci_addr, uint32_t max_bufs, struct aes_gcm_resources *resources)
+{
+	struct program_core_objects *state = NULL;
+	uint64_t start_ns = aes_gcm_get_time_ns();
+	doca_error_t result, tmp_result;
+
+	resources->state = malloc(sizeof(*resources->state));
+	if (resources->state == NULL) {
+		result = DOCA_ERROR_NO_MEMORY;
+		DOCA_LOG_ERR("Failed to allocate DOCA program core objects: %s", doca_error_get_descr(result));
+		return result;
 	}
 	resources->num_remaining_tasks = 0;
 
@@ -456,227 +1998,898 @@ doca_error_t allocate_aes_gcm_resources(const char *pci_addr, uint32_t max_bufs,
 	}
 
 	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to open DOCA device for DOCA AES-GCM: %s", doca_error_get_descr(result));
-		goto free_state;
+		DOCA_LOG_ERR("Failed to open DOCA device for DOCA AES-GCM: %s", doca_error_get_descr(result));
+		goto free_state;
+	}
+	resources->startup_ns[AES_GCM_STARTUP_DEV_OPEN] = aes_gcm_get_time_ns() - start_ns;
+
+	result = init_aes_gcm_resources(max_bufs, resources);
+	if (result != DOCA_SUCCESS)
+		goto close_device;
+
+	return result;
+
+close_device:
+	tmp_result = doca_dev_close(state->dev);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+		DOCA_LOG_ERR("Failed to close device: %s", doca_error_get_descr(tmp_result));
+	}
+free_state:
+	free(resources->state);
+
+	return result;
+}
+
+doca_error_t allocate_aes_gcm_resources_from_devinfo(struct doca_devinfo *devinfo,
+						     uint32_t max_bufs,
+						     struct aes_gcm_resources *resources)
+{
+	struct program_core_objects *state = NULL;
+	uint64_t start_ns = aes_gcm_get_time_ns();
+	doca_error_t result, tmp_result;
+
+	resources->state = calloc(1, sizeof(*resources->state));
+	if (resources->state == NULL) {
+		result = DOCA_ERROR_NO_MEMORY;
+		DOCA_LOG_ERR("Failed to allocate DOCA program core objects: %s", doca_error_get_descr(result));
+		return result;
+	}
+	resources->num_remaining_tasks = 0;
+
+	state = resources->state;
+
+	result = doca_dev_open(devinfo, &state->dev);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to open DOCA device for DOCA AES-GCM: %s", doca_error_get_descr(result));
+		goto free_state;
+	}
+	resources->startup_ns[AES_GCM_STARTUP_DEV_OPEN] = aes_gcm_get_time_ns() - start_ns;
+
+	result = init_aes_gcm_resources(max_bufs, resources);
+	if (result != DOCA_SUCCESS)
+		goto close_device;
+
+	return result;
+
+close_device:
+	tmp_result = doca_dev_close(state->dev);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+		DOCA_LOG_ERR("Failed to close device: %s", doca_error_get_descr(tmp_result));
+	}
+free_state:
+	free(resources->state);
+	resources->state = NULL;
+
+	return result;
+}
+
+doca_error_t allocate_aes_gcm_resources_emulated(const struct aes_gcm_emu_model *model,
+						 uint32_t idx,
+						 struct aes_gcm_resources *resources)
+{
+	doca_error_t result;
+
+	resources->state = NULL;
+	resources->aes_gcm = NULL;
+	resources->num_remaining_tasks = 0;
+	if (resources->num_tasks == 0)
+		resources->num_tasks = NUM_AES_GCM_TASKS;
+
+	result = aes_gcm_emu_create(model, idx, &resources->emu);
+	if (result != DOCA_SUCCESS)
+		DOCA_LOG_ERR("Failed to create emulated AES-GCM device: %s", doca_error_get_descr(result));
+	return result;
+}
+
+/*
+ * Get the generic task of a pooled encrypt/decrypt task
+ *
+ * @resources [in]: DOCA AES-GCM resources
+ * @pooled_task [in]: Encrypt or decrypt task, according to resources->mode
+ * @return: the generic DOCA task
+ */
+static struct doca_task *pooled_task_as_task(struct aes_gcm_resources *resources, void *pooled_task)
+{
+	if (resources->mode == AES_GCM_MODE_ENCRYPT)
+		return doca_aes_gcm_task_encrypt_as_task((struct doca_aes_gcm_task_encrypt *)pooled_task);
+	return doca_aes_gcm_task_decrypt_as_task((struct doca_aes_gcm_task_decrypt *)pooled_task);
+}
+
+/*
+ * Release a task, keeping it in the task pool while the context keeps running
+ *
+ * @resources [in]: DOCA AES-GCM resources
+ * @typed_task [in]: Encrypt or decrypt task, NULL forces the task to be freed
+ * @task [in]: The generic DOCA task
+ */
+static void release_task(struct aes_gcm_resources *resources, void *typed_task, struct doca_task *task)
+{
+	if (typed_task != NULL && resources->keep_ctx_running && resources->num_free_tasks < resources->num_tasks)
+		resources->free_tasks[resources->num_free_tasks++] = typed_task;
+	else
+		doca_task_free(task);
+}
+
+/*
+ * Take a task from the task pool and re-arm it with the job parameters
+ *
+ * @resources [in]: DOCA AES-GCM resources, the pool must not be empty
+ * @job [in]: The job to run
+ * @task_user_data [in]: Task user data
+ * @typed_task [out]: The encrypt or decrypt task
+ * @return: the re-armed generic DOCA task
+ */
+static struct doca_task *rearm_pooled_task(struct aes_gcm_resources *resources,
+					   struct aes_gcm_job *job,
+					   union doca_data task_user_data,
+					   void **typed_task)
+{
+	struct doca_aes_gcm_task_encrypt *encrypt_task;
+	struct doca_aes_gcm_task_decrypt *decrypt_task;
+	struct doca_task *task;
+
+	*typed_task = resources->free_tasks[--resources->num_free_tasks];
+	if (job->mode == AES_GCM_MODE_ENCRYPT) {
+		encrypt_task = (struct doca_aes_gcm_task_encrypt *)*typed_task;
+		doca_aes_gcm_task_encrypt_set_src(encrypt_task, job->src_buf);
+		doca_aes_gcm_task_encrypt_set_dst(encrypt_task, job->dst_buf);
+		doca_aes_gcm_task_encrypt_set_key(encrypt_task, job->key);
+		doca_aes_gcm_task_encrypt_set_iv(encrypt_task, job->iv, job->iv_length);
+		doca_aes_gcm_task_encrypt_set_tag_size(encrypt_task, job->tag_size);
+		doca_aes_gcm_task_encrypt_set_aad_size(encrypt_task, job->aad_size);
+		task = doca_aes_gcm_task_encrypt_as_task(encrypt_task);
+	} else {
+		decrypt_task = (struct doca_aes_gcm_task_decrypt *)*typed_task;
+		doca_aes_gcm_task_decrypt_set_src(decrypt_task, job->src_buf);
+		doca_aes_gcm_task_decrypt_set_dst(decrypt_task, job->dst_buf);
+		doca_aes_gcm_task_decrypt_set_key(decrypt_task, job->key);
+		doca_aes_gcm_task_decrypt_set_iv(decrypt_task, job->iv, job->iv_length);
+		doca_aes_gcm_task_decrypt_set_tag_size(decrypt_task, job->tag_size);
+		doca_aes_gcm_task_decrypt_set_aad_size(decrypt_task, job->aad_size);
+		task = doca_aes_gcm_task_decrypt_as_task(decrypt_task);
+	}
+
+	doca_task_set_user_data(task, task_user_data);
+	resources->num_task_reuses++;
+	return task;
+}
+
+/*
+ * Unchain the detached tag of a job and return the job buffers to the inventory
+ *
+ * @job [in]: The job
+ */
+static void release_job_bufs(struct aes_gcm_job *job)
+{
+	if (job->tag_buf != NULL) {
+		(void)doca_buf_unchain_list((job->mode == AES_GCM_MODE_ENCRYPT) ? job->dst_buf : job->src_buf,
+					    job->tag_buf);
+		(void)doca_buf_dec_refcount(job->tag_buf, NULL);
+		job->tag_buf = NULL;
+	}
+	(void)doca_buf_dec_refcount(job->src_buf, NULL);
+	(void)doca_buf_dec_refcount(job->dst_buf, NULL);
+	job->src_buf = NULL;
+	job->dst_buf = NULL;
+}
+
+/*
+ * Complete the job of a task that was accepted by aes_gcm_job_submit() but failed to reach the device
+ *
+ * @resources [in]: DOCA AES-GCM resources
+ * @typed_task [in]: Encrypt or decrypt task
+ * @task [in]: The generic DOCA task, NULL on an emulated device
+ * @job [in]: The job of the task
+ * @result [in]: Submission error
+ */
+static void fail_deferred_task(struct aes_gcm_resources *resources,
+			       void *typed_task,
+			       struct doca_task *task,
+			       struct aes_gcm_job *job,
+			       doca_error_t result)
+{
+	DOCA_LOG_ERR("Failed to submit %s task: %s",
+		     (job->mode == AES_GCM_MODE_ENCRYPT) ? "encrypt" : "decrypt",
+		     doca_error_get_descr(result));
+	if (task != NULL)
+		release_task(resources, typed_task, task);
+	if (job->release_bufs) {
+		release_job_bufs(job);
+		job->release_bufs = false;
+	}
+	aes_gcm_finish_job(resources, job, result, 0);
+}
+
+doca_error_t destroy_aes_gcm_resources(struct aes_gcm_resources *resources)
+{
+	struct program_core_objects *state = resources->state;
+	struct aes_gcm_job *job = resources->held_job;
+	doca_error_t result = DOCA_SUCCESS, tmp_result;
+
+	/* A task held back for its doorbell never reached the device, its job still has to complete */
+	if (job != NULL) {
+		resources->held_job = NULL;
+		resources->num_unflushed = 0;
+		fail_deferred_task(resources, NULL, resources->held_task, job, DOCA_ERROR_BAD_STATE);
+	}
+
+	if (resources->emu != NULL) {
+		aes_gcm_emu_destroy(resources->emu);
+		resources->emu = NULL;
+		return DOCA_SUCCESS;
+	}
+
+	/* Pooled tasks must be freed before the context can stop */
+	while (resources->num_free_tasks > 0)
+		doca_task_free(pooled_task_as_task(resources, resources->free_tasks[--resources->num_free_tasks]));
+	free(resources->free_tasks);
+	resources->free_tasks = NULL;
+
+	if (resources->aes_gcm != NULL) {
+		result = doca_ctx_stop(state->ctx);
+		if (result != DOCA_SUCCESS)
+			DOCA_LOG_ERR("Unable to stop context: %s", doca_error_get_descr(result));
+		state->ctx = NULL;
+
+		tmp_result = doca_aes_gcm_destroy(resources->aes_gcm);
+		if (tmp_result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to destroy DOCA AES-GCM: %s", doca_error_get_descr(tmp_result));
+			DOCA_ERROR_PROPAGATE(result, tmp_result);
+		}
+	}
+
+	if (resources->tag_mmap != NULL) {
+		tmp_result = doca_mmap_destroy(resources->tag_mmap);
+		if (tmp_result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to destroy tags mmap: %s", doca_error_get_descr(tmp_result));
+			DOCA_ERROR_PROPAGATE(result, tmp_result);
+		}
+		resources->tag_mmap = NULL;
+	}
+
+	tmp_result = destroy_core_objects(state);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to destroy DOCA core objects: %s", doca_error_get_descr(tmp_result));
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+
+	free(state);
+	resources->state = NULL;
+
+	return result;
+}
+
+/*
+ * Hand a task to the device, or its job to the emulated device
+ *
+ * @resources [in]: DOCA AES-GCM resources
+ * @task [in]: The generic DOCA task, NULL on an emulated device
+ * @job [in]: The job of the task
+ * @flags [in]: DOCA task submit flags, DOCA_TASK_SUBMIT_FLAG_FLUSH rings the doorbell
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t submit_to_device(struct aes_gcm_resources *resources,
+				     struct doca_task *task,
+				     struct aes_gcm_job *job,
+				     uint32_t flags)
+{
+	if (resources->emu != NULL)
+		return aes_gcm_emu_submit(resources->emu, job, flags);
+	return doca_task_submit_ex(task, flags);
+}
+
+/*
+ * Submit the held back task with a doorbell, which also hands the tasks submitted before it to the device
+ *
+ * If the held task fails to submit with a transient error while tasks before it wait for the doorbell, it stays held
+ * and the doorbell is rung again from the next aes_gcm_progress(). Any other failure completes its job, the tasks
+ * before it then wait for the doorbell of the next submitted task.
+ *
+ * @resources [in]: DOCA AES-GCM resources
+ */
+static void ring_doorbell(struct aes_gcm_resources *resources)
+{
+	struct doca_task *task = resources->held_task;
+	void *typed_task = resources->held_typed_task;
+	struct aes_gcm_job *job = resources->held_job;
+	doca_error_t result;
+
+	if (job == NULL)
+		return;
+
+	resources->held_job = NULL;
+	result = submit_to_device(resources, task, job, DOCA_TASK_SUBMIT_FLAG_FLUSH);
+	if (result != DOCA_SUCCESS && resources->num_unflushed > 1 && aes_gcm_error_is_transient(result)) {
+		resources->held_job = job;
+		return;
+	}
+	if (result != DOCA_SUCCESS) {
+		/* The state is consistent before the completion runs, it may submit again */
+		resources->num_unflushed--;
+		fail_deferred_task(resources, typed_task, task, job, result);
+		return;
+	}
+	resources->num_unflushed = 0;
+	resources->num_doorbells++;
+}
+
+/*
+ * Submit a task, ringing the doorbell once per burst of resources->submit_burst tasks
+ *
+ * The last submitted task is always held back: it goes out without a doorbell once the next task takes its place,
+ * and carries the doorbell of the whole burst when the held tasks fill a burst or aes_gcm_flush() is called. As the
+ * new task stays held, a doorbell that failed to submit along with its task can still be rung for the burst. Bursts
+ * are only formed while the context keeps running, a one-shot job always rings the doorbell.
+ * The job of a held task that fails to submit completes last, once the new task is held: its completion may submit
+ * again.
+ *
+ * @resources [in]: DOCA AES-GCM resources
+ * @typed_task [in]: Encrypt or decrypt task, NULL on an emulated device
+ * @task [in]: The generic DOCA task, NULL on an emulated device
+ * @job [in]: The job of the task
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR if the task itself failed to submit
+ */
+static doca_error_t submit_task(struct aes_gcm_resources *resources,
+				void *typed_task,
+				struct doca_task *task,
+				struct aes_gcm_job *job)
+{
+	struct doca_task *prev_task = resources->held_task;
+	void *prev_typed_task = resources->held_typed_task;
+	struct aes_gcm_job *prev_job = resources->held_job;
+	uint32_t flags = DOCA_TASK_SUBMIT_FLAG_NONE;
+	doca_error_t result = DOCA_SUCCESS;
+
+	if (resources->submit_burst <= 1 || !resources->keep_ctx_running) {
+		if (resources->emu != NULL)
+			result = aes_gcm_emu_submit(resources->emu, job, DOCA_TASK_SUBMIT_FLAG_FLUSH);
+		else
+			result = doca_task_submit(task);
+		if (result == DOCA_SUCCESS)
+			resources->num_doorbells++;
+		return result;
+	}
+
+	resources->held_task = task;
+	resources->held_typed_task = typed_task;
+	resources->held_job = job;
+
+	/* The task held back so far goes out, with the doorbell once it completes a burst */
+	if (prev_job != NULL) {
+		if (resources->num_unflushed >= resources->submit_burst)
+			flags = DOCA_TASK_SUBMIT_FLAG_FLUSH;
+		result = submit_to_device(resources, prev_task, prev_job, flags);
+		if (result != DOCA_SUCCESS) {
+			resources->num_unflushed--;
+		} else if (flags == DOCA_TASK_SUBMIT_FLAG_FLUSH) {
+			resources->num_unflushed = 0;
+			resources->num_doorbells++;
+		}
+	}
+
+	if (resources->num_unflushed == 0)
+		resources->first_unflushed_ns = job->submit_ns;
+	resources->num_unflushed++;
+
+	/* A late failure completes its job, the tasks before it wait for the new task's doorbell */
+	if (result != DOCA_SUCCESS)
+		fail_deferred_task(resources, prev_typed_task, prev_task, prev_job, result);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Get an AES-GCM task for the job, from the task pool when possible, and submit it
+ *
+ * @resources [in]: DOCA AES-GCM resources
+ * @job [in]: The job to submit, src_buf and dst_buf must be set
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t submit_job_task(struct aes_gcm_resources *resources, struct aes_gcm_job *job)
+{
+	struct doca_aes_gcm_task_encrypt *encrypt_task;
+	struct doca_aes_gcm_task_decrypt *decrypt_task;
+	struct doca_task *task;
+	void *typed_task;
+	union doca_data task_user_data = {0};
+	doca_error_t result;
+
+	/* Include the job in user data of task to be used in the callbacks */
+	task_user_data.ptr = job;
+	if (resources->num_free_tasks > 0) {
+		task = rearm_pooled_task(resources, job, task_user_data, &typed_task);
+	} else if (job->mode == AES_GCM_MODE_ENCRYPT) {
+		/* Allocate and construct encrypt task */
+		result = doca_aes_gcm_task_encrypt_alloc_init(resources->aes_gcm,
+							      job->src_buf,
+							      job->dst_buf,
+							      job->key,
+							      job->iv,
+							      job->iv_length,
+							      job->tag_size,
+							      job->aad_size,
+							      task_user_data,
+							      &encrypt_task);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to allocate encrypt task: %s", doca_error_get_descr(result));
+			return result;
+		}
+		resources->num_allocated_tasks++;
+		typed_task = encrypt_task;
+		task = doca_aes_gcm_task_encrypt_as_task(encrypt_task);
+	} else {
+		/* Allocate and construct decrypt task */
+		result = doca_aes_gcm_task_decrypt_alloc_init(resources->aes_gcm,
+							      job->src_buf,
+							      job->dst_buf,
+							      job->key,
+							      job->iv,
+							      job->iv_length,
+							      job->tag_size,
+							      job->aad_size,
+							      task_user_data,
+							      &decrypt_task);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to allocate decrypt task: %s", doca_error_get_descr(result));
+			return result;
+		}
+		resources->num_allocated_tasks++;
+		typed_task = decrypt_task;
+		task = doca_aes_gcm_task_decrypt_as_task(decrypt_task);
+	}
+
+	/* Submit the task */
+	job->submit_ns = aes_gcm_get_time_ns();
+	resources->num_remaining_tasks++;
+	result = submit_task(resources, typed_task, task, job);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to submit %s task: %s",
+			     (job->mode == AES_GCM_MODE_ENCRYPT) ? "encrypt" : "decrypt",
+			     doca_error_get_descr(result));
+		release_task(resources, typed_task, task);
+		resources->num_remaining_tasks--;
+		return result;
+	}
+	aes_gcm_metrics_gauge_add(AES_GCM_METRICS_INFLIGHT_TASKS, 1);
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Submit a single job and progress the PE until the context is stopped
+ *
+ * @resources [in]: DOCA AES-GCM resources
+ * @job [in]: The job to submit, src_buf and dst_buf must be set
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t submit_job_and_wait(struct aes_gcm_resources *resources, struct aes_gcm_job *job)
+{
+	struct program_core_objects *state = resources->state;
+	struct timespec ts = {
+		.tv_sec = 0,
+		.tv_nsec = SLEEP_IN_NANOS,
+	};
+	doca_error_t result;
+
+	result = submit_job_task(resources, job);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	resources->run_pe_progress = true;
+
+	/* Wait for all tasks to be completed and context to stop */
+	while (resources->run_pe_progress) {
+		if (doca_pe_progress(state->pe) == 0)
+			nanosleep(&ts, &ts);
+	}
+
+	return job->result;
+}
+
+doca_error_t submit_aes_gcm_encrypt_task(struct aes_gcm_resources *resources,
+					 struct doca_buf *src_buf,
+					 struct doca_buf *dst_buf,
+					 struct doca_aes_gcm_key *key,
+					 const uint8_t *iv,
+					 uint32_t iv_length,
+					 uint32_t tag_size,
+					 uint32_t aad_size)
+{
+	struct aes_gcm_job job = {
+		.mode = AES_GCM_MODE_ENCRYPT,
+		.key = key,
+		.iv_length = iv_length,
+		.tag_size = tag_size,
+		.aad_size = aad_size,
+		.src_buf = src_buf,
+		.dst_buf = dst_buf,
+	};
+
+	memcpy(job.iv, iv, iv_length);
+	return submit_job_and_wait(resources, &job);
+}
+
+doca_error_t submit_aes_gcm_decrypt_task(struct aes_gcm_resources *resources,
+					 struct doca_buf *src_buf,
+					 struct doca_buf *dst_buf,
+					 struct doca_aes_gcm_key *key,
+					 const uint8_t *iv,
+					 uint32_t iv_length,
+					 uint32_t tag_size,
+					 uint32_t aad_size)
+{
+	struct aes_gcm_job job = {
+		.mode = AES_GCM_MODE_DECRYPT,
+		.key = key,
+		.iv_length = iv_length,
+		.tag_size = tag_size,
+		.aad_size = aad_size,
+		.src_buf = src_buf,
+		.dst_buf = dst_buf,
+	};
+
+	memcpy(job.iv, iv, iv_length);
+	return submit_job_and_wait(resources, &job);
+}
+
+doca_error_t aes_gcm_register_memory(struct aes_gcm_resources *resources,
+				     void *src,
+				     size_t src_len,
+				     void *dst,
+				     size_t dst_len)
+{
+	struct program_core_objects *state = resources->state;
+	uint64_t start_ns = aes_gcm_get_time_ns();
+	doca_error_t result;
+
+	/* The emulated device works on host addresses */
+	if (resources->emu != NULL)
+		return DOCA_SUCCESS;
+
+	result = doca_mmap_set_memrange(state->src_mmap, src, src_len);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to set mmap memory range: %s", doca_error_get_descr(result));
+		return result;
+	}
+	result = doca_mmap_start(state->src_mmap);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to start mmap: %s", doca_error_get_descr(result));
+		return result;
 	}
 
-	result = doca_aes_gcm_create(state->dev, &resources->aes_gcm);
+	result = doca_mmap_set_memrange(state->dst_mmap, dst, dst_len);
 	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Unable to create AES-GCM engine: %s", doca_error_get_descr(result));
-		goto close_device;
+		DOCA_LOG_ERR("Failed to set mmap memory range: %s", doca_error_get_descr(result));
+		return result;
+	}
+	result = doca_mmap_start(state->dst_mmap);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to start mmap: %s", doca_error_get_descr(result));
+		return result;
 	}
 
-	state->ctx = doca_aes_gcm_as_ctx(resources->aes_gcm);
+	resources->startup_ns[AES_GCM_STARTUP_MMAP_START] = aes_gcm_get_time_ns() - start_ns;
+	return DOCA_SUCCESS;
+}
 
-	result = create_core_objects(state, max_bufs);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Unable to create DOCA core objects: %s", doca_error_get_descr(result));
-		goto destroy_aes_gcm;
+doca_error_t aes_gcm_register_tag_memory(struct aes_gcm_resources *resources, void *tags, size_t tags_len)
+{
+	struct program_core_objects *state = resources->state;
+	uint32_t max_list_num_elem = 0;
+	doca_error_t result;
+
+	if (resources->emu != NULL)
+		return DOCA_SUCCESS;
+
+	result = doca_aes_gcm_cap_get_max_list_buf_num_elem(doca_dev_as_devinfo(state->dev), &max_list_num_elem);
+	if (result != DOCA_SUCCESS || max_list_num_elem < 2) {
+		DOCA_LOG_ERR("Detached tags need buffer lists, which the device does not support");
+		return DOCA_ERROR_NOT_SUPPORTED;
 	}
 
-	result = doca_pe_connect_ctx(state->pe, state->ctx);
+	result = doca_mmap_create(&resources->tag_mmap);
 	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Unable to set progress engine for PE: %s", doca_error_get_descr(result));
-		goto destroy_core_objects;
+		DOCA_LOG_ERR("Unable to create tags mmap: %s", doca_error_get_descr(result));
+		return result;
 	}
 
-	result = doca_ctx_set_state_changed_cb(state->ctx, aes_gcm_state_changed_callback);
+	result = doca_mmap_add_dev(resources->tag_mmap, state->dev);
 	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Unable to set AES-GCM state change callback: %s", doca_error_get_descr(result));
-		goto destroy_core_objects;
+		DOCA_LOG_ERR("Unable to add device to tags mmap: %s", doca_error_get_descr(result));
+		goto destroy_mmap;
 	}
 
-	if (resources->mode == AES_GCM_MODE_ENCRYPT)
-		result = doca_aes_gcm_task_encrypt_set_conf(resources->aes_gcm,
-							    encrypt_completed_callback,
-							    encrypt_error_callback,
-							    NUM_AES_GCM_TASKS);
-	else
-		result = doca_aes_gcm_task_decrypt_set_conf(resources->aes_gcm,
-							    decrypt_completed_callback,
-							    decrypt_error_callback,
-							    NUM_AES_GCM_TASKS);
+	result = doca_mmap_set_memrange(resources->tag_mmap, tags, tags_len);
 	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Unable to set configurations for AES-GCM task: %s", doca_error_get_descr(result));
-		goto destroy_core_objects;
+		DOCA_LOG_ERR("Failed to set mmap memory range: %s", doca_error_get_descr(result));
+		goto destroy_mmap;
 	}
 
-	/* Include resources in user data of context to be used in callbacks */
-	ctx_user_data.ptr = resources;
-	doca_ctx_set_user_data(state->ctx, ctx_user_data);
-
-	return result;
-
-destroy_core_objects:
-	tmp_result = destroy_core_objects(state);
-	if (tmp_result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to destroy DOCA core objects: %s", doca_error_get_descr(tmp_result));
-		DOCA_ERROR_PROPAGATE(result, tmp_result);
-	}
-destroy_aes_gcm:
-	tmp_result = doca_aes_gcm_destroy(resources->aes_gcm);
-	if (tmp_result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to destroy DOCA AES-GCM: %s", doca_error_get_descr(tmp_result));
-		DOCA_ERROR_PROPAGATE(result, tmp_result);
-	}
-close_device:
-	tmp_result = doca_dev_close(state->dev);
-	if (tmp_result != DOCA_SUCCESS) {
-		DOCA_ERROR_PROPAGATE(result, tmp_result);
-		DOCA_LOG_ERR("Failed to close device: %s", doca_error_get_descr(tmp_result));
+	result = doca_mmap_start(resources->tag_mmap);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to start mmap: %s", doca_error_get_descr(result));
+		goto destroy_mmap;
 	}
-free_state:
-	free(resources->state);
 
+	return DOCA_SUCCESS;
+
+destroy_mmap:
+	(void)doca_mmap_destroy(resources->tag_mmap);
+	resources->tag_mmap = NULL;
 	return result;
 }
 
-doca_error_t destroy_aes_gcm_resources(struct aes_gcm_resources *resources)
+/*
+ * Chain the detached tag of a job to its payload buffer
+ *
+ * The tag is the input of a decrypt job and the output of an encrypt job.
+ *
+ * @resources [in]: DOCA AES-GCM resources
+ * @job [in]: The job, src_buf and dst_buf must be set
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t chain_job_tag(struct aes_gcm_resources *resources, struct aes_gcm_job *job)
 {
 	struct program_core_objects *state = resources->state;
-	doca_error_t result = DOCA_SUCCESS, tmp_result;
-
-	if (resources->aes_gcm != NULL) {
-		result = doca_ctx_stop(state->ctx);
-		if (result != DOCA_SUCCESS)
-			DOCA_LOG_ERR("Unable to stop context: %s", doca_error_get_descr(result));
-		state->ctx = NULL;
+	doca_error_t result;
 
-		tmp_result = doca_aes_gcm_destroy(resources->aes_gcm);
-		if (tmp_result != DOCA_SUCCESS) {
-			DOCA_LOG_ERR("Failed to destroy DOCA AES-GCM: %s", doca_error_get_descr(tmp_result));
-			DOCA_ERROR_PROPAGATE(result, tmp_result);
-		}
+	if (resources->tag_mmap == NULL) {
+		DOCA_LOG_ERR("Job has a detached tag but no tags memory was registered");
+		return DOCA_ERROR_BAD_STATE;
 	}
 
-	tmp_result = destroy_core_objects(state);
-	if (tmp_result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to destroy DOCA core objects: %s", doca_error_get_descr(tmp_result));
-		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	if (job->mode == AES_GCM_MODE_ENCRYPT)
+		result = doca_buf_inventory_buf_get_by_addr(state->buf_inv,
+							    resources->tag_mmap,
+							    job->tag,
+							    job->tag_size,
+							    &job->tag_buf);
+	else
+		result = doca_buf_inventory_buf_get_by_data(state->buf_inv,
+							    resources->tag_mmap,
+							    job->tag,
+							    job->tag_size,
+							    &job->tag_buf);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to acquire DOCA buffer representing the tag: %s", doca_error_get_descr(result));
+		return result;
 	}
 
-	free(state);
-	resources->state = NULL;
+	result = doca_buf_chain_list((job->mode == AES_GCM_MODE_ENCRYPT) ? job->dst_buf : job->src_buf, job->tag_buf);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to chain the tag buffer: %s", doca_error_get_descr(result));
+		(void)doca_buf_dec_refcount(job->tag_buf, NULL);
+		job->tag_buf = NULL;
+		return result;
+	}
 
-	return result;
+	return DOCA_SUCCESS;
 }
 
-doca_error_t submit_aes_gcm_encrypt_task(struct aes_gcm_resources *resources,
-					 struct doca_buf *src_buf,
-					 struct doca_buf *dst_buf,
-					 struct doca_aes_gcm_key *key,
-					 const uint8_t *iv,
-					 uint32_t iv_length,
-					 uint32_t tag_size,
-					 uint32_t aad_size)
+doca_error_t aes_gcm_job_submit(struct aes_gcm_resources *resources, struct aes_gcm_job *job)
 {
-	struct doca_aes_gcm_task_encrypt *encrypt_task;
 	struct program_core_objects *state = resources->state;
-	struct doca_task *task;
-	union doca_data task_user_data = {0};
-	struct timespec ts = {
-		.tv_sec = 0,
-		.tv_nsec = SLEEP_IN_NANOS,
-	};
-	doca_error_t result, task_result;
+	doca_error_t result;
+
+	/* The emulated device takes the jobs as they are, through the same doorbell bursts */
+	if (resources->emu != NULL) {
+		job->submit_ns = aes_gcm_get_time_ns();
+		resources->num_remaining_tasks++;
+		result = submit_task(resources, NULL, NULL, job);
+		if (result != DOCA_SUCCESS) {
+			resources->num_remaining_tasks--;
+			return result;
+		}
+		aes_gcm_metrics_gauge_add(AES_GCM_METRICS_INFLIGHT_TASKS, 1);
+		return DOCA_SUCCESS;
+	}
 
-	/* Include result in user data of task to be used in the callbacks */
-	task_user_data.ptr = &task_result;
-	/* Allocate and construct encrypt task */
-	result = doca_aes_gcm_task_encrypt_alloc_init(resources->aes_gcm,
-						      src_buf,
-						      dst_buf,
-						      key,
-						      iv,
-						      iv_length,
-						      tag_size,
-						      aad_size,
-						      task_user_data,
-						      &encrypt_task);
+	/* Construct DOCA buffer for each address range */
+	result = doca_buf_inventory_buf_get_by_data(state->buf_inv,
+						    state->src_mmap,
+						    job->src,
+						    job->src_len,
+						    &job->src_buf);
 	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to allocate encrypt task: %s", doca_error_get_descr(result));
+		DOCA_LOG_ERR("Unable to acquire DOCA buffer representing source buffer: %s",
+			     doca_error_get_descr(result));
 		return result;
 	}
 
-	task = doca_aes_gcm_task_encrypt_as_task(encrypt_task);
+	result = doca_buf_inventory_buf_get_by_addr(state->buf_inv,
+						    state->dst_mmap,
+						    job->dst,
+						    job->dst_len,
+						    &job->dst_buf);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to acquire DOCA buffer representing destination buffer: %s",
+			     doca_error_get_descr(result));
+		goto destroy_src_buf;
+	}
 
-	/* Submit encrypt task */
-	resources->num_remaining_tasks++;
-	result = doca_task_submit(task);
+	job->tag_buf = NULL;
+	if (job->tag != NULL) {
+		result = chain_job_tag(resources, job);
+		if (result != DOCA_SUCCESS)
+			goto destroy_dst_buf;
+	}
+
+	job->release_bufs = true;
+	result = submit_job_task(resources, job);
 	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to submit encrypt task: %s", doca_error_get_descr(result));
-		doca_task_free(task);
+		job->release_bufs = false;
+		release_job_bufs(job);
 		return result;
 	}
 
-	resources->run_pe_progress = true;
+	return DOCA_SUCCESS;
 
-	/* Wait for all tasks to be completed and context to stop */
-	while (resources->run_pe_progress) {
-		if (doca_pe_progress(state->pe) == 0)
-			nanosleep(&ts, &ts);
-	}
+destroy_dst_buf:
+	(void)doca_buf_dec_refcount(job->dst_buf, NULL);
+	job->dst_buf = NULL;
+destroy_src_buf:
+	(void)doca_buf_dec_refcount(job->src_buf, NULL);
+	job->src_buf = NULL;
+	return result;
+}
 
-	return task_result;
+doca_error_t aes_gcm_start(struct aes_gcm_resources *resources)
+{
+	if (resources->emu != NULL)
+		return DOCA_SUCCESS;
+	return doca_ctx_start(resources->state->ctx);
 }
 
-doca_error_t submit_aes_gcm_decrypt_task(struct aes_gcm_resources *resources,
-					 struct doca_buf *src_buf,
-					 struct doca_buf *dst_buf,
-					 struct doca_aes_gcm_key *key,
-					 const uint8_t *iv,
-					 uint32_t iv_length,
-					 uint32_t tag_size,
-					 uint32_t aad_size)
+uint32_t aes_gcm_progress(struct aes_gcm_resources *resources)
 {
-	struct doca_aes_gcm_task_decrypt *decrypt_task;
-	struct program_core_objects *state = resources->state;
-	struct doca_task *task;
-	union doca_data task_user_data = {0};
-	struct timespec ts = {
-		.tv_sec = 0,
-		.tv_nsec = SLEEP_IN_NANOS,
-	};
-	doca_error_t result, task_result;
+	/* A full burst, or a partial one that waited long enough, gets its doorbell */
+	if (resources->held_job != NULL &&
+	    (resources->num_unflushed >= resources->submit_burst ||
+	     aes_gcm_get_time_ns() - resources->first_unflushed_ns >= resources->burst_timeout_ns))
+		ring_doorbell(resources);
+
+	if (resources->emu != NULL)
+		return aes_gcm_emu_progress(resources->emu, resources);
+	return doca_pe_progress(resources->state->pe);
+}
 
-	/* Include result in user data of task to be used in the callbacks */
-	task_user_data.ptr = &task_result;
-	/* Allocate and construct decrypt task */
-	result = doca_aes_gcm_task_decrypt_alloc_init(resources->aes_gcm,
-						      src_buf,
-						      dst_buf,
-						      key,
-						      iv,
-						      iv_length,
-						      tag_size,
-						      aad_size,
-						      task_user_data,
-						      &decrypt_task);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to allocate decrypt task: %s", doca_error_get_descr(result));
-		return result;
+void aes_gcm_flush(struct aes_gcm_resources *resources)
+{
+	ring_doorbell(resources);
+}
+
+bool aes_gcm_is_running(struct aes_gcm_resources *resources)
+{
+	enum doca_ctx_states ctx_state = DOCA_CTX_STATE_IDLE;
+
+	if (resources->emu != NULL)
+		return aes_gcm_emu_is_running(resources->emu);
+	(void)doca_ctx_get_state(resources->state->ctx, &ctx_state);
+	return ctx_state == DOCA_CTX_STATE_RUNNING;
+}
+
+doca_error_t aes_gcm_recover(struct aes_gcm_resources *resources)
+{
+	enum doca_ctx_states ctx_state = DOCA_CTX_STATE_IDLE;
+	struct aes_gcm_job *job;
+	doca_error_t result;
+
+	if (resources->emu != NULL) {
+		/* The stopped engine flushes what it was handed, the held job never reached it */
+		job = resources->held_job;
+		if (job != NULL) {
+			resources->held_job = NULL;
+			resources->num_unflushed = 0;
+			fail_deferred_task(resources, NULL, NULL, job, DOCA_ERROR_BAD_STATE);
+		}
+		if (resources->num_remaining_tasks > 0) {
+			(void)aes_gcm_emu_progress(resources->emu, resources);
+			return DOCA_ERROR_AGAIN;
+		}
+		aes_gcm_emu_restart(resources->emu);
+		return DOCA_SUCCESS;
 	}
 
-	task = doca_aes_gcm_task_decrypt_as_task(decrypt_task);
+	(void)doca_ctx_get_state(resources->state->ctx, &ctx_state);
+	if (ctx_state == DOCA_CTX_STATE_RUNNING)
+		return DOCA_SUCCESS;
 
-	/* Submit decrypt task */
-	resources->num_remaining_tasks++;
-	result = doca_task_submit(task);
+	/* The context reaches idle only once every task it allocated was freed */
+	job = resources->held_job;
+	if (job != NULL) {
+		resources->held_job = NULL;
+		resources->num_unflushed = 0;
+		fail_deferred_task(resources, NULL, resources->held_task, job, DOCA_ERROR_BAD_STATE);
+	}
+	while (resources->num_free_tasks > 0)
+		doca_task_free(pooled_task_as_task(resources, resources->free_tasks[--resources->num_free_tasks]));
+
+	if (ctx_state != DOCA_CTX_STATE_IDLE) {
+		(void)doca_pe_progress(resources->state->pe);
+		return DOCA_ERROR_AGAIN;
+	}
+
+	result = doca_ctx_start(resources->state->ctx);
 	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to submit decrypt task: %s", doca_error_get_descr(result));
-		doca_task_free(task);
+		DOCA_LOG_ERR("Failed to restart the AES-GCM context: %s", doca_error_get_descr(result));
 		return result;
 	}
-
 	resources->run_pe_progress = true;
+	return DOCA_SUCCESS;
+}
 
-	/* Wait for all tasks to be completed and context to stop */
-	while (resources->run_pe_progress) {
-		if (doca_pe_progress(state->pe) == 0)
-			nanosleep(&ts, &ts);
+bool aes_gcm_error_is_transient(doca_error_t result)
+{
+	switch (result) {
+	case DOCA_ERROR_AGAIN:
+	case DOCA_ERROR_NO_MEMORY:
+	case DOCA_ERROR_FULL:
+	case DOCA_ERROR_TIME_OUT:
+	case DOCA_ERROR_IO_FAILED:
+		return true;
+	default:
+		return false;
+	}
+}
+
+doca_error_t aes_gcm_key_create(struct aes_gcm_resources *resources,
+				const void *raw_key,
+				enum doca_aes_gcm_key_type key_type,
+				struct doca_aes_gcm_key **key)
+{
+	if (resources->emu != NULL)
+		return aes_gcm_emu_key_create(resources->emu, raw_key, key_type, key);
+	return doca_aes_gcm_key_create(resources->aes_gcm, raw_key, key_type, key);
+}
+
+doca_error_t aes_gcm_key_destroy(struct aes_gcm_resources *resources, struct doca_aes_gcm_key *key)
+{
+	if (resources->emu != NULL) {
+		aes_gcm_emu_key_destroy(key);
+		return DOCA_SUCCESS;
 	}
+	return doca_aes_gcm_key_destroy(key);
+}
+
+void aes_gcm_derive_iv(const uint8_t *base_iv, uint32_t iv_length, uint64_t counter, uint8_t *iv)
+{
+	uint32_t i;
+
+	memcpy(iv, base_iv, iv_length);
+	for (i = 0; i < iv_length && i < sizeof(counter); i++)
+		iv[iv_length - 1 - i] ^= (uint8_t)(counter >> (8 * i));
+}
 
-	return task_result;
+uint64_t aes_gcm_get_time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+doca_error_t aes_gcm_file_io(int fd, void *buf, size_t len, off_t offset, bool write)
+{
+	ssize_t n;
+
+	while (len > 0) {
+		n = write ? pwrite(fd, buf, len, offset) : pread(fd, buf, len, offset);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0) {
+			DOCA_LOG_ERR("Failed to %s %zu bytes at offset %ld: %s",
+				     write ? "write" : "read",
+				     len,
+				     (long)offset,
+				     (n < 0) ? strerror(errno) : "unexpected end of file");
+			return DOCA_ERROR_IO_FAILED;
+		}
+		buf = (uint8_t *)buf + n;
+		len -= n;
+		offset += n;
+	}
+	return DOCA_SUCCESS;
 }
 
 doca_error_t aes_gcm_task_encrypt_is_supported(struct doca_devinfo *devinfo)
@@ -689,24 +2902,73 @@ doca_error_t aes_gcm_task_decrypt_is_supported(struct doca_devinfo *devinfo)
 	return doca_aes_gcm_cap_task_decrypt_is_supported(devinfo);
 }
 
+void aes_gcm_finish_job(struct aes_gcm_resources *resources,
+			struct aes_gcm_job *job,
+			doca_error_t status,
+			size_t out_len)
+{
+	job->result = status;
+	job->complete_ns = aes_gcm_get_time_ns();
+	job->out_len = out_len;
+
+	/* Decrement number of remaining tasks */
+	--resources->num_remaining_tasks;
+	aes_gcm_metrics_gauge_add(AES_GCM_METRICS_INFLIGHT_TASKS, -1);
+	aes_gcm_metrics_job_done(job);
+
+	if (resources->job_hook != NULL)
+		resources->job_hook(resources, job);
+	else if (job->done_cb != NULL)
+		job->done_cb(job);
+}
+
+/*
+ * Finish a job whose task has completed, successfully or not
+ *
+ * @resources [in]: DOCA AES-GCM resources
+ * @typed_task [in]: The completed encrypt/decrypt task, NULL if the task must not be reused
+ * @task [in]: The completed task
+ * @job [in]: The job the task belongs to
+ * @status [in]: Task status
+ */
+static void complete_job(struct aes_gcm_resources *resources,
+			 void *typed_task,
+			 struct doca_task *task,
+			 struct aes_gcm_job *job,
+			 doca_error_t status)
+{
+	size_t out_len = 0;
+
+	if (status == DOCA_SUCCESS)
+		(void)doca_buf_get_data_len(job->dst_buf, &out_len);
+
+	/* Return the task to the pool, or free it */
+	release_task(resources, typed_task, task);
+	if (job->release_bufs) {
+		release_job_bufs(job);
+		job->release_bufs = false;
+	}
+
+	aes_gcm_finish_job(resources, job, status, out_len);
+
+	/* Stop context once all tasks are completed */
+	if (resources->num_remaining_tasks == 0 && !resources->keep_ctx_running)
+		(void)doca_ctx_stop(resources->state->ctx);
+}
+
 void encrypt_completed_callback(struct doca_aes_gcm_task_encrypt *encrypt_task,
 				union doca_data task_user_data,
 				union doca_data ctx_user_data)
 {
 	struct aes_gcm_resources *resources = (struct aes_gcm_resources *)ctx_user_data.ptr;
-	doca_error_t *result = (doca_error_t *)task_user_data.ptr;
+	struct aes_gcm_job *job = (struct aes_gcm_job *)task_user_data.ptr;
 
-	DOCA_LOG_INFO("Encrypt task was done successfully");
+	if (resources->keep_ctx_running)
+		DOCA_LOG_DBG("Encrypt task was done successfully");
+	else
+		DOCA_LOG_INFO("Encrypt task was done successfully");
 
-	/* Assign success to the result */
-	*result = DOCA_SUCCESS;
-	/* Free task */
-	doca_task_free(doca_aes_gcm_task_encrypt_as_task(encrypt_task));
-	/* Decrement number of remaining tasks */
-	--resources->num_remaining_tasks;
-	/* Stop context once all tasks are completed */
-	if (resources->num_remaining_tasks == 0)
-		(void)doca_ctx_stop(resources->state->ctx);
+	complete_job(resources, encrypt_task, doca_aes_gcm_task_encrypt_as_task(encrypt_task), job, DOCA_SUCCESS);
 }
 
 void encrypt_error_callback(struct doca_aes_gcm_task_encrypt *encrypt_task,
@@ -715,18 +2977,14 @@ void encrypt_error_callback(struct doca_aes_gcm_task_encrypt *encrypt_task,
 {
 	struct aes_gcm_resources *resources = (struct aes_gcm_resources *)ctx_user_data.ptr;
 	struct doca_task *task = doca_aes_gcm_task_encrypt_as_task(encrypt_task);
-	doca_error_t *result = (doca_error_t *)task_user_data.ptr;
+	struct aes_gcm_job *job = (struct aes_gcm_job *)task_user_data.ptr;
+	doca_error_t result;
 
 	/* Get the result of the task */
-	*result = doca_task_get_status(task);
-	DOCA_LOG_ERR("Encrypt task failed: %s", doca_error_get_descr(*result));
-	/* Free task */
-	doca_task_free(task);
-	/* Decrement number of remaining tasks */
-	--resources->num_remaining_tasks;
-	/* Stop context once all tasks are completed */
-	if (resources->num_remaining_tasks == 0)
-		(void)doca_ctx_stop(resources->state->ctx);
+	result = doca_task_get_status(task);
+	DOCA_LOG_ERR("Encrypt task failed: %s", doca_error_get_descr(result));
+	/* A failed task is freed, the context may be stopping */
+	complete_job(resources, NULL, task, job, result);
 }
 
 void decrypt_completed_callback(struct doca_aes_gcm_task_decrypt *decrypt_task,
@@ -734,19 +2992,14 @@ void decrypt_completed_callback(struct doca_aes_gcm_task_decrypt *decrypt_task,
 				union doca_data ctx_user_data)
 {
 	struct aes_gcm_resources *resources = (struct aes_gcm_resources *)ctx_user_data.ptr;
-	doca_error_t *result = (doca_error_t *)task_user_data.ptr;
+	struct aes_gcm_job *job = (struct aes_gcm_job *)task_user_data.ptr;
 
-	DOCA_LOG_INFO("Decrypt task was done successfully");
+	if (resources->keep_ctx_running)
+		DOCA_LOG_DBG("Decrypt task was done successfully");
+	else
+		DOCA_LOG_INFO("Decrypt task was done successfully");
 
-	/* Assign success to the result */
-	*result = DOCA_SUCCESS;
-	/* Free task */
-	doca_task_free(doca_aes_gcm_task_decrypt_as_task(decrypt_task));
-	/* Decrement number of remaining tasks */
-	--resources->num_remaining_tasks;
-	/* Stop context once all tasks are completed */
-	if (resources->num_remaining_tasks == 0)
-		(void)doca_ctx_stop(resources->state->ctx);
+	complete_job(resources, decrypt_task, doca_aes_gcm_task_decrypt_as_task(decrypt_task), job, DOCA_SUCCESS);
 }
 
 void decrypt_error_callback(struct doca_aes_gcm_task_decrypt *decrypt_task,
@@ -755,16 +3008,12 @@ void decrypt_error_callback(struct doca_aes_gcm_task_decrypt *decrypt_task,
 {
 	struct aes_gcm_resources *resources = (struct aes_gcm_resources *)ctx_user_data.ptr;
 	struct doca_task *task = doca_aes_gcm_task_decrypt_as_task(decrypt_task);
-	doca_error_t *result = (doca_error_t *)task_user_data.ptr;
+	struct aes_gcm_job *job = (struct aes_gcm_job *)task_user_data.ptr;
+	doca_error_t result;
 
 	/* Get the result of the task */
-	*result = doca_task_get_status(task);
-	DOCA_LOG_ERR("Decrypt task failed: %s", doca_error_get_descr(*result));
-	/* Free task */
-	doca_task_free(task);
-	/* Decrement number of remaining tasks */
-	--resources->num_remaining_tasks;
-	/* Stop context once all tasks are completed */
-	if (resources->num_remaining_tasks == 0)
-		(void)doca_ctx_stop(resources->state->ctx);
+	result = doca_task_get_status(task);
+	DOCA_LOG_ERR("Decrypt task failed: %s", doca_error_get_descr(result));
+	/* A failed task is freed, the context may be stopping */
+	complete_job(resources, NULL, task, job, result);
 }
@@ -17,6 +17,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <sys/types.h>
 
 #include <doca_dev.h>
 #include <doca_aes_gcm.h>
@@ -43,33 +44,212 @@
 #define SLEEP_IN_NANOS (10 * 1000) /* Sample the task every 10 microseconds */
 #define NUM_AES_GCM_TASKS (1)	   /* Number of AES-GCM tasks */
 
+#define AES_GCM_MAX_DEVICES 8						/* Max number of devices in a device group */
+#define AES_GCM_DEFAULT_QUEUE_DEPTH 16					/* Default tasks in flight per device */
+#define AES_GCM_DEFAULT_BURST_TIMEOUT_US 50				/* Default max wait of a partial submit burst */
+#define AES_GCM_CODEC_NAME_SIZE 16					/* Max compression codec name length */
+#define AES_GCM_TLS_MAX_SECRET_SIZE 48					/* Max TLS 1.3 traffic secret size, SHA-384 */
+#define AES_GCM_DEFAULT_SECTOR_SIZE 4096				/* Default block image sector size */
+#define AES_GCM_MAX_TENANTS 8						/* Max number of fair share tenants */
+#define AES_GCM_ADDR_SIZE 64						/* Max relay address length, host:port */
+#define AES_GCM_DEFAULT_CAPS_CACHE "/var/cache/doca_aes_gcm/caps.cache"	/* Default device capabilities cache file */
+#define AES_GCM_DEFAULT_TUNING_PROFILE "/var/cache/doca_aes_gcm/tuning"	/* Default device tuning profile file */
+
 /* AES-GCM modes */
 enum aes_gcm_mode {
 	AES_GCM_MODE_ENCRYPT, /* Encrypt mode */
 	AES_GCM_MODE_DECRYPT, /* Decrypt mode */
 };
 
+/* Startup phases, timed per device */
+enum aes_gcm_startup_phase {
+	AES_GCM_STARTUP_DEV_OPEN,   /* Device lookup and open */
+	AES_GCM_STARTUP_CTX_CREATE, /* AES-GCM context, core objects, PE connection and task configuration */
+	AES_GCM_STARTUP_MMAP_START, /* Source and destination memory registration */
+	AES_GCM_STARTUP_CTX_START,  /* Context start */
+	AES_GCM_STARTUP_NUM_PHASES, /* Number of startup phases */
+};
+
+/* Page size preference for the registered memory, each policy falls back to the next smaller page size */
+enum aes_gcm_hugepage_policy {
+	AES_GCM_HUGEPAGE_OFF, /* Regular pages */
+	AES_GCM_HUGEPAGE_THP, /* Transparent huge pages, 2M aligned */
+	AES_GCM_HUGEPAGE_2M,  /* 2M hugetlbfs pages */
+	AES_GCM_HUGEPAGE_1G,  /* 1G hugetlbfs pages */
+};
+
+/* Scheduling class of a device group job, the higher class is dispatched first */
+enum aes_gcm_job_priority {
+	AES_GCM_PRIORITY_BULK,  /* Throughput jobs, the default */
+	AES_GCM_PRIORITY_HIGH,  /* Latency sensitive jobs, they may take the reserved task slots */
+	AES_GCM_NUM_PRIORITIES, /* Number of priority classes */
+};
+
+/* Destination memory of the chunked flow */
+enum aes_gcm_dst_buffers {
+	AES_GCM_DST_FULL,      /* One destination buffer for the whole output */
+	AES_GCM_DST_IN_PLACE,  /* Chunks are written over their source */
+	AES_GCM_DST_PING_PONG, /* Two windows of chunks reused across the stream */
+};
+
+/* Performance and fault model of the emulated AES-GCM devices, see aes_gcm_emu.h */
+struct aes_gcm_emu_model {
+	uint32_t num_devices;	    /* Number of emulated devices, 0 to use real devices */
+	uint64_t latency_ns;	    /* Fixed latency of every task */
+	uint64_t bandwidth_mbps;    /* Engine bandwidth in MB/s, 0 for unlimited */
+	uint32_t max_tasks;	    /* Max number of tasks in flight per device */
+	uint64_t max_buf_size;	    /* Max task buffer size */
+	double error_rate;	    /* Probability that a task fails */
+	double doorbell_error_rate; /* Probability that a doorbell is rejected along with its task */
+	uint64_t fail_after;	    /* Tasks after which the device stops running, 0 for never */
+	uint32_t seed;		    /* Seed of the error injection */
+};
+
+/* Share of the devices given to a tenant, see aes_gcm_tenant.h */
+struct aes_gcm_tenant_spec {
+	uint32_t weight;	 /* Share of the devices relative to the other tenants */
+	uint64_t bandwidth_mbps; /* Source bytes rate limit in MB/s, 0 for unlimited */
+	uint64_t ops_per_sec;	 /* Job rate limit, 0 for unlimited */
+};
+
 /* Configuration struct */
 struct aes_gcm_cfg {
-	char file_path[MAX_FILE_NAME];		      /* File to encrypt/decrypt */
-	char output_path[MAX_FILE_NAME];	      /* Output file */
+	char file_path[MAX_FILE_NAME]; /* File to encrypt/decrypt */
+	char output_path[MAX_FILE_NAME]; /* Output file */
 	char pci_address[DOCA_DEVINFO_PCI_ADDR_SIZE]; /* Device PCI address */
-	uint8_t raw_key[MAX_AES_GCM_KEY_SIZE];	      /* Raw key */
-	enum doca_aes_gcm_key_type raw_key_type;      /* Raw key type */
-	uint8_t iv[MAX_AES_GCM_IV_LENGTH];	      /* Initialization vector */
-	uint32_t iv_length;			      /* Initialization vector length */
-	uint32_t tag_size;			      /* Authentication tag size */
-	uint32_t aad_size;			      /* Additional authenticated data size */
-	enum aes_gcm_mode mode;			      /* AES-GCM task type */
+	uint8_t raw_key[MAX_AES_GCM_KEY_SIZE]; /* Raw key */
+	enum doca_aes_gcm_key_type raw_key_type; /* Raw key type */
+	uint8_t iv[MAX_AES_GCM_IV_LENGTH]; /* Initialization vector */
+	uint32_t iv_length; /* Initialization vector length */
+	uint32_t tag_size; /* Authentication tag size */
+	uint32_t aad_size; /* Additional authenticated data size */
+	enum aes_gcm_mode mode; /* AES-GCM task type */
+	char pci_addresses[AES_GCM_MAX_DEVICES][DOCA_DEVINFO_PCI_ADDR_SIZE]; /* Device group PCI addresses */
+	uint32_t num_pci_addresses; /* Number of device group addresses */
+	bool all_devices; /* Use every capable device */
+	uint32_t chunk_size; /* Chunk size, 0 for a single chunk */
+	char caps_cache_path[MAX_FILE_NAME]; /* Device capabilities cache file */
+	uint32_t queue_depth; /* Max tasks in flight per device */
+	bool queue_depth_set; /* Queue depth was given explicitly, the tuning profile does not override it */
+	uint32_t latency_target_us; /* Adaptive depth target, 0 is off */
+	bool verify_only; /* Only check the tags on decrypt */
+	char tag_index_path[MAX_FILE_NAME]; /* Detached tags file, empty when unused */
+	char compress_codec[AES_GCM_CODEC_NAME_SIZE]; /* Compression codec, empty when unused */
+	struct aes_gcm_emu_model emu; /* Emulated devices model */
+	bool no_numa; /* Keep buffers and threads where they are */
+	enum aes_gcm_hugepage_policy hugepages; /* Page size of the registered memory */
+	bool low_latency; /* Spin instead of sleeping in aes_gcm_device_group_wait() */
+	int poll_cpu; /* Core of the latency benchmark progress thread, -1 for the NUMA cores */
+	uint32_t latency_bench; /* Latency benchmark iterations, 0 is off */
+	uint32_t submit_burst; /* Tasks per doorbell, 1 rings it for every task */
+	uint32_t submit_burst_timeout_us; /* Max time a task waits for its doorbell */
+	bool records; /* Input is a stream of length-prefixed records */
+	uint8_t tls_secret[AES_GCM_TLS_MAX_SECRET_SIZE]; /* TLS 1.3 traffic secret */
+	uint32_t tls_secret_len; /* TLS 1.3 traffic secret length, 0 is off */
+	bool tls_verify; /* Check every TLS record against the CPU */
+	char block_image_path[MAX_FILE_NAME]; /* Encrypted block image, empty when unused */
+	uint32_t sector_size; /* Block image sector size */
+	uint64_t first_sector; /* First block image sector to process */
+	uint64_t num_sectors; /* Number of sectors to process, 0 up to the end */
+	bool cpu_fallback; /* Run the jobs no device could complete on the CPU */
+	char metrics_path[MAX_FILE_NAME]; /* Prometheus metrics file, empty when unused */
+	uint16_t metrics_port; /* Metrics HTTP port on the loopback interface, 0 is off */
+	char tuning_profile_path[MAX_FILE_NAME]; /* Device tuning profile file */
+	bool calibrate; /* Sweep the devices and save their tuning profile */
+	char gmac_manifest_path[MAX_FILE_NAME]; /* GMAC manifest file, empty when unused */
+	enum aes_gcm_dst_buffers dst_buffers; /* Destination memory of the chunked flow */
+	bool sparse; /* Only process the data extents of a sparse file */
+	char checkpoint_path[MAX_FILE_NAME]; /* Checkpoint file of the chunked flow, empty when unused */
+	bool resume; /* Continue from the checkpoint file */
+	uint32_t priority_reserve; /* Task slots per device kept free for the high priority jobs */
+	uint32_t deadline_us; /* Max time a high priority job waits in the queue, 0 is no limit */
+	uint32_t bench_bulk; /* Bulk jobs kept queued behind the latency benchmark, 0 is off */
+	struct aes_gcm_tenant_spec tenants[AES_GCM_MAX_TENANTS]; /* Fair share tenants */
+	uint32_t num_tenants; /* Number of fair share tenants, 0 is off */
+	char relay_listen[AES_GCM_ADDR_SIZE]; /* Relay listening address, empty when the relay is off */
+	char relay_target[AES_GCM_ADDR_SIZE]; /* Address the relay connects every client to */
+};
+
+struct aes_gcm_resources;
+struct aes_gcm_job;
+struct aes_gcm_emu;
+
+/*
+ * Job completion callback, called from within doca_pe_progress() once the job has finished
+ *
+ * @job [in]: The completed job, job->result holds the task status
+ */
+typedef void (*aes_gcm_job_done_cb)(struct aes_gcm_job *job);
+
+/*
+ * Resources level completion hook, called instead of job->done_cb when set
+ *
+ * @resources [in]: The resources the job was submitted to
+ * @job [in]: The completed job
+ */
+typedef void (*aes_gcm_job_hook)(struct aes_gcm_resources *resources, struct aes_gcm_job *job);
+
+/* Asynchronous AES-GCM job, described by host addresses inside the registered memory ranges */
+struct aes_gcm_job {
+	enum aes_gcm_mode mode;		    /* Encrypt or decrypt */
+	void *src;			    /* Source data: AAD followed by the payload (and tag on decrypt) */
+	size_t src_len;			    /* Source data length in bytes */
+	void *dst;			    /* Destination address */
+	size_t dst_len;			    /* Destination capacity in bytes */
+	struct doca_aes_gcm_key *key;	    /* Key object of the context the job runs on */
+	uint8_t iv[MAX_AES_GCM_IV_LENGTH];  /* Initialization vector */
+	uint32_t iv_length;		    /* Initialization vector length */
+	uint32_t tag_size;		    /* Authentication tag size */
+	uint32_t aad_size;		    /* Additional authenticated data size */
+	aes_gcm_job_done_cb done_cb;	    /* Completion callback, may be NULL */
+	void *user_data;		    /* Opaque caller data */
+	void *tag;			    /* Detached tag, NULL when the tag follows the payload */
+	enum aes_gcm_job_priority priority; /* Device group scheduling class */
+	uint64_t deadline_ns;		    /* Monotonic time after which a queued job is rejected, 0 for none */
+	uint32_t tenant;		    /* Fair share tenant of a bulk job */
+
+	doca_error_t result;  /* Task status, valid once the job has completed */
+	size_t out_len;	      /* Bytes written to the destination */
+	uint64_t submit_ns;   /* Submission timestamp */
+	uint64_t complete_ns; /* Completion timestamp */
+
+	struct doca_buf *src_buf;	     /* DOCA buffer wrapping the source */
+	struct doca_buf *dst_buf;	     /* DOCA buffer wrapping the destination */
+	struct doca_buf *tag_buf;	     /* DOCA buffer wrapping the detached tag */
+	bool release_bufs;		     /* Return the DOCA buffers to the inventory on completion */
+	struct aes_gcm_group_key *group_key; /* Device group key, see aes_gcm_device_group.h */
+	uint32_t member_idx;		     /* Device group member the job was dispatched to */
+	uint32_t tried_members;		     /* Bitmask of device group members that failed the job */
+	uint32_t num_retries;		     /* Retries of the job after transient errors */
+	struct aes_gcm_job *next;	     /* Queue linkage */
 };
 
 /* DOCA AES-GCM resources */
 struct aes_gcm_resources {
-	struct program_core_objects *state; /* DOCA program core objects */
-	struct doca_aes_gcm *aes_gcm;	    /* DOCA AES-GCM context */
-	size_t num_remaining_tasks;	    /* Number of remaining AES-GCM tasks */
-	enum aes_gcm_mode mode;		    /* AES-GCM mode - encrypt/decrypt */
-	bool run_pe_progress;		    /* Controls whether progress loop should run */
+	struct program_core_objects *state;		 /* DOCA program core objects */
+	struct doca_aes_gcm *aes_gcm;			 /* DOCA AES-GCM context */
+	size_t num_remaining_tasks;			 /* Number of remaining AES-GCM tasks */
+	enum aes_gcm_mode mode;				 /* AES-GCM mode - encrypt/decrypt */
+	bool run_pe_progress;				 /* Controls whether progress loop should run */
+	bool keep_ctx_running;				 /* Do not stop the context once all tasks are completed */
+	aes_gcm_job_hook job_hook;			 /* Optional job completion hook */
+	void *owner;					 /* Opaque owner of the resources, used by job_hook */
+	uint64_t startup_ns[AES_GCM_STARTUP_NUM_PHASES]; /* Time spent in every startup phase */
+	uint32_t num_tasks;				 /* Task pool size, NUM_AES_GCM_TASKS when 0 */
+	void **free_tasks;				 /* Completed encrypt/decrypt tasks kept for reuse */
+	uint32_t num_free_tasks;			 /* Number of tasks in free_tasks */
+	uint32_t num_allocated_tasks;			 /* Number of tasks allocated from the context */
+	uint64_t num_task_reuses;			 /* Number of submissions that re-armed a pooled task */
+	struct doca_mmap *tag_mmap;			 /* Detached tags memory, NULL until registered */
+	struct aes_gcm_emu *emu;			 /* Emulated device, NULL for a DOCA device */
+	uint32_t submit_burst;				 /* Tasks per doorbell, 0 or 1 rings it for every task */
+	uint64_t burst_timeout_ns;			 /* Max time a partial burst waits for its doorbell */
+	struct doca_task *held_task;			 /* Last submitted task, held back to carry the doorbell */
+	void *held_typed_task;				 /* Encrypt or decrypt task of held_task */
+	struct aes_gcm_job *held_job;			 /* Job of held_task, NULL if none, set alone when emulated */
+	uint32_t num_unflushed;				 /* Tasks submitted since the last doorbell */
+	uint64_t first_unflushed_ns;			 /* Submission timestamp of the oldest of them */
+	uint64_t num_doorbells;				 /* Number of doorbells rung */
 };
 
 /*
@@ -89,6 +269,8 @@ doca_error_t register_aes_gcm_params(void);
 /*
  * Allocate DOCA AES-GCM resources
  *
+ * resources->mode must be set by the caller, resources->num_tasks sizes the task pool (0 for NUM_AES_GCM_TASKS).
+ *
  * @pci_addr [in]: Device PCI address
  * @max_bufs [in]: Maximum number of buffers for DOCA Inventory
  * @resources [out]: DOCA AES-GCM resources to allocate
@@ -96,9 +278,38 @@ doca_error_t register_aes_gcm_params(void);
  */
 doca_error_t allocate_aes_gcm_resources(const char *pci_addr, uint32_t max_bufs, struct aes_gcm_resources *resources);
 
+/*
+ * Allocate DOCA AES-GCM resources on a device that was already probed, without walking the device list again
+ *
+ * @devinfo [in]: Device to open
+ * @max_bufs [in]: Maximum number of buffers for DOCA Inventory
+ * @resources [out]: DOCA AES-GCM resources to allocate
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t allocate_aes_gcm_resources_from_devinfo(struct doca_devinfo *devinfo,
+						     uint32_t max_bufs,
+						     struct aes_gcm_resources *resources);
+
+/*
+ * Allocate AES-GCM resources on an emulated device, see aes_gcm_emu.h
+ *
+ * The resources have no DOCA objects, they are driven through aes_gcm_start(), aes_gcm_progress() and the key
+ * functions below like the resources of a DOCA device.
+ *
+ * @model [in]: Emulated device model
+ * @idx [in]: Emulated device index
+ * @resources [out]: AES-GCM resources to allocate
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t allocate_aes_gcm_resources_emulated(const struct aes_gcm_emu_model *model,
+						 uint32_t idx,
+						 struct aes_gcm_resources *resources);
+
 /*
  * Destroy DOCA AES-GCM resources
  *
+ * A task still held back for its doorbell completes its job with DOCA_ERROR_BAD_STATE.
+ *
  * @resources [in]: DOCA AES-GCM resources to destroy
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
@@ -148,6 +359,168 @@ doca_error_t submit_aes_gcm_decrypt_task(struct aes_gcm_resources *resources,
 					 uint32_t tag_size,
 					 uint32_t aad_size);
 
+/*
+ * Register host memory ranges with the source and destination mmaps and start them
+ *
+ * @resources [in]: DOCA AES-GCM resources
+ * @src [in]: Source memory range address
+ * @src_len [in]: Source memory range length
+ * @dst [in]: Destination memory range address
+ * @dst_len [in]: Destination memory range length
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_register_memory(struct aes_gcm_resources *resources,
+				     void *src,
+				     size_t src_len,
+				     void *dst,
+				     size_t dst_len);
+
+/*
+ * Register the host memory range holding detached tags
+ *
+ * Jobs with a detached tag chain the tag to the payload buffer: the encrypt tag is written to job->tag and the
+ * decrypt tag is read from job->tag, so the payload memory holds no tags. The device must support buffer lists.
+ *
+ * @resources [in]: DOCA AES-GCM resources
+ * @tags [in]: Tags memory range address
+ * @tags_len [in]: Tags memory range length
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_register_tag_memory(struct aes_gcm_resources *resources, void *tags, size_t tags_len);
+
+/*
+ * Submit an AES-GCM job without waiting for its completion
+ *
+ * The job memory must stay valid until its completion callback is called from aes_gcm_progress().
+ * The context is expected to be running and resources->keep_ctx_running to be set, in which case completed tasks are
+ * kept in a pool of resources->num_tasks tasks and re-armed for the next jobs instead of being freed.
+ *
+ * @resources [in]: DOCA AES-GCM resources
+ * @job [in]: The job to submit
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_job_submit(struct aes_gcm_resources *resources, struct aes_gcm_job *job);
+
+/*
+ * Start the AES-GCM context, the memory must be registered first
+ *
+ * @resources [in]: AES-GCM resources
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_start(struct aes_gcm_resources *resources);
+
+/*
+ * Progress the AES-GCM resources once, completed jobs call their completion callback
+ *
+ * @resources [in]: AES-GCM resources
+ * @return: number of completed jobs
+ */
+uint32_t aes_gcm_progress(struct aes_gcm_resources *resources);
+
+/*
+ * Ring the doorbell for the tasks submitted since the last one, see resources->submit_burst
+ *
+ * aes_gcm_progress() does it on its own once they fill a burst or the oldest of them waited
+ * resources->burst_timeout_ns.
+ *
+ * @resources [in]: AES-GCM resources
+ */
+void aes_gcm_flush(struct aes_gcm_resources *resources);
+
+/*
+ * Check if the AES-GCM context is still running
+ *
+ * @resources [in]: AES-GCM resources
+ * @return: true if the context is running
+ */
+bool aes_gcm_is_running(struct aes_gcm_resources *resources);
+
+/*
+ * Bring a context that stopped on an engine failure back to running, without touching its memory registrations and
+ * keys
+ *
+ * The pooled tasks are freed, a task held back for its doorbell fails with DOCA_ERROR_BAD_STATE, and the context is
+ * progressed until the tasks in flight were flushed before it is started again. Must be called again as long as it
+ * returns DOCA_ERROR_AGAIN.
+ *
+ * @resources [in]: AES-GCM resources, keep_ctx_running must be set
+ * @return: DOCA_SUCCESS once the context runs, DOCA_ERROR_AGAIN while it is still stopping and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_recover(struct aes_gcm_resources *resources);
+
+/*
+ * Check if a job error is worth retrying as is, the job and the engine being fine
+ *
+ * @result [in]: Job status
+ * @return: true for errors caused by a momentary lack of resources or a timeout
+ */
+bool aes_gcm_error_is_transient(doca_error_t result);
+
+/*
+ * Create an AES-GCM key for the jobs submitted to the resources
+ *
+ * @resources [in]: AES-GCM resources
+ * @raw_key [in]: Raw key
+ * @key_type [in]: Raw key type
+ * @key [out]: The key
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_key_create(struct aes_gcm_resources *resources,
+				const void *raw_key,
+				enum doca_aes_gcm_key_type key_type,
+				struct doca_aes_gcm_key **key);
+
+/*
+ * Destroy a key created with aes_gcm_key_create()
+ *
+ * @resources [in]: AES-GCM resources
+ * @key [in]: The key
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_key_destroy(struct aes_gcm_resources *resources, struct doca_aes_gcm_key *key);
+
+/*
+ * Record the result of a job and hand it to the completion hook or callback
+ *
+ * @resources [in]: AES-GCM resources the job ran on
+ * @job [in]: The completed job
+ * @status [in]: Job status
+ * @out_len [in]: Bytes written to the destination
+ */
+void aes_gcm_finish_job(struct aes_gcm_resources *resources,
+			struct aes_gcm_job *job,
+			doca_error_t status,
+			size_t out_len);
+
+/*
+ * Derive a per-chunk initialization vector by XOR-ing a big endian counter into the trailing bytes of the IV
+ *
+ * @base_iv [in]: Base initialization vector
+ * @iv_length [in]: Initialization vector length in bytes
+ * @counter [in]: Chunk counter, counter 0 yields the base IV
+ * @iv [out]: Derived initialization vector
+ */
+void aes_gcm_derive_iv(const uint8_t *base_iv, uint32_t iv_length, uint64_t counter, uint8_t *iv);
+
+/*
+ * Get a monotonic timestamp
+ *
+ * @return: current monotonic time in nanoseconds
+ */
+uint64_t aes_gcm_get_time_ns(void);
+
+/*
+ * Read or write a whole range of a file, retrying partial transfers
+ *
+ * @fd [in]: File descriptor
+ * @buf [in]: Buffer
+ * @len [in]: Range length
+ * @offset [in]: Range offset
+ * @write [in]: true to write the buffer, false to read into it
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_file_io(int fd, void *buf, size_t len, off_t offset, bool write);
+
 /*
  * Check if given device is capable of executing a DOCA AES-GCM encrypt task.
  *
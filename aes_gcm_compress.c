@@ -0,0 +1,433 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <doca_log.h>
+#include <doca_error.h>
+
+#include "aes_gcm_codec.h"
+#include "aes_gcm_compress.h"
+#include "aes_gcm_device_group.h"
+#include "aes_gcm_hugepage.h"
+
+DOCA_LOG_REGISTER(AES_GCM::COMPRESS);
+
+/* Decrypted record of a compressed file */
+struct compressed_record {
+	struct aes_gcm_job job;	/* Decrypt job of the record */
+	size_t idx;		/* Index of the record in the file */
+	char *plain;		/* Decompressed chunk */
+	size_t plain_len;	/* Decompressed chunk length */
+	doca_error_t result;	/* Decrypt and decompress result */
+};
+
+/*
+ * Job done callback - decompress a decrypted frame
+ *
+ * @job [in]: The completed job
+ */
+static void decompress_record(struct aes_gcm_job *job)
+{
+	struct compressed_record *record = (struct compressed_record *)job->user_data;
+	struct aes_gcm_frame_header header;
+	const struct aes_gcm_codec *codec;
+
+	record->result = job->result;
+	if (job->result != DOCA_SUCCESS)
+		return;
+
+	record->result = DOCA_ERROR_INVALID_VALUE;
+	if (job->out_len < sizeof(header)) {
+		DOCA_LOG_ERR("Record %zu is too short to hold a frame header", record->idx);
+		return;
+	}
+
+	memcpy(&header, job->dst, sizeof(header));
+	if (header.magic != AES_GCM_FRAME_MAGIC || header.compressed_size != job->out_len - sizeof(header)) {
+		DOCA_LOG_ERR("Record %zu holds an invalid frame", record->idx);
+		return;
+	}
+
+	codec = aes_gcm_codec_get(header.codec);
+	if (codec == NULL) {
+		DOCA_LOG_ERR("Record %zu was compressed with codec %u, which is not available", record->idx, header.codec);
+		record->result = DOCA_ERROR_NOT_SUPPORTED;
+		return;
+	}
+
+	record->plain = malloc(header.original_size);
+	if (record->plain == NULL) {
+		record->result = DOCA_ERROR_NO_MEMORY;
+		return;
+	}
+
+	record->result = codec->decompress((char *)job->dst + sizeof(header),
+					   header.compressed_size,
+					   record->plain,
+					   header.original_size);
+	if (record->result == DOCA_SUCCESS)
+		record->plain_len = header.original_size;
+}
+
+/*
+ * Compress every chunk of a file and encrypt the frames
+ *
+ * @cfg [in]: Configuration parameters
+ * @codec [in]: Compression codec
+ * @file_data [in]: File data
+ * @file_size [in]: File size
+ * @out_file [in]: Output file
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t compress_encrypt(struct aes_gcm_cfg *cfg,
+				     const struct aes_gcm_codec *codec,
+				     char *file_data,
+				     size_t file_size,
+				     FILE *out_file)
+{
+	const struct aes_gcm_codec *store = aes_gcm_codec_get(AES_GCM_CODEC_STORE);
+	struct aes_gcm_device_group *group = NULL;
+	struct aes_gcm_group_key key = {0};
+	struct aes_gcm_frame_header *header;
+	struct aes_gcm_job *jobs = NULL;
+	struct aes_gcm_job *job;
+	struct aes_gcm_mem frames_mem = {0}, dst_mem = {0};
+	char *frames, *dst_buffer, *frame;
+	size_t chunk_size, num_chunks, frame_size, in_len, payload_len, compressed_bytes = 0, i;
+	uint32_t record_len;
+	uint64_t start_ns;
+	doca_error_t result, tmp_result;
+
+	chunk_size = (cfg->chunk_size != 0) ? cfg->chunk_size : file_size;
+	num_chunks = (file_size + chunk_size - 1) / chunk_size;
+	frame_size = sizeof(*header) + codec->compress_bound(chunk_size);
+	if (frame_size < sizeof(*header) + chunk_size)
+		frame_size = sizeof(*header) + chunk_size;
+
+	result = aes_gcm_device_group_create(cfg, AES_GCM_MODE_ENCRYPT, &group);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create device group: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Sealing appends the tag, the sealed frame is the larger buffer of a job */
+	if (frame_size + cfg->tag_size > group->max_buf_size) {
+		DOCA_LOG_ERR("Frame and tag of %zu bytes > max buffer size %lu",
+			     frame_size + cfg->tag_size,
+			     group->max_buf_size);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto destroy_group;
+	}
+
+	jobs = calloc(num_chunks, sizeof(*jobs));
+	if (jobs == NULL) {
+		result = DOCA_ERROR_NO_MEMORY;
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(result));
+		goto free_buffers;
+	}
+
+	result = aes_gcm_mem_alloc(cfg->hugepages, num_chunks * frame_size, &frames_mem);
+	if (result != DOCA_SUCCESS)
+		goto free_buffers;
+	result = aes_gcm_mem_alloc(cfg->hugepages, num_chunks * (frame_size + cfg->tag_size), &dst_mem);
+	if (result != DOCA_SUCCESS)
+		goto free_buffers;
+	frames = frames_mem.addr;
+	dst_buffer = dst_mem.addr;
+
+	result = aes_gcm_device_group_start(group,
+					    frames,
+					    num_chunks * frame_size,
+					    dst_buffer,
+					    num_chunks * (frame_size + cfg->tag_size));
+	if (result != DOCA_SUCCESS)
+		goto free_buffers;
+
+	result = aes_gcm_device_group_key_create(group, cfg->raw_key, cfg->raw_key_type, &key);
+	if (result != DOCA_SUCCESS)
+		goto free_buffers;
+
+	DOCA_LOG_INFO("Compressing with %s and encrypting %zu chunks on %u devices",
+		      codec->name,
+		      num_chunks,
+		      group->num_members);
+
+	start_ns = aes_gcm_get_time_ns();
+	for (i = 0; i < num_chunks; i++) {
+		in_len = (file_size - (i * chunk_size) < chunk_size) ? (file_size - (i * chunk_size)) : chunk_size;
+		frame = frames + (i * frame_size);
+		header = (struct aes_gcm_frame_header *)frame;
+
+		/* Compress the next chunk while the previous ones are being encrypted */
+		result = codec->compress(file_data + (i * chunk_size),
+					 in_len,
+					 frame + sizeof(*header),
+					 frame_size - sizeof(*header),
+					 &payload_len);
+		if (result != DOCA_SUCCESS)
+			break;
+
+		header->codec = codec->id;
+		if (payload_len >= in_len) {
+			(void)store->compress(file_data + (i * chunk_size),
+					      in_len,
+					      frame + sizeof(*header),
+					      frame_size - sizeof(*header),
+					      &payload_len);
+			header->codec = AES_GCM_CODEC_STORE;
+		}
+		header->magic = AES_GCM_FRAME_MAGIC;
+		header->original_size = in_len;
+		header->compressed_size = payload_len;
+		compressed_bytes += payload_len;
+
+		job = &jobs[i];
+		job->src = frame;
+		job->src_len = sizeof(*header) + payload_len;
+		job->dst = dst_buffer + (i * (frame_size + cfg->tag_size));
+		job->dst_len = frame_size + cfg->tag_size;
+		aes_gcm_derive_iv(cfg->iv, cfg->iv_length, i, job->iv);
+		job->iv_length = cfg->iv_length;
+		job->tag_size = cfg->tag_size;
+		aes_gcm_device_group_submit(group, &key, job);
+		(void)aes_gcm_device_group_progress(group);
+	}
+	aes_gcm_device_group_wait(group);
+	if (result != DOCA_SUCCESS)
+		goto destroy_key;
+	aes_gcm_device_group_report(group, aes_gcm_get_time_ns() - start_ns);
+
+	DOCA_LOG_INFO("Compressed %zu bytes to %zu bytes (%.1f%%), %zu bytes went through the devices",
+		      file_size,
+		      compressed_bytes,
+		      (100.0 * compressed_bytes) / file_size,
+		      compressed_bytes + (num_chunks * sizeof(*header)));
+
+	for (i = 0; i < num_chunks; i++) {
+		if (jobs[i].result != DOCA_SUCCESS) {
+			result = jobs[i].result;
+			DOCA_LOG_ERR("Chunk %zu failed: %s", i, doca_error_get_descr(result));
+			goto destroy_key;
+		}
+	}
+
+	/* Write the records to output file in order */
+	for (i = 0; i < num_chunks; i++) {
+		record_len = jobs[i].out_len;
+		if (fwrite(&record_len, sizeof(record_len), 1, out_file) != 1 ||
+		    fwrite(jobs[i].dst, sizeof(uint8_t), jobs[i].out_len, out_file) != jobs[i].out_len) {
+			DOCA_LOG_ERR("Failed to write to output file: %s", cfg->output_path);
+			result = DOCA_ERROR_IO_FAILED;
+			goto destroy_key;
+		}
+	}
+
+destroy_key:
+	tmp_result = aes_gcm_device_group_key_destroy(group, &key);
+	DOCA_ERROR_PROPAGATE(result, tmp_result);
+free_buffers:
+	free(jobs);
+destroy_group:
+	tmp_result = aes_gcm_device_group_destroy(group);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to destroy device group: %s", doca_error_get_descr(tmp_result));
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+	aes_gcm_mem_free(&dst_mem);
+	aes_gcm_mem_free(&frames_mem);
+
+	return result;
+}
+
+/*
+ * Decrypt every record of a file and decompress the frames
+ *
+ * @cfg [in]: Configuration parameters
+ * @file_data [in]: File data
+ * @file_size [in]: File size
+ * @out_file [in]: Output file
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t decrypt_decompress(struct aes_gcm_cfg *cfg, char *file_data, size_t file_size, FILE *out_file)
+{
+	struct aes_gcm_device_group *group = NULL;
+	struct aes_gcm_group_key key = {0};
+	struct compressed_record *records = NULL;
+	struct aes_gcm_job *job;
+	struct aes_gcm_mem dst_mem = {0};
+	char *dst_buffer;
+	size_t num_records = 0, offset, dst_offset, i;
+	uint32_t record_len;
+	uint64_t start_ns;
+	doca_error_t result, tmp_result;
+
+	/* Walk the records once to size the job array */
+	for (offset = 0; offset < file_size; offset += sizeof(record_len) + record_len) {
+		if (file_size - offset < sizeof(record_len))
+			break;
+		memcpy(&record_len, file_data + offset, sizeof(record_len));
+		if (record_len <= cfg->tag_size || record_len > file_size - offset - sizeof(record_len))
+			break;
+		num_records++;
+	}
+	if (offset != file_size || num_records == 0) {
+		DOCA_LOG_ERR("Input file is not a compressed and encrypted file, or it is truncated");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	result = aes_gcm_device_group_create(cfg, AES_GCM_MODE_DECRYPT, &group);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create device group: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	records = calloc(num_records, sizeof(*records));
+	if (records == NULL) {
+		result = DOCA_ERROR_NO_MEMORY;
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(result));
+		goto free_buffers;
+	}
+
+	result = aes_gcm_mem_alloc(cfg->hugepages, file_size, &dst_mem);
+	if (result != DOCA_SUCCESS)
+		goto free_buffers;
+	dst_buffer = dst_mem.addr;
+
+	result = aes_gcm_device_group_start(group, file_data, file_size, dst_buffer, file_size);
+	if (result != DOCA_SUCCESS)
+		goto free_buffers;
+
+	result = aes_gcm_device_group_key_create(group, cfg->raw_key, cfg->raw_key_type, &key);
+	if (result != DOCA_SUCCESS)
+		goto free_buffers;
+
+	DOCA_LOG_INFO("Decrypting and decompressing %zu records on %u devices", num_records, group->num_members);
+
+	start_ns = aes_gcm_get_time_ns();
+	offset = 0;
+	dst_offset = 0;
+	for (i = 0; i < num_records; i++) {
+		memcpy(&record_len, file_data + offset, sizeof(record_len));
+		if (record_len > group->max_buf_size) {
+			DOCA_LOG_ERR("Record size %u > max buffer size %lu", record_len, group->max_buf_size);
+			result = DOCA_ERROR_INVALID_VALUE;
+			break;
+		}
+
+		records[i].idx = i;
+		job = &records[i].job;
+		job->src = file_data + offset + sizeof(record_len);
+		job->src_len = record_len;
+		job->dst = dst_buffer + dst_offset;
+		job->dst_len = record_len - cfg->tag_size;
+		aes_gcm_derive_iv(cfg->iv, cfg->iv_length, i, job->iv);
+		job->iv_length = cfg->iv_length;
+		job->tag_size = cfg->tag_size;
+		job->done_cb = decompress_record;
+		job->user_data = &records[i];
+		aes_gcm_device_group_submit(group, &key, job);
+		(void)aes_gcm_device_group_progress(group);
+
+		offset += sizeof(record_len) + record_len;
+		dst_offset += job->dst_len;
+	}
+	aes_gcm_device_group_wait(group);
+	if (result != DOCA_SUCCESS)
+		goto destroy_key;
+	aes_gcm_device_group_report(group, aes_gcm_get_time_ns() - start_ns);
+
+	for (i = 0; i < num_records; i++) {
+		if (records[i].result != DOCA_SUCCESS) {
+			result = records[i].result;
+			DOCA_LOG_ERR("Record %zu failed: %s", i, doca_error_get_descr(result));
+			goto destroy_key;
+		}
+	}
+
+	/* Write the chunks to output file in order */
+	for (i = 0; i < num_records; i++) {
+		if (fwrite(records[i].plain, sizeof(uint8_t), records[i].plain_len, out_file) != records[i].plain_len) {
+			DOCA_LOG_ERR("Failed to write to output file: %s", cfg->output_path);
+			result = DOCA_ERROR_IO_FAILED;
+			goto destroy_key;
+		}
+	}
+
+destroy_key:
+	tmp_result = aes_gcm_device_group_key_destroy(group, &key);
+	DOCA_ERROR_PROPAGATE(result, tmp_result);
+free_buffers:
+	if (records != NULL) {
+		for (i = 0; i < num_records; i++)
+			free(records[i].plain);
+	}
+	free(records);
+	tmp_result = aes_gcm_device_group_destroy(group);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to destroy device group: %s", doca_error_get_descr(tmp_result));
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+	aes_gcm_mem_free(&dst_mem);
+
+	return result;
+}
+
+doca_error_t aes_gcm_compress_stream_file(struct aes_gcm_cfg *cfg,
+					  enum aes_gcm_mode mode,
+					  char *file_data,
+					  size_t file_size)
+{
+	const struct aes_gcm_codec *codec = NULL;
+	FILE *out_file;
+	doca_error_t result;
+
+	if (file_size == 0) {
+		DOCA_LOG_ERR("Input file is empty");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	if (cfg->aad_size != 0 || cfg->tag_index_path[0] != '\0') {
+		DOCA_LOG_ERR("Compression does not support additional authenticated data or detached tags");
+		return DOCA_ERROR_NOT_SUPPORTED;
+	}
+
+	if (mode == AES_GCM_MODE_ENCRYPT) {
+		codec = aes_gcm_codec_find(cfg->compress_codec);
+		if (codec == NULL) {
+			DOCA_LOG_ERR("Compression codec %s is unknown or was not built in", cfg->compress_codec);
+			return DOCA_ERROR_NOT_SUPPORTED;
+		}
+	}
+
+	out_file = fopen(cfg->output_path, "w");
+	if (out_file == NULL) {
+		DOCA_LOG_ERR("Unable to open output file: %s", cfg->output_path);
+		return DOCA_ERROR_NO_MEMORY;
+	}
+
+	if (mode == AES_GCM_MODE_ENCRYPT)
+		result = compress_encrypt(cfg, codec, file_data, file_size, out_file);
+	else
+		result = decrypt_decompress(cfg, file_data, file_size, out_file);
+
+	if (result == DOCA_SUCCESS)
+		DOCA_LOG_INFO("File was %s successfully and saved in: %s",
+			      (mode == AES_GCM_MODE_ENCRYPT) ? "compressed and encrypted" : "decrypted and decompressed",
+			      cfg->output_path);
+
+	fclose(out_file);
+	return result;
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_COMPRESS_H_
+#define AES_GCM_COMPRESS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+
+#define AES_GCM_FRAME_MAGIC 0x5a434741 /* "AGCZ" in little endian */
+
+/*
+ * Header of a compressed frame, encrypted together with the compressed payload that follows it
+ *
+ * On disk every chunk is a record: a uint32_t record length followed by the encrypted frame and its tag.
+ * All fields are in host byte order.
+ */
+struct aes_gcm_frame_header {
+	uint32_t magic;		  /* AES_GCM_FRAME_MAGIC */
+	uint32_t codec;		  /* enum aes_gcm_codec_id of the payload */
+	uint32_t original_size;	  /* Chunk size before compression */
+	uint32_t compressed_size; /* Payload size after compression */
+};
+
+/*
+ * Compress and encrypt, or decrypt and decompress, a file over a device group, and save the result in
+ * cfg->output_path
+ *
+ * Encryption compresses chunk i on the CPU with cfg->compress_codec while the previous chunks are on the devices, and
+ * encrypts the frame with the IV derived from cfg->iv and i. A chunk that does not shrink is stored as is.
+ * Decryption decompresses every chunk from its completion callback, while the next chunks are still on the devices.
+ *
+ * @cfg [in]: Configuration parameters
+ * @mode [in]: AES-GCM mode - encrypt/decrypt
+ * @file_data [in]: File data
+ * @file_size [in]: File size
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_compress_stream_file(struct aes_gcm_cfg *cfg,
+					  enum aes_gcm_mode mode,
+					  char *file_data,
+					  size_t file_size);
+
+#endif /* AES_GCM_COMPRESS_H_ */
@@ -20,9 +20,13 @@
 #include <doca_error.h>
 #include <doca_log.h>
 
-#include <utils.h>
-
 #include "aes_gcm_common.h"
+#include "aes_gcm_block.h"
+#include "aes_gcm_hugepage.h"
+#include "aes_gcm_metrics.h"
+#include "aes_gcm_relay.h"
+#include "aes_gcm_sparse.h"
+#include "aes_gcm_verify.h"
 
 DOCA_LOG_REGISTER(AES_GCM_DECRYPT::MAIN);
 
@@ -40,8 +44,7 @@ int main(int argc, char **argv)
 {
 	doca_error_t result;
 	struct aes_gcm_cfg aes_gcm_cfg;
-	char *file_data = NULL;
-	size_t file_size;
+	struct aes_gcm_mem file_mem = {0};
 	struct doca_log_backend *sdk_log;
 	int exit_status = EXIT_FAILURE;
 
@@ -80,12 +83,63 @@ int main(int argc, char **argv)
 		goto argp_cleanup;
 	}
 
-	result = read_file(aes_gcm_cfg.file_path, &file_data, &file_size);
+	result = aes_gcm_metrics_start(&aes_gcm_cfg);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to start the metrics exporter: %s", doca_error_get_descr(result));
+		goto argp_cleanup;
+	}
+
+	/* Block images are read and written a batch of sectors at a time, the file is never loaded as a whole */
+	if (aes_gcm_block_is_requested(&aes_gcm_cfg)) {
+		result = aes_gcm_block_run(&aes_gcm_cfg, AES_GCM_MODE_DECRYPT);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("aes_gcm_block_run() encountered an error: %s", doca_error_get_descr(result));
+			goto argp_cleanup;
+		}
+		exit_status = EXIT_SUCCESS;
+		goto argp_cleanup;
+	}
+
+	/* Sparse files are read and written one batch of data extent chunks at a time, holes are never touched */
+	if (aes_gcm_sparse_is_requested(&aes_gcm_cfg)) {
+		result = aes_gcm_sparse_run(&aes_gcm_cfg, AES_GCM_MODE_DECRYPT);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("aes_gcm_sparse_run() encountered an error: %s", doca_error_get_descr(result));
+			goto argp_cleanup;
+		}
+		exit_status = EXIT_SUCCESS;
+		goto argp_cleanup;
+	}
+
+	/* Verification reads the ciphertext a ring of chunks at a time and discards the plaintext */
+	if (aes_gcm_verify_is_requested(&aes_gcm_cfg)) {
+		result = aes_gcm_verify_run(&aes_gcm_cfg);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("aes_gcm_verify_run() encountered an error: %s", doca_error_get_descr(result));
+			goto argp_cleanup;
+		}
+		exit_status = EXIT_SUCCESS;
+		goto argp_cleanup;
+	}
+
+	/* The relay serves TCP connections until it is stopped, the input file is never read */
+	if (aes_gcm_relay_is_requested(&aes_gcm_cfg)) {
+		result = aes_gcm_relay_run(&aes_gcm_cfg, AES_GCM_MODE_DECRYPT);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("aes_gcm_relay_run() encountered an error: %s", doca_error_get_descr(result));
+			goto argp_cleanup;
+		}
+		exit_status = EXIT_SUCCESS;
+		goto argp_cleanup;
+	}
+
+	/* The input is registered with the devices as is, read it straight into the registered memory */
+	result = aes_gcm_mem_read_file(aes_gcm_cfg.file_path, aes_gcm_cfg.hugepages, &file_mem);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to read file: %s", doca_error_get_descr(result));
 		goto argp_cleanup;
 	}
-	result = aes_gcm_decrypt(&aes_gcm_cfg, file_data, file_size);
+	result = aes_gcm_decrypt(&aes_gcm_cfg, file_mem.addr, file_mem.size);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("aes_gcm_decrypt() encountered an error: %s", doca_error_get_descr(result));
 		goto data_file_cleanup;
@@ -94,9 +148,9 @@ int main(int argc, char **argv)
 	exit_status = EXIT_SUCCESS;
 
 data_file_cleanup:
-	if (file_data != NULL)
-		free(file_data);
+	aes_gcm_mem_free(&file_mem);
 argp_cleanup:
+	aes_gcm_metrics_stop();
 	doca_argp_destroy();
 sample_exit:
 	if (exit_status == EXIT_SUCCESS)
@@ -25,6 +25,7 @@
 
 #include "common.h"
 #include "aes_gcm_common.h"
+#include "aes_gcm_stream.h"
 
 DOCA_LOG_REGISTER(AES_GCM_DECRYPT);
 
@@ -54,6 +55,10 @@ doca_error_t aes_gcm_decrypt(struct aes_gcm_cfg *cfg, char *file_data, size_t fi
 	doca_error_t tmp_result = DOCA_SUCCESS;
 	uint64_t max_decrypt_buf_size = 0;
 
+	/* Chunked and multi-device runs spread the file over a device group */
+	if (aes_gcm_stream_is_requested(cfg))
+		return aes_gcm_stream_file(cfg, AES_GCM_MODE_DECRYPT, file_data, file_size);
+
 	out_file = fopen(cfg->output_path, "wr");
 	if (out_file == NULL) {
 		DOCA_LOG_ERR("Unable to open output file: %s", cfg->output_path);
@@ -0,0 +1,1229 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <doca_ctx.h>
+#include <doca_dev.h>
+#include <doca_log.h>
+#include <doca_error.h>
+#include <doca_pe.h>
+#include <doca_aes_gcm.h>
+
+#include "../common.h"
+#include "aes_gcm_calibrate.h"
+#include "aes_gcm_device_group.h"
+#include "aes_gcm_hugepage.h"
+#include "aes_gcm_metrics.h"
+#include "aes_gcm_startup.h"
+#include "aes_gcm_sw.h"
+
+DOCA_LOG_REGISTER(AES_GCM::DEVICE_GROUP);
+
+/* Bring-up work of a single member, run on its own thread */
+struct member_bringup {
+	struct aes_gcm_group_member *member; /* The member to bring up */
+	struct doca_devinfo *devinfo;	     /* Device of the member, used when opening */
+	const struct aes_gcm_emu_model *emu; /* Emulated device model, used instead of devinfo when set */
+	uint32_t emu_idx;		     /* Emulated device index */
+	bool pin_numa;			     /* Run the bring-up on the cores local to the device */
+	void *src;			     /* Source memory range address, used when starting */
+	size_t src_len;			     /* Source memory range length */
+	void *dst;			     /* Destination memory range address */
+	size_t dst_len;			     /* Destination memory range length */
+	doca_error_t result;		     /* Bring-up result */
+	pthread_t thread;		     /* Bring-up thread */
+	bool thread_started;		     /* Bring-up runs on its own thread */
+};
+
+/*
+ * Check if a device was requested by the configuration
+ *
+ * @cfg [in]: Configuration parameters
+ * @devinfo [in]: The device
+ * @return: true if the device is in cfg->pci_addresses or cfg->all_devices is set
+ */
+static bool device_is_requested(const struct aes_gcm_cfg *cfg, struct doca_devinfo *devinfo)
+{
+	uint8_t is_equal;
+	uint32_t i;
+
+	if (cfg->all_devices)
+		return true;
+
+	for (i = 0; i < cfg->num_pci_addresses; i++) {
+		if (doca_devinfo_is_equal_pci_addr(devinfo, cfg->pci_addresses[i], &is_equal) == DOCA_SUCCESS &&
+		    is_equal)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Pin a bring-up thread to the NUMA node of its member, so the memory the driver allocates for it is local
+ *
+ * @bringup [in]: The bring-up work
+ */
+static void pin_bringup_thread(const struct member_bringup *bringup)
+{
+	struct aes_gcm_numa_placement placement;
+
+	if (!bringup->pin_numa || bringup->member->numa_node == AES_GCM_NUMA_NODE_UNKNOWN)
+		return;
+	aes_gcm_numa_placement_init(bringup->member->numa_node, &placement);
+	(void)aes_gcm_numa_pin_thread(&placement);
+}
+
+/*
+ * Thread body - open the device of a member and allocate its AES-GCM resources
+ *
+ * @arg [in]: struct member_bringup *
+ * @return: NULL
+ */
+static void *member_open_thread(void *arg)
+{
+	struct member_bringup *bringup = (struct member_bringup *)arg;
+	struct aes_gcm_group_member *member = bringup->member;
+
+	pin_bringup_thread(bringup);
+	if (bringup->emu != NULL) {
+		bringup->result = allocate_aes_gcm_resources_emulated(bringup->emu,
+								      bringup->emu_idx,
+								      &member->resources);
+		return NULL;
+	}
+
+	/* Every task in flight holds a source, a destination and a detached tag buffer */
+	bringup->result = allocate_aes_gcm_resources_from_devinfo(bringup->devinfo,
+								  3 * member->max_inflight,
+								  &member->resources);
+	return NULL;
+}
+
+/*
+ * Thread body - register the memory ranges with a member and start its context
+ *
+ * @arg [in]: struct member_bringup *
+ * @return: NULL
+ */
+static void *member_start_thread(void *arg)
+{
+	struct member_bringup *bringup = (struct member_bringup *)arg;
+	struct aes_gcm_group_member *member = bringup->member;
+	uint64_t start_ns;
+
+	pin_bringup_thread(bringup);
+	bringup->result = aes_gcm_register_memory(&member->resources,
+						  bringup->src,
+						  bringup->src_len,
+						  bringup->dst,
+						  bringup->dst_len);
+	if (bringup->result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register memory with device %s: %s",
+			     member->pci_addr,
+			     doca_error_get_descr(bringup->result));
+		return NULL;
+	}
+
+	start_ns = aes_gcm_get_time_ns();
+	bringup->result = aes_gcm_start(&member->resources);
+	if (bringup->result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to start context of device %s: %s",
+			     member->pci_addr,
+			     doca_error_get_descr(bringup->result));
+		return NULL;
+	}
+	member->resources.startup_ns[AES_GCM_STARTUP_CTX_START] = aes_gcm_get_time_ns() - start_ns;
+
+	return NULL;
+}
+
+/*
+ * Run a bring-up step of every member in parallel, a member whose thread cannot be created runs inline
+ *
+ * @bringups [in]: Per member bring-up work
+ * @num_bringups [in]: Number of members
+ * @fn [in]: Bring-up step
+ */
+static void run_bringups(struct member_bringup *bringups, uint32_t num_bringups, void *(*fn)(void *))
+{
+	uint32_t i;
+
+	for (i = 0; i < num_bringups; i++) {
+		bringups[i].thread_started = (pthread_create(&bringups[i].thread, NULL, fn, &bringups[i]) == 0);
+		if (!bringups[i].thread_started)
+			fn(&bringups[i]);
+	}
+
+	for (i = 0; i < num_bringups; i++) {
+		if (bringups[i].thread_started)
+			pthread_join(bringups[i].thread, NULL);
+	}
+}
+
+/*
+ * Check if a member may run the job, regardless of its free task slots
+ *
+ * @group [in]: The device group
+ * @idx [in]: Member index
+ * @job [in]: The job
+ * @return: true if the member is healthy, did not fail the job already and can hold the job's buffers
+ */
+static bool member_is_eligible(const struct aes_gcm_device_group *group, uint32_t idx, const struct aes_gcm_job *job)
+{
+	const struct aes_gcm_group_member *member = &group->members[idx];
+
+	if (member->failed || (job->tried_members & (1U << idx)) != 0)
+		return false;
+
+	return job->src_len <= member->max_buf_size;
+}
+
+/*
+ * Check if any member may run the job, now or once its context restarted
+ *
+ * @group [in]: The device group
+ * @job [in]: The job
+ * @return: true if at least one member is eligible or recovering
+ */
+static bool group_has_eligible_member(const struct aes_gcm_device_group *group, const struct aes_gcm_job *job)
+{
+	const struct aes_gcm_group_member *member;
+	uint32_t i;
+
+	for (i = 0; i < group->num_members; i++) {
+		member = &group->members[i];
+		if (member_is_eligible(group, i, job))
+			return true;
+		if (member->recovering && (job->tried_members & (1U << i)) == 0 && job->src_len <= member->max_buf_size)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Check if a member has a free task slot for a job
+ *
+ * Bulk jobs leave group->priority_reserve slots free for the high priority jobs, but always get at least one slot.
+ *
+ * @group [in]: The device group
+ * @member [in]: The member
+ * @job [in]: The job
+ * @return: true if the job may be submitted to the member now
+ */
+static bool member_has_slot(const struct aes_gcm_device_group *group,
+			    const struct aes_gcm_group_member *member,
+			    const struct aes_gcm_job *job)
+{
+	uint32_t reserve = group->priority_reserve;
+
+	if (!aes_gcm_qd_can_submit(&member->qd, &member->resources))
+		return false;
+	if (job->priority == AES_GCM_PRIORITY_HIGH || reserve == 0)
+		return true;
+
+	if (reserve >= member->qd.depth)
+		reserve = member->qd.depth - 1;
+	return member->resources.num_remaining_tasks + reserve < member->qd.depth;
+}
+
+/*
+ * Pick the member with the lowest estimated completion time for the job
+ *
+ * Members with no latency samples yet are assumed to be as fast as the average measured member. A member takes a job
+ * only while its tasks in flight are under the depth chosen by its queue depth controller.
+ *
+ * @group [in]: The device group
+ * @job [in]: The job
+ * @return: index of the chosen member, or AES_GCM_MAX_DEVICES if no member has a free task slot
+ */
+static uint32_t pick_member(const struct aes_gcm_device_group *group, const struct aes_gcm_job *job)
+{
+	const struct aes_gcm_group_member *member;
+	double default_ns_per_byte = 0, ns_per_byte, score, best_score = 0;
+	uint32_t i, nb_measured = 0, best = AES_GCM_MAX_DEVICES;
+
+	for (i = 0; i < group->num_members; i++) {
+		if (group->members[i].ns_per_byte > 0) {
+			default_ns_per_byte += group->members[i].ns_per_byte;
+			nb_measured++;
+		}
+	}
+	default_ns_per_byte = (nb_measured > 0) ? (default_ns_per_byte / nb_measured) : 1.0;
+
+	for (i = 0; i < group->num_members; i++) {
+		member = &group->members[i];
+		if (!member_is_eligible(group, i, job) || !member_has_slot(group, member, job))
+			continue;
+
+		ns_per_byte = (member->ns_per_byte > 0) ? member->ns_per_byte : default_ns_per_byte;
+		score = (double)(member->outstanding_bytes + job->src_len) * ns_per_byte;
+		if (best == AES_GCM_MAX_DEVICES || score < best_score) {
+			best = i;
+			best_score = score;
+		}
+	}
+
+	return best;
+}
+
+/*
+ * Append a job to the pending queue of its priority class
+ *
+ * @group [in]: The device group
+ * @job [in]: The job
+ */
+static void enqueue_job(struct aes_gcm_device_group *group, struct aes_gcm_job *job)
+{
+	enum aes_gcm_job_priority priority = job->priority;
+
+	job->next = NULL;
+	if (group->pending_tail[priority] == NULL)
+		group->pending_head[priority] = job;
+	else
+		group->pending_tail[priority]->next = job;
+	group->pending_tail[priority] = job;
+	group->num_pending++;
+}
+
+/*
+ * Queue a newly submitted job, the bulk jobs of the fair share tenants wait in their tenant queue
+ *
+ * @group [in]: The device group
+ * @job [in]: The job
+ */
+static void queue_job(struct aes_gcm_device_group *group, struct aes_gcm_job *job)
+{
+	if (group->tenants.num_tenants == 0 || job->priority != AES_GCM_PRIORITY_BULK) {
+		enqueue_job(group, job);
+		return;
+	}
+	aes_gcm_tenant_enqueue(&group->tenants, job);
+	group->num_pending++;
+}
+
+/*
+ * Move the next fair share job to the bulk queue
+ *
+ * @group [in]: The device group
+ * @now_ns [in/out]: Current timestamp, taken on first use when 0
+ * @return: true if a job was admitted
+ */
+static bool admit_tenant_job(struct aes_gcm_device_group *group, uint64_t *now_ns)
+{
+	struct aes_gcm_job *job;
+
+	if (group->tenants.num_queued == 0)
+		return false;
+	if (*now_ns == 0)
+		*now_ns = aes_gcm_get_time_ns();
+
+	job = aes_gcm_tenant_next(&group->tenants, *now_ns);
+	if (job == NULL)
+		return false;
+	group->num_pending--;
+	enqueue_job(group, job);
+	return true;
+}
+
+/*
+ * Remove the first job of a pending queue
+ *
+ * @group [in]: The device group
+ * @priority [in]: Priority class of the queue
+ */
+static void dequeue_job(struct aes_gcm_device_group *group, enum aes_gcm_job_priority priority)
+{
+	group->pending_head[priority] = group->pending_head[priority]->next;
+	if (group->pending_head[priority] == NULL)
+		group->pending_tail[priority] = NULL;
+	group->num_pending--;
+}
+
+/*
+ * Run a job on the CPU with the raw group key, the caller completes it
+ *
+ * @job [in]: The job, job->group_key must be set
+ * @return: the job status
+ */
+static doca_error_t run_job_on_cpu(struct aes_gcm_job *job)
+{
+	size_t out_len = 0;
+
+	job->result = aes_gcm_sw_run_job(job->group_key->raw, job->group_key->raw_len, job, &out_len);
+	job->out_len = out_len;
+	job->complete_ns = aes_gcm_get_time_ns();
+	aes_gcm_metrics_cpu_job();
+	return job->result;
+}
+
+/*
+ * Complete a job no member can run anymore, on the CPU when the group falls back to it
+ *
+ * @group [in]: The device group
+ * @job [in]: The job, job->result holds its last error
+ */
+static void fail_job(struct aes_gcm_device_group *group, struct aes_gcm_job *job)
+{
+	doca_error_t error = job->result;
+
+	if (group->cpu_fallback && job->group_key->raw_len != 0) {
+		(void)run_job_on_cpu(job);
+		DOCA_LOG_DBG("Job ran on the CPU after device error \"%s\": %s",
+			     doca_error_get_descr(error),
+			     doca_error_get_descr(job->result));
+		group->cpu_jobs++;
+	}
+
+	if (job->done_cb != NULL)
+		job->done_cb(job);
+}
+
+/*
+ * Run a job under the CPU crossover of the group on the CPU and complete it
+ *
+ * @group [in]: The device group
+ * @job [in]: The job
+ */
+static void run_crossover_job(struct aes_gcm_device_group *group, struct aes_gcm_job *job)
+{
+	job->submit_ns = aes_gcm_get_time_ns();
+	(void)run_job_on_cpu(job);
+	group->crossover_jobs++;
+	if (job->done_cb != NULL)
+		job->done_cb(job);
+}
+
+/*
+ * Count a job failure against the member it ran on, and queue the job for a retry when possible
+ *
+ * Transient errors are retried on any member, the one that failed included. When the context of the member stopped,
+ * the member goes out of rotation until aes_gcm_device_group_progress() restarted it, and the job is not to blame.
+ * Any other error is retried once on another member; a job that already failed on another member is considered bad
+ * rather than the devices, it is not retried and the previous failure is not held against the other member. The last
+ * healthy member stays in rotation unless its context stopped running.
+ *
+ * @group [in]: The device group
+ * @job [in]: The failed job, job->member_idx and job->result must be set
+ */
+static void handle_job_error(struct aes_gcm_device_group *group, struct aes_gcm_job *job)
+{
+	struct aes_gcm_group_member *member = &group->members[job->member_idx];
+	uint32_t i, nb_healthy = 0;
+	bool engine_failed = !aes_gcm_is_running(&member->resources);
+	bool transient = !engine_failed && aes_gcm_error_is_transient(job->result);
+	bool bad_job = !engine_failed && !transient && (job->tried_members != 0);
+
+	member->failed_jobs++;
+	if (!engine_failed && !transient)
+		job->tried_members |= 1U << job->member_idx;
+
+	if (bad_job) {
+		for (i = 0; i < group->num_members; i++) {
+			if (i != job->member_idx && (job->tried_members & (1U << i)) != 0 &&
+			    group->members[i].consecutive_errors > 0)
+				group->members[i].consecutive_errors--;
+		}
+	} else if (!engine_failed) {
+		member->consecutive_errors++;
+	}
+
+	for (i = 0; i < group->num_members; i++) {
+		if (!group->members[i].failed)
+			nb_healthy++;
+	}
+
+	if (!member->failed && engine_failed) {
+		member->failed = true;
+		member->recovering = (member->num_recoveries < AES_GCM_GROUP_MAX_RECOVERIES);
+		DOCA_LOG_WARN("Context of device %s stopped, %s, last error: %s",
+			      member->pci_addr,
+			      member->recovering ? "restarting it" : "no restart left",
+			      doca_error_get_descr(job->result));
+	} else if (!member->failed &&
+		   member->consecutive_errors >= AES_GCM_GROUP_MAX_CONSECUTIVE_ERRORS && nb_healthy > 1) {
+		member->failed = true;
+		DOCA_LOG_WARN("Device %s was taken out of rotation after %u consecutive errors, last error: %s",
+			      member->pci_addr,
+			      member->consecutive_errors,
+			      doca_error_get_descr(job->result));
+	}
+
+	if (transient && job->num_retries < AES_GCM_GROUP_MAX_RETRIES) {
+		DOCA_LOG_DBG("Job failed on device %s with a transient error, retrying it", member->pci_addr);
+		job->num_retries++;
+		group->retried_jobs++;
+		enqueue_job(group, job);
+		return;
+	}
+
+	if (!transient && !bad_job && group_has_eligible_member(group, job)) {
+		if (engine_failed)
+			DOCA_LOG_DBG("Job was flushed from device %s, retrying it", member->pci_addr);
+		else
+			DOCA_LOG_WARN("Job failed on device %s, retrying on another device", member->pci_addr);
+		group->retried_jobs++;
+		enqueue_job(group, job);
+		return;
+	}
+
+	if (bad_job) {
+		if (job->done_cb != NULL)
+			job->done_cb(job);
+		return;
+	}
+	fail_job(group, job);
+}
+
+/*
+ * Restart the context of a member that stopped on an engine failure and put the member back in rotation
+ *
+ * @member [in]: The recovering member
+ */
+static void recover_member(struct aes_gcm_group_member *member)
+{
+	doca_error_t result;
+
+	result = aes_gcm_recover(&member->resources);
+	if (result == DOCA_ERROR_AGAIN)
+		return;
+
+	member->recovering = false;
+	member->num_recoveries++;
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Device %s stays out of rotation, its context failed to restart: %s",
+			     member->pci_addr,
+			     doca_error_get_descr(result));
+		return;
+	}
+
+	member->failed = false;
+	member->consecutive_errors = 0;
+	DOCA_LOG_INFO("Device %s is back in rotation after context restart %u of %d",
+		      member->pci_addr,
+		      member->num_recoveries,
+		      AES_GCM_GROUP_MAX_RECOVERIES);
+}
+
+/*
+ * Job completion hook of the group members
+ *
+ * @resources [in]: The member resources the job ran on
+ * @job [in]: The completed job
+ */
+static void group_job_hook(struct aes_gcm_resources *resources, struct aes_gcm_job *job)
+{
+	struct aes_gcm_device_group *group = (struct aes_gcm_device_group *)resources->owner;
+	struct aes_gcm_group_member *member = &group->members[job->member_idx];
+	double ns_per_byte;
+
+	member->inflight--;
+	member->outstanding_bytes -= job->src_len;
+	group->inflight--;
+
+	if (job->result != DOCA_SUCCESS) {
+		handle_job_error(group, job);
+		return;
+	}
+
+	if (group->first_completion_ns == 0)
+		group->first_completion_ns = job->complete_ns;
+
+	member->consecutive_errors = 0;
+	member->completed_jobs++;
+	member->completed_bytes += job->src_len;
+	aes_gcm_qd_on_completion(&member->qd, job->complete_ns - job->submit_ns, job->src_len, job->complete_ns);
+
+	ns_per_byte = (double)(job->complete_ns - job->submit_ns) / (double)(job->src_len != 0 ? job->src_len : 1);
+	if (member->ns_per_byte == 0)
+		member->ns_per_byte = ns_per_byte;
+	else
+		member->ns_per_byte += (ns_per_byte - member->ns_per_byte) / AES_GCM_GROUP_EWMA_WEIGHT;
+
+	if (job->done_cb != NULL)
+		job->done_cb(job);
+}
+
+/*
+ * Look a member up in the tuning profile
+ *
+ * The profile queue depth applies unless one was given explicitly. The chunk size is part of the output format, it is
+ * only reported when it differs from the configured one.
+ *
+ * @cfg [in]: Configuration parameters
+ * @profile [in]: Device tuning profile, NULL when it is not used
+ * @member [in]: The member, the identity fields must be set
+ * @return: the queue depth of the member
+ */
+static uint32_t tune_member(const struct aes_gcm_cfg *cfg,
+			    const struct aes_gcm_tuning_profile *profile,
+			    struct aes_gcm_group_member *member)
+{
+	const struct aes_gcm_tuning *tuning = NULL;
+
+	if (profile != NULL)
+		tuning = aes_gcm_tuning_lookup(profile, member->pci_addr, member->ibdev_name, member->fw_version);
+	if (tuning == NULL)
+		return cfg->queue_depth;
+
+	member->tuned = true;
+	member->cpu_crossover = tuning->cpu_crossover;
+	DOCA_LOG_INFO("Device %s tuning profile: queue depth %u%s, CPU under %u bytes, best chunk size %u%s",
+		      member->pci_addr,
+		      tuning->queue_depth,
+		      cfg->queue_depth_set ? " (overridden)" : "",
+		      tuning->cpu_crossover,
+		      tuning->chunk_size,
+		      (cfg->chunk_size == tuning->chunk_size) ? "" : " (not applied)");
+	return cfg->queue_depth_set ? cfg->queue_depth : tuning->queue_depth;
+}
+
+/*
+ * Set up a group member before it is brought up
+ *
+ * @cfg [in]: Configuration parameters
+ * @group [in]: The device group
+ * @member [in]: The member, pci_addr must be set
+ * @queue_depth [in]: Queue depth of the member
+ * @max_buf_size [in]: Max task buffer size of the device
+ * @max_num_tasks [in]: Max number of tasks the device supports
+ */
+static void init_member(const struct aes_gcm_cfg *cfg,
+			struct aes_gcm_device_group *group,
+			struct aes_gcm_group_member *member,
+			uint32_t queue_depth,
+			uint64_t max_buf_size,
+			uint32_t max_num_tasks)
+{
+	member->max_buf_size = max_buf_size;
+	/* The task pool is sized to the queue depth, bounded by what the device supports */
+	member->max_inflight = (queue_depth < max_num_tasks) ? queue_depth : max_num_tasks;
+	member->resources.mode = group->mode;
+	member->resources.num_tasks = member->max_inflight;
+	member->resources.submit_burst = cfg->submit_burst;
+	member->resources.burst_timeout_ns = (uint64_t)cfg->submit_burst_timeout_us * 1000;
+	aes_gcm_qd_init(&member->qd, member->max_inflight, (uint64_t)cfg->latency_target_us * 1000);
+	member->resources.keep_ctx_running = true;
+	member->resources.job_hook = group_job_hook;
+	member->resources.owner = group;
+}
+
+/*
+ * Place the group on the NUMA node most members are attached to and pin the calling thread to its cores
+ *
+ * @group [in]: The device group
+ */
+static void place_group(struct aes_gcm_device_group *group)
+{
+	uint32_t i, j, count, best_count = 0;
+	int node = AES_GCM_NUMA_NODE_UNKNOWN;
+
+	for (i = 0; i < group->num_members; i++) {
+		if (group->members[i].numa_node == AES_GCM_NUMA_NODE_UNKNOWN)
+			continue;
+		count = 0;
+		for (j = 0; j < group->num_members; j++) {
+			if (group->members[j].numa_node == group->members[i].numa_node)
+				count++;
+		}
+		if (count > best_count) {
+			node = group->members[i].numa_node;
+			best_count = count;
+		}
+	}
+
+	aes_gcm_numa_placement_init(node, &group->numa);
+	if (group->numa.node == AES_GCM_NUMA_NODE_UNKNOWN)
+		return;
+
+	group->numa.thread_pinned = (aes_gcm_numa_pin_thread(&group->numa) == DOCA_SUCCESS);
+	for (i = 0; i < group->num_members; i++) {
+		if (group->members[i].numa_node != AES_GCM_NUMA_NODE_UNKNOWN &&
+		    group->members[i].numa_node != group->numa.node)
+			DOCA_LOG_WARN("Device %s is on NUMA node %d, its DMA to the memory on node %d crosses sockets",
+				      group->members[i].pci_addr,
+				      group->members[i].numa_node,
+				      group->numa.node);
+	}
+}
+
+/*
+ * Dispatch queued jobs to members with free task slots
+ *
+ * The high priority queue is drained first. The fair share tenants hand their next bulk job over once the bulk queue
+ * is empty, so the tenant order is only decided when a slot is about to take the job. Jobs that no member can run
+ * anymore are completed with their last error, jobs whose deadline passed while queued are completed with
+ * DOCA_ERROR_TIME_OUT.
+ *
+ * @group [in]: The device group
+ */
+static void dispatch_pending(struct aes_gcm_device_group *group)
+{
+	struct aes_gcm_group_member *member;
+	struct aes_gcm_job *job;
+	uint32_t idx, priority;
+	uint64_t now_ns = 0;
+	doca_error_t result;
+
+	for (priority = AES_GCM_NUM_PRIORITIES; priority-- > 0;) {
+		while (group->pending_head[priority] != NULL ||
+		       (priority == AES_GCM_PRIORITY_BULK && admit_tenant_job(group, &now_ns))) {
+			job = group->pending_head[priority];
+
+			if (job->deadline_ns != 0) {
+				if (now_ns == 0)
+					now_ns = aes_gcm_get_time_ns();
+				if (now_ns >= job->deadline_ns) {
+					dequeue_job(group, priority);
+					job->result = DOCA_ERROR_TIME_OUT;
+					group->expired_jobs++;
+					if (job->done_cb != NULL)
+						job->done_cb(job);
+					continue;
+				}
+			}
+
+			if (!group_has_eligible_member(group, job)) {
+				dequeue_job(group, priority);
+				if (job->result == DOCA_ERROR_IN_PROGRESS)
+					job->result = DOCA_ERROR_NOT_FOUND;
+				DOCA_LOG_ERR("No device is left to run the job: %s", doca_error_get_descr(job->result));
+				fail_job(group, job);
+				continue;
+			}
+
+			/* A lower class never overtakes a job that is waiting for a slot */
+			idx = pick_member(group, job);
+			if (idx == AES_GCM_MAX_DEVICES) {
+				/* No slot frees up before the tasks already submitted reach the devices */
+				aes_gcm_device_group_flush(group);
+				return;
+			}
+
+			dequeue_job(group, priority);
+			member = &group->members[idx];
+			job->member_idx = idx;
+			job->key = job->group_key->keys[idx];
+
+			result = aes_gcm_job_submit(&member->resources, job);
+			if (result != DOCA_SUCCESS) {
+				job->result = result;
+				handle_job_error(group, job);
+				continue;
+			}
+
+			member->inflight++;
+			member->outstanding_bytes += job->src_len;
+			group->inflight++;
+			group->dispatched_jobs[priority]++;
+		}
+	}
+}
+
+doca_error_t aes_gcm_device_group_create(const struct aes_gcm_cfg *cfg,
+					 enum aes_gcm_mode mode,
+					 struct aes_gcm_device_group **group)
+{
+	struct member_bringup bringups[AES_GCM_MAX_DEVICES] = {0};
+	struct aes_gcm_caps_cache *cache;
+	struct aes_gcm_tuning_profile *profile;
+	struct aes_gcm_device_group *new_group;
+	struct aes_gcm_group_member *member;
+	struct aes_gcm_dev_caps caps;
+	struct doca_devinfo **dev_list = NULL;
+	union doca_data ctx_user_data = {0};
+	uint32_t nb_devs = 0, num_candidates = 0, i;
+	uint64_t start_ns;
+	doca_error_t result;
+
+	new_group = calloc(1, sizeof(*new_group));
+	cache = calloc(1, sizeof(*cache));
+	profile = calloc(1, sizeof(*profile));
+	if (new_group == NULL || cache == NULL || profile == NULL) {
+		DOCA_LOG_ERR("Failed to allocate device group: %s", doca_error_get_descr(DOCA_ERROR_NO_MEMORY));
+		free(profile);
+		free(cache);
+		free(new_group);
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	new_group->mode = mode;
+	new_group->busy_poll = cfg->low_latency;
+	new_group->cpu_fallback = cfg->cpu_fallback;
+	new_group->priority_reserve = cfg->priority_reserve;
+	aes_gcm_tenant_sched_init(&new_group->tenants, cfg->tenants, cfg->num_tenants, aes_gcm_get_time_ns());
+	new_group->max_buf_size = UINT64_MAX;
+	new_group->cpu_crossover = UINT32_MAX;
+	new_group->create_begin_ns = aes_gcm_get_time_ns();
+	aes_gcm_numa_placement_init(AES_GCM_NUMA_NODE_UNKNOWN, &new_group->numa);
+
+	/* A cache that cannot be read only costs a probe */
+	(void)aes_gcm_caps_cache_load(cfg->caps_cache_path, cache);
+	/* The calibration sweep sets the queue depths itself, an empty profile leaves them alone */
+	if (!cfg->calibrate)
+		(void)aes_gcm_tuning_profile_load(cfg->tuning_profile_path, profile);
+
+	/* Emulated devices replace the DOCA devices altogether */
+	if (cfg->emu.num_devices == 0) {
+		result = doca_devinfo_create_list(&dev_list, &nb_devs);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to load doca devices list: %s", doca_error_get_descr(result));
+			goto free_group;
+		}
+	}
+
+	/* Walk the device list once, probing only the devices the cache does not know */
+	for (i = 0; i < nb_devs && num_candidates < AES_GCM_MAX_DEVICES; i++) {
+		if (!device_is_requested(cfg, dev_list[i]))
+			continue;
+
+		if (aes_gcm_dev_caps_get(cache, dev_list[i], &caps) != DOCA_SUCCESS)
+			continue;
+		if (!((mode == AES_GCM_MODE_ENCRYPT) ? caps.encrypt_supported : caps.decrypt_supported)) {
+			if (!cfg->all_devices)
+				DOCA_LOG_WARN("Skipping device %s, AES-GCM %s is not supported",
+					      caps.pci_addr,
+					      (mode == AES_GCM_MODE_ENCRYPT) ? "encrypt" : "decrypt");
+			continue;
+		}
+
+		member = &new_group->members[num_candidates];
+		strcpy(member->pci_addr, caps.pci_addr);
+		strcpy(member->ibdev_name, caps.ibdev_name);
+		strcpy(member->fw_version, caps.fw_version);
+		init_member(cfg,
+			    new_group,
+			    member,
+			    tune_member(cfg, profile, member),
+			    (mode == AES_GCM_MODE_ENCRYPT) ? caps.encrypt_max_buf_size : caps.decrypt_max_buf_size,
+			    caps.max_num_tasks);
+		member->numa_node = aes_gcm_numa_device_node(caps.pci_addr);
+		bringups[num_candidates].member = member;
+		bringups[num_candidates].devinfo = dev_list[i];
+		bringups[num_candidates].pin_numa = !cfg->no_numa;
+		num_candidates++;
+	}
+	for (i = 0; i < cfg->emu.num_devices; i++) {
+		member = &new_group->members[num_candidates];
+		snprintf(member->pci_addr, sizeof(member->pci_addr), "emu:%u", i);
+		strcpy(member->ibdev_name, "emu");
+		strcpy(member->fw_version, "emulated");
+		init_member(cfg,
+			    new_group,
+			    member,
+			    tune_member(cfg, profile, member),
+			    cfg->emu.max_buf_size,
+			    cfg->emu.max_tasks);
+		member->numa_node = AES_GCM_NUMA_NODE_UNKNOWN;
+		bringups[num_candidates].member = member;
+		bringups[num_candidates].emu = &cfg->emu;
+		bringups[num_candidates].emu_idx = i;
+		num_candidates++;
+	}
+	if (cfg->emu.num_devices == 0 && !cfg->all_devices && num_candidates < cfg->num_pci_addresses)
+		DOCA_LOG_WARN("Only %u of the %u requested devices support AES-GCM %s",
+			      num_candidates,
+			      cfg->num_pci_addresses,
+			      (mode == AES_GCM_MODE_ENCRYPT) ? "encrypt" : "decrypt");
+	new_group->caps_cache_hits = cache->num_hits;
+	new_group->probe_ns = aes_gcm_get_time_ns() - new_group->create_begin_ns;
+
+	start_ns = aes_gcm_get_time_ns();
+	run_bringups(bringups, num_candidates, member_open_thread);
+	new_group->open_ns = aes_gcm_get_time_ns() - start_ns;
+
+	if (dev_list != NULL)
+		doca_devinfo_destroy_list(dev_list);
+	(void)aes_gcm_caps_cache_save(cfg->caps_cache_path, cache);
+
+	/* Compact the members that came up, the context user data must follow the moved resources */
+	for (i = 0; i < num_candidates; i++) {
+		if (bringups[i].result != DOCA_SUCCESS) {
+			DOCA_LOG_WARN("Skipping device %s: %s",
+				      new_group->members[i].pci_addr,
+				      doca_error_get_descr(bringups[i].result));
+			continue;
+		}
+
+		member = &new_group->members[new_group->num_members];
+		if (member != bringups[i].member) {
+			*member = *bringups[i].member;
+			ctx_user_data.ptr = &member->resources;
+			if (member->resources.state != NULL)
+				doca_ctx_set_user_data(member->resources.state->ctx, ctx_user_data);
+		}
+		if (member->max_buf_size < new_group->max_buf_size)
+			new_group->max_buf_size = member->max_buf_size;
+		/* Small jobs go to the CPU only when it was found faster than every member */
+		if (!member->tuned)
+			new_group->cpu_crossover = 0;
+		else if (member->cpu_crossover < new_group->cpu_crossover)
+			new_group->cpu_crossover = member->cpu_crossover;
+		aes_gcm_metrics_gauge_add(AES_GCM_METRICS_TASK_SLOTS, member->max_inflight);
+		new_group->num_members++;
+		DOCA_LOG_INFO("Device %s joined the device group", member->pci_addr);
+	}
+
+	if (new_group->num_members == 0) {
+		DOCA_LOG_ERR("Failed to open any device for the device group");
+		result = DOCA_ERROR_NOT_FOUND;
+		goto free_group;
+	}
+
+	if (!cfg->no_numa)
+		place_group(new_group);
+
+	free(profile);
+	free(cache);
+	*group = new_group;
+	return DOCA_SUCCESS;
+
+free_group:
+	free(profile);
+	free(cache);
+	free(new_group);
+	return result;
+}
+
+doca_error_t aes_gcm_device_group_destroy(struct aes_gcm_device_group *group)
+{
+	doca_error_t result = DOCA_SUCCESS, tmp_result;
+	uint32_t i;
+
+	aes_gcm_metrics_gauge_add(AES_GCM_METRICS_REGISTERED_BYTES, -(int64_t)group->registered_bytes);
+	aes_gcm_metrics_gauge_add(AES_GCM_METRICS_HUGEPAGE_BYTES, -(int64_t)group->hugepage_bytes);
+	for (i = 0; i < group->num_members; i++) {
+		aes_gcm_metrics_gauge_add(AES_GCM_METRICS_TASK_SLOTS, -(int64_t)group->members[i].max_inflight);
+		tmp_result = destroy_aes_gcm_resources(&group->members[i].resources);
+		if (tmp_result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to destroy AES-GCM resources of device %s: %s",
+				     group->members[i].pci_addr,
+				     doca_error_get_descr(tmp_result));
+			DOCA_ERROR_PROPAGATE(result, tmp_result);
+		}
+	}
+
+	free(group);
+	return result;
+}
+
+doca_error_t aes_gcm_device_group_start(struct aes_gcm_device_group *group,
+					void *src,
+					size_t src_len,
+					void *dst,
+					size_t dst_len)
+{
+	struct member_bringup bringups[AES_GCM_MAX_DEVICES] = {0};
+	bool in_place = (dst == src);
+	size_t hugepage_bytes, registered_bytes;
+	uint64_t start_ns;
+	uint32_t i;
+
+	if (group->numa.node != AES_GCM_NUMA_NODE_UNKNOWN) {
+		if (aes_gcm_numa_bind(&group->numa, src, src_len) == DOCA_SUCCESS)
+			group->numa.bound_bytes += src_len;
+		if (!in_place && aes_gcm_numa_bind(&group->numa, dst, dst_len) == DOCA_SUCCESS)
+			group->numa.bound_bytes += dst_len;
+	}
+
+	for (i = 0; i < group->num_members; i++) {
+		bringups[i].member = &group->members[i];
+		bringups[i].pin_numa = (group->numa.node != AES_GCM_NUMA_NODE_UNKNOWN);
+		bringups[i].src = src;
+		bringups[i].src_len = src_len;
+		bringups[i].dst = dst;
+		bringups[i].dst_len = dst_len;
+	}
+
+	start_ns = aes_gcm_get_time_ns();
+	run_bringups(bringups, group->num_members, member_start_thread);
+	group->start_ns = aes_gcm_get_time_ns() - start_ns;
+
+	/* An in place range is registered twice but only takes its memory once */
+	hugepage_bytes = aes_gcm_hugepage_backed_bytes(src, src_len);
+	registered_bytes = src_len;
+	if (!in_place) {
+		hugepage_bytes += aes_gcm_hugepage_backed_bytes(dst, dst_len);
+		registered_bytes += dst_len;
+	}
+	group->registered_bytes += registered_bytes;
+	group->hugepage_bytes += hugepage_bytes;
+	aes_gcm_metrics_gauge_add(AES_GCM_METRICS_REGISTERED_BYTES, registered_bytes);
+	aes_gcm_metrics_gauge_add(AES_GCM_METRICS_HUGEPAGE_BYTES, hugepage_bytes);
+	if (group->numa.node != AES_GCM_NUMA_NODE_UNKNOWN) {
+		group->numa.src_node = aes_gcm_numa_memory_node(src);
+		group->numa.dst_node = aes_gcm_numa_memory_node(dst);
+	}
+
+	for (i = 0; i < group->num_members; i++) {
+		if (bringups[i].result != DOCA_SUCCESS)
+			return bringups[i].result;
+	}
+
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_device_group_register_tags(struct aes_gcm_device_group *group, void *tags, size_t tags_len)
+{
+	size_t hugepage_bytes;
+	doca_error_t result;
+	uint32_t i;
+
+	if (group->numa.node != AES_GCM_NUMA_NODE_UNKNOWN &&
+	    aes_gcm_numa_bind(&group->numa, tags, tags_len) == DOCA_SUCCESS)
+		group->numa.bound_bytes += tags_len;
+	hugepage_bytes = aes_gcm_hugepage_backed_bytes(tags, tags_len);
+	group->registered_bytes += tags_len;
+	group->hugepage_bytes += hugepage_bytes;
+	aes_gcm_metrics_gauge_add(AES_GCM_METRICS_REGISTERED_BYTES, tags_len);
+	aes_gcm_metrics_gauge_add(AES_GCM_METRICS_HUGEPAGE_BYTES, hugepage_bytes);
+
+	for (i = 0; i < group->num_members; i++) {
+		result = aes_gcm_register_tag_memory(&group->members[i].resources, tags, tags_len);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to register tags memory on device %s: %s",
+				     group->members[i].pci_addr,
+				     doca_error_get_descr(result));
+			return result;
+		}
+	}
+
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_device_group_key_create(struct aes_gcm_device_group *group,
+					     const uint8_t *raw_key,
+					     enum doca_aes_gcm_key_type key_type,
+					     struct aes_gcm_group_key *key)
+{
+	doca_error_t result;
+	uint32_t i;
+
+	memset(key, 0, sizeof(*key));
+	key->raw_len = (key_type == DOCA_AES_GCM_KEY_128) ? 16 : 32;
+	memcpy(key->raw, raw_key, key->raw_len);
+	for (i = 0; i < group->num_members; i++) {
+		result = aes_gcm_key_create(&group->members[i].resources, raw_key, key_type, &key->keys[i]);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Unable to create DOCA AES-GCM key on device %s: %s",
+				     group->members[i].pci_addr,
+				     doca_error_get_descr(result));
+			(void)aes_gcm_device_group_key_destroy(group, key);
+			return result;
+		}
+	}
+
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_device_group_key_destroy(struct aes_gcm_device_group *group, struct aes_gcm_group_key *key)
+{
+	doca_error_t result = DOCA_SUCCESS, tmp_result;
+	uint32_t i;
+
+	for (i = 0; i < group->num_members; i++) {
+		if (key->keys[i] == NULL)
+			continue;
+		tmp_result = aes_gcm_key_destroy(&group->members[i].resources, key->keys[i]);
+		if (tmp_result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to destroy DOCA AES-GCM key: %s", doca_error_get_descr(tmp_result));
+			DOCA_ERROR_PROPAGATE(result, tmp_result);
+		}
+		key->keys[i] = NULL;
+	}
+	memset(key->raw, 0, sizeof(key->raw));
+	key->raw_len = 0;
+
+	return result;
+}
+
+void aes_gcm_device_group_submit(struct aes_gcm_device_group *group,
+				 struct aes_gcm_group_key *key,
+				 struct aes_gcm_job *job)
+{
+	job->mode = group->mode;
+	job->group_key = key;
+	job->tried_members = 0;
+	job->num_retries = 0;
+	job->result = DOCA_ERROR_IN_PROGRESS;
+
+	if (job->src_len < group->cpu_crossover && key->raw_len != 0) {
+		run_crossover_job(group, job);
+		return;
+	}
+
+	queue_job(group, job);
+	dispatch_pending(group);
+}
+
+void aes_gcm_device_group_submit_burst(struct aes_gcm_device_group *group,
+				       struct aes_gcm_group_key *key,
+				       struct aes_gcm_job *jobs,
+				       size_t nb_jobs)
+{
+	size_t i;
+
+	for (i = 0; i < nb_jobs; i++) {
+		jobs[i].mode = group->mode;
+		jobs[i].group_key = key;
+		jobs[i].tried_members = 0;
+		jobs[i].num_retries = 0;
+		jobs[i].result = DOCA_ERROR_IN_PROGRESS;
+		if (jobs[i].src_len < group->cpu_crossover && key->raw_len != 0)
+			run_crossover_job(group, &jobs[i]);
+		else
+			queue_job(group, &jobs[i]);
+	}
+
+	dispatch_pending(group);
+	aes_gcm_device_group_flush(group);
+}
+
+void aes_gcm_device_group_flush(struct aes_gcm_device_group *group)
+{
+	uint32_t i;
+
+	for (i = 0; i < group->num_members; i++)
+		aes_gcm_flush(&group->members[i].resources);
+}
+
+uint32_t aes_gcm_device_group_progress(struct aes_gcm_device_group *group)
+{
+	uint32_t i, nb_completions = 0;
+
+	for (i = 0; i < group->num_members; i++) {
+		if (group->members[i].recovering)
+			recover_member(&group->members[i]);
+		else if (group->members[i].inflight > 0)
+			nb_completions += aes_gcm_progress(&group->members[i].resources);
+	}
+
+	dispatch_pending(group);
+	return nb_completions;
+}
+
+void aes_gcm_device_group_wait(struct aes_gcm_device_group *group)
+{
+	struct timespec ts = {
+		.tv_sec = 0,
+		.tv_nsec = SLEEP_IN_NANOS,
+	};
+
+	/* Nothing else is coming, partial bursts do not need to wait for their timeout */
+	aes_gcm_device_group_flush(group);
+	while (group->inflight > 0 || group->num_pending != 0) {
+		if (aes_gcm_device_group_progress(group) == 0 && !group->busy_poll)
+			nanosleep(&ts, &ts);
+	}
+}
+
+void aes_gcm_device_group_report(const struct aes_gcm_device_group *group, uint64_t elapsed_ns)
+{
+	const struct aes_gcm_group_member *member;
+	uint64_t total_bytes = 0;
+	uint32_t i, phase;
+
+	DOCA_LOG_INFO("Startup: probe %.3f ms (%u of %u devices from cache), open %.3f ms, start %.3f ms",
+		      (double)group->probe_ns / 1e6,
+		      group->caps_cache_hits,
+		      group->num_members,
+		      (double)group->open_ns / 1e6,
+		      (double)group->start_ns / 1e6);
+	for (i = 0; i < group->num_members; i++) {
+		for (phase = 0; phase < AES_GCM_STARTUP_NUM_PHASES; phase++)
+			DOCA_LOG_INFO("Startup: device %s %s %.3f ms",
+				      group->members[i].pci_addr,
+				      aes_gcm_startup_phase_name(phase),
+				      (double)group->members[i].resources.startup_ns[phase] / 1e6);
+	}
+	DOCA_LOG_INFO("Placement: %zu of %zu registered bytes are backed by huge pages",
+		      group->hugepage_bytes,
+		      group->registered_bytes);
+	if (group->numa.node == AES_GCM_NUMA_NODE_UNKNOWN) {
+		DOCA_LOG_INFO("Placement: no NUMA affinity, memory and threads were left in place");
+	} else {
+		DOCA_LOG_INFO("Placement: NUMA node %d, cores %s%s, %zu bytes bound, src on node %d, dst on node %d",
+			      group->numa.node,
+			      group->numa.cpu_list,
+			      group->numa.thread_pinned ? "" : " (progress thread not pinned)",
+			      group->numa.bound_bytes,
+			      group->numa.src_node,
+			      group->numa.dst_node);
+		for (i = 0; i < group->num_members; i++)
+			DOCA_LOG_INFO("Placement: device %s on NUMA node %d%s",
+				      group->members[i].pci_addr,
+				      group->members[i].numa_node,
+				      (group->members[i].numa_node == group->numa.node) ? "" : " (remote)");
+	}
+	if (group->first_completion_ns != 0)
+		DOCA_LOG_INFO("Time to first completed task: %.3f ms",
+			      (double)(group->first_completion_ns - group->create_begin_ns) / 1e6);
+
+	for (i = 0; i < group->num_members; i++) {
+		member = &group->members[i];
+		total_bytes += member->completed_bytes;
+		DOCA_LOG_INFO("Device %s: %lu jobs, %lu bytes, %.3f ns/byte, %lu errors, %u context restarts%s",
+			      member->pci_addr,
+			      member->completed_jobs,
+			      member->completed_bytes,
+			      member->ns_per_byte,
+			      member->failed_jobs,
+			      member->num_recoveries,
+			      member->failed ? " (out of rotation)" : "");
+		DOCA_LOG_INFO("Device %s: task pool of %u, %u tasks allocated, %lu submissions reused a task",
+			      member->pci_addr,
+			      member->resources.num_tasks,
+			      member->resources.num_allocated_tasks,
+			      member->resources.num_task_reuses);
+		if (member->resources.submit_burst > 1)
+			DOCA_LOG_INFO("Device %s: %lu doorbells for %lu tasks, bursts of up to %u",
+				      member->pci_addr,
+				      member->resources.num_doorbells,
+				      member->completed_jobs + member->failed_jobs,
+				      member->resources.submit_burst);
+		if (member->qd.target_latency_ns != 0)
+			DOCA_LOG_INFO("Device %s: queue depth %u (peak %u of %u), %u up, %u down, latency %.1f us",
+				      member->pci_addr,
+				      member->qd.depth,
+				      member->qd.peak_depth,
+				      member->qd.max_depth,
+				      member->qd.num_increases,
+				      member->qd.num_decreases,
+				      member->qd.latency_ewma_ns / 1e3);
+	}
+
+	if (group->retried_jobs != 0 || group->cpu_jobs != 0)
+		DOCA_LOG_INFO("Errors: %lu job retries, %lu jobs ran on the CPU", group->retried_jobs, group->cpu_jobs);
+	if (group->cpu_crossover != 0)
+		DOCA_LOG_INFO("Tuning: %lu jobs under %u bytes ran on the CPU",
+			      group->crossover_jobs,
+			      group->cpu_crossover);
+	if (group->priority_reserve != 0 || group->dispatched_jobs[AES_GCM_PRIORITY_HIGH] != 0 ||
+	    group->expired_jobs != 0)
+		DOCA_LOG_INFO("Priorities: %lu high and %lu bulk jobs dispatched, %u slots per device reserved, %lu "
+			      "jobs expired in the queue",
+			      group->dispatched_jobs[AES_GCM_PRIORITY_HIGH],
+			      group->dispatched_jobs[AES_GCM_PRIORITY_BULK],
+			      group->priority_reserve,
+			      group->expired_jobs);
+	aes_gcm_tenant_report(&group->tenants);
+
+	if (elapsed_ns > 0)
+		DOCA_LOG_INFO("Device group processed %lu bytes in %.3f ms (%.2f MB/s)",
+			      total_bytes,
+			      (double)elapsed_ns / 1e6,
+			      ((double)total_bytes * 1e3) / (double)elapsed_ns);
+}
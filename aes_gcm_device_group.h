@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_DEVICE_GROUP_H_
+#define AES_GCM_DEVICE_GROUP_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <doca_dev.h>
+#include <doca_aes_gcm.h>
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+#include "aes_gcm_numa.h"
+#include "aes_gcm_queue_depth.h"
+#include "aes_gcm_startup.h"
+#include "aes_gcm_tenant.h"
+
+#define AES_GCM_GROUP_MAX_CONSECUTIVE_ERRORS 3 /* Task errors in a row that take a device out of rotation */
+#define AES_GCM_GROUP_EWMA_WEIGHT 8	       /* Weight of the history in the latency moving average */
+#define AES_GCM_GROUP_MAX_RETRIES 3	       /* Retries of a job after transient errors */
+#define AES_GCM_GROUP_MAX_RECOVERIES 3	       /* Context restarts of a member after engine failures */
+
+/* Per device state of a device group */
+struct aes_gcm_group_member {
+	struct aes_gcm_resources resources;	       /* AES-GCM resources of the device */
+	char pci_addr[DOCA_DEVINFO_PCI_ADDR_SIZE];     /* Device PCI address */
+	char ibdev_name[DOCA_DEVINFO_IBDEV_NAME_SIZE]; /* Device IB name */
+	char fw_version[AES_GCM_FW_VERSION_SIZE];      /* Device firmware version */
+	bool tuned;				       /* Device was found in the tuning profile */
+	uint32_t cpu_crossover;			       /* Source size under which the profile found the CPU faster */
+	uint64_t max_buf_size;			       /* Max task buffer size of the device */
+	uint32_t max_inflight;			       /* Max number of tasks in flight */
+	uint32_t inflight;			       /* Number of tasks in flight */
+	uint64_t outstanding_bytes;		       /* Source bytes of the tasks in flight */
+	double ns_per_byte;			       /* Moving average of the observed latency per source byte */
+	uint32_t consecutive_errors;		       /* Task errors since the last successful task */
+	bool failed;				       /* Device was taken out of rotation */
+	bool recovering;			       /* Context stopped on an engine failure and is being restarted */
+	uint32_t num_recoveries;		       /* Context restarts after engine failures */
+	uint64_t completed_jobs;		       /* Number of jobs completed successfully */
+	uint64_t completed_bytes;		       /* Source bytes of the jobs completed successfully */
+	uint64_t failed_jobs;			       /* Number of jobs that failed on the device */
+	struct aes_gcm_qd_controller qd;	       /* Tasks in flight limit */
+	int numa_node;				       /* NUMA node the device is attached to */
+};
+
+/* AES-GCM key created on every member of a device group */
+struct aes_gcm_group_key {
+	struct doca_aes_gcm_key *keys[AES_GCM_MAX_DEVICES]; /* Key object per member */
+	uint8_t raw[MAX_AES_GCM_KEY_SIZE];		    /* Raw key, for the jobs that fall back to the CPU */
+	uint32_t raw_len;				    /* Raw key length */
+};
+
+/* Group of AES-GCM devices sharing the jobs of a single flow */
+struct aes_gcm_device_group {
+	enum aes_gcm_mode mode;					  /* AES-GCM mode - encrypt/decrypt */
+	struct aes_gcm_group_member members[AES_GCM_MAX_DEVICES]; /* Group members */
+	uint32_t num_members;					  /* Number of group members */
+	uint64_t max_buf_size;					  /* Smallest max buffer size of the members */
+	uint32_t inflight;					  /* Number of tasks in flight on all members */
+	struct aes_gcm_job *pending_head[AES_GCM_NUM_PRIORITIES]; /* First queued job of every class */
+	struct aes_gcm_job *pending_tail[AES_GCM_NUM_PRIORITIES]; /* Last queued job of every class */
+	uint32_t num_pending;					  /* Queued jobs, tenant queues included */
+	uint32_t priority_reserve;				  /* Task slots per member bulk jobs leave free */
+	uint64_t create_begin_ns;				  /* Timestamp of the group creation start */
+	uint64_t probe_ns;					  /* Device list walk and capability probe time */
+	uint64_t open_ns;					  /* Wall time of the parallel member allocation */
+	uint64_t start_ns;					  /* Wall time of the parallel member start */
+	uint64_t first_completion_ns;				  /* Timestamp of the first job completion */
+	uint32_t caps_cache_hits;				  /* Members whose capabilities came from the cache */
+	struct aes_gcm_numa_placement numa;			  /* Placement of the memory and progress thread */
+	size_t registered_bytes;				  /* Memory registered with the members */
+	size_t hugepage_bytes;					  /* Registered memory backed by huge pages */
+	bool busy_poll;						  /* Never sleep while waiting for completions */
+	bool cpu_fallback;					  /* Run the jobs no member could complete on the CPU */
+	uint64_t retried_jobs;					  /* Job retries after errors */
+	uint64_t cpu_jobs;					  /* Jobs that fell back to the CPU */
+	uint32_t cpu_crossover;					  /* Smaller jobs run on the CPU, 0 is off */
+	uint64_t crossover_jobs;				  /* Jobs run on the CPU under cpu_crossover */
+	uint64_t dispatched_jobs[AES_GCM_NUM_PRIORITIES];	  /* Jobs handed to the members, per class */
+	uint64_t expired_jobs;					  /* Jobs rejected in the queue past their deadline */
+	struct aes_gcm_tenant_sched tenants;			  /* Fair share of the bulk jobs across tenants */
+};
+
+/*
+ * Open a device group
+ *
+ * The group holds every AES-GCM capable device when cfg->all_devices is set, and the devices listed in
+ * cfg->pci_addresses otherwise. Devices that fail to open are skipped as long as at least one device opened.
+ * The device list is walked once, capabilities come from the cache in cfg->caps_cache_path when it knows the device
+ * and firmware, and the members are brought up in parallel. Members found in the tuning profile of
+ * cfg->tuning_profile_path get its queue depth, unless cfg->queue_depth_set, and the group gets its CPU crossover when
+ * every member has one, see aes_gcm_calibrate.h. When cfg->emu.num_devices is set, the group holds that many
+ * emulated devices instead, see aes_gcm_emu.h.
+ * Unless cfg->no_numa is set, the calling thread, which is expected to progress the group, is pinned to the cores of
+ * the NUMA node most members are attached to.
+ *
+ * @cfg [in]: Configuration parameters
+ * @mode [in]: AES-GCM mode - encrypt/decrypt
+ * @group [out]: The created device group
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_device_group_create(const struct aes_gcm_cfg *cfg,
+					 enum aes_gcm_mode mode,
+					 struct aes_gcm_device_group **group);
+
+/*
+ * Destroy a device group and all of its members
+ *
+ * @group [in]: The device group to destroy
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_device_group_destroy(struct aes_gcm_device_group *group);
+
+/*
+ * Register the source and destination memory ranges with every member and start the members' contexts, all members
+ * are started in parallel. The ranges are bound to the NUMA node of the group first, migrating the pages already
+ * touched. dst may equal src for in place jobs.
+ *
+ * @group [in]: The device group
+ * @src [in]: Source memory range address
+ * @src_len [in]: Source memory range length
+ * @dst [in]: Destination memory range address
+ * @dst_len [in]: Destination memory range length
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_device_group_start(struct aes_gcm_device_group *group,
+					void *src,
+					size_t src_len,
+					void *dst,
+					size_t dst_len);
+
+/*
+ * Register the memory holding the detached tags of the jobs with every member, see aes_gcm_register_tag_memory()
+ *
+ * The tags memory is bound to the NUMA node of the group like the data.
+ *
+ * @group [in]: The device group
+ * @tags [in]: Tags memory range address
+ * @tags_len [in]: Tags memory range length
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_device_group_register_tags(struct aes_gcm_device_group *group, void *tags, size_t tags_len);
+
+/*
+ * Create an AES-GCM key on every member of a started device group
+ *
+ * @group [in]: The device group
+ * @raw_key [in]: Raw key
+ * @key_type [in]: Raw key type
+ * @key [out]: The group key
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_device_group_key_create(struct aes_gcm_device_group *group,
+					     const uint8_t *raw_key,
+					     enum doca_aes_gcm_key_type key_type,
+					     struct aes_gcm_group_key *key);
+
+/*
+ * Destroy a group key
+ *
+ * @group [in]: The device group
+ * @key [in]: The group key to destroy
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_device_group_key_destroy(struct aes_gcm_device_group *group, struct aes_gcm_group_key *key);
+
+/*
+ * Queue a job on the device group
+ *
+ * The job is dispatched to the member with the lowest estimated completion time, based on its outstanding bytes and
+ * observed latency. Errors are handled without stopping the members:
+ * - a transient error, see aes_gcm_error_is_transient(), is retried up to AES_GCM_GROUP_MAX_RETRIES times on any member
+ * - an engine failure takes the member out of rotation while its context is restarted, the job runs elsewhere
+ * - any other error is retried once on another healthy member, a job failing twice is reported as bad
+ * With cfg->cpu_fallback set, a job that runs out of retries or of members runs on the CPU instead, a bad job does not.
+ * Queued jobs are dispatched by job->priority: a high priority job always goes before the bulk jobs, and bulk jobs
+ * leave cfg->priority_reserve task slots of every member to the high priority ones. A job still queued past its
+ * job->deadline_ns is completed with DOCA_ERROR_TIME_OUT instead of being submitted.
+ * With cfg->num_tenants set, bulk jobs first wait in the queue of their job->tenant, and the tenants are admitted in
+ * weighted fair order within their token bucket limits, see aes_gcm_tenant_next().
+ * A job whose source is smaller than group->cpu_crossover runs on the CPU right away, job->done_cb is called before
+ * this returns.
+ * job->done_cb reports the final status.
+ *
+ * @group [in]: The device group
+ * @key [in]: The group key to run the job with
+ * @job [in]: The job, must stay valid until job->done_cb is called or aes_gcm_device_group_wait() returns
+ */
+void aes_gcm_device_group_submit(struct aes_gcm_device_group *group,
+				 struct aes_gcm_group_key *key,
+				 struct aes_gcm_job *job);
+
+/*
+ * Queue a burst of jobs on the device group and ring the doorbell of every member once they are dispatched
+ *
+ * With cfg->submit_burst above 1, the jobs dispatched to a member share a doorbell per burst instead of ringing one
+ * each. Jobs that wait for a free task slot are dispatched, in bursts as well, while the group is progressed.
+ *
+ * @group [in]: The device group
+ * @key [in]: The group key to run the jobs with
+ * @jobs [in]: The jobs, see aes_gcm_device_group_submit()
+ * @nb_jobs [in]: Number of jobs
+ */
+void aes_gcm_device_group_submit_burst(struct aes_gcm_device_group *group,
+				       struct aes_gcm_group_key *key,
+				       struct aes_gcm_job *jobs,
+				       size_t nb_jobs);
+
+/*
+ * Ring the doorbell of every member for the tasks submitted since their last one
+ *
+ * Needed only when jobs are submitted one by one and a partial burst should not wait for cfg->submit_burst_timeout_us,
+ * aes_gcm_device_group_wait() and aes_gcm_device_group_submit_burst() flush on their own.
+ *
+ * @group [in]: The device group
+ */
+void aes_gcm_device_group_flush(struct aes_gcm_device_group *group);
+
+/*
+ * Progress all members, restart the contexts that stopped on an engine failure and dispatch queued jobs
+ *
+ * @group [in]: The device group
+ * @return: number of completions handled
+ */
+uint32_t aes_gcm_device_group_progress(struct aes_gcm_device_group *group);
+
+/*
+ * Progress the device group until all queued and in flight jobs are done
+ *
+ * The thread sleeps SLEEP_IN_NANOS between empty progress calls, unless cfg->low_latency was set. Either way the
+ * completions are handled on the calling thread, which is neither pinned nor handed over to a poller, see
+ * aes_gcm_poller.h for a dedicated progress thread.
+ *
+ * @group [in]: The device group
+ */
+void aes_gcm_device_group_wait(struct aes_gcm_device_group *group);
+
+/*
+ * Log the startup time breakdown, the memory placement, the per device job distribution and the aggregate throughput
+ *
+ * @group [in]: The device group
+ * @elapsed_ns [in]: Wall time the jobs took
+ */
+void aes_gcm_device_group_report(const struct aes_gcm_device_group *group, uint64_t elapsed_ns);
+
+#endif /* AES_GCM_DEVICE_GROUP_H_ */
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <doca_log.h>
+#include <doca_error.h>
+
+#include "aes_gcm_emu.h"
+#include "aes_gcm_sw.h"
+
+DOCA_LOG_REGISTER(AES_GCM::EMU);
+
+/* Key of an emulated device, handed out as an opaque struct doca_aes_gcm_key pointer */
+struct emu_key {
+	uint8_t raw[MAX_AES_GCM_KEY_SIZE]; /* Raw key */
+	uint32_t len;			   /* Raw key length */
+};
+
+/* Job in flight on an emulated device */
+struct emu_slot {
+	struct aes_gcm_job *job; /* The job */
+	uint64_t complete_ns;	 /* Time the job completes at */
+	doca_error_t status;	 /* Injected status, DOCA_SUCCESS to run the job */
+};
+
+/* Emulated AES-GCM device */
+struct aes_gcm_emu {
+	struct aes_gcm_emu_model model;	/* Performance and fault model */
+	struct emu_slot *slots;		/* Ring of jobs in flight, in completion order */
+	uint32_t head;			/* Index of the oldest job in flight */
+	uint32_t count;			/* Number of jobs in flight */
+	uint32_t num_unrung;		/* Newest jobs in flight still waiting for a doorbell */
+	uint64_t busy_until_ns;		/* Time the engine is done with the accepted bytes */
+	uint64_t num_submitted;		/* Number of accepted jobs */
+	unsigned int rand_state;	/* Error injection state */
+};
+
+void aes_gcm_emu_model_init(struct aes_gcm_emu_model *model)
+{
+	memset(model, 0, sizeof(*model));
+	model->latency_ns = AES_GCM_EMU_DEFAULT_LATENCY_NS;
+	model->max_tasks = AES_GCM_EMU_DEFAULT_MAX_TASKS;
+	model->max_buf_size = AES_GCM_EMU_DEFAULT_MAX_BUF_SIZE;
+	model->seed = 1;
+}
+
+doca_error_t aes_gcm_emu_model_parse(const char *spec, struct aes_gcm_emu_model *model)
+{
+	char buf[256], *setting, *value, *end, *saveptr = NULL;
+	double number;
+
+	if (strnlen(spec, sizeof(buf)) == sizeof(buf)) {
+		DOCA_LOG_ERR("Emulation settings are too long, max %zu characters", sizeof(buf) - 1);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	strcpy(buf, spec);
+
+	model->num_devices = 1;
+	for (setting = strtok_r(buf, ",", &saveptr); setting != NULL; setting = strtok_r(NULL, ",", &saveptr)) {
+		value = strchr(setting, '=');
+		if (value == NULL) {
+			DOCA_LOG_ERR("Invalid emulation setting \"%s\", expected key=value", setting);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		*value++ = '\0';
+
+		errno = 0;
+		number = strtod(value, &end);
+		if (errno != 0 || end == value || *end != '\0' || number < 0) {
+			DOCA_LOG_ERR("Invalid value \"%s\" for emulation setting %s", value, setting);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+
+		if (strcmp(setting, "devices") == 0 && number >= 1 && number <= AES_GCM_MAX_DEVICES)
+			model->num_devices = number;
+		else if (strcmp(setting, "latency_us") == 0)
+			model->latency_ns = number * 1000;
+		else if (strcmp(setting, "bandwidth_mbps") == 0)
+			model->bandwidth_mbps = number;
+		else if (strcmp(setting, "max_tasks") == 0 && number >= 1)
+			model->max_tasks = number;
+		else if (strcmp(setting, "max_buf_size") == 0 && number >= 1)
+			model->max_buf_size = number;
+		else if (strcmp(setting, "error_rate") == 0 && number <= 1)
+			model->error_rate = number;
+		else if (strcmp(setting, "doorbell_error_rate") == 0 && number <= 1)
+			model->doorbell_error_rate = number;
+		else if (strcmp(setting, "fail_after") == 0)
+			model->fail_after = number;
+		else if (strcmp(setting, "seed") == 0)
+			model->seed = number;
+		else {
+			DOCA_LOG_ERR("Unknown emulation setting %s=%s", setting, value);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+	}
+
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_emu_create(const struct aes_gcm_emu_model *model, uint32_t idx, struct aes_gcm_emu **emu)
+{
+	struct aes_gcm_emu *new_emu;
+
+	new_emu = calloc(1, sizeof(*new_emu));
+	if (new_emu == NULL)
+		return DOCA_ERROR_NO_MEMORY;
+
+	new_emu->slots = calloc(model->max_tasks, sizeof(*new_emu->slots));
+	if (new_emu->slots == NULL) {
+		free(new_emu);
+		return DOCA_ERROR_NO_MEMORY;
+	}
+
+	new_emu->model = *model;
+	new_emu->rand_state = model->seed + idx;
+	*emu = new_emu;
+	return DOCA_SUCCESS;
+}
+
+void aes_gcm_emu_destroy(struct aes_gcm_emu *emu)
+{
+	if (emu == NULL)
+		return;
+	if (emu->count != 0)
+		DOCA_LOG_WARN("Emulated device destroyed with %u jobs in flight", emu->count);
+	free(emu->slots);
+	free(emu);
+}
+
+bool aes_gcm_emu_is_running(const struct aes_gcm_emu *emu)
+{
+	return emu->model.fail_after == 0 || emu->num_submitted < emu->model.fail_after;
+}
+
+void aes_gcm_emu_restart(struct aes_gcm_emu *emu)
+{
+	/* The restarted engine runs for another fail_after tasks */
+	emu->num_submitted = 0;
+	emu->busy_until_ns = 0;
+}
+
+doca_error_t aes_gcm_emu_submit(struct aes_gcm_emu *emu, struct aes_gcm_job *job, uint32_t flags)
+{
+	struct emu_slot *slot;
+	uint64_t now_ns = aes_gcm_get_time_ns();
+	bool doorbell = (flags & DOCA_TASK_SUBMIT_FLAG_FLUSH) != 0;
+
+	if (!aes_gcm_emu_is_running(emu))
+		return DOCA_ERROR_BAD_STATE;
+	if (emu->count == emu->model.max_tasks)
+		return DOCA_ERROR_NO_MEMORY;
+	if (job->src_len > emu->model.max_buf_size)
+		return DOCA_ERROR_INVALID_VALUE;
+	if (doorbell && emu->model.doorbell_error_rate > 0 &&
+	    ((double)rand_r(&emu->rand_state) / RAND_MAX) < emu->model.doorbell_error_rate)
+		return DOCA_ERROR_IO_FAILED;
+
+	/* The engine streams the bytes of one job at a time, the fixed latency overlaps */
+	if (emu->busy_until_ns < now_ns)
+		emu->busy_until_ns = now_ns;
+	if (emu->model.bandwidth_mbps != 0)
+		emu->busy_until_ns += (job->src_len * 1000) / emu->model.bandwidth_mbps;
+
+	slot = &emu->slots[(emu->head + emu->count) % emu->model.max_tasks];
+	slot->job = job;
+	slot->complete_ns = emu->busy_until_ns + emu->model.latency_ns;
+	slot->status = DOCA_SUCCESS;
+	if (emu->model.error_rate > 0 && ((double)rand_r(&emu->rand_state) / RAND_MAX) < emu->model.error_rate)
+		slot->status = DOCA_ERROR_IO_FAILED;
+
+	emu->count++;
+	emu->num_submitted++;
+	emu->num_unrung = doorbell ? 0 : emu->num_unrung + 1;
+	return DOCA_SUCCESS;
+}
+
+uint32_t aes_gcm_emu_progress(struct aes_gcm_emu *emu, struct aes_gcm_resources *resources)
+{
+	const struct emu_key *key;
+	struct emu_slot slot;
+	uint64_t now_ns = aes_gcm_get_time_ns();
+	uint32_t nb_completions = 0;
+	size_t out_len;
+	doca_error_t status;
+
+	/* A stopped engine flushes the jobs still waiting for their doorbell */
+	if (!aes_gcm_emu_is_running(emu)) {
+		for (; emu->num_unrung > 0; emu->num_unrung--)
+			emu->slots[(emu->head + emu->count - emu->num_unrung) % emu->model.max_tasks].status =
+				DOCA_ERROR_BAD_STATE;
+	}
+
+	/* Completion times only grow, so the due jobs are at the head of the ring, the ones behind no doorbell wait */
+	while (emu->count > emu->num_unrung && emu->slots[emu->head].complete_ns <= now_ns) {
+		slot = emu->slots[emu->head];
+		emu->head = (emu->head + 1) % emu->model.max_tasks;
+		emu->count--;
+
+		out_len = 0;
+		status = slot.status;
+		key = (const struct emu_key *)slot.job->key;
+		if (status == DOCA_SUCCESS)
+			status = aes_gcm_sw_run_job(key->raw, key->len, slot.job, &out_len);
+		if (status != DOCA_SUCCESS)
+			DOCA_LOG_ERR("%s task failed: %s",
+				     (slot.job->mode == AES_GCM_MODE_ENCRYPT) ? "Encrypt" : "Decrypt",
+				     doca_error_get_descr(status));
+		aes_gcm_finish_job(resources, slot.job, status, out_len);
+		nb_completions++;
+	}
+
+	return nb_completions;
+}
+
+doca_error_t aes_gcm_emu_key_create(struct aes_gcm_emu *emu,
+				    const void *raw_key,
+				    enum doca_aes_gcm_key_type key_type,
+				    struct doca_aes_gcm_key **key)
+{
+	struct emu_key *new_key;
+
+	(void)emu;
+	new_key = calloc(1, sizeof(*new_key));
+	if (new_key == NULL)
+		return DOCA_ERROR_NO_MEMORY;
+
+	new_key->len = (key_type == DOCA_AES_GCM_KEY_128) ? 16 : 32;
+	memcpy(new_key->raw, raw_key, new_key->len);
+	*key = (struct doca_aes_gcm_key *)new_key;
+	return DOCA_SUCCESS;
+}
+
+void aes_gcm_emu_key_destroy(struct doca_aes_gcm_key *key)
+{
+	free(key);
+}
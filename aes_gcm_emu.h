@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_EMU_H_
+#define AES_GCM_EMU_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <doca_aes_gcm.h>
+#include <doca_error.h>
+#include <doca_pe.h>
+
+#include "aes_gcm_common.h"
+
+#define AES_GCM_EMU_DEFAULT_LATENCY_NS 10000	     /* Default task latency */
+#define AES_GCM_EMU_DEFAULT_MAX_TASKS 128	     /* Default max number of tasks in flight */
+#define AES_GCM_EMU_DEFAULT_MAX_BUF_SIZE (2UL << 20) /* Default max task buffer size */
+
+struct aes_gcm_emu;
+
+/*
+ * Set the default emulation model, with emulation disabled
+ *
+ * @model [out]: The model
+ */
+void aes_gcm_emu_model_init(struct aes_gcm_emu_model *model);
+
+/*
+ * Parse an emulation model, e.g. "devices=2,latency_us=20,bandwidth_mbps=4000,error_rate=0.001"
+ *
+ * Settings that are not given keep their current value, devices defaults to 1.
+ *
+ * @spec [in]: Comma separated key=value settings
+ * @model [in/out]: The model
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_emu_model_parse(const char *spec, struct aes_gcm_emu_model *model);
+
+/*
+ * Create an emulated AES-GCM device
+ *
+ * The emulated device runs in-process and completes jobs from aes_gcm_emu_progress(), following the same contract as
+ * a DOCA AES-GCM context: a job is accepted while fewer than model->max_tasks jobs are in flight, and completes once
+ * its latency plus its share of the engine bandwidth has elapsed. The data is really encrypted or decrypted on the
+ * CPU, so the output matches a real device.
+ *
+ * @model [in]: Performance and fault model
+ * @idx [in]: Device index, used to seed the error injection
+ * @emu [out]: The emulated device
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_emu_create(const struct aes_gcm_emu_model *model, uint32_t idx, struct aes_gcm_emu **emu);
+
+/*
+ * Destroy an emulated device, jobs in flight are dropped
+ *
+ * @emu [in]: The emulated device
+ */
+void aes_gcm_emu_destroy(struct aes_gcm_emu *emu);
+
+/*
+ * Submit a job to an emulated device
+ *
+ * Like doca_task_submit_ex(), a job submitted without DOCA_TASK_SUBMIT_FLAG_FLUSH only starts once a later job rings
+ * the doorbell. A rejected doorbell, see aes_gcm_emu_model.doorbell_error_rate, leaves the jobs before it waiting.
+ *
+ * @emu [in]: The emulated device
+ * @job [in]: The job
+ * @flags [in]: DOCA task submit flags
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR_NO_MEMORY if the device queue is full and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_emu_submit(struct aes_gcm_emu *emu, struct aes_gcm_job *job, uint32_t flags);
+
+/*
+ * Complete the jobs whose time has come, each through aes_gcm_finish_job()
+ *
+ * @emu [in]: The emulated device
+ * @resources [in]: The resources the device belongs to
+ * @return: number of completed jobs
+ */
+uint32_t aes_gcm_emu_progress(struct aes_gcm_emu *emu, struct aes_gcm_resources *resources);
+
+/*
+ * Check if an emulated device is still running, see aes_gcm_emu_model.fail_after
+ *
+ * @emu [in]: The emulated device
+ * @return: true if the device is running
+ */
+bool aes_gcm_emu_is_running(const struct aes_gcm_emu *emu);
+
+/*
+ * Restart an emulated device that stopped running, no job may be in flight
+ *
+ * @emu [in]: The emulated device
+ */
+void aes_gcm_emu_restart(struct aes_gcm_emu *emu);
+
+/*
+ * Create a key on an emulated device
+ *
+ * @emu [in]: The emulated device
+ * @raw_key [in]: Raw key
+ * @key_type [in]: Raw key type
+ * @key [out]: Opaque key handle, only valid with the emulated device
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_emu_key_create(struct aes_gcm_emu *emu,
+				    const void *raw_key,
+				    enum doca_aes_gcm_key_type key_type,
+				    struct doca_aes_gcm_key **key);
+
+/*
+ * Destroy a key of an emulated device
+ *
+ * @key [in]: Key handle
+ */
+void aes_gcm_emu_key_destroy(struct doca_aes_gcm_key *key);
+
+#endif /* AES_GCM_EMU_H_ */
@@ -25,6 +25,9 @@
 
 #include "common.h"
 #include "aes_gcm_common.h"
+#include "aes_gcm_bench.h"
+#include "aes_gcm_calibrate.h"
+#include "aes_gcm_stream.h"
 
 DOCA_LOG_REGISTER(AES_GCM_ENCRYPT);
 
@@ -54,6 +57,16 @@ doca_error_t aes_gcm_encrypt(struct aes_gcm_cfg *cfg, char *file_data, size_t fi
 	doca_error_t tmp_result = DOCA_SUCCESS;
 	uint64_t max_encrypt_buf_size = 0;
 
+	/* The calibration and the latency benchmark run on synthetic messages, the file is not used */
+	if (cfg->calibrate)
+		return aes_gcm_calibrate(cfg);
+	if (cfg->latency_bench != 0)
+		return aes_gcm_latency_bench(cfg);
+
+	/* Chunked and multi-device runs spread the file over a device group */
+	if (aes_gcm_stream_is_requested(cfg))
+		return aes_gcm_stream_file(cfg, AES_GCM_MODE_ENCRYPT, file_data, file_size);
+
 	out_file = fopen(cfg->output_path, "wr");
 	if (out_file == NULL) {
 		DOCA_LOG_ERR("Unable to open output file: %s", cfg->output_path);
@@ -0,0 +1,337 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <doca_log.h>
+#include <doca_error.h>
+
+#include "aes_gcm_device_group.h"
+#include "aes_gcm_gmac.h"
+#include "aes_gcm_sw.h"
+
+DOCA_LOG_REGISTER(AES_GCM::GMAC);
+
+/*
+ * Compute the manifest tag, or check it, on the CPU
+ *
+ * @cfg [in]: Configuration parameters
+ * @manifest [in/out]: The manifest: header, chunk tags and room for the manifest tag
+ * @mode [in]: AES-GCM mode - encrypt writes the manifest tag, decrypt checks it
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR_INVALID_VALUE if the manifest tag does not match and DOCA_ERROR
+ * otherwise
+ */
+static doca_error_t manifest_tag(const struct aes_gcm_cfg *cfg, uint8_t *manifest, enum aes_gcm_mode mode)
+{
+	const struct aes_gcm_gmac_header *header = (const struct aes_gcm_gmac_header *)manifest;
+	uint32_t key_len = (cfg->raw_key_type == DOCA_AES_GCM_KEY_128) ? 16 : 32;
+	size_t aad_len = sizeof(*header) + (header->num_chunks * header->tag_size);
+	uint8_t iv[MAX_AES_GCM_IV_LENGTH];
+	uint8_t unused;
+
+	/* The chunks use the IVs of index 0 to num_chunks - 1, the manifest takes the next one */
+	aes_gcm_derive_iv(cfg->iv, cfg->iv_length, header->num_chunks, iv);
+	if (mode == AES_GCM_MODE_ENCRYPT)
+		return aes_gcm_sw_encrypt(cfg->raw_key,
+					  key_len,
+					  iv,
+					  cfg->iv_length,
+					  manifest,
+					  aad_len,
+					  &unused,
+					  0,
+					  &unused,
+					  manifest + aad_len,
+					  header->tag_size);
+	return aes_gcm_sw_decrypt(cfg->raw_key,
+				  key_len,
+				  iv,
+				  cfg->iv_length,
+				  manifest,
+				  aad_len,
+				  &unused,
+				  0,
+				  manifest + aad_len,
+				  header->tag_size,
+				  &unused);
+}
+
+/*
+ * Write a GMAC manifest file, the file is replaced atomically
+ *
+ * @path [in]: Manifest file path
+ * @manifest [in]: The manifest, with its manifest tag
+ * @manifest_len [in]: Manifest length
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t manifest_write(const char *path, const uint8_t *manifest, size_t manifest_len)
+{
+	char tmp_path[MAX_FILE_NAME + 4];
+	size_t written;
+	FILE *file;
+
+	snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+	file = fopen(tmp_path, "w");
+	if (file == NULL) {
+		DOCA_LOG_ERR("Unable to open GMAC manifest %s: %s", tmp_path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	written = fwrite(manifest, 1, manifest_len, file);
+	if (fclose(file) != 0 || written != manifest_len || rename(tmp_path, path) != 0) {
+		DOCA_LOG_ERR("Unable to write GMAC manifest %s: %s", path, strerror(errno));
+		remove(tmp_path);
+		return DOCA_ERROR_IO_FAILED;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Read a GMAC manifest file in one go, and check it matches the data file and the configuration
+ *
+ * @path [in]: Manifest file path
+ * @cfg [in]: Configuration parameters, provides the tag size
+ * @data_size [in]: Size of the data file
+ * @manifest [out]: The manifest, to be freed by the caller
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t manifest_read(const char *path,
+				  const struct aes_gcm_cfg *cfg,
+				  uint64_t data_size,
+				  uint8_t **manifest)
+{
+	struct aes_gcm_gmac_header header;
+	doca_error_t result = DOCA_SUCCESS;
+	uint8_t *new_manifest = NULL;
+	size_t manifest_len, tags_len;
+	FILE *file;
+
+	file = fopen(path, "r");
+	if (file == NULL) {
+		DOCA_LOG_ERR("Unable to open GMAC manifest %s: %s", path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	if (fread(&header, sizeof(header), 1, file) != 1 ||
+	    memcmp(header.magic, AES_GCM_GMAC_MAGIC, sizeof(header.magic)) != 0 ||
+	    header.version != AES_GCM_GMAC_VERSION) {
+		DOCA_LOG_ERR("File %s is not a GMAC manifest", path);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto close_file;
+	}
+
+	if (header.tag_size != cfg->tag_size) {
+		DOCA_LOG_ERR("GMAC manifest %s holds %u bytes tags, expected %u bytes tags",
+			     path,
+			     header.tag_size,
+			     cfg->tag_size);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto close_file;
+	}
+
+	if (header.chunk_size == 0 || header.data_size != data_size ||
+	    header.num_chunks != (data_size + header.chunk_size - 1) / header.chunk_size) {
+		DOCA_LOG_ERR("GMAC manifest %s describes %lu chunks of %u bytes in %lu bytes, the data file has %lu",
+			     path,
+			     header.num_chunks,
+			     header.chunk_size,
+			     header.data_size,
+			     data_size);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto close_file;
+	}
+
+	tags_len = (header.num_chunks + 1) * header.tag_size;
+	manifest_len = sizeof(header) + tags_len;
+	new_manifest = malloc(manifest_len);
+	if (new_manifest == NULL) {
+		result = DOCA_ERROR_NO_MEMORY;
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(result));
+		goto close_file;
+	}
+
+	/* All tags are contiguous, fetch them in one read */
+	memcpy(new_manifest, &header, sizeof(header));
+	if (fread(new_manifest + sizeof(header), 1, tags_len, file) != tags_len) {
+		DOCA_LOG_ERR("GMAC manifest %s is truncated", path);
+		free(new_manifest);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto close_file;
+	}
+	*manifest = new_manifest;
+
+close_file:
+	fclose(file);
+	return result;
+}
+
+doca_error_t aes_gcm_gmac_file(const struct aes_gcm_cfg *cfg,
+			       enum aes_gcm_mode mode,
+			       char *file_data,
+			       size_t file_size)
+{
+	struct aes_gcm_device_group *group = NULL;
+	struct aes_gcm_group_key key = {0};
+	struct aes_gcm_gmac_header *header;
+	struct aes_gcm_job *jobs = NULL;
+	struct aes_gcm_job *job;
+	uint8_t *manifest = NULL;
+	uint8_t *tags;
+	size_t manifest_len, chunk_size, offset, num_failed = 0, i;
+	uint64_t start_ns;
+	doca_error_t result, tmp_result;
+
+	if (cfg->aad_size != 0 || cfg->tag_index_path[0] != '\0' || cfg->compress_codec[0] != '\0' || cfg->records ||
+	    cfg->tls_secret_len != 0) {
+		DOCA_LOG_ERR("GMAC authenticates the whole file, it does not combine with AAD, tag index, compression, "
+			     "records or TLS");
+		return DOCA_ERROR_NOT_SUPPORTED;
+	}
+	if (file_size == 0) {
+		DOCA_LOG_ERR("Input file is empty");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	if (mode == AES_GCM_MODE_DECRYPT) {
+		result = manifest_read(cfg->gmac_manifest_path, cfg, file_size, &manifest);
+		if (result != DOCA_SUCCESS)
+			return result;
+		result = manifest_tag(cfg, manifest, mode);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("GMAC manifest %s failed authentication", cfg->gmac_manifest_path);
+			goto free_manifest;
+		}
+		header = (struct aes_gcm_gmac_header *)manifest;
+	} else {
+		chunk_size = (cfg->chunk_size != 0) ? cfg->chunk_size : AES_GCM_GMAC_DEFAULT_CHUNK_SIZE;
+		if (chunk_size > file_size)
+			chunk_size = file_size;
+		manifest_len = sizeof(*header) + ((((file_size + chunk_size - 1) / chunk_size) + 1) * cfg->tag_size);
+		manifest = calloc(1, manifest_len);
+		if (manifest == NULL) {
+			DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(DOCA_ERROR_NO_MEMORY));
+			return DOCA_ERROR_NO_MEMORY;
+		}
+		header = (struct aes_gcm_gmac_header *)manifest;
+		memcpy(header->magic, AES_GCM_GMAC_MAGIC, sizeof(header->magic));
+		header->version = AES_GCM_GMAC_VERSION;
+		header->tag_size = cfg->tag_size;
+		header->chunk_size = chunk_size;
+		header->num_chunks = (file_size + chunk_size - 1) / chunk_size;
+		header->data_size = file_size;
+	}
+	tags = manifest + sizeof(*header);
+	manifest_len = sizeof(*header) + ((header->num_chunks + 1) * header->tag_size);
+
+	result = aes_gcm_device_group_create(cfg, mode, &group);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create device group: %s", doca_error_get_descr(result));
+		goto free_manifest;
+	}
+
+	if (header->chunk_size > group->max_buf_size) {
+		DOCA_LOG_ERR("Chunk size %u > max buffer size %lu", header->chunk_size, group->max_buf_size);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto destroy_group;
+	}
+
+	jobs = calloc(header->num_chunks, sizeof(*jobs));
+	if (jobs == NULL) {
+		result = DOCA_ERROR_NO_MEMORY;
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(result));
+		goto destroy_group;
+	}
+
+	/* The devices copy the AAD to the destination, here the source itself, so only the tags are produced */
+	result = aes_gcm_device_group_start(group, file_data, file_size, file_data, file_size);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+
+	result = aes_gcm_device_group_register_tags(group, tags, header->num_chunks * header->tag_size);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+
+	result = aes_gcm_device_group_key_create(group, cfg->raw_key, cfg->raw_key_type, &key);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+
+	DOCA_LOG_INFO("%s %lu chunks of %u bytes on %u devices",
+		      (mode == AES_GCM_MODE_ENCRYPT) ? "Tagging" : "Checking",
+		      header->num_chunks,
+		      header->chunk_size,
+		      group->num_members);
+
+	start_ns = aes_gcm_get_time_ns();
+	for (i = 0; i < header->num_chunks; i++) {
+		job = &jobs[i];
+		offset = i * header->chunk_size;
+		job->src = file_data + offset;
+		job->src_len = (file_size - offset < header->chunk_size) ? (file_size - offset) : header->chunk_size;
+		job->aad_size = job->src_len;
+		job->dst = job->src;
+		job->dst_len = job->src_len;
+		job->tag = tags + (i * header->tag_size);
+		aes_gcm_derive_iv(cfg->iv, cfg->iv_length, i, job->iv);
+		job->iv_length = cfg->iv_length;
+		job->tag_size = header->tag_size;
+	}
+	aes_gcm_device_group_submit_burst(group, &key, jobs, header->num_chunks);
+	aes_gcm_device_group_wait(group);
+	aes_gcm_device_group_report(group, aes_gcm_get_time_ns() - start_ns);
+
+	for (i = 0; i < header->num_chunks; i++) {
+		if (jobs[i].result == DOCA_SUCCESS)
+			continue;
+		DOCA_LOG_ERR("Chunk %zu at offset %zu %s: %s",
+			     i,
+			     i * header->chunk_size,
+			     (mode == AES_GCM_MODE_ENCRYPT) ? "could not be tagged" : "failed authentication",
+			     doca_error_get_descr(jobs[i].result));
+		if (num_failed++ == 0)
+			result = jobs[i].result;
+	}
+	if (num_failed != 0) {
+		DOCA_LOG_ERR("%zu of %lu chunks failed", num_failed, header->num_chunks);
+		goto destroy_key;
+	}
+
+	if (mode == AES_GCM_MODE_ENCRYPT) {
+		result = manifest_tag(cfg, manifest, mode);
+		if (result == DOCA_SUCCESS)
+			result = manifest_write(cfg->gmac_manifest_path, manifest, manifest_len);
+		if (result == DOCA_SUCCESS)
+			DOCA_LOG_INFO("GMAC manifest of %lu chunks saved to %s",
+				      header->num_chunks,
+				      cfg->gmac_manifest_path);
+	} else {
+		DOCA_LOG_INFO("All %lu chunks are authentic", header->num_chunks);
+	}
+
+destroy_key:
+	tmp_result = aes_gcm_device_group_key_destroy(group, &key);
+	DOCA_ERROR_PROPAGATE(result, tmp_result);
+destroy_group:
+	tmp_result = aes_gcm_device_group_destroy(group);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to destroy device group: %s", doca_error_get_descr(tmp_result));
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+	free(jobs);
+free_manifest:
+	free(manifest);
+	return result;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+
+#ifndef AES_GCM_GMAC_H_
+#define AES_GCM_GMAC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+
+#define AES_GCM_GMAC_MAGIC "AGMM"		      /* GMAC manifest file magic */
+#define AES_GCM_GMAC_VERSION 1			      /* GMAC manifest file format version */
+#define AES_GCM_GMAC_DEFAULT_CHUNK_SIZE (1024 * 1024) /* Chunk size when none is given */
+
+/*
+ * GMAC manifest file header, in host byte order. It is followed by num_chunks tags of tag_size bytes each in chunk
+ * order, and by the manifest tag, which authenticates the header and the chunk tags.
+ */
+struct aes_gcm_gmac_header {
+	char magic[4];	     /* AES_GCM_GMAC_MAGIC, not NULL terminated */
+	uint32_t version;    /* AES_GCM_GMAC_VERSION */
+	uint32_t tag_size;   /* Size of every tag */
+	uint32_t chunk_size; /* Data bytes per chunk, the last chunk may be shorter */
+	uint64_t num_chunks; /* Number of chunks and chunk tags */
+	uint64_t data_size;  /* Size of the authenticated data file */
+};
+
+/*
+ * Tag a file, or check it against its tags, with AES-GMAC over a device group: the data is authenticated but not
+ * encrypted
+ *
+ * The file is cut in chunks, and chunk i is passed to the devices as additional authenticated data only, with the IV
+ * derived from cfg->iv and i by aes_gcm_derive_iv(). The devices run on the file memory in place and the chunk tags
+ * are detached, so no copy of the data is produced or written out. On encrypt the chunk tags are saved to the
+ * manifest in cfg->gmac_manifest_path, with chunks of cfg->chunk_size bytes, AES_GCM_GMAC_DEFAULT_CHUNK_SIZE when
+ * unset. The manifest tag is computed on the CPU with the IV of index num_chunks, so a manifest cannot be truncated or
+ * edited without notice. On decrypt the manifest is checked first, then every chunk against its tag, with the chunk
+ * size of the manifest; all failing chunks are reported.
+ *
+ * @cfg [in]: Configuration parameters
+ * @mode [in]: AES-GCM mode - encrypt tags the file, decrypt checks it
+ * @file_data [in]: File data, in writable memory
+ * @file_size [in]: File size
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR_INVALID_VALUE when the file or the manifest fails authentication and
+ * DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_gmac_file(const struct aes_gcm_cfg *cfg,
+			       enum aes_gcm_mode mode,
+			       char *file_data,
+			       size_t file_size);
+
+#endif /* AES_GCM_GMAC_H_ */
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <doca_log.h>
+
+#include "aes_gcm_hugepage.h"
+
+DOCA_LOG_REGISTER(AES_GCM::HUGEPAGE);
+
+#define HUGEPAGE_2M_SHIFT 21			    /* log2 of the 2M page size */
+#define HUGEPAGE_1G_SHIFT 30			    /* log2 of the 1G page size */
+#define HUGEPAGE_2M_SIZE (1UL << HUGEPAGE_2M_SHIFT) /* 2M page size */
+#define HUGEPAGE_1G_SIZE (1UL << HUGEPAGE_1G_SHIFT) /* 1G page size */
+
+doca_error_t aes_gcm_hugepage_policy_parse(const char *name, enum aes_gcm_hugepage_policy *policy)
+{
+	if (strcmp(name, "off") == 0)
+		*policy = AES_GCM_HUGEPAGE_OFF;
+	else if (strcmp(name, "thp") == 0)
+		*policy = AES_GCM_HUGEPAGE_THP;
+	else if (strcasecmp(name, "2m") == 0)
+		*policy = AES_GCM_HUGEPAGE_2M;
+	else if (strcasecmp(name, "1g") == 0)
+		*policy = AES_GCM_HUGEPAGE_1G;
+	else
+		return DOCA_ERROR_INVALID_VALUE;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Round a size up to a power of two alignment
+ *
+ * @size [in]: Size
+ * @align [in]: Alignment, a power of two
+ * @return: the rounded size
+ */
+static size_t align_up(size_t size, size_t align)
+{
+	return (size + align - 1) & ~(align - 1);
+}
+
+/*
+ * Map memory from a hugetlbfs pool
+ *
+ * @size [in]: Size in bytes
+ * @shift [in]: log2 of the page size
+ * @mem [out]: The allocation
+ * @return: true on success, false if the pool cannot hold the allocation
+ */
+static bool map_hugetlb(size_t size, int shift, struct aes_gcm_mem *mem)
+{
+	size_t map_size = align_up(size, 1UL << shift);
+	void *addr;
+
+	addr = mmap(NULL,
+		    map_size,
+		    PROT_READ | PROT_WRITE,
+		    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE | (shift << MAP_HUGE_SHIFT),
+		    -1,
+		    0);
+	if (addr == MAP_FAILED)
+		return false;
+
+	mem->addr = addr;
+	mem->map_size = map_size;
+	return true;
+}
+
+/*
+ * Map regular pages, 2M aligned and advised for transparent huge pages when asked
+ *
+ * @size [in]: Size in bytes
+ * @thp [in]: Align the memory and advise the kernel to back it with transparent huge pages
+ * @mem [out]: The allocation
+ * @return: true on success
+ */
+static bool map_regular(size_t size, bool thp, struct aes_gcm_mem *mem)
+{
+	size_t map_size = align_up(size, thp ? HUGEPAGE_2M_SIZE : (size_t)sysconf(_SC_PAGESIZE));
+	size_t extra = thp ? HUGEPAGE_2M_SIZE : 0;
+	uintptr_t addr, aligned;
+
+	/* Over-map by one huge page and trim, so the range starts on a huge page boundary */
+	addr = (uintptr_t)mmap(NULL, map_size + extra, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if ((void *)addr == MAP_FAILED)
+		return false;
+
+	aligned = addr;
+	if (thp) {
+		aligned = align_up(addr, HUGEPAGE_2M_SIZE);
+		if (aligned > addr)
+			(void)munmap((void *)addr, aligned - addr);
+		if (addr + extra > aligned)
+			(void)munmap((void *)(aligned + map_size), addr + extra - aligned);
+		if (madvise((void *)aligned, map_size, MADV_HUGEPAGE) != 0)
+			DOCA_LOG_DBG("Transparent huge pages are not available: %s", strerror(errno));
+	}
+
+	mem->addr = (void *)aligned;
+	mem->map_size = map_size;
+	return true;
+}
+
+doca_error_t aes_gcm_mem_alloc(enum aes_gcm_hugepage_policy policy, size_t size, struct aes_gcm_mem *mem)
+{
+	static bool fallback_logged;
+	enum aes_gcm_hugepage_policy requested = policy;
+
+	memset(mem, 0, sizeof(*mem));
+	mem->size = size;
+	if (size == 0)
+		size = 1;
+
+	if (policy == AES_GCM_HUGEPAGE_1G) {
+		if (map_hugetlb(size, HUGEPAGE_1G_SHIFT, mem)) {
+			mem->backing = AES_GCM_MEM_BACKING_1G;
+			return DOCA_SUCCESS;
+		}
+		policy = AES_GCM_HUGEPAGE_2M;
+	}
+	if (policy == AES_GCM_HUGEPAGE_2M) {
+		if (map_hugetlb(size, HUGEPAGE_2M_SHIFT, mem)) {
+			mem->backing = AES_GCM_MEM_BACKING_2M;
+			return DOCA_SUCCESS;
+		}
+		policy = AES_GCM_HUGEPAGE_THP;
+	}
+	if (requested != policy && !fallback_logged) {
+		DOCA_LOG_WARN("Not enough %s hugetlbfs pages for %zu bytes, falling back to transparent huge pages",
+			      (requested == AES_GCM_HUGEPAGE_1G) ? "1G" : "2M",
+			      size);
+		fallback_logged = true;
+	}
+
+	if (!map_regular(size, policy == AES_GCM_HUGEPAGE_THP, mem)) {
+		DOCA_LOG_ERR("Failed to map %zu bytes: %s", size, strerror(errno));
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	mem->backing = (policy == AES_GCM_HUGEPAGE_THP) ? AES_GCM_MEM_BACKING_THP : AES_GCM_MEM_BACKING_REGULAR;
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_mem_read_file(const char *path, enum aes_gcm_hugepage_policy policy, struct aes_gcm_mem *mem)
+{
+	struct stat st;
+	size_t offset = 0;
+	ssize_t nb_read;
+	doca_error_t result;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		DOCA_LOG_ERR("Unable to open %s: %s", path, strerror(errno));
+		return DOCA_ERROR_NOT_FOUND;
+	}
+	if (fstat(fd, &st) != 0) {
+		DOCA_LOG_ERR("Unable to stat %s: %s", path, strerror(errno));
+		close(fd);
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	result = aes_gcm_mem_alloc(policy, st.st_size, mem);
+	if (result != DOCA_SUCCESS) {
+		close(fd);
+		return result;
+	}
+
+	while (offset < mem->size) {
+		nb_read = read(fd, (char *)mem->addr + offset, mem->size - offset);
+		if (nb_read < 0 && errno == EINTR)
+			continue;
+		if (nb_read <= 0) {
+			DOCA_LOG_ERR("Unable to read %s: %s", path, (nb_read < 0) ? strerror(errno) : "short read");
+			close(fd);
+			aes_gcm_mem_free(mem);
+			return DOCA_ERROR_IO_FAILED;
+		}
+		offset += nb_read;
+	}
+
+	close(fd);
+	return DOCA_SUCCESS;
+}
+
+void aes_gcm_mem_free(struct aes_gcm_mem *mem)
+{
+	if (mem->addr != NULL)
+		(void)munmap(mem->addr, mem->map_size);
+	memset(mem, 0, sizeof(*mem));
+}
+
+const char *aes_gcm_mem_backing_name(enum aes_gcm_mem_backing backing)
+{
+	switch (backing) {
+	case AES_GCM_MEM_BACKING_THP:
+		return "transparent huge pages";
+	case AES_GCM_MEM_BACKING_2M:
+		return "2M hugetlbfs pages";
+	case AES_GCM_MEM_BACKING_1G:
+		return "1G hugetlbfs pages";
+	default:
+		return "regular pages";
+	}
+}
+
+size_t aes_gcm_hugepage_backed_bytes(const void *addr, size_t len)
+{
+	char line[256];
+	uintptr_t start = (uintptr_t)addr, end = start + len, from, to;
+	size_t backed = 0, overlap = 0, value;
+	FILE *file;
+
+	file = fopen("/proc/self/smaps", "r");
+	if (file == NULL)
+		return 0;
+
+	while (fgets(line, sizeof(line), file) != NULL) {
+		if (sscanf(line, "%lx-%lx ", &from, &to) == 2) {
+			/* Start of a mapping, keep the part inside the range */
+			from = (from > start) ? from : start;
+			to = (to < end) ? to : end;
+			overlap = (to > from) ? (to - from) : 0;
+			continue;
+		}
+		if (overlap == 0)
+			continue;
+
+		/* A hugetlbfs mapping is backed entirely, a THP one as far as the kernel assembled huge pages */
+		if (sscanf(line, "KernelPageSize: %zu kB", &value) == 1 && value >= (HUGEPAGE_2M_SIZE >> 10)) {
+			backed += overlap;
+			overlap = 0;
+		} else if (sscanf(line, "AnonHugePages: %zu kB", &value) == 1) {
+			backed += ((value << 10) < overlap) ? (value << 10) : overlap;
+			overlap = 0;
+		}
+	}
+
+	fclose(file);
+	return backed;
+}
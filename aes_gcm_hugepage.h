@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_HUGEPAGE_H_
+#define AES_GCM_HUGEPAGE_H_
+
+#include <stddef.h>
+
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+
+/* Pages backing an allocation */
+enum aes_gcm_mem_backing {
+	AES_GCM_MEM_BACKING_REGULAR, /* Regular pages */
+	AES_GCM_MEM_BACKING_THP,     /* Transparent huge pages, if the kernel could assemble them */
+	AES_GCM_MEM_BACKING_2M,	     /* 2M hugetlbfs pages */
+	AES_GCM_MEM_BACKING_1G,	     /* 1G hugetlbfs pages */
+};
+
+/* Page aligned, zeroed memory for registration with the devices */
+struct aes_gcm_mem {
+	void *addr;			  /* Memory address */
+	size_t size;			  /* Requested size */
+	size_t map_size;		  /* Mapped size, a multiple of the page size */
+	enum aes_gcm_mem_backing backing; /* Pages backing the memory */
+};
+
+/*
+ * Parse a hugepage policy name: off, thp, 2m or 1g
+ *
+ * @name [in]: Policy name
+ * @policy [out]: The policy
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR_INVALID_VALUE for an unknown name
+ */
+doca_error_t aes_gcm_hugepage_policy_parse(const char *name, enum aes_gcm_hugepage_policy *policy);
+
+/*
+ * Allocate memory with the largest page size the policy allows and the system can provide
+ *
+ * hugetlbfs pages come from the reserved pool (vm.nr_hugepages or the per size pools), a policy whose pages are not
+ * available falls back to the next smaller page size and finally to regular pages, logging the fallback once.
+ *
+ * @policy [in]: Hugepage policy
+ * @size [in]: Size in bytes
+ * @mem [out]: The allocation
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_mem_alloc(enum aes_gcm_hugepage_policy policy, size_t size, struct aes_gcm_mem *mem);
+
+/*
+ * Read a file into memory allocated with aes_gcm_mem_alloc()
+ *
+ * @path [in]: File path
+ * @policy [in]: Hugepage policy
+ * @mem [out]: The allocation, mem->size is the file size
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_mem_read_file(const char *path, enum aes_gcm_hugepage_policy policy, struct aes_gcm_mem *mem);
+
+/*
+ * Free memory allocated with aes_gcm_mem_alloc(), a zeroed struct is ignored
+ *
+ * @mem [in]: The allocation
+ */
+void aes_gcm_mem_free(struct aes_gcm_mem *mem);
+
+/*
+ * Get the name of a memory backing
+ *
+ * @backing [in]: Memory backing
+ * @return: backing name
+ */
+const char *aes_gcm_mem_backing_name(enum aes_gcm_mem_backing backing);
+
+/*
+ * Count the bytes of a memory range that are backed by huge pages, hugetlbfs or transparent, from /proc/self/smaps
+ *
+ * @addr [in]: Memory range address
+ * @len [in]: Memory range length
+ * @return: number of hugepage backed bytes, 0 if smaps cannot be read
+ */
+size_t aes_gcm_hugepage_backed_bytes(const void *addr, size_t len);
+
+#endif /* AES_GCM_HUGEPAGE_H_ */
@@ -0,0 +1,494 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <doca_log.h>
+#include <doca_error.h>
+
+#include "aes_gcm_metrics.h"
+
+DOCA_LOG_REGISTER(AES_GCM::METRICS);
+
+/* Upper bounds of the latency histogram buckets in nanoseconds, the last bucket has none */
+static const uint64_t latency_bounds_ns[AES_GCM_METRICS_NUM_BUCKETS - 1] = {
+	1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000, 1000000, 2000000, 5000000, 10000000,
+};
+
+/* Counters of a single thread, only written by their thread */
+struct metrics_shard {
+	atomic_uint_least64_t ops[2];					    /* Successful jobs per mode */
+	atomic_uint_least64_t bytes[2];					    /* Source bytes per mode */
+	atomic_uint_least64_t errors[AES_GCM_METRICS_NUM_ERRORS];	    /* Failed jobs per status */
+	atomic_uint_least64_t latency_buckets[AES_GCM_METRICS_NUM_BUCKETS]; /* Jobs per latency bucket */
+	atomic_uint_least64_t latency_sum_ns;				    /* Sum of the job latencies */
+	atomic_uint_least64_t cpu_jobs;					    /* Jobs that ran on the CPU */
+	atomic_uint_least64_t tenant_ops[AES_GCM_MAX_TENANTS];		    /* Dispatched jobs per tenant */
+	atomic_uint_least64_t tenant_bytes[AES_GCM_MAX_TENANTS];	    /* Dispatched source bytes per tenant */
+	atomic_uint_least64_t tenant_throttles[AES_GCM_MAX_TENANTS];	    /* Token shortages per tenant */
+	struct metrics_shard *next;					    /* Next shard of the registry */
+};
+
+/* Aggregated counters, as read from all the shards */
+struct metrics_snapshot {
+	uint64_t ops[2];				       /* Successful jobs per mode */
+	uint64_t bytes[2];				       /* Source bytes per mode */
+	uint64_t errors[AES_GCM_METRICS_NUM_ERRORS];	       /* Failed jobs per status */
+	uint64_t latency_buckets[AES_GCM_METRICS_NUM_BUCKETS]; /* Jobs per latency bucket */
+	uint64_t latency_sum_ns;			       /* Sum of the job latencies */
+	uint64_t cpu_jobs;				       /* Jobs that ran on the CPU */
+	uint64_t tenant_ops[AES_GCM_MAX_TENANTS];	       /* Dispatched jobs per tenant */
+	uint64_t tenant_bytes[AES_GCM_MAX_TENANTS];	       /* Dispatched source bytes per tenant */
+	uint64_t tenant_throttles[AES_GCM_MAX_TENANTS];	       /* Token shortages per tenant */
+	int64_t gauges[AES_GCM_METRICS_NUM_GAUGES];	       /* Gauges */
+};
+
+/* Metrics exporter thread */
+struct metrics_exporter {
+	char path[MAX_FILE_NAME]; /* Metrics file, empty when unused */
+	int listen_fd;		  /* HTTP listening socket, -1 when unused */
+	pthread_t thread;	  /* Exporter thread */
+	atomic_bool running;	  /* Cleared to stop the thread */
+	bool started;		  /* The thread was started */
+};
+
+/* Shards of every thread that recorded a job, kept after their thread exits so no count is lost */
+static struct metrics_shard *shards;
+static pthread_mutex_t shards_lock = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local struct metrics_shard *local_shard;
+static atomic_int_least64_t gauges[AES_GCM_METRICS_NUM_GAUGES];
+static struct metrics_exporter exporter = {.listen_fd = -1};
+
+/* Names and descriptions of the gauges */
+static const char *const gauge_names[AES_GCM_METRICS_NUM_GAUGES][2] = {
+	{"inflight_tasks", "Tasks submitted to the devices and not completed yet"},
+	{"task_slots", "Tasks the device groups may keep in flight"},
+	{"registered_bytes", "Memory registered with the devices"},
+	{"hugepage_bytes", "Registered memory backed by huge pages"},
+};
+
+/*
+ * Get the counters of the calling thread, registering them on first use
+ *
+ * @return: the shard of the thread, NULL if it could not be allocated
+ */
+static struct metrics_shard *get_shard(void)
+{
+	struct metrics_shard *shard = local_shard;
+
+	if (shard != NULL)
+		return shard;
+
+	shard = calloc(1, sizeof(*shard));
+	if (shard == NULL)
+		return NULL;
+
+	pthread_mutex_lock(&shards_lock);
+	shard->next = shards;
+	shards = shard;
+	pthread_mutex_unlock(&shards_lock);
+
+	local_shard = shard;
+	return shard;
+}
+
+/*
+ * Add to a counter of the calling thread, no other thread writes it so a relaxed load and store are enough
+ *
+ * @counter [in]: The counter
+ * @value [in]: Value to add
+ */
+static inline void counter_add(atomic_uint_least64_t *counter, uint64_t value)
+{
+	atomic_store_explicit(counter,
+			      atomic_load_explicit(counter, memory_order_relaxed) + value,
+			      memory_order_relaxed);
+}
+
+void aes_gcm_metrics_job_done(const struct aes_gcm_job *job)
+{
+	struct metrics_shard *shard = get_shard();
+	uint64_t latency_ns;
+	uint32_t bucket, error;
+
+	if (shard == NULL)
+		return;
+
+	if (job->result != DOCA_SUCCESS) {
+		error = ((uint32_t)job->result < AES_GCM_METRICS_NUM_ERRORS) ? job->result : DOCA_ERROR_UNKNOWN;
+		counter_add(&shard->errors[error], 1);
+		return;
+	}
+
+	counter_add(&shard->ops[job->mode], 1);
+	counter_add(&shard->bytes[job->mode], job->src_len);
+
+	latency_ns = (job->complete_ns > job->submit_ns) ? (job->complete_ns - job->submit_ns) : 0;
+	for (bucket = 0; bucket < AES_GCM_METRICS_NUM_BUCKETS - 1; bucket++) {
+		if (latency_ns <= latency_bounds_ns[bucket])
+			break;
+	}
+	counter_add(&shard->latency_buckets[bucket], 1);
+	counter_add(&shard->latency_sum_ns, latency_ns);
+}
+
+void aes_gcm_metrics_cpu_job(void)
+{
+	struct metrics_shard *shard = get_shard();
+
+	if (shard != NULL)
+		counter_add(&shard->cpu_jobs, 1);
+}
+
+void aes_gcm_metrics_tenant_dispatch(uint32_t tenant, uint64_t bytes)
+{
+	struct metrics_shard *shard = get_shard();
+
+	if (shard == NULL)
+		return;
+	counter_add(&shard->tenant_ops[tenant], 1);
+	counter_add(&shard->tenant_bytes[tenant], bytes);
+}
+
+void aes_gcm_metrics_tenant_throttled(uint32_t tenant)
+{
+	struct metrics_shard *shard = get_shard();
+
+	if (shard != NULL)
+		counter_add(&shard->tenant_throttles[tenant], 1);
+}
+
+void aes_gcm_metrics_gauge_add(enum aes_gcm_metrics_gauge gauge, int64_t delta)
+{
+	atomic_fetch_add_explicit(&gauges[gauge], delta, memory_order_relaxed);
+}
+
+/*
+ * Sum up the counters of all the threads
+ *
+ * @snapshot [out]: The aggregated counters
+ */
+static void take_snapshot(struct metrics_snapshot *snapshot)
+{
+	struct metrics_shard *shard;
+	uint32_t i;
+
+	memset(snapshot, 0, sizeof(*snapshot));
+
+	pthread_mutex_lock(&shards_lock);
+	for (shard = shards; shard != NULL; shard = shard->next) {
+		for (i = 0; i < 2; i++) {
+			snapshot->ops[i] += atomic_load_explicit(&shard->ops[i], memory_order_relaxed);
+			snapshot->bytes[i] += atomic_load_explicit(&shard->bytes[i], memory_order_relaxed);
+		}
+		for (i = 0; i < AES_GCM_METRICS_NUM_ERRORS; i++)
+			snapshot->errors[i] += atomic_load_explicit(&shard->errors[i], memory_order_relaxed);
+		for (i = 0; i < AES_GCM_METRICS_NUM_BUCKETS; i++)
+			snapshot->latency_buckets[i] += atomic_load_explicit(&shard->latency_buckets[i],
+									     memory_order_relaxed);
+		snapshot->latency_sum_ns += atomic_load_explicit(&shard->latency_sum_ns, memory_order_relaxed);
+		snapshot->cpu_jobs += atomic_load_explicit(&shard->cpu_jobs, memory_order_relaxed);
+		for (i = 0; i < AES_GCM_MAX_TENANTS; i++) {
+			snapshot->tenant_ops[i] += atomic_load_explicit(&shard->tenant_ops[i], memory_order_relaxed);
+			snapshot->tenant_bytes[i] += atomic_load_explicit(&shard->tenant_bytes[i],
+									  memory_order_relaxed);
+			snapshot->tenant_throttles[i] += atomic_load_explicit(&shard->tenant_throttles[i],
+									      memory_order_relaxed);
+		}
+	}
+	pthread_mutex_unlock(&shards_lock);
+
+	for (i = 0; i < AES_GCM_METRICS_NUM_GAUGES; i++)
+		snapshot->gauges[i] = atomic_load_explicit(&gauges[i], memory_order_relaxed);
+}
+
+/*
+ * Print the aggregated metrics in the Prometheus text format
+ *
+ * @out [in]: Output stream
+ */
+static void print_metrics(FILE *out)
+{
+	static const char *const mode_names[2] = {"encrypt", "decrypt"};
+	struct metrics_snapshot snapshot;
+	uint64_t count = 0;
+	uint32_t i;
+
+	take_snapshot(&snapshot);
+
+	fprintf(out, "# HELP " AES_GCM_METRICS_PREFIX "ops_total Jobs completed successfully\n");
+	fprintf(out, "# TYPE " AES_GCM_METRICS_PREFIX "ops_total counter\n");
+	for (i = 0; i < 2; i++)
+		fprintf(out, AES_GCM_METRICS_PREFIX "ops_total{mode=\"%s\"} %lu\n", mode_names[i], snapshot.ops[i]);
+
+	fprintf(out, "# HELP " AES_GCM_METRICS_PREFIX "bytes_total Source bytes of the jobs completed successfully\n");
+	fprintf(out, "# TYPE " AES_GCM_METRICS_PREFIX "bytes_total counter\n");
+	for (i = 0; i < 2; i++)
+		fprintf(out, AES_GCM_METRICS_PREFIX "bytes_total{mode=\"%s\"} %lu\n", mode_names[i], snapshot.bytes[i]);
+
+	fprintf(out, "# HELP " AES_GCM_METRICS_PREFIX "errors_total Failed jobs by DOCA error\n");
+	fprintf(out, "# TYPE " AES_GCM_METRICS_PREFIX "errors_total counter\n");
+	for (i = 0; i < AES_GCM_METRICS_NUM_ERRORS; i++) {
+		if (snapshot.errors[i] != 0)
+			fprintf(out,
+				AES_GCM_METRICS_PREFIX "errors_total{error=\"%s\"} %lu\n",
+				doca_error_get_name((doca_error_t)i),
+				snapshot.errors[i]);
+	}
+
+	fprintf(out, "# HELP " AES_GCM_METRICS_PREFIX "cpu_fallback_jobs_total Jobs that ran on the CPU\n");
+	fprintf(out, "# TYPE " AES_GCM_METRICS_PREFIX "cpu_fallback_jobs_total counter\n");
+	fprintf(out, AES_GCM_METRICS_PREFIX "cpu_fallback_jobs_total %lu\n", snapshot.cpu_jobs);
+
+	fprintf(out, "# HELP " AES_GCM_METRICS_PREFIX "latency_seconds Job latency from submission to completion\n");
+	fprintf(out, "# TYPE " AES_GCM_METRICS_PREFIX "latency_seconds histogram\n");
+	for (i = 0; i < AES_GCM_METRICS_NUM_BUCKETS; i++) {
+		count += snapshot.latency_buckets[i];
+		if (i < AES_GCM_METRICS_NUM_BUCKETS - 1)
+			fprintf(out,
+				AES_GCM_METRICS_PREFIX "latency_seconds_bucket{le=\"%g\"} %lu\n",
+				(double)latency_bounds_ns[i] / 1e9,
+				count);
+		else
+			fprintf(out, AES_GCM_METRICS_PREFIX "latency_seconds_bucket{le=\"+Inf\"} %lu\n", count);
+	}
+	fprintf(out, AES_GCM_METRICS_PREFIX "latency_seconds_sum %.9f\n", (double)snapshot.latency_sum_ns / 1e9);
+	fprintf(out, AES_GCM_METRICS_PREFIX "latency_seconds_count %lu\n", count);
+
+	/* Tenants only show up once the fair share scheduler saw them */
+	fprintf(out, "# HELP " AES_GCM_METRICS_PREFIX "tenant_ops_total Jobs dispatched per fair share tenant\n");
+	fprintf(out, "# TYPE " AES_GCM_METRICS_PREFIX "tenant_ops_total counter\n");
+	for (i = 0; i < AES_GCM_MAX_TENANTS; i++) {
+		if (snapshot.tenant_ops[i] != 0 || snapshot.tenant_throttles[i] != 0)
+			fprintf(out,
+				AES_GCM_METRICS_PREFIX "tenant_ops_total{tenant=\"%u\"} %lu\n",
+				i,
+				snapshot.tenant_ops[i]);
+	}
+	fprintf(out,
+		"# HELP " AES_GCM_METRICS_PREFIX "tenant_bytes_total Source bytes dispatched per fair share tenant\n");
+	fprintf(out, "# TYPE " AES_GCM_METRICS_PREFIX "tenant_bytes_total counter\n");
+	for (i = 0; i < AES_GCM_MAX_TENANTS; i++) {
+		if (snapshot.tenant_ops[i] != 0 || snapshot.tenant_throttles[i] != 0)
+			fprintf(out,
+				AES_GCM_METRICS_PREFIX "tenant_bytes_total{tenant=\"%u\"} %lu\n",
+				i,
+				snapshot.tenant_bytes[i]);
+	}
+	fprintf(out,
+		"# HELP " AES_GCM_METRICS_PREFIX
+		"tenant_throttled_total Times a fair share tenant ran out of tokens with jobs queued\n");
+	fprintf(out, "# TYPE " AES_GCM_METRICS_PREFIX "tenant_throttled_total counter\n");
+	for (i = 0; i < AES_GCM_MAX_TENANTS; i++) {
+		if (snapshot.tenant_ops[i] != 0 || snapshot.tenant_throttles[i] != 0)
+			fprintf(out,
+				AES_GCM_METRICS_PREFIX "tenant_throttled_total{tenant=\"%u\"} %lu\n",
+				i,
+				snapshot.tenant_throttles[i]);
+	}
+
+	for (i = 0; i < AES_GCM_METRICS_NUM_GAUGES; i++) {
+		fprintf(out, "# HELP " AES_GCM_METRICS_PREFIX "%s %s\n", gauge_names[i][0], gauge_names[i][1]);
+		fprintf(out, "# TYPE " AES_GCM_METRICS_PREFIX "%s gauge\n", gauge_names[i][0]);
+		fprintf(out, AES_GCM_METRICS_PREFIX "%s %ld\n", gauge_names[i][0], snapshot.gauges[i]);
+	}
+}
+
+doca_error_t aes_gcm_metrics_write_file(const char *path)
+{
+	char tmp_path[MAX_FILE_NAME + 8];
+	FILE *out;
+
+	snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+	out = fopen(tmp_path, "w");
+	if (out == NULL) {
+		DOCA_LOG_ERR("Unable to open metrics file %s: %s", tmp_path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	print_metrics(out);
+	if (fclose(out) != 0 || rename(tmp_path, path) != 0) {
+		DOCA_LOG_ERR("Failed to write metrics file %s: %s", path, strerror(errno));
+		(void)unlink(tmp_path);
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Answer an HTTP client with the metrics, whatever it asked for
+ *
+ * @fd [in]: Client socket
+ */
+static void serve_client(int fd)
+{
+	struct pollfd pfd = {.fd = fd, .events = POLLIN};
+	char request[1024], header[128];
+	char *body = NULL;
+	size_t body_len = 0, sent;
+	ssize_t n;
+	FILE *out;
+
+	/* The request itself does not matter, read it so the client does not see a reset */
+	if (poll(&pfd, 1, 100) > 0)
+		(void)read(fd, request, sizeof(request));
+
+	out = open_memstream(&body, &body_len);
+	if (out == NULL)
+		return;
+	print_metrics(out);
+	fclose(out);
+
+	snprintf(header,
+		 sizeof(header),
+		 "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\n\r\n",
+		 body_len);
+	if (write(fd, header, strlen(header)) < 0)
+		goto free_body;
+	for (sent = 0; sent < body_len; sent += n) {
+		n = write(fd, body + sent, body_len - sent);
+		if (n <= 0)
+			break;
+	}
+
+free_body:
+	free(body);
+}
+
+/*
+ * Exporter thread, refreshes the metrics file and serves the HTTP clients
+ *
+ * @arg [in]: Unused
+ * @return: NULL
+ */
+static void *exporter_thread(void *arg)
+{
+	struct pollfd pfd = {.fd = exporter.listen_fd, .events = POLLIN};
+	uint64_t next_write_ns = 0, now_ns;
+	int client_fd;
+
+	(void)arg;
+	while (atomic_load(&exporter.running)) {
+		now_ns = aes_gcm_get_time_ns();
+		if (exporter.path[0] != '\0' && now_ns >= next_write_ns) {
+			(void)aes_gcm_metrics_write_file(exporter.path);
+			next_write_ns = now_ns + (AES_GCM_METRICS_INTERVAL_MS * 1000000ULL);
+		}
+
+		/* Without a listening socket poll() only waits, a negative fd is ignored */
+		if (poll(&pfd, 1, 100) > 0 && (pfd.revents & POLLIN) != 0) {
+			client_fd = accept(exporter.listen_fd, NULL, NULL);
+			if (client_fd >= 0) {
+				serve_client(client_fd);
+				close(client_fd);
+			}
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Open the HTTP listening socket on the loopback interface
+ *
+ * @port [in]: TCP port
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t open_listener(uint16_t port)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(port),
+		.sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+	};
+	int one = 1;
+
+	exporter.listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (exporter.listen_fd < 0) {
+		DOCA_LOG_ERR("Unable to create the metrics socket: %s", strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+	(void)setsockopt(exporter.listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+	if (bind(exporter.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+	    listen(exporter.listen_fd, 8) != 0) {
+		DOCA_LOG_ERR("Unable to serve the metrics on 127.0.0.1:%u: %s", port, strerror(errno));
+		close(exporter.listen_fd);
+		exporter.listen_fd = -1;
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_metrics_start(const struct aes_gcm_cfg *cfg)
+{
+	doca_error_t result;
+
+	if (cfg->metrics_path[0] == '\0' && cfg->metrics_port == 0)
+		return DOCA_SUCCESS;
+
+	strcpy(exporter.path, cfg->metrics_path);
+	if (cfg->metrics_port != 0) {
+		result = open_listener(cfg->metrics_port);
+		if (result != DOCA_SUCCESS)
+			return result;
+	}
+
+	atomic_store(&exporter.running, true);
+	if (pthread_create(&exporter.thread, NULL, exporter_thread, NULL) != 0) {
+		DOCA_LOG_ERR("Failed to start the metrics exporter thread");
+		if (exporter.listen_fd >= 0) {
+			close(exporter.listen_fd);
+			exporter.listen_fd = -1;
+		}
+		return DOCA_ERROR_OPERATING_SYSTEM;
+	}
+	exporter.started = true;
+
+	if (cfg->metrics_port != 0)
+		DOCA_LOG_INFO("Serving the metrics on http://127.0.0.1:%u/metrics", cfg->metrics_port);
+	return DOCA_SUCCESS;
+}
+
+void aes_gcm_metrics_stop(void)
+{
+	if (!exporter.started)
+		return;
+
+	atomic_store(&exporter.running, false);
+	pthread_join(exporter.thread, NULL);
+	exporter.started = false;
+
+	if (exporter.listen_fd >= 0) {
+		close(exporter.listen_fd);
+		exporter.listen_fd = -1;
+	}
+
+	/* The last jobs completed after the last refresh */
+	if (exporter.path[0] != '\0')
+		(void)aes_gcm_metrics_write_file(exporter.path);
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+
+#ifndef AES_GCM_METRICS_H_
+#define AES_GCM_METRICS_H_
+
+#include <stdint.h>
+
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+
+#define AES_GCM_METRICS_NUM_ERRORS 64	       /* doca_error_t values tracked, larger ones count as unknown */
+#define AES_GCM_METRICS_NUM_BUCKETS 14	       /* Latency histogram buckets, the last one is +Inf */
+#define AES_GCM_METRICS_INTERVAL_MS 1000       /* Metrics file refresh period */
+#define AES_GCM_METRICS_PREFIX "doca_aes_gcm_" /* Prefix of the exported metric names */
+
+/* Gauges, shared by all threads and updated with deltas */
+enum aes_gcm_metrics_gauge {
+	AES_GCM_METRICS_INFLIGHT_TASKS,	  /* Tasks submitted to the devices and not completed yet */
+	AES_GCM_METRICS_TASK_SLOTS,	  /* Tasks the device groups may keep in flight */
+	AES_GCM_METRICS_REGISTERED_BYTES, /* Memory registered with the devices */
+	AES_GCM_METRICS_HUGEPAGE_BYTES,	  /* Registered memory backed by huge pages */
+	AES_GCM_METRICS_NUM_GAUGES,	  /* Number of gauges */
+};
+
+/*
+ * Account a completed job to the counters of the calling thread
+ *
+ * Successful jobs count as an operation of their mode with their source bytes and latency, failed jobs count as an
+ * error of their status. The counters of all threads are summed up when the metrics are exported.
+ *
+ * @job [in]: The completed job, job->result, submit_ns and complete_ns must be set
+ */
+void aes_gcm_metrics_job_done(const struct aes_gcm_job *job);
+
+/*
+ * Account a job that ran on the CPU after the devices failed it
+ */
+void aes_gcm_metrics_cpu_job(void);
+
+/*
+ * Account a job the fair share scheduler handed to the devices
+ *
+ * @tenant [in]: Tenant index, below AES_GCM_MAX_TENANTS
+ * @bytes [in]: Source bytes of the job
+ */
+void aes_gcm_metrics_tenant_dispatch(uint32_t tenant, uint64_t bytes);
+
+/*
+ * Account a tenant running out of tokens while it has jobs queued
+ *
+ * @tenant [in]: Tenant index, below AES_GCM_MAX_TENANTS
+ */
+void aes_gcm_metrics_tenant_throttled(uint32_t tenant);
+
+/*
+ * Add to a gauge
+ *
+ * @gauge [in]: The gauge
+ * @delta [in]: Value to add, negative to subtract
+ */
+void aes_gcm_metrics_gauge_add(enum aes_gcm_metrics_gauge gauge, int64_t delta);
+
+/*
+ * Write the aggregated metrics to a file in the Prometheus text format
+ *
+ * The file is replaced atomically, so a node exporter textfile collector never reads it half written.
+ *
+ * @path [in]: File path
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_metrics_write_file(const char *path);
+
+/*
+ * Start exporting the metrics when cfg->metrics_path or cfg->metrics_port is set
+ *
+ * An exporter thread refreshes the metrics file every AES_GCM_METRICS_INTERVAL_MS and serves the metrics over HTTP on
+ * 127.0.0.1:cfg->metrics_port.
+ *
+ * @cfg [in]: Configuration parameters
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_metrics_start(const struct aes_gcm_cfg *cfg);
+
+/*
+ * Stop the exporter thread, writing the metrics file a last time
+ */
+void aes_gcm_metrics_stop(void);
+
+#endif /* AES_GCM_METRICS_H_ */
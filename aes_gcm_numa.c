@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+
+#include <doca_log.h>
+
+#include "aes_gcm_numa.h"
+
+DOCA_LOG_REGISTER(AES_GCM::NUMA);
+
+/*
+ * Read the first line of a sysfs attribute
+ *
+ * @path [in]: Attribute path
+ * @line [out]: Attribute value, without the trailing newline
+ * @size [in]: line buffer size
+ * @return: true if the attribute was read
+ */
+static bool read_sysfs_line(const char *path, char *line, size_t size)
+{
+	FILE *file;
+	bool found;
+
+	file = fopen(path, "r");
+	if (file == NULL)
+		return false;
+	found = (fgets(line, size, file) != NULL);
+	fclose(file);
+	if (found)
+		line[strcspn(line, "\n")] = '\0';
+	return found;
+}
+
+/*
+ * Parse a sysfs CPU list, e.g. "0-15,32-47"
+ *
+ * @list [in]: CPU list
+ * @cpus [out]: The CPUs of the list
+ * @return: number of CPUs in the list
+ */
+static int parse_cpu_list(const char *list, cpu_set_t *cpus)
+{
+	const char *pos = list;
+	char *end;
+	long first, last, cpu;
+
+	CPU_ZERO(cpus);
+	while (*pos != '\0') {
+		first = strtol(pos, &end, 10);
+		if (end == pos)
+			break;
+		last = first;
+		if (*end == '-') {
+			pos = end + 1;
+			last = strtol(pos, &end, 10);
+		}
+		for (cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++)
+			CPU_SET(cpu, cpus);
+		pos = (*end == ',') ? end + 1 : end;
+		if (*end != ',')
+			break;
+	}
+	return CPU_COUNT(cpus);
+}
+
+int aes_gcm_numa_device_node(const char *pci_addr)
+{
+	char path[128], line[AES_GCM_NUMA_CPU_LIST_SIZE];
+	int node;
+
+	/* DOCA may report the address without the PCI domain */
+	if (strchr(pci_addr, ':') == strrchr(pci_addr, ':'))
+		snprintf(path, sizeof(path), "/sys/bus/pci/devices/0000:%s/numa_node", pci_addr);
+	else
+		snprintf(path, sizeof(path), "/sys/bus/pci/devices/%s/numa_node", pci_addr);
+
+	if (!read_sysfs_line(path, line, sizeof(line)))
+		return AES_GCM_NUMA_NODE_UNKNOWN;
+
+	node = atoi(line);
+	return (node >= 0) ? node : AES_GCM_NUMA_NODE_UNKNOWN;
+}
+
+void aes_gcm_numa_placement_init(int node, struct aes_gcm_numa_placement *placement)
+{
+	char path[128];
+	cpu_set_t cpus;
+
+	memset(placement, 0, sizeof(*placement));
+	placement->node = AES_GCM_NUMA_NODE_UNKNOWN;
+	placement->src_node = AES_GCM_NUMA_NODE_UNKNOWN;
+	placement->dst_node = AES_GCM_NUMA_NODE_UNKNOWN;
+	if (node == AES_GCM_NUMA_NODE_UNKNOWN)
+		return;
+
+	snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+	if (!read_sysfs_line(path, placement->cpu_list, sizeof(placement->cpu_list)) ||
+	    parse_cpu_list(placement->cpu_list, &cpus) == 0) {
+		DOCA_LOG_WARN("Unable to read the cores of NUMA node %d, placement is off", node);
+		return;
+	}
+	placement->node = node;
+}
+
+doca_error_t aes_gcm_numa_pin_thread(const struct aes_gcm_numa_placement *placement)
+{
+	cpu_set_t cpus;
+	int ret;
+
+	if (placement->node == AES_GCM_NUMA_NODE_UNKNOWN)
+		return DOCA_SUCCESS;
+
+	(void)parse_cpu_list(placement->cpu_list, &cpus);
+	ret = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+	if (ret != 0) {
+		DOCA_LOG_WARN("Unable to pin thread to NUMA node %d: %s", placement->node, strerror(ret));
+		return DOCA_ERROR_OPERATING_SYSTEM;
+	}
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_numa_bind(const struct aes_gcm_numa_placement *placement, void *addr, size_t len)
+{
+	unsigned long nodemask;
+	uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+	uintptr_t start, end;
+
+	if (placement->node == AES_GCM_NUMA_NODE_UNKNOWN)
+		return DOCA_SUCCESS;
+	if (placement->node >= (int)(sizeof(nodemask) * 8))
+		return DOCA_ERROR_NOT_SUPPORTED;
+
+	start = ((uintptr_t)addr + page_size - 1) & ~(page_size - 1);
+	end = ((uintptr_t)addr + len) & ~(page_size - 1);
+	if (end <= start)
+		return DOCA_SUCCESS;
+
+	nodemask = 1UL << placement->node;
+	/* The kernel expects the number of bits in the mask plus one */
+	if (syscall(SYS_mbind,
+		    (void *)start,
+		    end - start,
+		    MPOL_PREFERRED,
+		    &nodemask,
+		    sizeof(nodemask) * 8 + 1,
+		    MPOL_MF_MOVE) != 0) {
+		DOCA_LOG_WARN("Unable to bind memory to NUMA node %d: %s", placement->node, strerror(errno));
+		return DOCA_ERROR_OPERATING_SYSTEM;
+	}
+	return DOCA_SUCCESS;
+}
+
+int aes_gcm_numa_memory_node(void *addr)
+{
+	int node;
+
+	if (syscall(SYS_get_mempolicy, &node, NULL, 0, addr, MPOL_F_NODE | MPOL_F_ADDR) != 0)
+		return AES_GCM_NUMA_NODE_UNKNOWN;
+	return node;
+}
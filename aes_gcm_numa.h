@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_NUMA_H_
+#define AES_GCM_NUMA_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <doca_error.h>
+
+#define AES_GCM_NUMA_NODE_UNKNOWN (-1) /* Device or buffer with no known NUMA node */
+#define AES_GCM_NUMA_CPU_LIST_SIZE 256 /* Max length of a node CPU list, e.g. "0-15,32-47" */
+
+/* NUMA node and local cores the buffers and threads of a device group are placed on */
+struct aes_gcm_numa_placement {
+	int node;				   /* NUMA node, AES_GCM_NUMA_NODE_UNKNOWN when placement is off */
+	char cpu_list[AES_GCM_NUMA_CPU_LIST_SIZE]; /* Cores local to the node, in sysfs CPU list format */
+	bool thread_pinned;			   /* The progress thread was pinned to the local cores */
+	int src_node;				   /* Node the source memory ended up on */
+	int dst_node;				   /* Node the destination memory ended up on */
+	size_t bound_bytes;			   /* Registered memory bound to the node */
+};
+
+/*
+ * Get the NUMA node a PCI device is attached to, from sysfs
+ *
+ * @pci_addr [in]: Device PCI address, with or without the PCI domain
+ * @return: the NUMA node, or AES_GCM_NUMA_NODE_UNKNOWN on a single node host or when it is not exposed
+ */
+int aes_gcm_numa_device_node(const char *pci_addr);
+
+/*
+ * Set up the placement on a NUMA node, reading the cores of the node from sysfs
+ *
+ * @node [in]: NUMA node, AES_GCM_NUMA_NODE_UNKNOWN disables the placement
+ * @placement [out]: The placement
+ */
+void aes_gcm_numa_placement_init(int node, struct aes_gcm_numa_placement *placement);
+
+/*
+ * Pin the calling thread to the cores of the placement
+ *
+ * @placement [in]: The placement
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_numa_pin_thread(const struct aes_gcm_numa_placement *placement);
+
+/*
+ * Bind a memory range to the node of the placement, pages already touched are migrated to it
+ *
+ * Only the pages fully inside the range are bound, so heap neighbours of a malloc() buffer are left alone. The policy
+ * is a preference: when the node runs out of memory the pages are placed elsewhere rather than failing.
+ *
+ * @placement [in]: The placement
+ * @addr [in]: Memory range address
+ * @len [in]: Memory range length
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_numa_bind(const struct aes_gcm_numa_placement *placement, void *addr, size_t len);
+
+/*
+ * Get the NUMA node a memory address resides on, faulting the page in if needed
+ *
+ * @addr [in]: Memory address
+ * @return: the NUMA node, or AES_GCM_NUMA_NODE_UNKNOWN
+ */
+int aes_gcm_numa_memory_node(void *addr);
+
+#endif /* AES_GCM_NUMA_H_ */
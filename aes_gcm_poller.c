@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#include <doca_log.h>
+
+#include "aes_gcm_poller.h"
+
+DOCA_LOG_REGISTER(AES_GCM::POLLER);
+
+/*
+ * Completion callback of the jobs handed off to the poller
+ *
+ * @job [in]: The completed job, job->user_data is its completion flag
+ */
+static void poller_job_done(struct aes_gcm_job *job)
+{
+	struct aes_gcm_poll_flag *flag = (struct aes_gcm_poll_flag *)job->user_data;
+
+	/* Release: job->result and the output are visible to the waiter once it sees the flag */
+	atomic_store_explicit(&flag->done, true, memory_order_release);
+}
+
+/*
+ * Take the next job off the ring
+ *
+ * @ring [in]: The ring
+ * @return: the job, or NULL if the ring is empty
+ */
+static struct aes_gcm_job *ring_pop(struct aes_gcm_spsc_ring *ring)
+{
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	struct aes_gcm_job *job;
+
+	if (head == atomic_load_explicit(&ring->tail, memory_order_acquire))
+		return NULL;
+
+	job = ring->slots[head & (AES_GCM_POLLER_RING_SIZE - 1)];
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+	return job;
+}
+
+/*
+ * Pin the progress thread
+ *
+ * @poller [in]: The poller
+ */
+static void pin_progress_thread(struct aes_gcm_poller *poller)
+{
+	cpu_set_t cpus;
+	int ret;
+
+	if (poller->cpu < 0) {
+		(void)aes_gcm_numa_pin_thread(&poller->group->numa);
+		return;
+	}
+
+	CPU_ZERO(&cpus);
+	CPU_SET(poller->cpu, &cpus);
+	ret = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+	if (ret != 0)
+		DOCA_LOG_WARN("Unable to pin the progress thread to core %d: %s", poller->cpu, strerror(ret));
+}
+
+/*
+ * Thread body - hand the queued jobs to the device group and progress it without ever sleeping
+ *
+ * @arg [in]: struct aes_gcm_poller *
+ * @return: NULL
+ */
+static void *poller_thread(void *arg)
+{
+	struct aes_gcm_poller *poller = (struct aes_gcm_poller *)arg;
+	struct aes_gcm_device_group *group = poller->group;
+	struct aes_gcm_job *job;
+
+	pin_progress_thread(poller);
+
+	while (atomic_load_explicit(&poller->running, memory_order_acquire) || group->inflight > 0 ||
+	       group->num_pending != 0 ||
+	       atomic_load_explicit(&poller->ring.head, memory_order_relaxed) !=
+		       atomic_load_explicit(&poller->ring.tail, memory_order_acquire)) {
+		while ((job = ring_pop(&poller->ring)) != NULL)
+			aes_gcm_device_group_submit(group, poller->key, job);
+		/* Whatever was handed off so far goes out with one doorbell per member */
+		aes_gcm_device_group_flush(group);
+
+		poller->num_polls++;
+		if (aes_gcm_device_group_progress(group) == 0)
+			poller->num_empty_polls++;
+	}
+
+	return NULL;
+}
+
+doca_error_t aes_gcm_poller_start(struct aes_gcm_poller *poller,
+				  struct aes_gcm_device_group *group,
+				  struct aes_gcm_group_key *key,
+				  int cpu)
+{
+	int ret;
+
+	memset(poller, 0, sizeof(*poller));
+	poller->group = group;
+	poller->key = key;
+	poller->cpu = cpu;
+	atomic_init(&poller->ring.head, 0);
+	atomic_init(&poller->ring.tail, 0);
+	atomic_init(&poller->running, true);
+
+	ret = pthread_create(&poller->thread, NULL, poller_thread, poller);
+	if (ret != 0) {
+		DOCA_LOG_ERR("Failed to create the progress thread: %s", strerror(ret));
+		return DOCA_ERROR_OPERATING_SYSTEM;
+	}
+	return DOCA_SUCCESS;
+}
+
+void aes_gcm_poller_stop(struct aes_gcm_poller *poller)
+{
+	atomic_store_explicit(&poller->running, false, memory_order_release);
+	pthread_join(poller->thread, NULL);
+}
+
+bool aes_gcm_poller_submit(struct aes_gcm_poller *poller, struct aes_gcm_job *job, struct aes_gcm_poll_flag *flag)
+{
+	struct aes_gcm_spsc_ring *ring = &poller->ring;
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+	if (tail - atomic_load_explicit(&ring->head, memory_order_acquire) == AES_GCM_POLLER_RING_SIZE)
+		return false;
+
+	atomic_store_explicit(&flag->done, false, memory_order_relaxed);
+	job->done_cb = poller_job_done;
+	job->user_data = flag;
+	ring->slots[tail & (AES_GCM_POLLER_RING_SIZE - 1)] = job;
+	/* Release: the job is fully written before the progress thread can see it */
+	atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+	return true;
+}
+
+void aes_gcm_poller_wait(struct aes_gcm_poll_flag *flag)
+{
+	while (!atomic_load_explicit(&flag->done, memory_order_acquire))
+		;
+}
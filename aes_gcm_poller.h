@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_POLLER_H_
+#define AES_GCM_POLLER_H_
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+#include "aes_gcm_device_group.h"
+
+#define AES_GCM_CACHE_LINE_SIZE 64				/* Size of a cache line */
+#define AES_GCM_CACHE_ALIGNED _Alignas(AES_GCM_CACHE_LINE_SIZE)	/* Start a field on its own cache line */
+#define AES_GCM_POLLER_RING_SIZE 256				/* Ring capacity, a power of 2 */
+
+/* Completion flag of a job handed off to the poller, alone on its cache line so waiters do not share it */
+struct aes_gcm_poll_flag {
+	AES_GCM_CACHE_ALIGNED atomic_bool done; /* Set once the job completed */
+};
+
+/* Single producer, single consumer ring of jobs, the producer and consumer indexes live on separate cache lines */
+struct aes_gcm_spsc_ring {
+	AES_GCM_CACHE_ALIGNED atomic_size_t head;				   /* Next slot to consume */
+	AES_GCM_CACHE_ALIGNED atomic_size_t tail;				   /* Next slot to produce */
+	AES_GCM_CACHE_ALIGNED struct aes_gcm_job *slots[AES_GCM_POLLER_RING_SIZE]; /* Jobs */
+};
+
+/*
+ * Dedicated progress thread that busy-polls a device group, used by the latency benchmark. The other flows progress
+ * their device group from their own thread, cfg->low_latency only makes that thread spin instead of sleeping.
+ */
+struct aes_gcm_poller {
+	struct aes_gcm_spsc_ring ring;		   /* Jobs handed off by the submitter */
+	struct aes_gcm_device_group *group;	   /* The device group, owned by the progress thread */
+	struct aes_gcm_group_key *key;		   /* Key of the jobs */
+	int cpu;				   /* Core of the progress thread, -1 for the group NUMA cores */
+	pthread_t thread;			   /* Progress thread */
+	uint64_t num_polls;			   /* Progress calls made by the thread */
+	uint64_t num_empty_polls;		   /* Progress calls that completed nothing */
+	AES_GCM_CACHE_ALIGNED atomic_bool running; /* Cleared to stop the thread */
+};
+
+/*
+ * Start a progress thread that owns a started device group
+ *
+ * From then on the group must only be used through the poller, until aes_gcm_poller_stop() returns.
+ *
+ * @poller [out]: The poller
+ * @group [in]: The started device group
+ * @key [in]: Key the jobs run with
+ * @cpu [in]: Core to pin the thread to, -1 for the cores of the group NUMA node
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_poller_start(struct aes_gcm_poller *poller,
+				  struct aes_gcm_device_group *group,
+				  struct aes_gcm_group_key *key,
+				  int cpu);
+
+/*
+ * Stop the progress thread once the jobs handed off to it completed
+ *
+ * @poller [in]: The poller
+ */
+void aes_gcm_poller_stop(struct aes_gcm_poller *poller);
+
+/*
+ * Hand off a job to the progress thread, must always be called from the same thread
+ *
+ * The poller takes over job->done_cb and job->user_data. The flag is set once the job completed, job->result is then
+ * valid.
+ *
+ * @poller [in]: The poller
+ * @job [in]: The job
+ * @flag [in]: Completion flag of the job
+ * @return: true if the job was handed off, false if the ring is full
+ */
+bool aes_gcm_poller_submit(struct aes_gcm_poller *poller, struct aes_gcm_job *job, struct aes_gcm_poll_flag *flag);
+
+/*
+ * Spin until a job handed off to the poller completed
+ *
+ * @flag [in]: Completion flag of the job
+ */
+void aes_gcm_poller_wait(struct aes_gcm_poll_flag *flag);
+
+#endif /* AES_GCM_POLLER_H_ */
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <doca_log.h>
+
+#include "aes_gcm_queue_depth.h"
+
+DOCA_LOG_REGISTER(AES_GCM::QUEUE_DEPTH);
+
+/*
+ * Set a new depth, bounded by the controller limits
+ *
+ * @qd [in]: The controller
+ * @depth [in]: Requested depth
+ */
+static void set_depth(struct aes_gcm_qd_controller *qd, uint32_t depth)
+{
+	if (depth < AES_GCM_QD_MIN_DEPTH)
+		depth = AES_GCM_QD_MIN_DEPTH;
+	if (depth > qd->max_depth)
+		depth = qd->max_depth;
+
+	if (depth > qd->depth)
+		qd->num_increases++;
+	else if (depth < qd->depth)
+		qd->num_decreases++;
+	else
+		return;
+
+	DOCA_LOG_DBG("Queue depth %u -> %u, latency %.1f us", qd->depth, depth, qd->latency_ewma_ns / 1e3);
+	qd->depth = depth;
+	if (depth > qd->peak_depth)
+		qd->peak_depth = depth;
+}
+
+void aes_gcm_qd_init(struct aes_gcm_qd_controller *qd, uint32_t max_depth, uint64_t target_latency_ns)
+{
+	*qd = (struct aes_gcm_qd_controller){0};
+	qd->max_depth = (max_depth < AES_GCM_QD_MIN_DEPTH) ? AES_GCM_QD_MIN_DEPTH : max_depth;
+	qd->target_latency_ns = target_latency_ns;
+	qd->slow_start = true;
+	qd->depth = (target_latency_ns == 0) ? qd->max_depth : AES_GCM_QD_MIN_DEPTH;
+	qd->peak_depth = qd->depth;
+}
+
+void aes_gcm_qd_on_completion(struct aes_gcm_qd_controller *qd, uint64_t latency_ns, uint64_t bytes, uint64_t now_ns)
+{
+	double avg_latency_ns, throughput;
+
+	if (qd->latency_ewma_ns == 0)
+		qd->latency_ewma_ns = (double)latency_ns;
+	else
+		qd->latency_ewma_ns += ((double)latency_ns - qd->latency_ewma_ns) / 8;
+
+	if (qd->target_latency_ns == 0)
+		return;
+
+	/* The first task of a window was submitted one latency before it completed */
+	if (qd->window_completions == 0)
+		qd->window_start_ns = now_ns - latency_ns;
+	qd->window_completions++;
+	qd->window_latency_ns += latency_ns;
+	qd->window_bytes += bytes;
+	if (qd->window_completions < qd->depth)
+		return;
+
+	avg_latency_ns = (double)qd->window_latency_ns / qd->window_completions;
+	throughput = 0;
+	if (now_ns > qd->window_start_ns)
+		throughput = (double)qd->window_bytes / (double)(now_ns - qd->window_start_ns);
+
+	if (avg_latency_ns > (double)qd->target_latency_ns) {
+		qd->slow_start = false;
+		set_depth(qd, qd->depth - qd->depth / 2);
+	} else if (qd->slow_start) {
+		set_depth(qd, qd->depth * 2);
+		if (qd->depth == qd->max_depth)
+			qd->slow_start = false;
+	} else if (throughput >= qd->last_throughput * (1 - AES_GCM_QD_THROUGHPUT_TOLERANCE)) {
+		set_depth(qd, qd->depth + 1);
+	}
+
+	qd->last_throughput = throughput;
+	qd->window_completions = 0;
+	qd->window_latency_ns = 0;
+	qd->window_bytes = 0;
+}
+
+bool aes_gcm_qd_can_submit(const struct aes_gcm_qd_controller *qd, const struct aes_gcm_resources *resources)
+{
+	return resources->num_remaining_tasks < qd->depth;
+}
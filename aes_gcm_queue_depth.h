@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_QUEUE_DEPTH_H_
+#define AES_GCM_QUEUE_DEPTH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "aes_gcm_common.h"
+
+#define AES_GCM_QD_MIN_DEPTH 1		     /* The controller never goes below one task in flight */
+#define AES_GCM_QD_THROUGHPUT_TOLERANCE 0.05 /* Throughput drop that stops additive increase */
+
+/* Queue depth controller of a single context */
+struct aes_gcm_qd_controller {
+	uint32_t depth;		     /* Number of tasks allowed in flight */
+	uint32_t max_depth;	     /* Task pool size of the context */
+	uint64_t target_latency_ns;  /* Completion latency target, 0 keeps the depth at max_depth */
+	bool slow_start;	     /* Depth doubles every window until the target is first exceeded */
+	uint64_t window_start_ns;    /* Timestamp of the current window start */
+	uint32_t window_completions; /* Completions in the current window */
+	uint64_t window_latency_ns;  /* Sum of the completion latencies in the current window */
+	uint64_t window_bytes;	     /* Source bytes completed in the current window */
+	double last_throughput;	     /* Throughput of the last window, in bytes per ns */
+	double latency_ewma_ns;	     /* Moving average of the completion latency */
+	uint32_t peak_depth;	     /* Highest depth reached */
+	uint32_t num_increases;	     /* Number of depth increases */
+	uint32_t num_decreases;	     /* Number of depth decreases */
+};
+
+/*
+ * Initialize a queue depth controller
+ *
+ * With a latency target the controller starts at one task in flight, doubles the depth every window while the
+ * average completion latency stays under the target, and then runs AIMD: the depth grows by one per window while the
+ * latency is under the target and the throughput did not drop, and is halved when the latency exceeds the target.
+ * A window lasts as many completions as the current depth.
+ *
+ * @qd [out]: The controller
+ * @max_depth [in]: Max number of tasks in flight, the context task pool size
+ * @target_latency_ns [in]: Completion latency target, 0 for a fixed depth of max_depth
+ */
+void aes_gcm_qd_init(struct aes_gcm_qd_controller *qd, uint32_t max_depth, uint64_t target_latency_ns);
+
+/*
+ * Feed a task completion to the controller
+ *
+ * @qd [in]: The controller
+ * @latency_ns [in]: Time from task submission to completion
+ * @bytes [in]: Source bytes of the task
+ * @now_ns [in]: Completion timestamp
+ */
+void aes_gcm_qd_on_completion(struct aes_gcm_qd_controller *qd, uint64_t latency_ns, uint64_t bytes, uint64_t now_ns);
+
+/*
+ * Check if the context may take another task
+ *
+ * @qd [in]: The controller
+ * @resources [in]: The context resources, num_remaining_tasks is compared to the current depth
+ * @return: true if another task can be submitted
+ */
+bool aes_gcm_qd_can_submit(const struct aes_gcm_qd_controller *qd, const struct aes_gcm_resources *resources);
+
+#endif /* AES_GCM_QUEUE_DEPTH_H_ */
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <doca_log.h>
+#include <doca_error.h>
+
+#include "aes_gcm_device_group.h"
+#include "aes_gcm_hugepage.h"
+#include "aes_gcm_record.h"
+
+DOCA_LOG_REGISTER(AES_GCM::RECORD);
+
+uint32_t aes_gcm_record_len(const char *data)
+{
+	uint32_t record_len;
+
+	memcpy(&record_len, data, sizeof(record_len));
+	return ntohl(record_len);
+}
+
+/*
+ * Walk the records of a stream once, to check the framing and size the jobs and the destination memory
+ *
+ * @cfg [in]: Configuration parameters
+ * @mode [in]: AES-GCM mode - encrypt/decrypt
+ * @file_data [in]: File data
+ * @file_size [in]: File size
+ * @num_records [out]: Number of records
+ * @dst_len [out]: Destination memory needed by all the records
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t scan_records(const struct aes_gcm_cfg *cfg,
+				 enum aes_gcm_mode mode,
+				 const char *file_data,
+				 size_t file_size,
+				 size_t *num_records,
+				 size_t *dst_len)
+{
+	size_t min_len = cfg->aad_size + ((mode == AES_GCM_MODE_DECRYPT) ? cfg->tag_size : 0);
+	size_t offset;
+	uint32_t record_len;
+
+	*num_records = 0;
+	*dst_len = 0;
+	for (offset = 0; offset < file_size; offset += AES_GCM_RECORD_LEN_SIZE + record_len) {
+		if (file_size - offset < AES_GCM_RECORD_LEN_SIZE) {
+			DOCA_LOG_ERR("Record %zu at offset %zu has a truncated length prefix", *num_records, offset);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		record_len = aes_gcm_record_len(file_data + offset);
+		if (record_len > file_size - offset - AES_GCM_RECORD_LEN_SIZE) {
+			DOCA_LOG_ERR("Record %zu at offset %zu is truncated", *num_records, offset);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		if (record_len < min_len) {
+			DOCA_LOG_ERR("Record %zu of %u bytes is too short to hold a %u bytes header%s",
+				     *num_records,
+				     record_len,
+				     cfg->aad_size,
+				     (mode == AES_GCM_MODE_DECRYPT) ? " and a tag" : "");
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+
+		if (mode == AES_GCM_MODE_ENCRYPT)
+			*dst_len += (size_t)record_len + cfg->tag_size;
+		else
+			*dst_len += record_len - cfg->tag_size;
+		(*num_records)++;
+	}
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Write the processed records to the output file, each with its length prefix
+ *
+ * @jobs [in]: The completed jobs, one per record
+ * @num_records [in]: Number of records
+ * @out_file [in]: Output file
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t write_records(const struct aes_gcm_job *jobs, size_t num_records, FILE *out_file)
+{
+	uint32_t record_len;
+	size_t i;
+
+	for (i = 0; i < num_records; i++) {
+		record_len = htonl((uint32_t)jobs[i].out_len);
+		if (fwrite(&record_len, sizeof(record_len), 1, out_file) != 1 ||
+		    fwrite(jobs[i].dst, sizeof(uint8_t), jobs[i].out_len, out_file) != jobs[i].out_len)
+			return DOCA_ERROR_IO_FAILED;
+	}
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_record_stream_file(struct aes_gcm_cfg *cfg,
+					enum aes_gcm_mode mode,
+					char *file_data,
+					size_t file_size)
+{
+	struct aes_gcm_device_group *group = NULL;
+	struct aes_gcm_group_key key = {0};
+	struct aes_gcm_job *jobs = NULL;
+	struct aes_gcm_job *job;
+	struct aes_gcm_mem dst_mem = {0};
+	char *dst_buffer;
+	FILE *out_file = NULL;
+	size_t num_records, dst_len, buf_len, num_failed = 0, offset, dst_offset, i;
+	uint32_t record_len;
+	uint64_t start_ns, elapsed_ns;
+	doca_error_t result, tmp_result;
+
+	if (file_size == 0) {
+		DOCA_LOG_ERR("Input file is empty");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	if (cfg->tag_index_path[0] != '\0' || cfg->compress_codec[0] != '\0') {
+		DOCA_LOG_ERR("Record mode does not support detached tags or compression");
+		return DOCA_ERROR_NOT_SUPPORTED;
+	}
+	if (cfg->num_tenants != 0 && cfg->aad_size == 0)
+		DOCA_LOG_WARN("Records have no header to name their tenant, they all go to tenant 0");
+
+	result = scan_records(cfg, mode, file_data, file_size, &num_records, &dst_len);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	out_file = fopen(cfg->output_path, "w");
+	if (out_file == NULL) {
+		DOCA_LOG_ERR("Unable to open output file: %s", cfg->output_path);
+		return DOCA_ERROR_NO_MEMORY;
+	}
+
+	result = aes_gcm_device_group_create(cfg, mode, &group);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create device group: %s", doca_error_get_descr(result));
+		goto close_file;
+	}
+
+	jobs = calloc(num_records, sizeof(*jobs));
+	if (jobs == NULL) {
+		result = DOCA_ERROR_NO_MEMORY;
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(result));
+		goto destroy_group;
+	}
+
+	/* Records with an empty payload and no header still need a valid range to register */
+	result = aes_gcm_mem_alloc(cfg->hugepages, (dst_len != 0) ? dst_len : 1, &dst_mem);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+	dst_buffer = dst_mem.addr;
+
+	offset = 0;
+	dst_offset = 0;
+	for (i = 0; i < num_records; i++) {
+		record_len = aes_gcm_record_len(file_data + offset);
+
+		job = &jobs[i];
+		job->src = file_data + offset + AES_GCM_RECORD_LEN_SIZE;
+		job->src_len = record_len;
+		job->dst = dst_buffer + dst_offset;
+		if (mode == AES_GCM_MODE_ENCRYPT)
+			job->dst_len = (size_t)record_len + cfg->tag_size;
+		else
+			job->dst_len = record_len - cfg->tag_size;
+		/* Sealing appends the tag, so the output is the larger buffer when encrypting */
+		buf_len = (mode == AES_GCM_MODE_ENCRYPT) ? job->dst_len : job->src_len;
+		if (buf_len > group->max_buf_size) {
+			DOCA_LOG_ERR("Record %zu of %zu bytes > max buffer size %lu", i, buf_len, group->max_buf_size);
+			result = DOCA_ERROR_INVALID_VALUE;
+			goto destroy_group;
+		}
+		aes_gcm_derive_iv(cfg->iv, cfg->iv_length, i, job->iv);
+		job->iv_length = cfg->iv_length;
+		job->tag_size = cfg->tag_size;
+		job->aad_size = cfg->aad_size;
+		/* The header is in the clear both ways, its first byte names the tenant of the record */
+		if (cfg->aad_size != 0)
+			job->tenant = (uint8_t)file_data[offset + AES_GCM_RECORD_LEN_SIZE];
+
+		offset += AES_GCM_RECORD_LEN_SIZE + record_len;
+		dst_offset += job->dst_len;
+	}
+
+	result = aes_gcm_device_group_start(group, file_data, file_size, dst_buffer, (dst_len != 0) ? dst_len : 1);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+
+	result = aes_gcm_device_group_key_create(group, cfg->raw_key, cfg->raw_key_type, &key);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+
+	DOCA_LOG_INFO("Processing %zu records on %u devices", num_records, group->num_members);
+
+	start_ns = aes_gcm_get_time_ns();
+	aes_gcm_device_group_submit_burst(group, &key, jobs, num_records);
+	aes_gcm_device_group_wait(group);
+	elapsed_ns = aes_gcm_get_time_ns() - start_ns;
+	aes_gcm_device_group_report(group, elapsed_ns);
+	if (elapsed_ns > 0)
+		DOCA_LOG_INFO("Processed %zu records in %.3f ms (%.0f records/s)",
+			      num_records,
+			      (double)elapsed_ns / 1e6,
+			      ((double)num_records * 1e9) / (double)elapsed_ns);
+
+	/* Every record stands on its own, report all of the failed ones */
+	for (i = 0; i < num_records; i++) {
+		if (jobs[i].result == DOCA_SUCCESS)
+			continue;
+		if (num_failed++ == 0)
+			result = jobs[i].result;
+		DOCA_LOG_ERR("Record %zu failed: %s", i, doca_error_get_descr(jobs[i].result));
+	}
+	if (num_failed != 0) {
+		DOCA_LOG_ERR("%zu of %zu records failed", num_failed, num_records);
+		goto destroy_key;
+	}
+
+	result = write_records(jobs, num_records, out_file);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to write to output file: %s", cfg->output_path);
+		goto destroy_key;
+	}
+	DOCA_LOG_INFO("%zu records were %s successfully and saved in: %s",
+		      num_records,
+		      (mode == AES_GCM_MODE_ENCRYPT) ? "encrypted" : "decrypted",
+		      cfg->output_path);
+
+destroy_key:
+	tmp_result = aes_gcm_device_group_key_destroy(group, &key);
+	DOCA_ERROR_PROPAGATE(result, tmp_result);
+destroy_group:
+	free(jobs);
+	tmp_result = aes_gcm_device_group_destroy(group);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to destroy device group: %s", doca_error_get_descr(tmp_result));
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+	aes_gcm_mem_free(&dst_mem);
+close_file:
+	fclose(out_file);
+
+	return result;
+}
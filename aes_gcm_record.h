@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+
+#ifndef AES_GCM_RECORD_H_
+#define AES_GCM_RECORD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+
+#define AES_GCM_RECORD_LEN_SIZE sizeof(uint32_t) /* Size of the length prefix of a record */
+
+/*
+ * Read the length prefix of a record
+ *
+ * @data [in]: Start of the record, at least AES_GCM_RECORD_LEN_SIZE bytes
+ * @return: the record length
+ */
+uint32_t aes_gcm_record_len(const char *data);
+
+/*
+ * Encrypt or decrypt a stream of length-prefixed records over a device group, and save the result in
+ * cfg->output_path
+ *
+ * The input and the output are a sequence of records, each made of a uint32_t length in network byte order and that
+ * many bytes. A plaintext record is a header of cfg->aad_size bytes, authenticated but left in the clear, followed by
+ * the payload. The matching encrypted record is the same header, the payload ciphertext and the tag. Record i is
+ * processed on its own with the IV derived from cfg->iv and i by aes_gcm_derive_iv(), so every record can be
+ * authenticated without the others. All records are in flight at once, submitted in bursts, see cfg->submit_burst.
+ * With cfg->num_tenants set, the first header byte of a record is its tenant index and the tenants share the devices
+ * as given by cfg->tenants.
+ *
+ * @cfg [in]: Configuration parameters
+ * @mode [in]: AES-GCM mode - encrypt/decrypt
+ * @file_data [in]: File data
+ * @file_size [in]: File size
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_record_stream_file(struct aes_gcm_cfg *cfg,
+					enum aes_gcm_mode mode,
+					char *file_data,
+					size_t file_size);
+
+#endif /* AES_GCM_RECORD_H_ */
@@ -0,0 +1,1014 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/random.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <doca_log.h>
+#include <doca_error.h>
+
+#include "aes_gcm_device_group.h"
+#include "aes_gcm_hugepage.h"
+#include "aes_gcm_relay.h"
+#include "aes_gcm_tls.h"
+
+DOCA_LOG_REGISTER(AES_GCM::RELAY);
+
+#define RELAY_SLOT_SIZE (AES_GCM_TLS_HEADER_SIZE + AES_GCM_TLS_MAX_CIPHERTEXT) /* Registered bytes of a pipe */
+#define RELAY_MAX_EVENTS 64						       /* Events handled per epoll_wait() */
+#define RELAY_IDLE_TIMEOUT_MS 100					       /* epoll_wait() timeout when idle */
+#define RELAY_UPSTREAM_LABEL "relay upstream"				       /* Secret label, client to target */
+#define RELAY_DOWNSTREAM_LABEL "relay downstream"			       /* Secret label, target to client */
+
+struct relay;
+struct relay_conn;
+struct relay_endpoint;
+
+/* One direction of a relayed connection */
+struct relay_pipe {
+	struct relay_conn *conn;	    /* Connection of the pipe */
+	struct relay_endpoint *in;	    /* Socket the pipe reads from */
+	struct relay_endpoint *out;	    /* Socket the pipe writes to */
+	bool seal;			    /* Seals the input into records, opens records otherwise */
+	bool hello;			    /* The source slot collects the connection hello, not a record */
+	struct aes_gcm_device_group *group; /* Device group of the pipe */
+	struct aes_gcm_tls_session session; /* Record protection state */
+	struct aes_gcm_group_key key;	    /* Traffic key of the pipe on the devices */
+	uint8_t *src;			    /* Source slot in the registered memory */
+	uint8_t *dst;			    /* Destination slot in the registered memory */
+	size_t in_len;			    /* Bytes read into the source slot */
+	size_t in_need;			    /* Bytes the source slot must hold before the record is complete */
+	const uint8_t *out_data;	    /* Output waiting to be written */
+	size_t out_len;			    /* Output length */
+	size_t out_sent;		    /* Output bytes written so far */
+	bool busy;			    /* A job is in flight */
+	bool eof;			    /* No more input, the end of the stream or a close_notify */
+	bool done;			    /* The end of the stream went out, the output side is shut down */
+	struct aes_gcm_job job;		    /* Job of the current record */
+	uint64_t records;		    /* Records sealed or opened */
+	uint64_t bytes;			    /* Plaintext bytes relayed */
+};
+
+/* Socket of a relayed connection */
+struct relay_endpoint {
+	struct relay_conn *conn;   /* Connection of the socket */
+	int fd;			   /* The socket */
+	uint32_t events;	   /* Events the socket is registered for */
+	struct relay_pipe *reader; /* Pipe reading from the socket */
+	struct relay_pipe *writer; /* Pipe writing to the socket */
+};
+
+/* Relayed connection, one pipe per direction */
+struct relay_conn {
+	struct relay *relay;			 /* The relay */
+	uint32_t idx;				 /* Index of the connection and of its registered slots */
+	bool in_use;				 /* The connection is open */
+	bool connecting;			 /* The connection to the target is not made yet */
+	bool keyed;				 /* The sessions and their keys are set up */
+	bool failed;				 /* Dropped once no job is in flight anymore */
+	struct relay_endpoint client;		 /* Accepted socket */
+	struct relay_endpoint target;		 /* Socket to cfg->relay_target */
+	struct relay_pipe upstream;		 /* Client to target */
+	struct relay_pipe downstream;		 /* Target to client */
+	uint8_t hello[AES_GCM_RELAY_HELLO_SIZE]; /* Hello this relay sends, with its own salt */
+};
+
+/* Relay state */
+struct relay {
+	struct aes_gcm_cfg *cfg;				/* Configuration parameters */
+	enum aes_gcm_mode mode;					/* Encrypt seals the upstream, decrypt opens it */
+	int epoll_fd;						/* Event loop */
+	int listen_fd;						/* Listening socket */
+	struct sockaddr_in target_addr;				/* Address of cfg->relay_target */
+	struct aes_gcm_device_group *seal_group;		/* Device group of the sealing pipes */
+	struct aes_gcm_device_group *open_group;		/* Device group of the opening pipes */
+	struct aes_gcm_mem seal_src;				/* Source slots of the sealing pipes */
+	struct aes_gcm_mem seal_dst;				/* Destination slots of the sealing pipes */
+	struct aes_gcm_mem open_src;				/* Source slots of the opening pipes */
+	struct aes_gcm_mem open_dst;				/* Destination slots of the opening pipes */
+	struct relay_conn conns[AES_GCM_RELAY_MAX_CONNECTIONS];	/* Connections */
+	uint64_t num_accepted;					/* Connections accepted */
+	uint64_t num_failed;					/* Connections dropped on an error */
+	uint64_t records_sealed;				/* Records sealed by closed connections */
+	uint64_t records_opened;				/* Records opened by closed connections */
+	uint64_t plaintext_bytes;				/* Plaintext relayed by closed connections */
+};
+
+/* Set by SIGINT and SIGTERM */
+static volatile sig_atomic_t relay_stop;
+
+/*
+ * Signal handler - stop the relay
+ *
+ * @signum [in]: Signal number
+ */
+static void relay_signal_handler(int signum)
+{
+	(void)signum;
+	relay_stop = 1;
+}
+
+/*
+ * Parse an IPv4 address and port, e.g. "127.0.0.1:9000", the address may be left out for all interfaces
+ *
+ * @str [in]: The address
+ * @addr [out]: The socket address
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR_INVALID_VALUE otherwise
+ */
+static doca_error_t parse_address(const char *str, struct sockaddr_in *addr)
+{
+	char host[AES_GCM_ADDR_SIZE];
+	const char *colon = strrchr(str, ':');
+	const char *port = (colon != NULL) ? colon + 1 : str;
+	char *end;
+	long port_num;
+
+	memset(addr, 0, sizeof(*addr));
+	addr->sin_family = AF_INET;
+	addr->sin_addr.s_addr = htonl(INADDR_ANY);
+
+	errno = 0;
+	port_num = strtol(port, &end, 10);
+	if (errno != 0 || end == port || *end != '\0' || port_num <= 0 || port_num > UINT16_MAX) {
+		DOCA_LOG_ERR("Invalid port in address %s", str);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	addr->sin_port = htons((uint16_t)port_num);
+
+	if (colon == NULL || colon == str)
+		return DOCA_SUCCESS;
+	if ((size_t)(colon - str) >= sizeof(host)) {
+		DOCA_LOG_ERR("Invalid host in address %s", str);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	memcpy(host, str, colon - str);
+	host[colon - str] = '\0';
+	if (inet_pton(AF_INET, host, &addr->sin_addr) != 1) {
+		DOCA_LOG_ERR("Invalid IPv4 address %s", host);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Check if a pipe takes more input
+ *
+ * @pipe [in]: The pipe
+ * @return: true if the pipe may read from its input socket
+ */
+static bool pipe_wants_input(const struct relay_pipe *pipe)
+{
+	return !pipe->conn->failed && !pipe->busy && !pipe->eof && pipe->out_sent == pipe->out_len &&
+	       (pipe->conn->keyed || pipe->hello);
+}
+
+/*
+ * Register a socket for the events its pipes wait for
+ *
+ * @relay [in]: The relay
+ * @endpoint [in]: The socket
+ */
+static void update_events(struct relay *relay, struct relay_endpoint *endpoint)
+{
+	struct epoll_event event = {.data.ptr = endpoint};
+
+	if (endpoint->conn->failed)
+		return;
+	if (endpoint->reader != NULL && pipe_wants_input(endpoint->reader))
+		event.events |= EPOLLIN;
+	if (endpoint->writer != NULL && endpoint->writer->out_sent < endpoint->writer->out_len)
+		event.events |= EPOLLOUT;
+	if (event.events == endpoint->events)
+		return;
+
+	if (epoll_ctl(relay->epoll_fd, EPOLL_CTL_MOD, endpoint->fd, &event) != 0) {
+		DOCA_LOG_ERR("Failed to update the events of connection %u: %s", endpoint->conn->idx, strerror(errno));
+		endpoint->conn->failed = true;
+		return;
+	}
+	endpoint->events = event.events;
+}
+
+/*
+ * Drop a connection on an error, it is closed once no job is in flight anymore
+ *
+ * @conn [in]: The connection
+ * @reason [in]: Reason, for the log
+ */
+static void fail_conn(struct relay_conn *conn, const char *reason)
+{
+	if (!conn->failed)
+		DOCA_LOG_WARN("Dropping connection %u: %s", conn->idx, reason);
+	conn->failed = true;
+}
+
+/*
+ * Write the pending output of a pipe, and shut the output down once the end of the stream went out
+ *
+ * @pipe [in]: The pipe
+ */
+static void pipe_flush(struct relay_pipe *pipe)
+{
+	struct relay *relay = pipe->conn->relay;
+	ssize_t n;
+
+	while (pipe->out_sent < pipe->out_len) {
+		n = send(pipe->out->fd, pipe->out_data + pipe->out_sent, pipe->out_len - pipe->out_sent, MSG_NOSIGNAL);
+		if (n < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+				break;
+			fail_conn(pipe->conn, strerror(errno));
+			return;
+		}
+		pipe->out_sent += n;
+	}
+
+	if (pipe->out_sent == pipe->out_len && pipe->eof && !pipe->busy && !pipe->done) {
+		(void)shutdown(pipe->out->fd, SHUT_WR);
+		pipe->done = true;
+	}
+	update_events(relay, pipe->in);
+	update_events(relay, pipe->out);
+}
+
+/*
+ * Completion callback of the record jobs
+ *
+ * @job [in]: The completed job, job->user_data is its pipe
+ */
+static void pipe_job_done(struct aes_gcm_job *job)
+{
+	struct relay_pipe *pipe = (struct relay_pipe *)job->user_data;
+	const uint8_t *content;
+	size_t content_len;
+	uint8_t content_type;
+	doca_error_t result;
+
+	pipe->busy = false;
+	if (pipe->conn->failed)
+		return;
+	if (job->result != DOCA_SUCCESS) {
+		fail_conn(pipe->conn, doca_error_get_descr(job->result));
+		return;
+	}
+
+	pipe->out_sent = 0;
+	pipe->records++;
+	if (pipe->seal) {
+		pipe->out_data = job->dst;
+		pipe->out_len = job->out_len;
+		pipe_flush(pipe);
+		return;
+	}
+
+	result = aes_gcm_tls_open_finish(job, &content_type, &content, &content_len);
+	if (result != DOCA_SUCCESS) {
+		fail_conn(pipe->conn, "record without content");
+		return;
+	}
+	if (content_type == AES_GCM_TLS_CONTENT_APPLICATION_DATA) {
+		pipe->out_data = content;
+		pipe->out_len = content_len;
+		pipe->bytes += content_len;
+	} else if (content_type == AES_GCM_TLS_CONTENT_ALERT && content_len == 2 && content[1] == 0) {
+		/* close_notify, the peer is done with this direction */
+		pipe->out_len = 0;
+		pipe->eof = true;
+	} else {
+		fail_conn(pipe->conn, "unexpected record content type or alert");
+		return;
+	}
+	pipe_flush(pipe);
+}
+
+/*
+ * Hand the record of a pipe to its device group
+ *
+ * @pipe [in]: The pipe, its job is prepared
+ */
+static void pipe_submit(struct relay_pipe *pipe)
+{
+	pipe->busy = true;
+	pipe->job.done_cb = pipe_job_done;
+	pipe->job.user_data = pipe;
+	aes_gcm_device_group_submit(pipe->group, &pipe->key, &pipe->job);
+}
+
+/*
+ * Fill the hello of a connection with the magic and a random salt
+ *
+ * @conn [in]: The connection
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t draw_hello(struct relay_conn *conn)
+{
+	memcpy(conn->hello, AES_GCM_RELAY_MAGIC, AES_GCM_RELAY_MAGIC_SIZE);
+	if (getrandom(conn->hello + AES_GCM_RELAY_MAGIC_SIZE, AES_GCM_RELAY_SALT_SIZE, 0) !=
+	    AES_GCM_RELAY_SALT_SIZE)
+		return DOCA_ERROR_OPERATING_SYSTEM;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Derive the sessions of a connection from the salts of both relays and create their keys
+ *
+ * @conn [in]: The connection
+ * @client_salt [in]: Salt of the encrypting relay, AES_GCM_RELAY_SALT_SIZE bytes
+ * @server_salt [in]: Salt of the decrypting relay, AES_GCM_RELAY_SALT_SIZE bytes
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t setup_sessions(struct relay_conn *conn, const uint8_t *client_salt, const uint8_t *server_salt)
+{
+	const struct aes_gcm_cfg *cfg = conn->relay->cfg;
+	struct relay_pipe *pipes[2] = {&conn->upstream, &conn->downstream};
+	const char *labels[2] = {RELAY_UPSTREAM_LABEL, RELAY_DOWNSTREAM_LABEL};
+	uint8_t secret[AES_GCM_TLS_MAX_SECRET_SIZE];
+	uint8_t salts[2 * AES_GCM_RELAY_SALT_SIZE];
+	doca_error_t result = DOCA_SUCCESS;
+	uint32_t i;
+
+	memcpy(salts, client_salt, AES_GCM_RELAY_SALT_SIZE);
+	memcpy(salts + AES_GCM_RELAY_SALT_SIZE, server_salt, AES_GCM_RELAY_SALT_SIZE);
+	for (i = 0; i < 2 && result == DOCA_SUCCESS; i++) {
+		result = aes_gcm_tls_derive_secret(cfg->tls_secret,
+						   cfg->tls_secret_len,
+						   labels[i],
+						   salts,
+						   sizeof(salts),
+						   secret);
+		if (result == DOCA_SUCCESS)
+			result = aes_gcm_tls_session_init(secret, cfg->tls_secret_len, 0, &pipes[i]->session);
+		if (result == DOCA_SUCCESS)
+			result = aes_gcm_device_group_key_create(pipes[i]->group,
+								 pipes[i]->session.key,
+								 aes_gcm_tls_key_type(&pipes[i]->session),
+								 &pipes[i]->key);
+	}
+	memset(secret, 0, sizeof(secret));
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	conn->keyed = true;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Take the hello of the peer relay and set up the sessions of the connection
+ *
+ * The decrypting relay answers the hello of the encrypting relay with its own, ahead of the first downstream record.
+ * A replayed hello thus never brings back the keys of an earlier connection.
+ *
+ * @conn [in]: The connection
+ * @hello [in]: Hello of the peer relay, AES_GCM_RELAY_HELLO_SIZE bytes
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t take_hello(struct relay_conn *conn, const uint8_t *hello)
+{
+	const uint8_t *peer_salt = hello + AES_GCM_RELAY_MAGIC_SIZE;
+	const uint8_t *own_salt = conn->hello + AES_GCM_RELAY_MAGIC_SIZE;
+	doca_error_t result;
+
+	if (memcmp(hello, AES_GCM_RELAY_MAGIC, AES_GCM_RELAY_MAGIC_SIZE) != 0)
+		return DOCA_ERROR_INVALID_VALUE;
+	if (conn->relay->mode == AES_GCM_MODE_ENCRYPT)
+		return setup_sessions(conn, own_salt, peer_salt);
+
+	result = draw_hello(conn);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = setup_sessions(conn, peer_salt, own_salt);
+	if (result != DOCA_SUCCESS)
+		return result;
+	conn->downstream.out_data = conn->hello;
+	conn->downstream.out_len = AES_GCM_RELAY_HELLO_SIZE;
+	conn->downstream.out_sent = 0;
+	pipe_flush(&conn->downstream);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Read from the input socket of a pipe until a record can be submitted or the socket runs dry
+ *
+ * @pipe [in]: The pipe
+ */
+static void pipe_read(struct relay_pipe *pipe)
+{
+	static const uint8_t close_notify[2] = {1, 0};
+	struct relay_conn *conn = pipe->conn;
+	size_t length;
+	ssize_t n;
+	doca_error_t result;
+
+	while (pipe_wants_input(pipe)) {
+		if (pipe->seal)
+			n = recv(pipe->in->fd, pipe->src + AES_GCM_TLS_HEADER_SIZE, AES_GCM_TLS_MAX_PLAINTEXT, 0);
+		else
+			n = recv(pipe->in->fd, pipe->src + pipe->in_len, pipe->in_need - pipe->in_len, 0);
+		if (n < 0) {
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+				fail_conn(conn, strerror(errno));
+			break;
+		}
+
+		memset(&pipe->job, 0, sizeof(pipe->job));
+		if (pipe->seal) {
+			/* The end of the plaintext is sealed as a close_notify, the peer tells it from a truncation */
+			if (n == 0)
+				pipe->eof = true;
+			else
+				pipe->bytes += n;
+			result = aes_gcm_tls_seal_prepare(&pipe->session,
+							  (n == 0) ? AES_GCM_TLS_CONTENT_ALERT :
+								     AES_GCM_TLS_CONTENT_APPLICATION_DATA,
+							  (n == 0) ? close_notify : pipe->src + AES_GCM_TLS_HEADER_SIZE,
+							  (n == 0) ? sizeof(close_notify) : (size_t)n,
+							  0,
+							  pipe->src,
+							  pipe->dst,
+							  &pipe->job);
+			if (result != DOCA_SUCCESS) {
+				fail_conn(conn, doca_error_get_descr(result));
+				break;
+			}
+			pipe_submit(pipe);
+			break;
+		}
+
+		if (n == 0) {
+			fail_conn(conn, "stream ended without a close_notify");
+			break;
+		}
+		pipe->in_len += n;
+		if (pipe->in_len < pipe->in_need)
+			continue;
+
+		if (pipe->hello) {
+			result = take_hello(conn, pipe->src);
+			if (result != DOCA_SUCCESS) {
+				fail_conn(conn,
+					  (result == DOCA_ERROR_INVALID_VALUE) ? "invalid connection hello" :
+										  doca_error_get_descr(result));
+				break;
+			}
+			pipe->hello = false;
+			pipe->in_len = 0;
+			pipe->in_need = AES_GCM_TLS_HEADER_SIZE;
+			/* The other direction was waiting for the keys */
+			update_events(conn->relay, pipe->out);
+			continue;
+		}
+
+		if (pipe->in_need == AES_GCM_TLS_HEADER_SIZE) {
+			length = ((size_t)pipe->src[3] << 8) | pipe->src[4];
+			if (length < 1 + AES_GCM_TLS_TAG_SIZE || length > AES_GCM_TLS_MAX_CIPHERTEXT) {
+				fail_conn(conn, "invalid record header");
+				break;
+			}
+			pipe->in_need += length;
+			continue;
+		}
+
+		result = aes_gcm_tls_open_prepare(&pipe->session, pipe->src, pipe->in_len, pipe->dst, &pipe->job);
+		pipe->in_len = 0;
+		pipe->in_need = AES_GCM_TLS_HEADER_SIZE;
+		if (result != DOCA_SUCCESS) {
+			fail_conn(conn, "invalid record header");
+			break;
+		}
+		pipe_submit(pipe);
+		break;
+	}
+
+	update_events(conn->relay, pipe->in);
+}
+
+/*
+ * Set up a pipe of a new connection
+ *
+ * @relay [in]: The relay
+ * @conn [in]: The connection
+ * @pipe [out]: The pipe
+ * @in [in]: Socket the pipe reads from
+ * @out [in]: Socket the pipe writes to
+ * @seal [in]: The pipe seals its input, opens it otherwise
+ */
+static void pipe_init(struct relay *relay,
+		      struct relay_conn *conn,
+		      struct relay_pipe *pipe,
+		      struct relay_endpoint *in,
+		      struct relay_endpoint *out,
+		      bool seal)
+{
+	size_t slot_offset = (size_t)conn->idx * RELAY_SLOT_SIZE;
+
+	memset(pipe, 0, sizeof(*pipe));
+	pipe->conn = conn;
+	pipe->in = in;
+	pipe->out = out;
+	pipe->seal = seal;
+	pipe->group = seal ? relay->seal_group : relay->open_group;
+	pipe->src = (uint8_t *)(seal ? relay->seal_src.addr : relay->open_src.addr) + slot_offset;
+	pipe->dst = (uint8_t *)(seal ? relay->seal_dst.addr : relay->open_dst.addr) + slot_offset;
+	pipe->in_need = AES_GCM_TLS_HEADER_SIZE;
+	in->reader = pipe;
+	out->writer = pipe;
+}
+
+/*
+ * Close a connection and account its pipes
+ *
+ * @relay [in]: The relay
+ * @conn [in]: The connection, no job of it is in flight
+ */
+static void close_conn(struct relay *relay, struct relay_conn *conn)
+{
+	struct relay_pipe *pipes[2] = {&conn->upstream, &conn->downstream};
+	doca_error_t result;
+	uint32_t i;
+
+	for (i = 0; i < 2; i++) {
+		result = aes_gcm_device_group_key_destroy(pipes[i]->group, &pipes[i]->key);
+		if (result != DOCA_SUCCESS)
+			DOCA_LOG_ERR("Failed to destroy the key of connection %u: %s",
+				     conn->idx,
+				     doca_error_get_descr(result));
+		if (pipes[i]->seal)
+			relay->records_sealed += pipes[i]->records;
+		else
+			relay->records_opened += pipes[i]->records;
+		relay->plaintext_bytes += pipes[i]->bytes;
+	}
+	if (conn->failed)
+		relay->num_failed++;
+	else
+		DOCA_LOG_DBG("Connection %u closed after %lu bytes upstream and %lu bytes downstream",
+			     conn->idx,
+			     conn->upstream.bytes,
+			     conn->downstream.bytes);
+
+	close(conn->client.fd);
+	close(conn->target.fd);
+	conn->in_use = false;
+}
+
+/*
+ * Close the connections that are done or failed and have no job in flight
+ *
+ * @relay [in]: The relay
+ */
+static void sweep_conns(struct relay *relay)
+{
+	struct relay_conn *conn;
+	uint32_t i;
+
+	for (i = 0; i < AES_GCM_RELAY_MAX_CONNECTIONS; i++) {
+		conn = &relay->conns[i];
+		if (!conn->in_use || conn->upstream.busy || conn->downstream.busy)
+			continue;
+		if (conn->failed || (conn->upstream.done && conn->downstream.done))
+			close_conn(relay, conn);
+	}
+}
+
+/*
+ * Start connecting to the target without blocking the event loop
+ *
+ * @relay [in]: The relay
+ * @connected [out]: The connection was made right away, it completes on EPOLLOUT otherwise
+ * @return: the non-blocking socket, -1 on error with errno set
+ */
+static int connect_target(const struct relay *relay, bool *connected)
+{
+	int fd, err, one = 1;
+
+	fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	if (fd < 0)
+		return -1;
+	/* Records go out as soon as they are sealed */
+	(void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+	*connected = connect(fd, (const struct sockaddr *)&relay->target_addr, sizeof(relay->target_addr)) == 0;
+	if (!*connected && errno != EINPROGRESS) {
+		err = errno;
+		close(fd);
+		errno = err;
+		return -1;
+	}
+	return fd;
+}
+
+/*
+ * Arm the pipes of a connection once its target connection is made
+ *
+ * @relay [in]: The relay
+ * @conn [in]: The connection
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t start_conn(struct relay *relay, struct relay_conn *conn)
+{
+	conn->connecting = false;
+	if (relay->mode == AES_GCM_MODE_DECRYPT) {
+		/* The encrypting relay starts with the hello, the keys are only known once it arrived */
+		conn->upstream.hello = true;
+		conn->upstream.in_need = AES_GCM_RELAY_HELLO_SIZE;
+		update_events(relay, &conn->client);
+		update_events(relay, &conn->target);
+		return DOCA_SUCCESS;
+	}
+
+	if (draw_hello(conn) != DOCA_SUCCESS) {
+		fail_conn(conn, "unable to draw the connection salt");
+		return DOCA_ERROR_OPERATING_SYSTEM;
+	}
+
+	/* Nothing is sealed before the hello of the decrypting relay came back with its salt */
+	conn->downstream.hello = true;
+	conn->downstream.in_need = AES_GCM_RELAY_HELLO_SIZE;
+	conn->upstream.out_data = conn->hello;
+	conn->upstream.out_len = AES_GCM_RELAY_HELLO_SIZE;
+	pipe_flush(&conn->upstream);
+	update_events(relay, &conn->target);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Complete the connection to the target and arm the pipes, or drop the connection if it failed
+ *
+ * @conn [in]: The connection, its target socket reported the end of the connection attempt
+ */
+static void finish_connect(struct relay_conn *conn)
+{
+	socklen_t len = sizeof(int);
+	int err = 0;
+
+	if (getsockopt(conn->target.fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0)
+		err = errno;
+	if (err != 0) {
+		DOCA_LOG_WARN("Unable to connect to %s: %s", conn->relay->cfg->relay_target, strerror(err));
+		fail_conn(conn, "no target connection");
+		return;
+	}
+	(void)start_conn(conn->relay, conn);
+}
+
+/*
+ * Set up a connection for an accepted client, its pipes are armed once the target connection is made
+ *
+ * @relay [in]: The relay
+ * @client_fd [in]: The accepted socket
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise, the socket is closed on error
+ */
+static doca_error_t open_conn(struct relay *relay, int client_fd)
+{
+	struct relay_conn *conn = NULL;
+	struct epoll_event event = {0};
+	int target_fd, one = 1;
+	bool connected;
+	uint32_t i;
+
+	for (i = 0; i < AES_GCM_RELAY_MAX_CONNECTIONS && conn == NULL; i++) {
+		if (!relay->conns[i].in_use)
+			conn = &relay->conns[i];
+	}
+	if (conn == NULL) {
+		DOCA_LOG_WARN("Refusing a client, %d connections are relayed already", AES_GCM_RELAY_MAX_CONNECTIONS);
+		close(client_fd);
+		return DOCA_ERROR_FULL;
+	}
+
+	target_fd = connect_target(relay, &connected);
+	if (target_fd < 0) {
+		DOCA_LOG_WARN("Refusing a client, unable to connect to %s: %s",
+			      relay->cfg->relay_target,
+			      strerror(errno));
+		close(client_fd);
+		return DOCA_ERROR_CONNECTION_ABORTED;
+	}
+	(void)setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+	memset(conn, 0, sizeof(*conn));
+	conn->relay = relay;
+	conn->idx = (uint32_t)(conn - relay->conns);
+	conn->in_use = true;
+	conn->connecting = !connected;
+	conn->client.conn = conn;
+	conn->client.fd = client_fd;
+	conn->target.conn = conn;
+	conn->target.fd = target_fd;
+	pipe_init(relay, conn, &conn->upstream, &conn->client, &conn->target, relay->mode == AES_GCM_MODE_ENCRYPT);
+	pipe_init(relay, conn, &conn->downstream, &conn->target, &conn->client, relay->mode == AES_GCM_MODE_DECRYPT);
+	relay->num_accepted++;
+
+	event.data.ptr = &conn->client;
+	if (epoll_ctl(relay->epoll_fd, EPOLL_CTL_ADD, client_fd, &event) != 0) {
+		fail_conn(conn, strerror(errno));
+		return DOCA_ERROR_OPERATING_SYSTEM;
+	}
+	/* Until the connection is made, the target socket only waits for it to complete */
+	event.events = conn->connecting ? EPOLLOUT : 0;
+	event.data.ptr = &conn->target;
+	if (epoll_ctl(relay->epoll_fd, EPOLL_CTL_ADD, target_fd, &event) != 0) {
+		fail_conn(conn, strerror(errno));
+		return DOCA_ERROR_OPERATING_SYSTEM;
+	}
+	conn->target.events = event.events;
+
+	if (conn->connecting)
+		return DOCA_SUCCESS;
+	return start_conn(relay, conn);
+}
+
+/*
+ * Accept the pending clients
+ *
+ * @relay [in]: The relay
+ */
+static void accept_clients(struct relay *relay)
+{
+	int fd;
+
+	while ((fd = accept4(relay->listen_fd, NULL, NULL, SOCK_NONBLOCK)) >= 0)
+		(void)open_conn(relay, fd);
+	if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+		DOCA_LOG_WARN("Failed to accept a client: %s", strerror(errno));
+}
+
+/*
+ * Handle the events of a connection socket
+ *
+ * @endpoint [in]: The socket
+ * @events [in]: The events
+ */
+static void handle_events(struct relay_endpoint *endpoint, uint32_t events)
+{
+	if (endpoint->conn->failed)
+		return;
+	if (endpoint->conn->connecting) {
+		/* The client is not read yet, it can only have hung up */
+		if (endpoint == &endpoint->conn->target)
+			finish_connect(endpoint->conn);
+		else
+			fail_conn(endpoint->conn, "client left before the target connection was made");
+		return;
+	}
+	if ((events & EPOLLERR) != 0) {
+		fail_conn(endpoint->conn, "socket error");
+		return;
+	}
+	if ((events & EPOLLOUT) != 0)
+		pipe_flush(endpoint->writer);
+	if ((events & (EPOLLIN | EPOLLHUP)) != 0)
+		pipe_read(endpoint->reader);
+}
+
+/*
+ * Open the listening socket and the event loop
+ *
+ * @relay [in]: The relay
+ * @listen_addr [in]: Address to listen on
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t open_listener(struct relay *relay, const struct sockaddr_in *listen_addr)
+{
+	struct epoll_event event = {.events = EPOLLIN, .data.ptr = NULL};
+	int one = 1;
+
+	relay->epoll_fd = epoll_create1(0);
+	if (relay->epoll_fd < 0) {
+		DOCA_LOG_ERR("Unable to create the event loop: %s", strerror(errno));
+		return DOCA_ERROR_OPERATING_SYSTEM;
+	}
+
+	relay->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	if (relay->listen_fd < 0) {
+		DOCA_LOG_ERR("Unable to create the relay socket: %s", strerror(errno));
+		return DOCA_ERROR_OPERATING_SYSTEM;
+	}
+	(void)setsockopt(relay->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+	if (bind(relay->listen_fd, (const struct sockaddr *)listen_addr, sizeof(*listen_addr)) != 0 ||
+	    listen(relay->listen_fd, AES_GCM_RELAY_MAX_CONNECTIONS) != 0 ||
+	    epoll_ctl(relay->epoll_fd, EPOLL_CTL_ADD, relay->listen_fd, &event) != 0) {
+		DOCA_LOG_ERR("Unable to listen on %s: %s", relay->cfg->relay_listen, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Create and start the device groups, with one registered slot per connection and direction
+ *
+ * @relay [in]: The relay
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t start_groups(struct relay *relay)
+{
+	struct aes_gcm_device_group **groups[2] = {&relay->seal_group, &relay->open_group};
+	struct aes_gcm_mem *src_mems[2] = {&relay->seal_src, &relay->open_src};
+	struct aes_gcm_mem *dst_mems[2] = {&relay->seal_dst, &relay->open_dst};
+	const enum aes_gcm_mode modes[2] = {AES_GCM_MODE_ENCRYPT, AES_GCM_MODE_DECRYPT};
+	size_t region_size = (size_t)AES_GCM_RELAY_MAX_CONNECTIONS * RELAY_SLOT_SIZE;
+	doca_error_t result;
+	uint32_t i;
+
+	for (i = 0; i < 2; i++) {
+		result = aes_gcm_device_group_create(relay->cfg, modes[i], groups[i]);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to create device group: %s", doca_error_get_descr(result));
+			return result;
+		}
+		if ((*groups[i])->max_buf_size < RELAY_SLOT_SIZE) {
+			DOCA_LOG_ERR("Max buffer size %lu < record size %d",
+				     (*groups[i])->max_buf_size,
+				     RELAY_SLOT_SIZE);
+			return DOCA_ERROR_NOT_SUPPORTED;
+		}
+
+		result = aes_gcm_mem_alloc(relay->cfg->hugepages, region_size, src_mems[i]);
+		if (result != DOCA_SUCCESS)
+			return result;
+		result = aes_gcm_mem_alloc(relay->cfg->hugepages, region_size, dst_mems[i]);
+		if (result != DOCA_SUCCESS)
+			return result;
+
+		result = aes_gcm_device_group_start(*groups[i],
+						    src_mems[i]->addr,
+						    region_size,
+						    dst_mems[i]->addr,
+						    region_size);
+		if (result != DOCA_SUCCESS)
+			return result;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Run the event loop until the relay is stopped
+ *
+ * @relay [in]: The relay
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t run_loop(struct relay *relay)
+{
+	struct epoll_event events[RELAY_MAX_EVENTS];
+	int nb_events, timeout_ms, i;
+
+	while (!relay_stop) {
+		/* Completions only show up through progress, the loop must not sleep while records are in flight */
+		timeout_ms = (relay->seal_group->inflight != 0 || relay->seal_group->num_pending != 0 ||
+			      relay->open_group->inflight != 0 || relay->open_group->num_pending != 0) ?
+				     0 :
+				     RELAY_IDLE_TIMEOUT_MS;
+		nb_events = epoll_wait(relay->epoll_fd, events, RELAY_MAX_EVENTS, timeout_ms);
+		if (nb_events < 0) {
+			if (errno == EINTR)
+				continue;
+			DOCA_LOG_ERR("Failed to wait for events: %s", strerror(errno));
+			return DOCA_ERROR_OPERATING_SYSTEM;
+		}
+
+		for (i = 0; i < nb_events; i++) {
+			if (events[i].data.ptr == NULL)
+				accept_clients(relay);
+			else
+				handle_events(events[i].data.ptr, events[i].events);
+		}
+		aes_gcm_device_group_flush(relay->seal_group);
+		aes_gcm_device_group_flush(relay->open_group);
+
+		(void)aes_gcm_device_group_progress(relay->seal_group);
+		(void)aes_gcm_device_group_progress(relay->open_group);
+		sweep_conns(relay);
+	}
+	return DOCA_SUCCESS;
+}
+
+bool aes_gcm_relay_is_requested(const struct aes_gcm_cfg *cfg)
+{
+	return cfg->relay_listen[0] != '\0';
+}
+
+doca_error_t aes_gcm_relay_run(struct aes_gcm_cfg *cfg, enum aes_gcm_mode mode)
+{
+	struct sigaction action = {.sa_handler = relay_signal_handler}, old_int, old_term;
+	struct aes_gcm_device_group *groups[2];
+	struct sockaddr_in listen_addr;
+	struct relay *relay;
+	uint64_t start_ns;
+	doca_error_t result, tmp_result;
+	uint32_t i;
+
+	if (cfg->relay_target[0] == '\0' || cfg->tls_secret_len == 0) {
+		DOCA_LOG_ERR("The relay needs a target and a TLS traffic secret shared with its peer relay");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	relay = calloc(1, sizeof(*relay));
+	if (relay == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(DOCA_ERROR_NO_MEMORY));
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	relay->cfg = cfg;
+	relay->mode = mode;
+	relay->epoll_fd = -1;
+	relay->listen_fd = -1;
+
+	result = parse_address(cfg->relay_listen, &listen_addr);
+	if (result == DOCA_SUCCESS)
+		result = parse_address(cfg->relay_target, &relay->target_addr);
+	if (result != DOCA_SUCCESS)
+		goto free_relay;
+	if (relay->target_addr.sin_addr.s_addr == htonl(INADDR_ANY)) {
+		DOCA_LOG_ERR("The relay target %s has no address", cfg->relay_target);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto free_relay;
+	}
+
+	result = start_groups(relay);
+	if (result != DOCA_SUCCESS)
+		goto destroy_groups;
+
+	result = open_listener(relay, &listen_addr);
+	if (result != DOCA_SUCCESS)
+		goto close_sockets;
+
+	relay_stop = 0;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGINT, &action, &old_int);
+	sigaction(SIGTERM, &action, &old_term);
+
+	DOCA_LOG_INFO("%s relay listening on %s, forwarding to %s",
+		      (mode == AES_GCM_MODE_ENCRYPT) ? "Encrypting" : "Decrypting",
+		      cfg->relay_listen,
+		      cfg->relay_target);
+
+	start_ns = aes_gcm_get_time_ns();
+	result = run_loop(relay);
+
+	sigaction(SIGINT, &old_int, NULL);
+	sigaction(SIGTERM, &old_term, NULL);
+
+	/* Whatever is still relayed is dropped, its jobs complete before the keys and sockets go away */
+	for (i = 0; i < AES_GCM_RELAY_MAX_CONNECTIONS; i++) {
+		if (relay->conns[i].in_use)
+			relay->conns[i].failed = true;
+	}
+	aes_gcm_device_group_wait(relay->seal_group);
+	aes_gcm_device_group_wait(relay->open_group);
+	sweep_conns(relay);
+
+	DOCA_LOG_INFO("Relayed %lu connections, %lu dropped: %lu records sealed, %lu opened, %lu plaintext bytes",
+		      relay->num_accepted,
+		      relay->num_failed,
+		      relay->records_sealed,
+		      relay->records_opened,
+		      relay->plaintext_bytes);
+	aes_gcm_device_group_report(relay->seal_group, aes_gcm_get_time_ns() - start_ns);
+	aes_gcm_device_group_report(relay->open_group, aes_gcm_get_time_ns() - start_ns);
+
+close_sockets:
+	if (relay->listen_fd >= 0)
+		close(relay->listen_fd);
+	if (relay->epoll_fd >= 0)
+		close(relay->epoll_fd);
+destroy_groups:
+	groups[0] = relay->seal_group;
+	groups[1] = relay->open_group;
+	for (i = 0; i < 2; i++) {
+		if (groups[i] == NULL)
+			continue;
+		tmp_result = aes_gcm_device_group_destroy(groups[i]);
+		if (tmp_result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to destroy device group: %s", doca_error_get_descr(tmp_result));
+			DOCA_ERROR_PROPAGATE(result, tmp_result);
+		}
+	}
+	aes_gcm_mem_free(&relay->open_dst);
+	aes_gcm_mem_free(&relay->open_src);
+	aes_gcm_mem_free(&relay->seal_dst);
+	aes_gcm_mem_free(&relay->seal_src);
+free_relay:
+	free(relay);
+
+	return result;
+}
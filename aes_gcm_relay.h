@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_RELAY_H_
+#define AES_GCM_RELAY_H_
+
+#include <stdbool.h>
+
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+
+#define AES_GCM_RELAY_MAX_CONNECTIONS 64					      /* Connections relayed at once */
+#define AES_GCM_RELAY_MAGIC "AGRL"						      /* Hello magic */
+#define AES_GCM_RELAY_MAGIC_SIZE 4						      /* Size of the magic */
+#define AES_GCM_RELAY_SALT_SIZE 32						      /* Random salt of a connection */
+#define AES_GCM_RELAY_HELLO_SIZE (AES_GCM_RELAY_MAGIC_SIZE + AES_GCM_RELAY_SALT_SIZE) /* Connection hello */
+
+/*
+ * Check if the relay mode was requested
+ *
+ * @cfg [in]: Configuration parameters
+ * @return: true if cfg->relay_listen is set
+ */
+bool aes_gcm_relay_is_requested(const struct aes_gcm_cfg *cfg);
+
+/*
+ * Relay TCP connections from cfg->relay_listen to cfg->relay_target, protecting the data on one side with TLS 1.3
+ * application data records, until SIGINT or SIGTERM
+ *
+ * The encrypting relay takes plaintext clients: it opens a connection to the target for every client, sends a hello
+ * made of AES_GCM_RELAY_MAGIC and a random salt, waits for the hello of the decrypting relay, then seals the client
+ * bytes into records and opens the records coming back. The decrypting relay sits in front of the real service and
+ * does the reverse, its clients are encrypting relays, and it answers every hello with one carrying its own random
+ * salt. Every connection gets its own traffic secret per direction, derived from cfg->tls_secret and the salts of
+ * both relays, so the record sequence numbers restart at 0 and a replayed hello still gets fresh keys. The end of a
+ * direction is sent as a sealed close_notify alert, a stream that ends without one is treated as truncated and the
+ * connection is dropped.
+ *
+ * All connections are multiplexed by a single epoll loop, over one device group that seals and one that opens. Each
+ * direction of a connection has one record in flight at a time, read straight into its slot of the registered memory.
+ * The -f input file is not read.
+ *
+ * @cfg [in]: Configuration parameters
+ * @mode [in]: AES-GCM mode - encrypt on the plaintext client side, decrypt on the service side
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_relay_run(struct aes_gcm_cfg *cfg, enum aes_gcm_mode mode);
+
+#endif /* AES_GCM_RELAY_H_ */
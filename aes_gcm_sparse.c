@@ -0,0 +1,513 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <doca_log.h>
+#include <doca_error.h>
+
+#include "aes_gcm_sparse.h"
+#include "aes_gcm_device_group.h"
+#include "aes_gcm_hugepage.h"
+#include "aes_gcm_sw.h"
+
+DOCA_LOG_REGISTER(AES_GCM::SPARSE);
+
+/* Container layout of a run and the files it moves between */
+struct sparse_run {
+	uint8_t *meta;			       /* Header, extents and header tag, as stored in the container */
+	size_t meta_len;		       /* Header and extents length, the header tag follows */
+	struct aes_gcm_sparse_header *header;  /* Container header, inside meta */
+	struct aes_gcm_sparse_extent *extents; /* Data extents, inside meta */
+	uint64_t num_chunks;		       /* Number of data chunks */
+	off_t chunks_offset;		       /* Container offset of the first encrypted chunk */
+	int in_fd;			       /* Sparse file on encrypt, container on decrypt */
+	int out_fd;			       /* Container on encrypt, sparse file on decrypt */
+	uint64_t extent;		       /* Extent the data cursor is in */
+	uint64_t extent_done;		       /* Bytes of the extent before the data cursor */
+};
+
+/*
+ * List the data extents of a file
+ *
+ * File systems without hole reporting answer SEEK_DATA and SEEK_HOLE as if the file was a single data extent.
+ *
+ * @fd [in]: File descriptor
+ * @file_size [in]: File size
+ * @extents [out]: The extents, to be freed by the caller
+ * @num_extents [out]: Number of extents
+ * @data_size [out]: Bytes in the extents
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t walk_extents(int fd,
+				 uint64_t file_size,
+				 struct aes_gcm_sparse_extent **extents,
+				 uint64_t *num_extents,
+				 uint64_t *data_size)
+{
+	struct aes_gcm_sparse_extent *list = NULL, *grown;
+	uint64_t capacity = 0, count = 0, size = 0;
+	off_t data, hole = 0;
+
+	while ((uint64_t)hole < file_size) {
+		data = lseek(fd, hole, SEEK_DATA);
+		if (data < 0 && errno == ENXIO)
+			break;
+		if (data >= 0)
+			hole = lseek(fd, data, SEEK_HOLE);
+		if (data < 0 || hole < 0) {
+			DOCA_LOG_ERR("Failed to walk the extents of the input file: %s", strerror(errno));
+			free(list);
+			return DOCA_ERROR_IO_FAILED;
+		}
+
+		if (count == capacity) {
+			capacity = (capacity == 0) ? 16 : (capacity * 2);
+			grown = realloc(list, capacity * sizeof(*list));
+			if (grown == NULL) {
+				DOCA_LOG_ERR("Failed to allocate memory for %lu extents", capacity);
+				free(list);
+				return DOCA_ERROR_NO_MEMORY;
+			}
+			list = grown;
+		}
+		list[count].offset = data;
+		list[count].length = hole - data;
+		size += list[count].length;
+		count++;
+	}
+
+	*extents = list;
+	*num_extents = count;
+	*data_size = size;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Check that the extents of a container are ordered, apart, inside the file and hold data_size bytes
+ *
+ * @header [in]: Container header
+ * @extents [in]: Container extents
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR_INVALID_VALUE otherwise
+ */
+static doca_error_t check_extents(const struct aes_gcm_sparse_header *header,
+				  const struct aes_gcm_sparse_extent *extents)
+{
+	uint64_t end = 0, size = 0, i;
+
+	for (i = 0; i < header->num_extents; i++) {
+		if (extents[i].length == 0 || extents[i].offset < end || extents[i].offset > header->file_size ||
+		    extents[i].length > header->file_size - extents[i].offset) {
+			DOCA_LOG_ERR("Extent %lu of the container is out of order or out of the file", i);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		end = extents[i].offset + extents[i].length;
+		size += extents[i].length;
+	}
+
+	if (size != header->data_size) {
+		DOCA_LOG_ERR("Container extents hold %lu bytes, the header announces %lu", size, header->data_size);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Compute the header tag of a container on encrypt, or check it on decrypt
+ *
+ * @cfg [in]: Configuration parameters
+ * @run [in]: The run, with its header and extents loaded
+ * @mode [in]: AES-GCM mode - encrypt computes the tag, decrypt checks it
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR_INVALID_VALUE when the tag does not match and DOCA_ERROR otherwise
+ */
+static doca_error_t header_tag(const struct aes_gcm_cfg *cfg, struct sparse_run *run, enum aes_gcm_mode mode)
+{
+	uint32_t key_len = (cfg->raw_key_type == DOCA_AES_GCM_KEY_128) ? 16 : 32;
+	uint8_t iv[MAX_AES_GCM_IV_LENGTH];
+	uint8_t unused;
+
+	/* The chunks use the IVs of index 0 to num_chunks - 1, the header takes the next one */
+	aes_gcm_derive_iv(cfg->iv, cfg->iv_length, run->num_chunks, iv);
+	if (mode == AES_GCM_MODE_ENCRYPT)
+		return aes_gcm_sw_encrypt(cfg->raw_key,
+					  key_len,
+					  iv,
+					  cfg->iv_length,
+					  run->meta,
+					  run->meta_len,
+					  &unused,
+					  0,
+					  &unused,
+					  run->meta + run->meta_len,
+					  run->header->tag_size);
+	return aes_gcm_sw_decrypt(cfg->raw_key,
+				  key_len,
+				  iv,
+				  cfg->iv_length,
+				  run->meta,
+				  run->meta_len,
+				  &unused,
+				  0,
+				  run->meta + run->meta_len,
+				  run->header->tag_size,
+				  &unused);
+}
+
+/*
+ * Allocate the container metadata of a run and point its header and extents inside it
+ *
+ * @run [in]: The run
+ * @num_extents [in]: Number of extents
+ * @tag_size [in]: Header tag size
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t alloc_meta(struct sparse_run *run, uint64_t num_extents, uint32_t tag_size)
+{
+	run->meta_len = sizeof(*run->header) + (num_extents * sizeof(*run->extents));
+	run->meta = calloc(1, run->meta_len + tag_size);
+	if (run->meta == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(DOCA_ERROR_NO_MEMORY));
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	run->header = (struct aes_gcm_sparse_header *)run->meta;
+	run->extents = (struct aes_gcm_sparse_extent *)(run->meta + sizeof(*run->header));
+	run->chunks_offset = run->meta_len + tag_size;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Walk the input file and write the header of its container
+ *
+ * @cfg [in]: Configuration parameters
+ * @run [in/out]: The run
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t open_encrypt(const struct aes_gcm_cfg *cfg, struct sparse_run *run)
+{
+	struct aes_gcm_sparse_extent *extents = NULL;
+	uint64_t num_extents, data_size;
+	uint32_t chunk_size = (cfg->chunk_size != 0) ? cfg->chunk_size : AES_GCM_SPARSE_DEFAULT_CHUNK_SIZE;
+	struct stat st;
+	doca_error_t result;
+
+	run->in_fd = open(cfg->file_path, O_RDONLY);
+	if (run->in_fd < 0 || fstat(run->in_fd, &st) != 0) {
+		DOCA_LOG_ERR("Unable to open input file %s: %s", cfg->file_path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	result = walk_extents(run->in_fd, st.st_size, &extents, &num_extents, &data_size);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	result = alloc_meta(run, num_extents, cfg->tag_size);
+	if (result != DOCA_SUCCESS) {
+		free(extents);
+		return result;
+	}
+	memcpy(run->header->magic, AES_GCM_SPARSE_MAGIC, sizeof(run->header->magic));
+	run->header->version = AES_GCM_SPARSE_VERSION;
+	run->header->tag_size = cfg->tag_size;
+	run->header->chunk_size = chunk_size;
+	run->header->file_size = st.st_size;
+	run->header->data_size = data_size;
+	run->header->num_extents = num_extents;
+	if (num_extents != 0)
+		memcpy(run->extents, extents, num_extents * sizeof(*extents));
+	free(extents);
+	run->num_chunks = (data_size + chunk_size - 1) / chunk_size;
+
+	result = header_tag(cfg, run, AES_GCM_MODE_ENCRYPT);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	run->out_fd = open(cfg->output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (run->out_fd < 0) {
+		DOCA_LOG_ERR("Unable to open output file %s: %s", cfg->output_path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+	return aes_gcm_file_io(run->out_fd, run->meta, run->chunks_offset, 0, true);
+}
+
+/*
+ * Read and check the header of a container, and create the sparse output file
+ *
+ * @cfg [in]: Configuration parameters
+ * @run [in/out]: The run
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR_INVALID_VALUE when the container fails authentication and DOCA_ERROR
+ * otherwise
+ */
+static doca_error_t open_decrypt(const struct aes_gcm_cfg *cfg, struct sparse_run *run)
+{
+	struct aes_gcm_sparse_header header;
+	uint64_t expected_size;
+	struct stat st;
+	doca_error_t result;
+
+	run->in_fd = open(cfg->file_path, O_RDONLY);
+	if (run->in_fd < 0 || fstat(run->in_fd, &st) != 0) {
+		DOCA_LOG_ERR("Unable to open input file %s: %s", cfg->file_path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	if ((size_t)st.st_size < sizeof(header) ||
+	    aes_gcm_file_io(run->in_fd, &header, sizeof(header), 0, false) != DOCA_SUCCESS ||
+	    memcmp(header.magic, AES_GCM_SPARSE_MAGIC, sizeof(header.magic)) != 0 ||
+	    header.version != AES_GCM_SPARSE_VERSION || header.chunk_size == 0 ||
+	    header.num_extents > (st.st_size - sizeof(header)) / sizeof(struct aes_gcm_sparse_extent)) {
+		DOCA_LOG_ERR("File %s is not a sparse container", cfg->file_path);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	if (header.tag_size != cfg->tag_size) {
+		DOCA_LOG_ERR("Sparse container %s holds %u bytes tags, expected %u bytes tags",
+			     cfg->file_path,
+			     header.tag_size,
+			     cfg->tag_size);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	result = alloc_meta(run, header.num_extents, header.tag_size);
+	if (result != DOCA_SUCCESS)
+		return result;
+	run->num_chunks = (header.data_size + header.chunk_size - 1) / header.chunk_size;
+	expected_size = run->chunks_offset + header.data_size + (run->num_chunks * header.tag_size);
+	if ((uint64_t)st.st_size != expected_size) {
+		DOCA_LOG_ERR("Sparse container %s is %ld bytes long, expected %lu bytes",
+			     cfg->file_path,
+			     (long)st.st_size,
+			     expected_size);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	result = aes_gcm_file_io(run->in_fd, run->meta, run->chunks_offset, 0, false);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = header_tag(cfg, run, AES_GCM_MODE_DECRYPT);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Header of sparse container %s failed authentication", cfg->file_path);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	result = check_extents(run->header, run->extents);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	/* The holes are never written, truncating the output up front leaves them unallocated */
+	run->out_fd = open(cfg->output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (run->out_fd < 0 || ftruncate(run->out_fd, run->header->file_size) != 0) {
+		DOCA_LOG_ERR("Unable to create output file %s: %s", cfg->output_path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Read the next bytes of the data extents from the sparse file, or write them to it
+ *
+ * @run [in]: The run, its data cursor is moved past the bytes
+ * @fd [in]: Sparse file descriptor
+ * @buf [in]: Buffer
+ * @len [in]: Number of bytes, no more than the data left after the cursor
+ * @write [in]: true to write the buffer, false to read into it
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t extents_io(struct sparse_run *run, int fd, uint8_t *buf, size_t len, bool write)
+{
+	const struct aes_gcm_sparse_extent *extent;
+	doca_error_t result;
+	size_t n;
+
+	while (len > 0) {
+		extent = &run->extents[run->extent];
+		n = extent->length - run->extent_done;
+		if (n > len)
+			n = len;
+		result = aes_gcm_file_io(fd, buf, n, extent->offset + run->extent_done, write);
+		if (result != DOCA_SUCCESS)
+			return result;
+		run->extent_done += n;
+		if (run->extent_done == extent->length) {
+			run->extent++;
+			run->extent_done = 0;
+		}
+		buf += n;
+		len -= n;
+	}
+	return DOCA_SUCCESS;
+}
+
+bool aes_gcm_sparse_is_requested(const struct aes_gcm_cfg *cfg)
+{
+	return cfg->sparse;
+}
+
+doca_error_t aes_gcm_sparse_run(struct aes_gcm_cfg *cfg, enum aes_gcm_mode mode)
+{
+	struct sparse_run run = {.in_fd = -1, .out_fd = -1};
+	struct aes_gcm_device_group *group = NULL;
+	struct aes_gcm_group_key key = {0};
+	struct aes_gcm_mem src_mem = {0}, dst_mem = {0};
+	struct aes_gcm_job *jobs = NULL;
+	struct aes_gcm_job *job;
+	uint64_t first, data_offset, start_ns;
+	size_t slot_size, batch_chunks, nb_chunks, data_len, chunk_len, i;
+	doca_error_t result, tmp_result;
+
+	result = (mode == AES_GCM_MODE_ENCRYPT) ? open_encrypt(cfg, &run) : open_decrypt(cfg, &run);
+	if (result != DOCA_SUCCESS)
+		goto close_files;
+
+	result = aes_gcm_device_group_create(cfg, mode, &group);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create device group: %s", doca_error_get_descr(result));
+		goto close_files;
+	}
+
+	slot_size = (size_t)run.header->chunk_size + run.header->tag_size;
+	if (slot_size > group->max_buf_size) {
+		DOCA_LOG_ERR("Chunk and tag of %zu bytes > max buffer size %lu", slot_size, group->max_buf_size);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto destroy_group;
+	}
+
+	batch_chunks = (run.num_chunks < AES_GCM_SPARSE_BATCH_CHUNKS) ? run.num_chunks : AES_GCM_SPARSE_BATCH_CHUNKS;
+	if (batch_chunks == 0)
+		batch_chunks = 1;
+	jobs = calloc(batch_chunks, sizeof(*jobs));
+	if (jobs == NULL) {
+		result = DOCA_ERROR_NO_MEMORY;
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(result));
+		goto destroy_group;
+	}
+
+	/* The batch buffers are registered once and reused by every batch */
+	result = aes_gcm_mem_alloc(cfg->hugepages, batch_chunks * slot_size, &src_mem);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+	result = aes_gcm_mem_alloc(cfg->hugepages, batch_chunks * slot_size, &dst_mem);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+
+	result = aes_gcm_device_group_start(group, src_mem.addr, src_mem.size, dst_mem.addr, dst_mem.size);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+
+	result = aes_gcm_device_group_key_create(group, cfg->raw_key, cfg->raw_key_type, &key);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+
+	DOCA_LOG_INFO("%s %lu data bytes in %lu extents of a %lu bytes file on %u devices, %lu bytes of holes skipped",
+		      (mode == AES_GCM_MODE_ENCRYPT) ? "Encrypting" : "Decrypting",
+		      run.header->data_size,
+		      run.header->num_extents,
+		      run.header->file_size,
+		      group->num_members,
+		      run.header->file_size - run.header->data_size);
+
+	start_ns = aes_gcm_get_time_ns();
+	for (first = 0; first < run.num_chunks; first += nb_chunks) {
+		nb_chunks = (run.num_chunks - first < batch_chunks) ? (run.num_chunks - first) : batch_chunks;
+		data_offset = first * run.header->chunk_size;
+		data_len = nb_chunks * run.header->chunk_size;
+		if (data_len > run.header->data_size - data_offset)
+			data_len = run.header->data_size - data_offset;
+
+		/* Full chunks fill their slots, so the encrypted chunks of a batch are back to back in the container */
+		if (mode == AES_GCM_MODE_ENCRYPT)
+			result = extents_io(&run, run.in_fd, src_mem.addr, data_len, false);
+		else
+			result = aes_gcm_file_io(run.in_fd,
+						 src_mem.addr,
+						 data_len + (nb_chunks * run.header->tag_size),
+						 run.chunks_offset + (first * slot_size),
+						 false);
+		if (result != DOCA_SUCCESS)
+			goto destroy_key;
+
+		for (i = 0; i < nb_chunks; i++) {
+			job = &jobs[i];
+			memset(job, 0, sizeof(*job));
+			chunk_len = (data_len - (i * run.header->chunk_size) < run.header->chunk_size) ?
+					    (data_len - (i * run.header->chunk_size)) :
+					    run.header->chunk_size;
+			if (mode == AES_GCM_MODE_ENCRYPT) {
+				job->src = (uint8_t *)src_mem.addr + (i * run.header->chunk_size);
+				job->src_len = chunk_len;
+				job->dst = (uint8_t *)dst_mem.addr + (i * slot_size);
+				job->dst_len = slot_size;
+			} else {
+				job->src = (uint8_t *)src_mem.addr + (i * slot_size);
+				job->src_len = chunk_len + run.header->tag_size;
+				job->dst = (uint8_t *)dst_mem.addr + (i * run.header->chunk_size);
+				job->dst_len = run.header->chunk_size;
+			}
+			aes_gcm_derive_iv(cfg->iv, cfg->iv_length, first + i, job->iv);
+			job->iv_length = cfg->iv_length;
+			job->tag_size = run.header->tag_size;
+			job->aad_size = 0;
+		}
+
+		aes_gcm_device_group_submit_burst(group, &key, jobs, nb_chunks);
+		aes_gcm_device_group_wait(group);
+
+		for (i = 0; i < nb_chunks; i++) {
+			if (jobs[i].result != DOCA_SUCCESS) {
+				result = jobs[i].result;
+				DOCA_LOG_ERR("Chunk %lu failed: %s", first + i, doca_error_get_descr(result));
+				goto destroy_key;
+			}
+		}
+
+		if (mode == AES_GCM_MODE_ENCRYPT)
+			result = aes_gcm_file_io(run.out_fd,
+						 dst_mem.addr,
+						 data_len + (nb_chunks * run.header->tag_size),
+						 run.chunks_offset + (first * slot_size),
+						 true);
+		else
+			result = extents_io(&run, run.out_fd, dst_mem.addr, data_len, true);
+		if (result != DOCA_SUCCESS)
+			goto destroy_key;
+	}
+	aes_gcm_device_group_report(group, aes_gcm_get_time_ns() - start_ns);
+
+	DOCA_LOG_INFO("File was %s successfully and saved in: %s",
+		      (mode == AES_GCM_MODE_ENCRYPT) ? "encrypted" : "decrypted",
+		      cfg->output_path);
+
+destroy_key:
+	tmp_result = aes_gcm_device_group_key_destroy(group, &key);
+	DOCA_ERROR_PROPAGATE(result, tmp_result);
+destroy_group:
+	free(jobs);
+	tmp_result = aes_gcm_device_group_destroy(group);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to destroy device group: %s", doca_error_get_descr(tmp_result));
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+	aes_gcm_mem_free(&dst_mem);
+	aes_gcm_mem_free(&src_mem);
+close_files:
+	if (run.in_fd >= 0)
+		close(run.in_fd);
+	if (run.out_fd >= 0)
+		close(run.out_fd);
+	free(run.meta);
+
+	return result;
+}
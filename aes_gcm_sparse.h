@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_SPARSE_H_
+#define AES_GCM_SPARSE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+
+#define AES_GCM_SPARSE_MAGIC "AGSP"			/* Sparse container magic */
+#define AES_GCM_SPARSE_VERSION 1			/* Sparse container format version */
+#define AES_GCM_SPARSE_DEFAULT_CHUNK_SIZE (1024 * 1024)	/* Chunk size when none is given */
+#define AES_GCM_SPARSE_BATCH_CHUNKS 32			/* Max chunks in flight in one batch */
+
+/*
+ * Sparse container header, in host byte order
+ *
+ * It is followed by num_extents data extents, by the header tag, which authenticates the header and the extents, and
+ * by the encrypted chunks. The data of the extents, back to back, is cut in chunks of chunk_size bytes, the last chunk
+ * may be shorter, and every encrypted chunk is its ciphertext followed by its tag.
+ */
+struct aes_gcm_sparse_header {
+	char magic[4];	      /* AES_GCM_SPARSE_MAGIC, not NULL terminated */
+	uint32_t version;     /* AES_GCM_SPARSE_VERSION */
+	uint32_t tag_size;    /* Size of every tag */
+	uint32_t chunk_size;  /* Data bytes per chunk */
+	uint64_t file_size;   /* Size of the sparse file, holes included */
+	uint64_t data_size;   /* Bytes in the data extents */
+	uint64_t num_extents; /* Number of data extents */
+};
+
+/* Data extent of a sparse file, everything between the extents is a hole */
+struct aes_gcm_sparse_extent {
+	uint64_t offset; /* Extent offset in the file */
+	uint64_t length; /* Extent length */
+};
+
+/*
+ * Check if the configuration asks for the sparse file mode
+ *
+ * @cfg [in]: Configuration parameters
+ * @return: true if the run should go through aes_gcm_sparse_run()
+ */
+bool aes_gcm_sparse_is_requested(const struct aes_gcm_cfg *cfg);
+
+/*
+ * Encrypt a sparse file into a sparse container, or restore the sparse file from its container
+ *
+ * Encryption walks cfg->file_path with SEEK_DATA and SEEK_HOLE and only reads its data extents, the holes are recorded
+ * in the container as the gaps between the extents. Chunk i of the data is encrypted with the IV derived from cfg->iv
+ * and i by aes_gcm_derive_iv(), with chunks of cfg->chunk_size bytes, AES_GCM_SPARSE_DEFAULT_CHUNK_SIZE when unset.
+ * The header tag is computed on the CPU with the IV of index num_chunks. Decryption checks the header tag, then writes
+ * the data extents to cfg->output_path and leaves the holes unwritten, so the output is sparse again.
+ * The chunks go through a device group AES_GCM_SPARSE_BATCH_CHUNKS at a time, the file is never loaded as a whole.
+ *
+ * @cfg [in]: Configuration parameters
+ * @mode [in]: AES-GCM mode - encrypt/decrypt
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_sparse_run(struct aes_gcm_cfg *cfg, enum aes_gcm_mode mode);
+
+#endif /* AES_GCM_SPARSE_H_ */
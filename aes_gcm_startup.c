@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <doca_aes_gcm.h>
+#include <doca_dev.h>
+#include <doca_error.h>
+#include <doca_log.h>
+
+#include "aes_gcm_startup.h"
+
+DOCA_LOG_REGISTER(AES_GCM::STARTUP);
+
+#define CAPS_CACHE_VERSION 1 /* Cache file format version */
+
+/*
+ * Find a cache entry matching the device identity
+ *
+ * @cache [in]: Device capabilities cache
+ * @id [in]: Device identity: PCI address, IB device name and firmware version
+ * @return: the matching entry or NULL
+ */
+static struct aes_gcm_dev_caps *caps_cache_lookup(struct aes_gcm_caps_cache *cache, const struct aes_gcm_dev_caps *id)
+{
+	struct aes_gcm_dev_caps *entry;
+	uint32_t i;
+
+	for (i = 0; i < cache->num_entries; i++) {
+		entry = &cache->entries[i];
+		if (strcmp(entry->pci_addr, id->pci_addr) == 0 && strcmp(entry->ibdev_name, id->ibdev_name) == 0 &&
+		    strcmp(entry->fw_version, id->fw_version) == 0)
+			return entry;
+	}
+	return NULL;
+}
+
+/*
+ * Store a probed device in the cache, replacing a stale entry of the same PCI address
+ *
+ * @cache [in]: Device capabilities cache
+ * @caps [in]: Probed device capabilities
+ */
+static void caps_cache_store(struct aes_gcm_caps_cache *cache, const struct aes_gcm_dev_caps *caps)
+{
+	uint32_t i;
+
+	for (i = 0; i < cache->num_entries; i++) {
+		if (strcmp(cache->entries[i].pci_addr, caps->pci_addr) == 0)
+			break;
+	}
+	if (i == AES_GCM_CAPS_CACHE_MAX_ENTRIES)
+		return;
+	if (i == cache->num_entries)
+		cache->num_entries++;
+	cache->entries[i] = *caps;
+	cache->dirty = true;
+}
+
+/*
+ * Query the AES-GCM capabilities of a device
+ *
+ * @devinfo [in]: The device
+ * @caps [in/out]: Device capabilities, the identity fields must be set
+ */
+static void probe_caps(struct doca_devinfo *devinfo, struct aes_gcm_dev_caps *caps)
+{
+	caps->encrypt_supported = (doca_aes_gcm_cap_task_encrypt_is_supported(devinfo) == DOCA_SUCCESS);
+	caps->decrypt_supported = (doca_aes_gcm_cap_task_decrypt_is_supported(devinfo) == DOCA_SUCCESS);
+
+	if (caps->encrypt_supported &&
+	    doca_aes_gcm_cap_task_encrypt_get_max_buf_size(devinfo, &caps->encrypt_max_buf_size) != DOCA_SUCCESS)
+		caps->encrypt_supported = false;
+	if (caps->decrypt_supported &&
+	    doca_aes_gcm_cap_task_decrypt_get_max_buf_size(devinfo, &caps->decrypt_max_buf_size) != DOCA_SUCCESS)
+		caps->decrypt_supported = false;
+	if (doca_aes_gcm_cap_get_max_num_tasks(devinfo, &caps->max_num_tasks) != DOCA_SUCCESS)
+		caps->max_num_tasks = NUM_AES_GCM_TASKS;
+}
+
+doca_error_t aes_gcm_caps_cache_load(const char *path, struct aes_gcm_caps_cache *cache)
+{
+	struct aes_gcm_dev_caps *entry;
+	struct stat st;
+	FILE *file;
+	int fd, version, encrypt_supported, decrypt_supported;
+
+	memset(cache, 0, sizeof(*cache));
+
+	fd = open(path, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+	if (fd < 0) {
+		if (errno == ENOENT)
+			return DOCA_SUCCESS;
+		DOCA_LOG_WARN("Unable to open capabilities cache %s: %s", path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	/* The cache sizes the tasks, only trust a file no other user could have written */
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_uid != geteuid() ||
+	    (st.st_mode & (S_IWGRP | S_IWOTH)) != 0) {
+		DOCA_LOG_WARN("Ignoring capabilities cache %s, it is not a private file of the current user", path);
+		close(fd);
+		return DOCA_SUCCESS;
+	}
+
+	file = fdopen(fd, "r");
+	if (file == NULL) {
+		DOCA_LOG_WARN("Unable to open capabilities cache %s: %s", path, strerror(errno));
+		close(fd);
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	if (fscanf(file, "version %d\n", &version) != 1 || version != CAPS_CACHE_VERSION) {
+		DOCA_LOG_WARN("Ignoring capabilities cache %s with unknown format", path);
+		fclose(file);
+		return DOCA_SUCCESS;
+	}
+
+	while (cache->num_entries < AES_GCM_CAPS_CACHE_MAX_ENTRIES) {
+		entry = &cache->entries[cache->num_entries];
+		if (fscanf(file,
+			   "%12s %63s %63s %d %d %lu %lu %u\n",
+			   entry->pci_addr,
+			   entry->ibdev_name,
+			   entry->fw_version,
+			   &encrypt_supported,
+			   &decrypt_supported,
+			   &entry->encrypt_max_buf_size,
+			   &entry->decrypt_max_buf_size,
+			   &entry->max_num_tasks) != 8)
+			break;
+		entry->encrypt_supported = (encrypt_supported != 0);
+		entry->decrypt_supported = (decrypt_supported != 0);
+		cache->num_entries++;
+	}
+
+	fclose(file);
+	DOCA_LOG_DBG("Loaded %u devices from capabilities cache %s", cache->num_entries, path);
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_caps_cache_save(const char *path, struct aes_gcm_caps_cache *cache)
+{
+	char tmp_path[MAX_FILE_NAME + 8], dir_path[MAX_FILE_NAME];
+	const struct aes_gcm_dev_caps *entry;
+	FILE *file;
+	uint32_t i;
+	int fd;
+
+	if (!cache->dirty)
+		return DOCA_SUCCESS;
+
+	/* The default directory is private to the user running the sample, create it on first use */
+	snprintf(dir_path, sizeof(dir_path), "%s", path);
+	if (mkdir(dirname(dir_path), 0700) != 0 && errno != EEXIST) {
+		DOCA_LOG_WARN("Unable to create the directory of capabilities cache %s: %s", path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	/* A fresh temporary file with an unpredictable name, never one planted by another user */
+	snprintf(tmp_path, sizeof(tmp_path), "%s.XXXXXX", path);
+	fd = mkstemp(tmp_path);
+	if (fd < 0) {
+		DOCA_LOG_WARN("Unable to write capabilities cache %s: %s", path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+	file = fdopen(fd, "w");
+	if (file == NULL) {
+		DOCA_LOG_WARN("Unable to write capabilities cache %s: %s", tmp_path, strerror(errno));
+		close(fd);
+		remove(tmp_path);
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	fprintf(file, "version %d\n", CAPS_CACHE_VERSION);
+	for (i = 0; i < cache->num_entries; i++) {
+		entry = &cache->entries[i];
+		fprintf(file,
+			"%s %s %s %d %d %lu %lu %u\n",
+			entry->pci_addr,
+			entry->ibdev_name,
+			entry->fw_version,
+			entry->encrypt_supported,
+			entry->decrypt_supported,
+			entry->encrypt_max_buf_size,
+			entry->decrypt_max_buf_size,
+			entry->max_num_tasks);
+	}
+
+	if (fclose(file) != 0 || rename(tmp_path, path) != 0) {
+		DOCA_LOG_WARN("Unable to write capabilities cache %s: %s", path, strerror(errno));
+		remove(tmp_path);
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	cache->dirty = false;
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_dev_caps_get(struct aes_gcm_caps_cache *cache,
+				  struct doca_devinfo *devinfo,
+				  struct aes_gcm_dev_caps *caps)
+{
+	struct aes_gcm_dev_caps *entry;
+	doca_error_t result;
+
+	memset(caps, 0, sizeof(*caps));
+
+	result = doca_devinfo_get_pci_addr_str(devinfo, caps->pci_addr);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to get device PCI address: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_devinfo_get_ibdev_name(devinfo, caps->ibdev_name, sizeof(caps->ibdev_name));
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to get device IB name: %s", doca_error_get_descr(result));
+		return result;
+	}
+	aes_gcm_get_fw_version(caps->ibdev_name, caps->fw_version, sizeof(caps->fw_version));
+
+	entry = caps_cache_lookup(cache, caps);
+	if (entry != NULL) {
+		*caps = *entry;
+		cache->num_hits++;
+		return DOCA_SUCCESS;
+	}
+
+	probe_caps(devinfo, caps);
+	caps_cache_store(cache, caps);
+	return DOCA_SUCCESS;
+}
+
+void aes_gcm_get_fw_version(const char *ibdev_name, char *fw_version, size_t size)
+{
+	char path[128];
+	FILE *file;
+	size_t len;
+
+	snprintf(path, sizeof(path), "/sys/class/infiniband/%s/fw_ver", ibdev_name);
+	file = fopen(path, "r");
+	if (file == NULL || fgets(fw_version, size, file) == NULL) {
+		snprintf(fw_version, size, "unknown");
+		if (file != NULL)
+			fclose(file);
+		return;
+	}
+	fclose(file);
+
+	len = strcspn(fw_version, " \n");
+	fw_version[len] = '\0';
+}
+
+const char *aes_gcm_startup_phase_name(enum aes_gcm_startup_phase phase)
+{
+	switch (phase) {
+	case AES_GCM_STARTUP_DEV_OPEN:
+		return "device open";
+	case AES_GCM_STARTUP_CTX_CREATE:
+		return "context create";
+	case AES_GCM_STARTUP_MMAP_START:
+		return "memory registration";
+	case AES_GCM_STARTUP_CTX_START:
+		return "context start";
+	default:
+		return "unknown";
+	}
+}
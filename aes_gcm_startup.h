@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_STARTUP_H_
+#define AES_GCM_STARTUP_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <doca_dev.h>
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+
+#define AES_GCM_CAPS_CACHE_MAX_ENTRIES 32 /* Max number of devices in the cache */
+#define AES_GCM_FW_VERSION_SIZE 64	  /* Max firmware version string length */
+
+/* Capabilities of a device, as probed or loaded from the cache */
+struct aes_gcm_dev_caps {
+	char pci_addr[DOCA_DEVINFO_PCI_ADDR_SIZE];     /* Device PCI address */
+	char ibdev_name[DOCA_DEVINFO_IBDEV_NAME_SIZE]; /* Device IB name */
+	char fw_version[AES_GCM_FW_VERSION_SIZE];      /* Device firmware version */
+	bool encrypt_supported;			       /* Encrypt task is supported */
+	bool decrypt_supported;			       /* Decrypt task is supported */
+	uint64_t encrypt_max_buf_size;		       /* Encrypt task max buffer size */
+	uint64_t decrypt_max_buf_size;		       /* Decrypt task max buffer size */
+	uint32_t max_num_tasks;			       /* Max number of tasks per context */
+};
+
+/* Device capabilities cache, entries are keyed by PCI address, IB device name and firmware version */
+struct aes_gcm_caps_cache {
+	struct aes_gcm_dev_caps entries[AES_GCM_CAPS_CACHE_MAX_ENTRIES]; /* Cached devices */
+	uint32_t num_entries;						 /* Number of cached devices */
+	uint32_t num_hits;						 /* Lookups served from the cache */
+	bool dirty;							 /* Cache changed since it was loaded */
+};
+
+/*
+ * Load the device capabilities cache, a missing file results in an empty cache
+ *
+ * @path [in]: Cache file path
+ * @cache [out]: The loaded cache
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_caps_cache_load(const char *path, struct aes_gcm_caps_cache *cache);
+
+/*
+ * Save the device capabilities cache if it changed, the file is replaced atomically
+ *
+ * @path [in]: Cache file path
+ * @cache [in]: The cache to save
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_caps_cache_save(const char *path, struct aes_gcm_caps_cache *cache);
+
+/*
+ * Get the capabilities of a device from the cache, probing the device on a cache miss
+ *
+ * @cache [in]: Device capabilities cache, updated on a miss
+ * @devinfo [in]: The device
+ * @caps [out]: The device capabilities
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_dev_caps_get(struct aes_gcm_caps_cache *cache,
+				  struct doca_devinfo *devinfo,
+				  struct aes_gcm_dev_caps *caps);
+
+/*
+ * Read the firmware version of a device from sysfs
+ *
+ * @ibdev_name [in]: Device IB name
+ * @fw_version [out]: Firmware version string, "unknown" if it is not exposed
+ * @size [in]: fw_version buffer size
+ */
+void aes_gcm_get_fw_version(const char *ibdev_name, char *fw_version, size_t size);
+
+/*
+ * Get the printable name of a startup phase
+ *
+ * @phase [in]: Startup phase
+ * @return: phase name
+ */
+const char *aes_gcm_startup_phase_name(enum aes_gcm_startup_phase phase);
+
+#endif /* AES_GCM_STARTUP_H_ */
@@ -0,0 +1,615 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <doca_log.h>
+#include <doca_error.h>
+
+#include "aes_gcm_checkpoint.h"
+#include "aes_gcm_compress.h"
+#include "aes_gcm_device_group.h"
+#include "aes_gcm_gmac.h"
+#include "aes_gcm_hugepage.h"
+#include "aes_gcm_record.h"
+#include "aes_gcm_stream.h"
+#include "aes_gcm_sw.h"
+#include "aes_gcm_tag_index.h"
+#include "aes_gcm_tls.h"
+
+DOCA_LOG_REGISTER(AES_GCM::STREAM);
+
+doca_error_t aes_gcm_stream_compute_layout(const struct aes_gcm_cfg *cfg,
+					   enum aes_gcm_mode mode,
+					   size_t file_size,
+					   struct aes_gcm_stream_layout *layout)
+{
+	bool detached = (cfg->tag_index_path[0] != '\0');
+	size_t last_chunk_size;
+
+	if (file_size == 0) {
+		DOCA_LOG_ERR("Input file is empty");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	if (cfg->chunk_size == 0)
+		layout->in_chunk_size = file_size;
+	else if (mode == AES_GCM_MODE_ENCRYPT || detached)
+		layout->in_chunk_size = cfg->chunk_size;
+	else
+		layout->in_chunk_size = (size_t)cfg->chunk_size + cfg->tag_size;
+
+	layout->num_chunks = (file_size + layout->in_chunk_size - 1) / layout->in_chunk_size;
+	last_chunk_size = file_size - ((layout->num_chunks - 1) * layout->in_chunk_size);
+
+	if (mode == AES_GCM_MODE_DECRYPT && !detached && last_chunk_size <= cfg->tag_size) {
+		DOCA_LOG_ERR("Last chunk of %zu bytes is too short to hold a %u bytes tag", last_chunk_size, cfg->tag_size);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	/* Detached chunks go to the data file with direct I/O, every chunk must start on an aligned offset */
+	if (detached && cfg->chunk_size % AES_GCM_DATA_ALIGNMENT != 0) {
+		DOCA_LOG_ERR("Chunk size %u must be a multiple of %d bytes when the tags are detached",
+			     cfg->chunk_size,
+			     AES_GCM_DATA_ALIGNMENT);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	if (layout->num_chunks > 1 && cfg->aad_size != 0) {
+		DOCA_LOG_ERR("Additional authenticated data is only supported when the file is processed as one chunk");
+		return DOCA_ERROR_NOT_SUPPORTED;
+	}
+
+	/* Detached tags leave the payload chunks back to back in the output */
+	if (mode == AES_GCM_MODE_ENCRYPT && !detached)
+		layout->out_chunk_size = layout->in_chunk_size + cfg->tag_size;
+	else
+		layout->out_chunk_size = layout->in_chunk_size;
+
+	return DOCA_SUCCESS;
+}
+
+bool aes_gcm_stream_is_requested(const struct aes_gcm_cfg *cfg)
+{
+	return cfg->chunk_size != 0 || cfg->num_pci_addresses > 1 || cfg->all_devices || cfg->tag_index_path[0] != '\0' ||
+	       cfg->compress_codec[0] != '\0' || cfg->emu.num_devices > 0 || cfg->records ||
+	       cfg->tls_secret_len != 0 || cfg->gmac_manifest_path[0] != '\0' ||
+	       cfg->dst_buffers != AES_GCM_DST_FULL || cfg->checkpoint_path[0] != '\0';
+}
+
+/*
+ * Name of a destination memory mode, for the logs
+ *
+ * @dst_buffers [in]: Destination memory mode
+ * @return: the mode name
+ */
+static const char *dst_buffers_name(enum aes_gcm_dst_buffers dst_buffers)
+{
+	switch (dst_buffers) {
+	case AES_GCM_DST_IN_PLACE:
+		return "in-place";
+	case AES_GCM_DST_PING_PONG:
+		return "ping-pong";
+	default:
+		return "full";
+	}
+}
+
+/*
+ * Check a window of consecutive chunks completed and append them to the output file
+ *
+ * With direct I/O, the window is written with a single aligned write, its chunks are back to back in the destination
+ * memory. Only the last chunk of the file may end off the alignment, its tail goes through the page cache.
+ *
+ * @cfg [in]: Configuration parameters
+ * @out_file [in]: Output file
+ * @direct_fd [in]: Output file opened with O_DIRECT, -1 to append through out_file
+ * @jobs [in]: Jobs of the window, in chunk order
+ * @first [in]: Index of the first chunk of the window
+ * @nb_chunks [in]: Number of chunks in the window
+ * @output_size [in/out]: Output bytes written so far
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t write_chunks(const struct aes_gcm_cfg *cfg,
+				 FILE *out_file,
+				 int direct_fd,
+				 const struct aes_gcm_job *jobs,
+				 size_t first,
+				 size_t nb_chunks,
+				 uint64_t *output_size)
+{
+	size_t i, aligned_len, len = 0;
+
+	for (i = 0; i < nb_chunks; i++) {
+		if (jobs[i].result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Chunk %zu failed: %s", first + i, doca_error_get_descr(jobs[i].result));
+			return jobs[i].result;
+		}
+		len += jobs[i].out_len;
+		if (direct_fd >= 0)
+			continue;
+		if (fwrite(jobs[i].dst, sizeof(uint8_t), jobs[i].out_len, out_file) != jobs[i].out_len) {
+			DOCA_LOG_ERR("Failed to write to output file: %s", cfg->output_path);
+			return DOCA_ERROR_IO_FAILED;
+		}
+	}
+
+	if (direct_fd >= 0 && nb_chunks != 0) {
+		aligned_len = len & ~((size_t)AES_GCM_DATA_ALIGNMENT - 1);
+		if (aes_gcm_file_io(direct_fd, jobs[0].dst, aligned_len, *output_size, true) != DOCA_SUCCESS ||
+		    aes_gcm_file_io(fileno(out_file),
+				    (uint8_t *)jobs[0].dst + aligned_len,
+				    len - aligned_len,
+				    *output_size + aligned_len,
+				    true) != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to write to output file: %s", cfg->output_path);
+			return DOCA_ERROR_IO_FAILED;
+		}
+	}
+	*output_size += len;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Check that the output holds the last chunk of a checkpoint, by running that chunk again on the CPU
+ *
+ * This catches a checkpoint resumed with another key, input or output than the ones it was taken with.
+ *
+ * @cfg [in]: Configuration parameters
+ * @checkpoint [in]: The checkpoint, with at least one done chunk
+ * @file_data [in]: Input file data
+ * @out_file [in]: Output file
+ * @tags [in]: Detached tags, the tags of the done chunks included, NULL when the tags are not detached
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR_INVALID_VALUE when the chunk does not match and DOCA_ERROR otherwise
+ */
+static doca_error_t verify_last_chunk(const struct aes_gcm_cfg *cfg,
+				      const struct aes_gcm_checkpoint *checkpoint,
+				      char *file_data,
+				      FILE *out_file,
+				      uint8_t *tags)
+{
+	uint64_t chunk = checkpoint->done_chunks - 1;
+	uint32_t key_len = (cfg->raw_key_type == DOCA_AES_GCM_KEY_128) ? 16 : 32;
+	uint8_t tag[AES_GCM_AUTH_TAG_128_SIZE_IN_BYTES];
+	struct aes_gcm_job job = {0};
+	size_t offset = chunk * checkpoint->in_chunk_size;
+	uint8_t *expected, *written;
+	size_t out_len;
+	doca_error_t result;
+
+	expected = malloc(2 * checkpoint->out_chunk_size);
+	if (expected == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(DOCA_ERROR_NO_MEMORY));
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	written = expected + checkpoint->out_chunk_size;
+
+	job.mode = checkpoint->mode;
+	job.src = file_data + offset;
+	job.src_len = (checkpoint->file_size - offset < checkpoint->in_chunk_size) ? (checkpoint->file_size - offset) :
+										      checkpoint->in_chunk_size;
+	job.dst = expected;
+	job.dst_len = checkpoint->out_chunk_size;
+	aes_gcm_derive_iv(cfg->iv, cfg->iv_length, chunk, job.iv);
+	job.iv_length = cfg->iv_length;
+	job.tag_size = cfg->tag_size;
+	job.aad_size = cfg->aad_size;
+	if (tags != NULL)
+		job.tag = (checkpoint->mode == AES_GCM_MODE_ENCRYPT) ? tag : (tags + (chunk * cfg->tag_size));
+
+	result = aes_gcm_sw_run_job(cfg->raw_key, key_len, &job, &out_len);
+	if (result != DOCA_SUCCESS || out_len > checkpoint->output_size) {
+		DOCA_LOG_ERR("Chunk %lu of the checkpoint does not run with this key and input", chunk);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto free_buffers;
+	}
+
+	result = aes_gcm_file_io(fileno(out_file), written, out_len, checkpoint->output_size - out_len, false);
+	if (result != DOCA_SUCCESS)
+		goto free_buffers;
+
+	if (memcmp(expected, written, out_len) != 0 ||
+	    (tags != NULL && checkpoint->mode == AES_GCM_MODE_ENCRYPT &&
+	     memcmp(tag, tags + (chunk * cfg->tag_size), cfg->tag_size) != 0)) {
+		DOCA_LOG_ERR("Output of chunk %lu does not match the checkpoint", chunk);
+		result = DOCA_ERROR_INVALID_VALUE;
+	}
+
+free_buffers:
+	free(expected);
+	return result;
+}
+
+/*
+ * Load the checkpoint of an interrupted run and rewind the output to it
+ *
+ * The checkpoint must describe the same run: mode, IV, chunk layout and input size. Its last chunk is checked against
+ * the output, see verify_last_chunk(), and the output is cut back to the checkpoint, dropping whatever was written
+ * after it.
+ *
+ * @cfg [in]: Configuration parameters
+ * @expected [in]: Checkpoint of the run before its first chunk
+ * @file_data [in]: Input file data
+ * @out_file [in]: Output file, opened without truncation
+ * @tags [in/out]: Detached tags, the tags of the done chunks are restored on encrypt, NULL when not detached
+ * @checkpoint [out]: The checkpoint to continue from, expected when there is none
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR_INVALID_VALUE when the checkpoint does not match the run and
+ * DOCA_ERROR otherwise
+ */
+static doca_error_t resume_from_checkpoint(const struct aes_gcm_cfg *cfg,
+					   const struct aes_gcm_checkpoint *expected,
+					   char *file_data,
+					   FILE *out_file,
+					   uint8_t *tags,
+					   struct aes_gcm_checkpoint *checkpoint)
+{
+	struct aes_gcm_checkpoint run;
+	uint8_t *checkpoint_tags = NULL;
+	struct stat st;
+	doca_error_t result;
+
+	result = aes_gcm_checkpoint_load(cfg->checkpoint_path, checkpoint, &checkpoint_tags);
+	if (result == DOCA_ERROR_NOT_FOUND) {
+		DOCA_LOG_INFO("No checkpoint in %s, starting from the first chunk", cfg->checkpoint_path);
+		*checkpoint = *expected;
+		return DOCA_SUCCESS;
+	}
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	/* The header has no padding, it matches the run once the progress fields are cleared */
+	run = *checkpoint;
+	run.done_chunks = 0;
+	run.output_size = 0;
+	if (memcmp(&run, expected, sizeof(run)) != 0 || checkpoint->done_chunks >= checkpoint->num_chunks) {
+		DOCA_LOG_ERR("Checkpoint %s was taken by another run, remove it to start over", cfg->checkpoint_path);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto free_tags;
+	}
+
+	if (fstat(fileno(out_file), &st) != 0 || (uint64_t)st.st_size < checkpoint->output_size) {
+		DOCA_LOG_ERR("Output file %s is shorter than the %lu bytes of checkpoint %s",
+			     cfg->output_path,
+			     checkpoint->output_size,
+			     cfg->checkpoint_path);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto free_tags;
+	}
+
+	if (checkpoint_tags != NULL && checkpoint->mode == AES_GCM_MODE_ENCRYPT)
+		memcpy(tags, checkpoint_tags, checkpoint->done_chunks * checkpoint->tag_size);
+
+	if (checkpoint->done_chunks != 0) {
+		result = verify_last_chunk(cfg, checkpoint, file_data, out_file, tags);
+		if (result != DOCA_SUCCESS)
+			goto free_tags;
+	}
+
+	if (ftruncate(fileno(out_file), checkpoint->output_size) != 0 ||
+	    fseeko(out_file, checkpoint->output_size, SEEK_SET) != 0) {
+		DOCA_LOG_ERR("Failed to rewind output file %s: %s", cfg->output_path, strerror(errno));
+		result = DOCA_ERROR_IO_FAILED;
+		goto free_tags;
+	}
+
+	DOCA_LOG_INFO("Resuming from checkpoint %s after %lu of %lu chunks",
+		      cfg->checkpoint_path,
+		      checkpoint->done_chunks,
+		      checkpoint->num_chunks);
+
+free_tags:
+	free(checkpoint_tags);
+	return result;
+}
+
+/*
+ * Make the output durable up to a chunk watermark and record it in the checkpoint file
+ *
+ * @cfg [in]: Configuration parameters
+ * @out_file [in]: Output file
+ * @checkpoint [in]: The checkpoint, with the watermark and output size of the chunks written so far
+ * @tags [in]: Detached tags, NULL when the tags are not detached
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t take_checkpoint(const struct aes_gcm_cfg *cfg,
+				    FILE *out_file,
+				    const struct aes_gcm_checkpoint *checkpoint,
+				    const uint8_t *tags)
+{
+	/* The output must reach the disk before a checkpoint vouches for it */
+	if (fflush(out_file) != 0 || fdatasync(fileno(out_file)) != 0) {
+		DOCA_LOG_ERR("Failed to flush output file %s: %s", cfg->output_path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+	DOCA_LOG_DBG("Checkpoint after %lu of %lu chunks", checkpoint->done_chunks, checkpoint->num_chunks);
+	return aes_gcm_checkpoint_save(cfg->checkpoint_path, checkpoint, tags);
+}
+
+doca_error_t aes_gcm_stream_file(struct aes_gcm_cfg *cfg, enum aes_gcm_mode mode, char *file_data, size_t file_size)
+{
+	struct aes_gcm_device_group *group = NULL;
+	struct aes_gcm_group_key key = {0};
+	struct aes_gcm_stream_layout layout;
+	struct aes_gcm_job *jobs = NULL;
+	struct aes_gcm_job *job;
+	struct aes_gcm_mem dst_mem = {0};
+	enum aes_gcm_dst_buffers dst_buffers;
+	char *dst_buffer;
+	uint8_t *tags = NULL;
+	bool detached = (cfg->tag_index_path[0] != '\0');
+	bool checkpointed = (cfg->checkpoint_path[0] != '\0');
+	struct aes_gcm_checkpoint expected = {0}, checkpoint = {0};
+	FILE *out_file = NULL;
+	int direct_fd = -1;
+	size_t i, offset, dst_len, window, num_jobs, start, first, nb_chunks = 0;
+	uint64_t start_ns, checkpoint_ns, output_size = 0;
+	doca_error_t result, tmp_result;
+
+	/* Authenticate-only runs produce nothing but a manifest of tags */
+	if (cfg->gmac_manifest_path[0] != '\0')
+		return aes_gcm_gmac_file(cfg, mode, file_data, file_size);
+
+	/* Compressed files are made of variable length records */
+	if (cfg->compress_codec[0] != '\0')
+		return aes_gcm_compress_stream_file(cfg, mode, file_data, file_size);
+
+	/* Record streams are framed by their producer, not cut into chunks */
+	if (cfg->records)
+		return aes_gcm_record_stream_file(cfg, mode, file_data, file_size);
+	if (cfg->tls_secret_len != 0)
+		return aes_gcm_tls_stream_file(cfg, mode, file_data, file_size);
+
+	result = aes_gcm_stream_compute_layout(cfg, mode, file_size, &layout);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	/* A resumed run keeps the output written before the checkpoint */
+	out_file = fopen(cfg->output_path, (checkpointed && cfg->resume) ? "r+" : "w");
+	if (out_file == NULL && checkpointed && cfg->resume && errno == ENOENT)
+		out_file = fopen(cfg->output_path, "w");
+	if (out_file == NULL) {
+		DOCA_LOG_ERR("Unable to open output file: %s", cfg->output_path);
+		return DOCA_ERROR_NO_MEMORY;
+	}
+
+	result = aes_gcm_device_group_create(cfg, mode, &group);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create device group: %s", doca_error_get_descr(result));
+		goto close_file;
+	}
+
+	if (layout.in_chunk_size > group->max_buf_size) {
+		DOCA_LOG_ERR("Chunk size %zu > max buffer size %lu", layout.in_chunk_size, group->max_buf_size);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto destroy_group;
+	}
+
+	if (detached && mode == AES_GCM_MODE_ENCRYPT) {
+		tags = calloc(layout.num_chunks, cfg->tag_size);
+		if (tags == NULL) {
+			result = DOCA_ERROR_NO_MEMORY;
+			DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(result));
+			goto destroy_group;
+		}
+	} else if (detached) {
+		result = aes_gcm_tag_index_read(cfg->tag_index_path, cfg, layout.num_chunks, file_size, &tags);
+		if (result != DOCA_SUCCESS)
+			goto destroy_group;
+	}
+
+	/* The IV of a chunk derives from its index, so the watermark is all the IV state a checkpoint needs */
+	if (checkpointed) {
+		memcpy(expected.magic, AES_GCM_CHECKPOINT_MAGIC, sizeof(expected.magic));
+		expected.version = AES_GCM_CHECKPOINT_VERSION;
+		expected.mode = mode;
+		expected.detached = detached;
+		expected.tag_size = cfg->tag_size;
+		expected.aad_size = cfg->aad_size;
+		expected.iv_length = cfg->iv_length;
+		memcpy(expected.iv, cfg->iv, cfg->iv_length);
+		expected.in_chunk_size = layout.in_chunk_size;
+		expected.out_chunk_size = layout.out_chunk_size;
+		expected.file_size = file_size;
+		expected.num_chunks = layout.num_chunks;
+		if (cfg->resume) {
+			result = resume_from_checkpoint(cfg, &expected, file_data, out_file, tags, &checkpoint);
+			if (result != DOCA_SUCCESS)
+				goto destroy_group;
+		} else {
+			aes_gcm_checkpoint_remove(cfg->checkpoint_path);
+			checkpoint = expected;
+		}
+		output_size = checkpoint.output_size;
+	}
+	start = checkpoint.done_chunks;
+
+	/*
+	 * In place chunks are written over their input, which only fits when the output is not larger. Ping-pong
+	 * windows hold as many chunks as the members have task slots, one is written out while the other is processed.
+	 * Checkpointed runs need the output to be written as it goes, so they always run in windows.
+	 */
+	dst_buffers = cfg->dst_buffers;
+	if (dst_buffers == AES_GCM_DST_IN_PLACE && layout.out_chunk_size > layout.in_chunk_size) {
+		DOCA_LOG_INFO("Encrypted chunks outgrow their input by the tag, using ping-pong buffers instead");
+		dst_buffers = AES_GCM_DST_PING_PONG;
+	}
+	if (dst_buffers == AES_GCM_DST_FULL && checkpointed)
+		dst_buffers = AES_GCM_DST_PING_PONG;
+	window = layout.num_chunks - start;
+	num_jobs = window;
+	if (dst_buffers == AES_GCM_DST_PING_PONG || checkpointed) {
+		for (i = 0, window = 0; i < group->num_members; i++)
+			window += group->members[i].max_inflight;
+		if (window > num_jobs)
+			window = num_jobs;
+		if (2 * window < num_jobs)
+			num_jobs = 2 * window;
+	}
+
+	jobs = calloc(num_jobs, sizeof(*jobs));
+	if (jobs == NULL) {
+		result = DOCA_ERROR_NO_MEMORY;
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(result));
+		goto free_buffers;
+	}
+
+	if (dst_buffers == AES_GCM_DST_IN_PLACE) {
+		dst_buffer = file_data;
+		dst_len = file_size;
+	} else {
+		dst_len = num_jobs * layout.out_chunk_size;
+		result = aes_gcm_mem_alloc(cfg->hugepages, dst_len, &dst_mem);
+		if (result != DOCA_SUCCESS)
+			goto free_buffers;
+		dst_buffer = dst_mem.addr;
+	}
+
+	/*
+	 * The detached chunks start on aligned offsets of the data file and of the destination memory, which is page
+	 * aligned unless an in place run was handed other memory, so they bypass the page cache when the file system
+	 * allows it
+	 */
+	if (detached && ((uintptr_t)dst_buffer % AES_GCM_DATA_ALIGNMENT) == 0) {
+		direct_fd = open(cfg->output_path, O_WRONLY | O_DIRECT);
+		if (direct_fd < 0)
+			DOCA_LOG_WARN("No direct I/O on output file %s, writing it buffered: %s",
+				      cfg->output_path,
+				      strerror(errno));
+	}
+
+	result = aes_gcm_device_group_start(group, file_data, file_size, dst_buffer, dst_len);
+	if (result != DOCA_SUCCESS)
+		goto free_buffers;
+
+	if (detached) {
+		result = aes_gcm_device_group_register_tags(group, tags, layout.num_chunks * cfg->tag_size);
+		if (result != DOCA_SUCCESS)
+			goto free_buffers;
+	}
+
+	result = aes_gcm_device_group_key_create(group, cfg->raw_key, cfg->raw_key_type, &key);
+	if (result != DOCA_SUCCESS)
+		goto free_buffers;
+
+	DOCA_LOG_INFO("Processing %zu chunks on %u devices, %s destination of %zu bytes",
+		      layout.num_chunks - start,
+		      group->num_members,
+		      dst_buffers_name(dst_buffers),
+		      dst_len);
+
+	/* Chunk i is held by jobs[(i - start) % num_jobs], a window never wraps around the ring */
+	start_ns = aes_gcm_get_time_ns();
+	checkpoint_ns = start_ns;
+	for (first = start; first < layout.num_chunks; first += window) {
+		nb_chunks = (layout.num_chunks - first < window) ? (layout.num_chunks - first) : window;
+		for (i = first; i < first + nb_chunks; i++) {
+			job = &jobs[(i - start) % num_jobs];
+			memset(job, 0, sizeof(*job));
+			offset = i * layout.in_chunk_size;
+			job->src = file_data + offset;
+			job->src_len = (file_size - offset < layout.in_chunk_size) ? (file_size - offset) :
+										     layout.in_chunk_size;
+			if (dst_buffers == AES_GCM_DST_IN_PLACE) {
+				job->dst = file_data + offset;
+				job->dst_len = job->src_len;
+			} else {
+				job->dst = dst_buffer + (((i - start) % num_jobs) * layout.out_chunk_size);
+				job->dst_len = layout.out_chunk_size;
+			}
+			aes_gcm_derive_iv(cfg->iv, cfg->iv_length, i, job->iv);
+			job->iv_length = cfg->iv_length;
+			job->tag_size = cfg->tag_size;
+			job->aad_size = cfg->aad_size;
+			if (detached)
+				job->tag = tags + (i * cfg->tag_size);
+		}
+		aes_gcm_device_group_submit_burst(group, &key, &jobs[(first - start) % num_jobs], nb_chunks);
+
+		/* The devices fill this window while the previous one goes to the output file */
+		if (first != start) {
+			result = write_chunks(cfg,
+					      out_file,
+					      direct_fd,
+					      &jobs[(first - window - start) % num_jobs],
+					      first - window,
+					      window,
+					      &output_size);
+			if (result == DOCA_SUCCESS && checkpointed &&
+			    aes_gcm_get_time_ns() - checkpoint_ns >= AES_GCM_CHECKPOINT_INTERVAL_NS) {
+				checkpoint.done_chunks = first;
+				checkpoint.output_size = output_size;
+				result = take_checkpoint(cfg, out_file, &checkpoint, tags);
+				checkpoint_ns = aes_gcm_get_time_ns();
+			}
+			if (result != DOCA_SUCCESS) {
+				aes_gcm_device_group_wait(group);
+				goto destroy_key;
+			}
+		}
+		aes_gcm_device_group_wait(group);
+	}
+	aes_gcm_device_group_report(group, aes_gcm_get_time_ns() - start_ns);
+
+	result = write_chunks(cfg,
+			      out_file,
+			      direct_fd,
+			      &jobs[(first - window - start) % num_jobs],
+			      first - window,
+			      nb_chunks,
+			      &output_size);
+	if (result != DOCA_SUCCESS)
+		goto destroy_key;
+
+
+	DOCA_LOG_INFO("File was %s successfully and saved in: %s",
+		      (mode == AES_GCM_MODE_ENCRYPT) ? "encrypted" : "decrypted",
+		      cfg->output_path);
+
+	if (detached && mode == AES_GCM_MODE_ENCRYPT) {
+		result = aes_gcm_tag_index_write(cfg->tag_index_path, cfg, layout.num_chunks, file_size, tags);
+		if (result != DOCA_SUCCESS)
+			goto destroy_key;
+		DOCA_LOG_INFO("Tags of %zu chunks were saved in: %s", layout.num_chunks, cfg->tag_index_path);
+	}
+
+	/* The run is complete, there is nothing left to resume */
+	if (checkpointed)
+		aes_gcm_checkpoint_remove(cfg->checkpoint_path);
+
+destroy_key:
+	tmp_result = aes_gcm_device_group_key_destroy(group, &key);
+	DOCA_ERROR_PROPAGATE(result, tmp_result);
+free_buffers:
+	free(jobs);
+destroy_group:
+	tmp_result = aes_gcm_device_group_destroy(group);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to destroy device group: %s", doca_error_get_descr(tmp_result));
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+	free(tags);
+	aes_gcm_mem_free(&dst_mem);
+close_file:
+	if (direct_fd >= 0)
+		close(direct_fd);
+	fclose(out_file);
+
+	return result;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_STREAM_H_
+#define AES_GCM_STREAM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+
+/* Chunk layout of a file */
+struct aes_gcm_stream_layout {
+	size_t in_chunk_size;  /* Input bytes per chunk, the last chunk may be shorter */
+	size_t out_chunk_size; /* Output capacity per chunk */
+	size_t num_chunks;     /* Number of chunks */
+};
+
+/*
+ * Compute the chunk layout of an input file
+ *
+ * @cfg [in]: Configuration parameters
+ * @mode [in]: AES-GCM mode - encrypt/decrypt
+ * @file_size [in]: File size
+ * @layout [out]: The chunk layout
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_stream_compute_layout(const struct aes_gcm_cfg *cfg,
+					   enum aes_gcm_mode mode,
+					   size_t file_size,
+					   struct aes_gcm_stream_layout *layout);
+
+/*
+ * Check if the configuration asks for the chunked, device group based flow
+ *
+ * @cfg [in]: Configuration parameters
+ * @return: true if the file should be processed by aes_gcm_stream_file()
+ */
+bool aes_gcm_stream_is_requested(const struct aes_gcm_cfg *cfg);
+
+/*
+ * Encrypt or decrypt a file in chunks spread over a device group, and save the result in cfg->output_path
+ *
+ * Chunk i holds cfg->chunk_size plaintext bytes (the last chunk may be shorter) and is processed with the IV derived
+ * from cfg->iv and i by aes_gcm_derive_iv(). An encrypted chunk is the chunk ciphertext followed by its tag, so the
+ * encrypted file is the concatenation of the encrypted chunks. A single chunk output is identical to the output of
+ * the single task flow.
+ *
+ * When cfg->tag_index_path is set the tags are detached: the encrypted file holds only the ciphertext chunks back to
+ * back, and the tags are kept in the tag index file (see aes_gcm_tag_index.h), written on encrypt and read on decrypt.
+ * cfg->dst_buffers picks the destination memory: a buffer for the whole output, the input itself when no chunk grows
+ * (decrypt, or detached encrypt, falling back to ping-pong otherwise), or two windows of as many chunks as the group
+ * has task slots, one being written to the output file while the devices fill the other.
+ * When cfg->checkpoint_path is set the output is written window by window, and about every
+ * AES_GCM_CHECKPOINT_INTERVAL_NS the output is synced and the chunk watermark saved to the checkpoint, with the tags
+ * of the done chunks on detached encrypt, see aes_gcm_checkpoint.h. With cfg->resume the run continues after the
+ * watermark of the checkpoint instead, once the output was checked to hold its last chunk, and the checkpoint is
+ * removed when the file is done.
+ * When cfg->compress_codec is set the file is handled by aes_gcm_compress_stream_file() instead, when cfg->records
+ * is set by aes_gcm_record_stream_file(), when cfg->tls_secret_len is set by aes_gcm_tls_stream_file(), and when
+ * cfg->gmac_manifest_path is set by aes_gcm_gmac_file().
+ *
+ * @cfg [in]: Configuration parameters
+ * @mode [in]: AES-GCM mode - encrypt/decrypt
+ * @file_data [in/out]: File data, overwritten with in place destination buffers
+ * @file_size [in]: File size
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_stream_file(struct aes_gcm_cfg *cfg, enum aes_gcm_mode mode, char *file_data, size_t file_size);
+
+#endif /* AES_GCM_STREAM_H_ */
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <limits.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <openssl/evp.h>
+
+#include <doca_log.h>
+#include <doca_error.h>
+
+#include "aes_gcm_sw.h"
+
+DOCA_LOG_REGISTER(AES_GCM::SW);
+
+/*
+ * Create an OpenSSL cipher context set up with the key and IV
+ *
+ * @key [in]: Raw key
+ * @key_len [in]: Raw key length, 16 or 32 bytes
+ * @iv [in]: Initialization vector
+ * @iv_length [in]: Initialization vector length
+ * @encrypt [in]: 1 to encrypt, 0 to decrypt
+ * @return: the cipher context, or NULL on error
+ */
+static EVP_CIPHER_CTX *cipher_ctx_create(const uint8_t *key,
+					 uint32_t key_len,
+					 const uint8_t *iv,
+					 uint32_t iv_length,
+					 int encrypt)
+{
+	const EVP_CIPHER *cipher;
+	EVP_CIPHER_CTX *ctx;
+
+	if (key_len == 16)
+		cipher = EVP_aes_128_gcm();
+	else if (key_len == 32)
+		cipher = EVP_aes_256_gcm();
+	else
+		return NULL;
+
+	if (iv_length == 0)
+		return NULL;
+
+	ctx = EVP_CIPHER_CTX_new();
+	if (ctx == NULL)
+		return NULL;
+
+	if (EVP_CipherInit_ex(ctx, cipher, NULL, NULL, NULL, encrypt) != 1 ||
+	    EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, iv_length, NULL) != 1 ||
+	    EVP_CipherInit_ex(ctx, NULL, NULL, key, iv, encrypt) != 1) {
+		EVP_CIPHER_CTX_free(ctx);
+		return NULL;
+	}
+
+	return ctx;
+}
+
+/*
+ * Run the cipher over the AAD and the payload
+ *
+ * @ctx [in]: The cipher context
+ * @aad [in]: Additional authenticated data
+ * @aad_len [in]: Additional authenticated data length
+ * @in [in]: Input payload
+ * @in_len [in]: Input payload length
+ * @out [out]: Output payload
+ * @return: true on success
+ */
+static bool cipher_update(EVP_CIPHER_CTX *ctx,
+			  const uint8_t *aad,
+			  size_t aad_len,
+			  const uint8_t *in,
+			  size_t in_len,
+			  uint8_t *out)
+{
+	size_t offset, step;
+	int out_len;
+
+	if (aad_len > INT_MAX || (aad_len != 0 && EVP_CipherUpdate(ctx, NULL, &out_len, aad, (int)aad_len) != 1))
+		return false;
+
+	/* EVP lengths are ints, feed large payloads in steps */
+	for (offset = 0; offset < in_len; offset += step) {
+		step = (in_len - offset > INT_MAX / 2) ? (INT_MAX / 2) : (in_len - offset);
+		if (EVP_CipherUpdate(ctx, out + offset, &out_len, in + offset, (int)step) != 1)
+			return false;
+	}
+	return true;
+}
+
+doca_error_t aes_gcm_sw_encrypt(const uint8_t *key,
+				uint32_t key_len,
+				const uint8_t *iv,
+				uint32_t iv_length,
+				const uint8_t *aad,
+				size_t aad_len,
+				const uint8_t *in,
+				size_t in_len,
+				uint8_t *out,
+				uint8_t *tag,
+				uint32_t tag_size)
+{
+	EVP_CIPHER_CTX *ctx;
+	doca_error_t result = DOCA_SUCCESS;
+	int final_len;
+
+	ctx = cipher_ctx_create(key, key_len, iv, iv_length, 1);
+	if (ctx == NULL) {
+		DOCA_LOG_ERR("Unable to set up AES-GCM with a %u bytes key and a %u bytes IV", key_len, iv_length);
+		return DOCA_ERROR_NOT_SUPPORTED;
+	}
+
+	if (!cipher_update(ctx, aad, aad_len, in, in_len, out) || EVP_CipherFinal_ex(ctx, out + in_len, &final_len) != 1 ||
+	    EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, tag_size, tag) != 1) {
+		DOCA_LOG_ERR("AES-GCM encryption of %zu bytes failed", in_len);
+		result = DOCA_ERROR_UNEXPECTED;
+	}
+
+	EVP_CIPHER_CTX_free(ctx);
+	return result;
+}
+
+doca_error_t aes_gcm_sw_decrypt(const uint8_t *key,
+				uint32_t key_len,
+				const uint8_t *iv,
+				uint32_t iv_length,
+				const uint8_t *aad,
+				size_t aad_len,
+				const uint8_t *in,
+				size_t in_len,
+				const uint8_t *tag,
+				uint32_t tag_size,
+				uint8_t *out)
+{
+	EVP_CIPHER_CTX *ctx;
+	doca_error_t result = DOCA_SUCCESS;
+	int final_len;
+
+	ctx = cipher_ctx_create(key, key_len, iv, iv_length, 0);
+	if (ctx == NULL) {
+		DOCA_LOG_ERR("Unable to set up AES-GCM with a %u bytes key and a %u bytes IV", key_len, iv_length);
+		return DOCA_ERROR_NOT_SUPPORTED;
+	}
+
+	if (!cipher_update(ctx, aad, aad_len, in, in_len, out) ||
+	    EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, tag_size, (void *)tag) != 1) {
+		DOCA_LOG_ERR("AES-GCM decryption of %zu bytes failed", in_len);
+		result = DOCA_ERROR_UNEXPECTED;
+	} else if (EVP_CipherFinal_ex(ctx, out + in_len, &final_len) != 1) {
+		result = DOCA_ERROR_INVALID_VALUE;
+	}
+
+	EVP_CIPHER_CTX_free(ctx);
+	return result;
+}
+
+doca_error_t aes_gcm_sw_run_job(const uint8_t *key, uint32_t key_len, struct aes_gcm_job *job, size_t *out_len)
+{
+	const uint8_t *src = job->src;
+	uint8_t *dst = job->dst;
+	size_t payload_len;
+	uint8_t *tag;
+
+	if (job->src_len < job->aad_size)
+		return DOCA_ERROR_INVALID_VALUE;
+	payload_len = job->src_len - job->aad_size;
+
+	if (job->mode == AES_GCM_MODE_ENCRYPT) {
+		*out_len = job->aad_size + payload_len + ((job->tag != NULL) ? 0 : job->tag_size);
+		if (*out_len > job->dst_len)
+			return DOCA_ERROR_INVALID_VALUE;
+		memmove(dst, src, job->aad_size);
+		tag = (job->tag != NULL) ? (uint8_t *)job->tag : (dst + job->aad_size + payload_len);
+		return aes_gcm_sw_encrypt(key,
+					  key_len,
+					  job->iv,
+					  job->iv_length,
+					  src,
+					  job->aad_size,
+					  src + job->aad_size,
+					  payload_len,
+					  dst + job->aad_size,
+					  tag,
+					  job->tag_size);
+	}
+
+	if (job->tag == NULL) {
+		if (payload_len < job->tag_size)
+			return DOCA_ERROR_INVALID_VALUE;
+		payload_len -= job->tag_size;
+		tag = (uint8_t *)src + job->aad_size + payload_len;
+	} else {
+		tag = job->tag;
+	}
+	*out_len = job->aad_size + payload_len;
+	if (*out_len > job->dst_len)
+		return DOCA_ERROR_INVALID_VALUE;
+	memmove(dst, src, job->aad_size);
+	return aes_gcm_sw_decrypt(key,
+				  key_len,
+				  job->iv,
+				  job->iv_length,
+				  src,
+				  job->aad_size,
+				  src + job->aad_size,
+				  payload_len,
+				  tag,
+				  job->tag_size,
+				  dst + job->aad_size);
+}
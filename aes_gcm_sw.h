@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_SW_H_
+#define AES_GCM_SW_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+
+/*
+ * Encrypt a buffer with AES-GCM on the CPU
+ *
+ * @key [in]: Raw key
+ * @key_len [in]: Raw key length, 16 or 32 bytes
+ * @iv [in]: Initialization vector
+ * @iv_length [in]: Initialization vector length, must not be 0
+ * @aad [in]: Additional authenticated data, may be NULL if aad_len is 0
+ * @aad_len [in]: Additional authenticated data length
+ * @in [in]: Plaintext
+ * @in_len [in]: Plaintext length
+ * @out [out]: Ciphertext, in_len bytes, may be equal to in
+ * @tag [out]: Authentication tag
+ * @tag_size [in]: Authentication tag size
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_sw_encrypt(const uint8_t *key,
+				uint32_t key_len,
+				const uint8_t *iv,
+				uint32_t iv_length,
+				const uint8_t *aad,
+				size_t aad_len,
+				const uint8_t *in,
+				size_t in_len,
+				uint8_t *out,
+				uint8_t *tag,
+				uint32_t tag_size);
+
+/*
+ * Decrypt a buffer with AES-GCM on the CPU and check its tag
+ *
+ * @key [in]: Raw key
+ * @key_len [in]: Raw key length, 16 or 32 bytes
+ * @iv [in]: Initialization vector
+ * @iv_length [in]: Initialization vector length, must not be 0
+ * @aad [in]: Additional authenticated data, may be NULL if aad_len is 0
+ * @aad_len [in]: Additional authenticated data length
+ * @in [in]: Ciphertext
+ * @in_len [in]: Ciphertext length
+ * @tag [in]: Authentication tag
+ * @tag_size [in]: Authentication tag size
+ * @out [out]: Plaintext, in_len bytes, may be equal to in
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR_INVALID_VALUE if the tag does not match and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_sw_decrypt(const uint8_t *key,
+				uint32_t key_len,
+				const uint8_t *iv,
+				uint32_t iv_length,
+				const uint8_t *aad,
+				size_t aad_len,
+				const uint8_t *in,
+				size_t in_len,
+				const uint8_t *tag,
+				uint32_t tag_size,
+				uint8_t *out);
+
+/*
+ * Run a job on the CPU, with the buffer layout of the device: the AAD leads the source and the destination, and the
+ * tag follows the payload unless it is detached
+ *
+ * @key [in]: Raw key
+ * @key_len [in]: Raw key length, 16 or 32 bytes
+ * @job [in]: The job, job->key is not used
+ * @out_len [out]: Bytes written to the destination
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR_INVALID_VALUE if the tag does not match and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_sw_run_job(const uint8_t *key, uint32_t key_len, struct aes_gcm_job *job, size_t *out_len);
+
+#endif /* AES_GCM_SW_H_ */
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <doca_log.h>
+#include <doca_error.h>
+
+#include "aes_gcm_tag_index.h"
+
+DOCA_LOG_REGISTER(AES_GCM::TAG_INDEX);
+
+doca_error_t aes_gcm_tag_index_write(const char *path,
+				     const struct aes_gcm_cfg *cfg,
+				     uint64_t num_chunks,
+				     uint64_t data_size,
+				     const uint8_t *tags)
+{
+	struct aes_gcm_tag_index_header header = {0};
+	size_t tags_len = num_chunks * cfg->tag_size;
+	FILE *file;
+
+	memcpy(header.magic, AES_GCM_TAG_INDEX_MAGIC, sizeof(header.magic));
+	header.version = AES_GCM_TAG_INDEX_VERSION;
+	header.tag_size = cfg->tag_size;
+	header.chunk_size = cfg->chunk_size;
+	header.num_chunks = num_chunks;
+	header.data_size = data_size;
+
+	file = fopen(path, "w");
+	if (file == NULL) {
+		DOCA_LOG_ERR("Unable to open tag index file %s: %s", path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	if (fwrite(&header, sizeof(header), 1, file) != 1 || fwrite(tags, 1, tags_len, file) != tags_len) {
+		DOCA_LOG_ERR("Failed to write tag index file %s", path);
+		fclose(file);
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	if (fclose(file) != 0) {
+		DOCA_LOG_ERR("Failed to write tag index file %s: %s", path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_tag_index_read(const char *path,
+				    const struct aes_gcm_cfg *cfg,
+				    uint64_t num_chunks,
+				    uint64_t data_size,
+				    uint8_t **tags)
+{
+	struct aes_gcm_tag_index_header header;
+	size_t tags_len = num_chunks * cfg->tag_size;
+	doca_error_t result = DOCA_SUCCESS;
+	uint8_t *new_tags = NULL;
+	FILE *file;
+
+	file = fopen(path, "r");
+	if (file == NULL) {
+		DOCA_LOG_ERR("Unable to open tag index file %s: %s", path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	if (fread(&header, sizeof(header), 1, file) != 1 ||
+	    memcmp(header.magic, AES_GCM_TAG_INDEX_MAGIC, sizeof(header.magic)) != 0 ||
+	    header.version != AES_GCM_TAG_INDEX_VERSION) {
+		DOCA_LOG_ERR("File %s is not a tag index", path);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto close_file;
+	}
+
+	if (header.tag_size != cfg->tag_size || header.chunk_size != cfg->chunk_size) {
+		DOCA_LOG_ERR("Tag index %s holds %u bytes tags of %u bytes chunks, expected %u bytes tags of %u bytes chunks",
+			     path,
+			     header.tag_size,
+			     header.chunk_size,
+			     cfg->tag_size,
+			     cfg->chunk_size);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto close_file;
+	}
+
+	if (header.num_chunks != num_chunks || header.data_size != data_size) {
+		DOCA_LOG_ERR("Tag index %s describes %lu chunks in %lu bytes, the data file has %lu chunks in %lu bytes",
+			     path,
+			     header.num_chunks,
+			     header.data_size,
+			     num_chunks,
+			     data_size);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto close_file;
+	}
+
+	new_tags = malloc(tags_len);
+	if (new_tags == NULL) {
+		result = DOCA_ERROR_NO_MEMORY;
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(result));
+		goto close_file;
+	}
+
+	/* All tags are contiguous, fetch them in one read */
+	if (fread(new_tags, 1, tags_len, file) != tags_len) {
+		DOCA_LOG_ERR("Tag index %s is truncated", path);
+		free(new_tags);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto close_file;
+	}
+	*tags = new_tags;
+
+close_file:
+	fclose(file);
+	return result;
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_TAG_INDEX_H_
+#define AES_GCM_TAG_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+
+#define AES_GCM_TAG_INDEX_MAGIC "AGTI" /* Tag index file magic */
+#define AES_GCM_TAG_INDEX_VERSION 1    /* Tag index file format version */
+#define AES_GCM_DATA_ALIGNMENT 4096    /* Alignment of the detached chunks, for O_DIRECT */
+
+/* Tag index file header, followed by num_chunks tags of tag_size bytes each in chunk order, in host byte order */
+struct aes_gcm_tag_index_header {
+	char magic[4];	     /* AES_GCM_TAG_INDEX_MAGIC, not NULL terminated */
+	uint32_t version;    /* AES_GCM_TAG_INDEX_VERSION */
+	uint32_t tag_size;   /* Size of every tag */
+	uint32_t chunk_size; /* Plaintext bytes per chunk, 0 for a single chunk */
+	uint64_t num_chunks; /* Number of chunks and tags */
+	uint64_t data_size;  /* Size of the matching data file */
+};
+
+/*
+ * Write a tag index file
+ *
+ * @path [in]: Tag index file path
+ * @cfg [in]: Configuration parameters, provides the tag and chunk sizes
+ * @num_chunks [in]: Number of chunks
+ * @data_size [in]: Size of the matching data file
+ * @tags [in]: num_chunks tags of cfg->tag_size bytes each
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_tag_index_write(const char *path,
+				     const struct aes_gcm_cfg *cfg,
+				     uint64_t num_chunks,
+				     uint64_t data_size,
+				     const uint8_t *tags);
+
+/*
+ * Read all tags of a tag index file in one go, and check the index matches the data file and the configuration
+ *
+ * @path [in]: Tag index file path
+ * @cfg [in]: Configuration parameters, provides the tag and chunk sizes
+ * @num_chunks [in]: Expected number of chunks
+ * @data_size [in]: Size of the data file
+ * @tags [out]: num_chunks tags of cfg->tag_size bytes each, to be freed by the caller
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_tag_index_read(const char *path,
+				    const struct aes_gcm_cfg *cfg,
+				    uint64_t num_chunks,
+				    uint64_t data_size,
+				    uint8_t **tags);
+
+#endif /* AES_GCM_TAG_INDEX_H_ */
@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <doca_log.h>
+#include <doca_error.h>
+
+#include "aes_gcm_metrics.h"
+#include "aes_gcm_tenant.h"
+
+DOCA_LOG_REGISTER(AES_GCM::TENANT);
+
+/*
+ * Parse the settings of a single tenant
+ *
+ * @settings [in]: Comma separated key=value settings, modified in place
+ * @idx [in]: Tenant index, for the error messages
+ * @tenant [out]: The tenant
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t parse_tenant(char *settings, uint32_t idx, struct aes_gcm_tenant_spec *tenant)
+{
+	char *setting, *value, *end, *saveptr = NULL;
+	double number;
+
+	memset(tenant, 0, sizeof(*tenant));
+	tenant->weight = 1;
+	for (setting = strtok_r(settings, ",", &saveptr); setting != NULL; setting = strtok_r(NULL, ",", &saveptr)) {
+		value = strchr(setting, '=');
+		if (value == NULL) {
+			DOCA_LOG_ERR("Invalid setting \"%s\" of tenant %u, expected key=value", setting, idx);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		*value++ = '\0';
+
+		errno = 0;
+		number = strtod(value, &end);
+		if (errno != 0 || end == value || *end != '\0' || number < 0) {
+			DOCA_LOG_ERR("Invalid value \"%s\" for setting %s of tenant %u", value, setting, idx);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+
+		if (strcmp(setting, "weight") == 0 && number >= 1 && number <= UINT16_MAX)
+			tenant->weight = number;
+		else if (strcmp(setting, "mbps") == 0)
+			tenant->bandwidth_mbps = number;
+		else if (strcmp(setting, "ops") == 0)
+			tenant->ops_per_sec = number;
+		else {
+			DOCA_LOG_ERR("Unknown setting %s=%s of tenant %u", setting, value, idx);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+	}
+
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_tenants_parse(const char *spec, struct aes_gcm_tenant_spec *tenants, uint32_t *num_tenants)
+{
+	char buf[256], *tenant, *saveptr = NULL;
+	uint32_t count = 0;
+	doca_error_t result;
+
+	if (strnlen(spec, sizeof(buf)) == sizeof(buf)) {
+		DOCA_LOG_ERR("Tenant settings are too long, max %zu characters", sizeof(buf) - 1);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	strcpy(buf, spec);
+
+	for (tenant = strtok_r(buf, ";", &saveptr); tenant != NULL; tenant = strtok_r(NULL, ";", &saveptr)) {
+		if (count == AES_GCM_MAX_TENANTS) {
+			DOCA_LOG_ERR("Too many tenants, max %d", AES_GCM_MAX_TENANTS);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		result = parse_tenant(tenant, count, &tenants[count]);
+		if (result != DOCA_SUCCESS)
+			return result;
+		count++;
+	}
+
+	if (count == 0) {
+		DOCA_LOG_ERR("No tenant was given");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	*num_tenants = count;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Initialize a full token bucket
+ *
+ * @bucket [out]: The bucket
+ * @per_sec [in]: Tokens added per second, 0 for unlimited
+ */
+static void bucket_init(struct aes_gcm_token_bucket *bucket, double per_sec)
+{
+	bucket->rate = per_sec / 1e9;
+	bucket->depth = bucket->rate * AES_GCM_TENANT_BURST_NS;
+	/* A bucket always holds at least one token, or a slow rate would never let a job through */
+	if (bucket->depth < 1)
+		bucket->depth = 1;
+	bucket->tokens = bucket->depth;
+}
+
+/*
+ * Add the tokens earned since the last refill
+ *
+ * @bucket [in]: The bucket
+ * @elapsed_ns [in]: Time since the last refill
+ */
+static void bucket_refill(struct aes_gcm_token_bucket *bucket, uint64_t elapsed_ns)
+{
+	if (bucket->rate == 0)
+		return;
+	bucket->tokens += bucket->rate * (double)elapsed_ns;
+	if (bucket->tokens > bucket->depth)
+		bucket->tokens = bucket->depth;
+}
+
+/*
+ * Check if a bucket can pay for a job
+ *
+ * A job larger than the depth goes through once the bucket is full and leaves it in debt, so it is delayed by its own
+ * size instead of blocking forever.
+ *
+ * @bucket [in]: The bucket
+ * @cost [in]: Tokens the job costs
+ * @return: true if the job may be dispatched
+ */
+static bool bucket_ready(const struct aes_gcm_token_bucket *bucket, double cost)
+{
+	if (bucket->rate == 0)
+		return true;
+	return bucket->tokens >= ((cost < bucket->depth) ? cost : bucket->depth);
+}
+
+/*
+ * Pay for a job
+ *
+ * @bucket [in]: The bucket
+ * @cost [in]: Tokens the job costs
+ */
+static void bucket_consume(struct aes_gcm_token_bucket *bucket, double cost)
+{
+	if (bucket->rate != 0)
+		bucket->tokens -= cost;
+}
+
+void aes_gcm_tenant_sched_init(struct aes_gcm_tenant_sched *sched,
+			       const struct aes_gcm_tenant_spec *tenants,
+			       uint32_t num_tenants,
+			       uint64_t now_ns)
+{
+	struct aes_gcm_tenant *tenant;
+	uint32_t i;
+
+	memset(sched, 0, sizeof(*sched));
+	sched->num_tenants = num_tenants;
+	sched->last_refill_ns = now_ns;
+	for (i = 0; i < num_tenants; i++) {
+		tenant = &sched->tenants[i];
+		tenant->weight = tenants[i].weight;
+		bucket_init(&tenant->bytes, (double)tenants[i].bandwidth_mbps * 1e6);
+		bucket_init(&tenant->ops, (double)tenants[i].ops_per_sec);
+	}
+}
+
+void aes_gcm_tenant_enqueue(struct aes_gcm_tenant_sched *sched, struct aes_gcm_job *job)
+{
+	struct aes_gcm_tenant *tenant;
+
+	if (job->tenant >= sched->num_tenants)
+		job->tenant = 0;
+	tenant = &sched->tenants[job->tenant];
+
+	job->next = NULL;
+	if (tenant->tail == NULL)
+		tenant->head = job;
+	else
+		tenant->tail->next = job;
+	tenant->tail = job;
+	sched->num_queued++;
+}
+
+struct aes_gcm_job *aes_gcm_tenant_next(struct aes_gcm_tenant_sched *sched, uint64_t now_ns)
+{
+	struct aes_gcm_tenant *tenant, *best = NULL;
+	struct aes_gcm_job *job;
+	double start, finish, best_start = 0, best_finish = 0;
+	uint32_t i;
+
+	if (sched->num_queued == 0)
+		return NULL;
+
+	for (i = 0; i < sched->num_tenants; i++) {
+		tenant = &sched->tenants[i];
+		bucket_refill(&tenant->bytes, now_ns - sched->last_refill_ns);
+		bucket_refill(&tenant->ops, now_ns - sched->last_refill_ns);
+		if (tenant->head == NULL)
+			continue;
+
+		job = tenant->head;
+		if (!bucket_ready(&tenant->bytes, job->src_len) || !bucket_ready(&tenant->ops, 1)) {
+			if (!tenant->throttled) {
+				tenant->throttled = true;
+				tenant->num_throttles++;
+				aes_gcm_metrics_tenant_throttled(i);
+			}
+			continue;
+		}
+		tenant->throttled = false;
+
+		/* A tenant that was idle starts from the current virtual time, it has no credit left */
+		start = (tenant->finish_tag > sched->virtual_time) ? tenant->finish_tag : sched->virtual_time;
+		finish = start + (double)job->src_len / tenant->weight;
+		if (best == NULL || finish < best_finish) {
+			best = tenant;
+			best_start = start;
+			best_finish = finish;
+		}
+	}
+	sched->last_refill_ns = now_ns;
+
+	if (best == NULL)
+		return NULL;
+
+	job = best->head;
+	best->head = job->next;
+	if (best->head == NULL)
+		best->tail = NULL;
+	sched->num_queued--;
+
+	bucket_consume(&best->bytes, job->src_len);
+	bucket_consume(&best->ops, 1);
+	best->finish_tag = best_finish;
+	sched->virtual_time = best_start;
+
+	if (best->dispatched_jobs == 0)
+		best->first_dispatch_ns = now_ns;
+	best->last_dispatch_ns = now_ns;
+	best->dispatched_jobs++;
+	best->dispatched_bytes += job->src_len;
+	aes_gcm_metrics_tenant_dispatch(job->tenant, job->src_len);
+
+	return job;
+}
+
+void aes_gcm_tenant_report(const struct aes_gcm_tenant_sched *sched)
+{
+	const struct aes_gcm_tenant *tenant;
+	uint64_t active_ns;
+	uint32_t i;
+
+	for (i = 0; i < sched->num_tenants; i++) {
+		tenant = &sched->tenants[i];
+		active_ns = tenant->last_dispatch_ns - tenant->first_dispatch_ns;
+		DOCA_LOG_INFO("Tenant %u (weight %u): %lu jobs, %lu bytes, %.2f MB/s while active, throttled %lu times",
+			      i,
+			      tenant->weight,
+			      tenant->dispatched_jobs,
+			      tenant->dispatched_bytes,
+			      (active_ns != 0) ? ((double)tenant->dispatched_bytes * 1e3) / (double)active_ns : 0.0,
+			      tenant->num_throttles);
+	}
+}
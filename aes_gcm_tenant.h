@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_TENANT_H_
+#define AES_GCM_TENANT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+
+#define AES_GCM_TENANT_BURST_NS (10 * 1000 * 1000) /* Rate a token bucket may accumulate while its tenant is idle */
+
+/* Token bucket, refilled at a constant rate up to its depth */
+struct aes_gcm_token_bucket {
+	double rate;   /* Tokens per ns, 0 for unlimited */
+	double depth;  /* Max tokens */
+	double tokens; /* Available tokens, negative after a job larger than the depth */
+};
+
+/* Fair share state of a tenant */
+struct aes_gcm_tenant {
+	uint32_t weight;		   /* Share of the devices relative to the other tenants */
+	struct aes_gcm_token_bucket bytes; /* Source bytes rate limit */
+	struct aes_gcm_token_bucket ops;   /* Job rate limit */
+	double finish_tag;		   /* Virtual finish time of the last dispatched job */
+	struct aes_gcm_job *head;	   /* First queued job */
+	struct aes_gcm_job *tail;	   /* Last queued job */
+	bool throttled;			   /* The first queued job waits for tokens */
+	uint64_t dispatched_jobs;	   /* Jobs handed to the devices */
+	uint64_t dispatched_bytes;	   /* Source bytes handed to the devices */
+	uint64_t num_throttles;		   /* Times the tenant ran out of tokens with jobs queued */
+	uint64_t first_dispatch_ns;	   /* Timestamp of the first dispatched job */
+	uint64_t last_dispatch_ns;	   /* Timestamp of the last dispatched job */
+};
+
+/* Weighted fair queuing of the bulk jobs across tenants */
+struct aes_gcm_tenant_sched {
+	struct aes_gcm_tenant tenants[AES_GCM_MAX_TENANTS]; /* Tenants */
+	uint32_t num_tenants;				    /* Number of tenants, 0 when fair sharing is off */
+	uint32_t num_queued;				    /* Jobs queued across all tenants */
+	double virtual_time;				    /* Virtual start time of the last dispatched job */
+	uint64_t last_refill_ns;			    /* Timestamp of the last token refill */
+};
+
+/*
+ * Parse the fair share tenants, e.g. "weight=4,mbps=800;weight=1,ops=5000"
+ *
+ * Tenants are separated by semicolons, tenant i is the i-th one. A tenant that does not give its weight gets 1, and a
+ * rate that is not given is unlimited.
+ *
+ * @spec [in]: Semicolon separated tenants, each made of comma separated key=value settings
+ * @tenants [out]: The tenants, AES_GCM_MAX_TENANTS entries
+ * @num_tenants [out]: Number of tenants
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_tenants_parse(const char *spec, struct aes_gcm_tenant_spec *tenants, uint32_t *num_tenants);
+
+/*
+ * Initialize a fair share scheduler with full token buckets
+ *
+ * @sched [out]: The scheduler
+ * @tenants [in]: The tenants
+ * @num_tenants [in]: Number of tenants, 0 to turn fair sharing off
+ * @now_ns [in]: Current timestamp
+ */
+void aes_gcm_tenant_sched_init(struct aes_gcm_tenant_sched *sched,
+			       const struct aes_gcm_tenant_spec *tenants,
+			       uint32_t num_tenants,
+			       uint64_t now_ns);
+
+/*
+ * Queue a job on its tenant, job->tenant is the tenant index and jobs of an unknown tenant go to tenant 0
+ *
+ * @sched [in]: The scheduler
+ * @job [in]: The job
+ */
+void aes_gcm_tenant_enqueue(struct aes_gcm_tenant_sched *sched, struct aes_gcm_job *job);
+
+/*
+ * Take the next job to dispatch off the tenant queues
+ *
+ * Among the tenants whose first job fits in both of their token buckets, the job with the earliest virtual finish time
+ * is picked: a tenant with twice the weight gets twice the bytes while both are backlogged, and an idle tenant does not
+ * build up credit. The tokens of the job are consumed.
+ *
+ * @sched [in]: The scheduler
+ * @now_ns [in]: Current timestamp
+ * @return: the job, or NULL if no job is queued or every tenant with queued jobs waits for tokens
+ */
+struct aes_gcm_job *aes_gcm_tenant_next(struct aes_gcm_tenant_sched *sched, uint64_t now_ns);
+
+/*
+ * Log the share of the devices every tenant got
+ *
+ * @sched [in]: The scheduler
+ */
+void aes_gcm_tenant_report(const struct aes_gcm_tenant_sched *sched);
+
+#endif /* AES_GCM_TENANT_H_ */
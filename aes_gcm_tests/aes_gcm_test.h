@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_TEST_H_
+#define AES_GCM_TEST_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define AES_GCM_TEST_TIMEOUT_S 60 /* A test still running after this long is hung */
+
+/* Fail the test at the first expectation that does not hold */
+#define AES_GCM_TEST_CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+			exit(EXIT_FAILURE); \
+		} \
+	} while (0)
+
+#endif /* AES_GCM_TEST_H_ */
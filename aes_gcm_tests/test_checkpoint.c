@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <doca_log.h>
+
+#include "aes_gcm_checkpoint.h"
+#include "aes_gcm_emu.h"
+#include "aes_gcm_stream.h"
+#include "aes_gcm_test.h"
+
+DOCA_LOG_REGISTER(AES_GCM::TEST_CHECKPOINT);
+
+#define TEST_FILE_SIZE (16 * 1024 * 1024) /* Input bytes */
+#define TEST_CHUNK_SIZE (64 * 1024)	  /* Chunk size of the runs */
+#define TEST_SLOW_MBPS 4		  /* Device bandwidth of the killed run, it checkpoints long before it ends */
+#define TEST_POLL_NS (10 * 1000 * 1000)	  /* Wait between two looks for the checkpoint file */
+
+static char work_dir[] = "/tmp/aes_gcm_test_checkpoint.XXXXXX";
+static char input[TEST_FILE_SIZE];
+
+/*
+ * Set up the configuration of an encryption run over an emulated device
+ *
+ * @cfg [out]: Configuration parameters
+ * @output [in]: Output file name, in the work directory
+ * @checkpointed [in]: Keep a checkpoint file in the work directory
+ */
+static void setup_run(struct aes_gcm_cfg *cfg, const char *output, bool checkpointed)
+{
+	init_aes_gcm_params(cfg);
+	AES_GCM_TEST_CHECK(aes_gcm_emu_model_parse("devices=1,seed=1", &cfg->emu) == DOCA_SUCCESS);
+	cfg->no_numa = true;
+	cfg->caps_cache_path[0] = '\0';
+	cfg->tuning_profile_path[0] = '\0';
+	cfg->chunk_size = TEST_CHUNK_SIZE;
+	snprintf(cfg->output_path, sizeof(cfg->output_path), "%s/%s", work_dir, output);
+	if (checkpointed)
+		snprintf(cfg->checkpoint_path, sizeof(cfg->checkpoint_path), "%s/run.ckpt", work_dir);
+}
+
+/*
+ * Read a whole file of the work directory
+ *
+ * @name [in]: File name
+ * @size [out]: File size
+ * @return: The file contents, to be freed by the caller
+ */
+static char *read_file(const char *name, size_t *size)
+{
+	char path[MAX_FILE_NAME];
+	struct stat st;
+	FILE *file;
+	char *data;
+
+	snprintf(path, sizeof(path), "%s/%s", work_dir, name);
+	file = fopen(path, "r");
+	AES_GCM_TEST_CHECK(file != NULL && fstat(fileno(file), &st) == 0);
+	*size = st.st_size;
+	data = malloc(*size + 1);
+	AES_GCM_TEST_CHECK(data != NULL && fread(data, 1, *size, file) == *size);
+	fclose(file);
+	return data;
+}
+
+/*
+ * Write a buffer to a file
+ *
+ * @path [in]: File path
+ * @data [in]: Bytes to write
+ * @size [in]: Number of bytes
+ */
+static void write_file(const char *path, const char *data, size_t size)
+{
+	FILE *file = fopen(path, "w");
+
+	AES_GCM_TEST_CHECK(file != NULL && fwrite(data, 1, size, file) == size);
+	AES_GCM_TEST_CHECK(fclose(file) == 0);
+}
+
+/*
+ * Kill a checkpointed run once it saved its first checkpoint, then tear the next save: a half written temporary file
+ * is left next to the checkpoint. The resumed run must ignore it and produce the same output as a run that was never
+ * interrupted. A checkpoint torn in place must be refused.
+ *
+ * @return: EXIT_SUCCESS on success and EXIT_FAILURE otherwise
+ */
+int main(void)
+{
+	static struct aes_gcm_cfg cfg;
+	struct aes_gcm_checkpoint checkpoint;
+	struct timespec poll_time = {0, TEST_POLL_NS};
+	char path[MAX_FILE_NAME + 8];
+	char *saved, *resumed, *reference;
+	size_t saved_size, resumed_size, reference_size;
+	uint8_t *tags;
+	struct stat st;
+	pid_t pid;
+	int fd, status;
+	size_t i;
+
+	(void)doca_log_backend_create_standard();
+	alarm(AES_GCM_TEST_TIMEOUT_S);
+
+	AES_GCM_TEST_CHECK(mkdtemp(work_dir) != NULL);
+	for (i = 0; i < sizeof(input); i++)
+		input[i] = (char)(i * 131 + (i >> 12));
+
+	/* The interrupted run, killed like a crash once its first checkpoint is on disk */
+	pid = fork();
+	AES_GCM_TEST_CHECK(pid >= 0);
+	if (pid == 0) {
+		setup_run(&cfg, "resumed.enc", true);
+		cfg.emu.bandwidth_mbps = TEST_SLOW_MBPS;
+		_exit(aes_gcm_stream_file(&cfg, AES_GCM_MODE_ENCRYPT, input, sizeof(input)) == DOCA_SUCCESS ? 0 : 1);
+	}
+	snprintf(path, sizeof(path), "%s/run.ckpt", work_dir);
+	while (stat(path, &st) != 0) {
+		AES_GCM_TEST_CHECK(waitpid(pid, &status, WNOHANG) == 0);
+		nanosleep(&poll_time, NULL);
+	}
+	AES_GCM_TEST_CHECK(kill(pid, SIGKILL) == 0 && waitpid(pid, &status, 0) == pid);
+	AES_GCM_TEST_CHECK(WIFSIGNALED(status));
+
+	AES_GCM_TEST_CHECK(aes_gcm_checkpoint_load(path, &checkpoint, &tags) == DOCA_SUCCESS);
+	AES_GCM_TEST_CHECK(checkpoint.done_chunks > 0 && checkpoint.done_chunks < checkpoint.num_chunks);
+	free(tags);
+	DOCA_LOG_INFO("Run killed after a checkpoint of %lu of %lu chunks",
+		      checkpoint.done_chunks,
+		      checkpoint.num_chunks);
+
+	/* A save killed before its rename leaves a partial temporary file, the checkpoint itself is untouched */
+	saved = read_file("run.ckpt", &saved_size);
+	snprintf(path, sizeof(path), "%s/run.ckpt.XXXXXX", work_dir);
+	fd = mkstemp(path);
+	AES_GCM_TEST_CHECK(fd >= 0 && write(fd, saved, saved_size / 2) == (ssize_t)(saved_size / 2));
+	close(fd);
+
+	/* A checkpoint cut short in place is not a valid checkpoint */
+	snprintf(path, sizeof(path), "%s/torn.ckpt", work_dir);
+	write_file(path, saved, saved_size - 1);
+	AES_GCM_TEST_CHECK(aes_gcm_checkpoint_load(path, &checkpoint, &tags) == DOCA_ERROR_INVALID_VALUE);
+	AES_GCM_TEST_CHECK(tags == NULL);
+	free(saved);
+
+	setup_run(&cfg, "resumed.enc", true);
+	cfg.resume = true;
+	AES_GCM_TEST_CHECK(aes_gcm_stream_file(&cfg, AES_GCM_MODE_ENCRYPT, input, sizeof(input)) == DOCA_SUCCESS);
+	/* The finished run removes its checkpoint */
+	AES_GCM_TEST_CHECK(stat(cfg.checkpoint_path, &st) != 0);
+
+	setup_run(&cfg, "reference.enc", false);
+	AES_GCM_TEST_CHECK(aes_gcm_stream_file(&cfg, AES_GCM_MODE_ENCRYPT, input, sizeof(input)) == DOCA_SUCCESS);
+
+	resumed = read_file("resumed.enc", &resumed_size);
+	reference = read_file("reference.enc", &reference_size);
+	AES_GCM_TEST_CHECK(resumed_size == reference_size && memcmp(resumed, reference, reference_size) == 0);
+	free(resumed);
+	free(reference);
+
+	snprintf(path, sizeof(path), "rm -rf %s", work_dir);
+	(void)system(path);
+	return EXIT_SUCCESS;
+}
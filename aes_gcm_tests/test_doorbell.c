@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <doca_log.h>
+
+#include "aes_gcm_device_group.h"
+#include "aes_gcm_emu.h"
+#include "aes_gcm_sw.h"
+#include "aes_gcm_test.h"
+
+DOCA_LOG_REGISTER(AES_GCM::TEST_DOORBELL);
+
+#define TEST_NUM_JOBS 512   /* Jobs of the run */
+#define TEST_NUM_CHAINS 16  /* Jobs submitted up front, every completion submits the next one */
+#define TEST_JOB_SIZE 256   /* Plaintext bytes of a job */
+#define TEST_TAG_SIZE 16    /* Tag bytes of a job */
+#define TEST_SUBMIT_BURST 8 /* Tasks per doorbell */
+
+static struct aes_gcm_device_group *group;
+static struct aes_gcm_group_key key;
+static struct aes_gcm_job jobs[TEST_NUM_JOBS];
+static uint32_t num_submitted;
+static uint32_t num_done;
+
+/*
+ * Completion callback, submits the next job from inside the completion like the chunked flows do
+ *
+ * @job [in]: The completed job
+ */
+static void job_done(struct aes_gcm_job *job)
+{
+	(void)job;
+	num_done++;
+	if (num_submitted < TEST_NUM_JOBS)
+		aes_gcm_device_group_submit(group, &key, &jobs[num_submitted++]);
+}
+
+/*
+ * Run jobs over emulated devices whose doorbells are often rejected, some jobs run out of retries and complete from
+ * inside the failed flush, the run must still drain and every job that succeeded must hold the right ciphertext
+ *
+ * @return: EXIT_SUCCESS on success and EXIT_FAILURE otherwise
+ */
+int main(void)
+{
+	static struct aes_gcm_cfg cfg;
+	static uint8_t src[TEST_NUM_JOBS * TEST_JOB_SIZE];
+	static uint8_t dst[TEST_NUM_JOBS * (TEST_JOB_SIZE + TEST_TAG_SIZE)];
+	uint8_t raw_key[32], plain[TEST_JOB_SIZE];
+	uint8_t *ciphertext;
+	uint32_t i, num_ok = 0;
+
+	(void)doca_log_backend_create_standard();
+	alarm(AES_GCM_TEST_TIMEOUT_S);
+
+	init_aes_gcm_params(&cfg);
+	AES_GCM_TEST_CHECK(aes_gcm_emu_model_parse("devices=2,latency_us=5,doorbell_error_rate=0.6,seed=3", &cfg.emu) ==
+			   DOCA_SUCCESS);
+	cfg.submit_burst = TEST_SUBMIT_BURST;
+	cfg.no_numa = true;
+	cfg.caps_cache_path[0] = '\0';
+	cfg.tuning_profile_path[0] = '\0';
+
+	for (i = 0; i < sizeof(src); i++)
+		src[i] = (uint8_t)(i * 31 + 7);
+	for (i = 0; i < sizeof(raw_key); i++)
+		raw_key[i] = (uint8_t)i;
+
+	AES_GCM_TEST_CHECK(aes_gcm_device_group_create(&cfg, AES_GCM_MODE_ENCRYPT, &group) == DOCA_SUCCESS);
+	AES_GCM_TEST_CHECK(aes_gcm_device_group_start(group, src, sizeof(src), dst, sizeof(dst)) == DOCA_SUCCESS);
+	AES_GCM_TEST_CHECK(aes_gcm_device_group_key_create(group, raw_key, DOCA_AES_GCM_KEY_256, &key) == DOCA_SUCCESS);
+
+	for (i = 0; i < TEST_NUM_JOBS; i++) {
+		jobs[i].src = src + (i * TEST_JOB_SIZE);
+		jobs[i].src_len = TEST_JOB_SIZE;
+		jobs[i].dst = dst + (i * (TEST_JOB_SIZE + TEST_TAG_SIZE));
+		jobs[i].dst_len = TEST_JOB_SIZE + TEST_TAG_SIZE;
+		aes_gcm_derive_iv(cfg.iv, cfg.iv_length, i, jobs[i].iv);
+		jobs[i].iv_length = cfg.iv_length;
+		jobs[i].tag_size = TEST_TAG_SIZE;
+		jobs[i].done_cb = job_done;
+	}
+
+	for (num_submitted = 0; num_submitted < TEST_NUM_CHAINS;)
+		aes_gcm_device_group_submit(group, &key, &jobs[num_submitted++]);
+	aes_gcm_device_group_wait(group);
+
+	AES_GCM_TEST_CHECK(num_done == TEST_NUM_JOBS);
+	AES_GCM_TEST_CHECK(group->inflight == 0 && group->num_pending == 0);
+	/* The doorbells were really rejected, their jobs went through the retry path */
+	AES_GCM_TEST_CHECK(group->retried_jobs > 0);
+
+	for (i = 0; i < TEST_NUM_JOBS; i++) {
+		if (jobs[i].result != DOCA_SUCCESS)
+			continue;
+		ciphertext = jobs[i].dst;
+		AES_GCM_TEST_CHECK(aes_gcm_sw_decrypt(raw_key,
+						      sizeof(raw_key),
+						      jobs[i].iv,
+						      jobs[i].iv_length,
+						      NULL,
+						      0,
+						      ciphertext,
+						      TEST_JOB_SIZE,
+						      ciphertext + TEST_JOB_SIZE,
+						      TEST_TAG_SIZE,
+						      plain) == DOCA_SUCCESS);
+		AES_GCM_TEST_CHECK(memcmp(plain, jobs[i].src, TEST_JOB_SIZE) == 0);
+		num_ok++;
+	}
+	/* Some jobs ran out of retries, their completions submitted again from inside the failed flush */
+	AES_GCM_TEST_CHECK(num_ok > 0 && num_ok < TEST_NUM_JOBS);
+	DOCA_LOG_INFO("%u of %u jobs succeeded, %lu retries", num_ok, TEST_NUM_JOBS, group->retried_jobs);
+
+	AES_GCM_TEST_CHECK(aes_gcm_device_group_key_destroy(group, &key) == DOCA_SUCCESS);
+	AES_GCM_TEST_CHECK(aes_gcm_device_group_destroy(group) == DOCA_SUCCESS);
+	return EXIT_SUCCESS;
+}
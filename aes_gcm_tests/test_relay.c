@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <doca_log.h>
+
+#include "aes_gcm_emu.h"
+#include "aes_gcm_relay.h"
+#include "aes_gcm_test.h"
+
+DOCA_LOG_REGISTER(AES_GCM::TEST_RELAY);
+
+#define TEST_PAYLOAD_SIZE (1024 * 1024)	 /* Bytes sent through the relays, many records each way */
+#define TEST_IO_SIZE 4096		 /* Bytes per socket read or write */
+#define TEST_SECRET_SIZE 32		 /* Traffic secret size */
+#define TEST_POLL_NS (10 * 1000 * 1000) /* Wait between two attempts to reach a relay */
+
+/* Sockets and relays of the test, the relays run in child processes */
+enum test_endpoint {
+	TEST_SERVICE,	   /* Echo service, in the test process */
+	TEST_DECRYPT,	   /* Decrypting relay in front of the service */
+	TEST_ENCRYPT,	   /* Encrypting relay that shares the secret of the decrypting relay */
+	TEST_ENCRYPT_BAD,  /* Encrypting relay with another secret */
+	TEST_NUM_ENDPOINTS /* Number of endpoints */
+};
+
+static uint16_t ports[TEST_NUM_ENDPOINTS];
+static atomic_size_t service_bytes;
+static char payload[TEST_PAYLOAD_SIZE];
+
+/* Sending side of a client */
+struct test_sender {
+	int fd;		  /* Client socket */
+	const char *data; /* Bytes to send */
+	size_t size;	  /* Number of bytes */
+};
+
+/*
+ * Bind a loopback TCP socket to a port picked by the kernel
+ *
+ * @port [out]: The port
+ * @return: the socket
+ */
+static int bind_loopback(uint16_t *port)
+{
+	struct sockaddr_in addr = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+	socklen_t addr_len = sizeof(addr);
+	int fd, one = 1;
+
+	fd = socket(AF_INET, SOCK_STREAM, 0);
+	AES_GCM_TEST_CHECK(fd >= 0);
+	(void)setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	AES_GCM_TEST_CHECK(bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+	AES_GCM_TEST_CHECK(getsockname(fd, (struct sockaddr *)&addr, &addr_len) == 0);
+	*port = ntohs(addr.sin_port);
+	return fd;
+}
+
+/*
+ * Connect to a loopback port
+ *
+ * @port [in]: The port
+ * @return: the socket, -1 if nothing listens on the port
+ */
+static int connect_loopback(uint16_t port)
+{
+	struct sockaddr_in addr = {.sin_family = AF_INET,
+				   .sin_port = htons(port),
+				   .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+	int fd;
+
+	fd = socket(AF_INET, SOCK_STREAM, 0);
+	AES_GCM_TEST_CHECK(fd >= 0);
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/*
+ * Echo a service connection until its peer ends it, then end the echo
+ *
+ * @arg [in]: The connection socket
+ * @return: NULL
+ */
+static void *echo_conn(void *arg)
+{
+	int fd = (int)(intptr_t)arg;
+	char buf[TEST_IO_SIZE];
+	ssize_t nb_read, nb_written, offset;
+
+	while ((nb_read = read(fd, buf, sizeof(buf))) > 0) {
+		atomic_fetch_add(&service_bytes, (size_t)nb_read);
+		for (offset = 0; offset < nb_read; offset += nb_written) {
+			nb_written = write(fd, buf + offset, nb_read - offset);
+			if (nb_written <= 0)
+				goto close_conn;
+		}
+	}
+	/* The end of the request travels back as the end of the response */
+	shutdown(fd, SHUT_WR);
+close_conn:
+	close(fd);
+	return NULL;
+}
+
+/*
+ * Accept service connections and echo each of them in its own thread
+ *
+ * @arg [in]: The listening socket
+ * @return: NULL
+ */
+static void *run_service(void *arg)
+{
+	int listen_fd = (int)(intptr_t)arg;
+	pthread_t thread;
+	int fd;
+
+	while ((fd = accept(listen_fd, NULL, NULL)) >= 0) {
+		AES_GCM_TEST_CHECK(pthread_create(&thread, NULL, echo_conn, (void *)(intptr_t)fd) == 0);
+		pthread_detach(thread);
+	}
+	return NULL;
+}
+
+/*
+ * Send the bytes of a client, then end its side of the stream
+ *
+ * @arg [in]: The sender
+ * @return: NULL
+ */
+static void *run_sender(void *arg)
+{
+	struct test_sender *sender = arg;
+	size_t offset, len;
+	ssize_t nb_written;
+
+	for (offset = 0; offset < sender->size; offset += nb_written) {
+		len = (sender->size - offset < TEST_IO_SIZE) ? (sender->size - offset) : TEST_IO_SIZE;
+		nb_written = write(sender->fd, sender->data + offset, len);
+		if (nb_written <= 0)
+			return NULL;
+	}
+	shutdown(sender->fd, SHUT_WR);
+	return NULL;
+}
+
+/*
+ * Send the payload through a relay and read the reply until the relay ends it
+ *
+ * @port [in]: Port of the encrypting relay
+ * @reply [out]: The reply, TEST_PAYLOAD_SIZE bytes long
+ * @clean_end [out]: The reply ended with an orderly shutdown rather than a reset
+ * @return: the reply size
+ */
+static size_t relay_exchange(uint16_t port, char *reply, bool *clean_end)
+{
+	struct test_sender sender = {.data = payload, .size = TEST_PAYLOAD_SIZE};
+	size_t reply_size = 0;
+	pthread_t thread;
+	ssize_t nb_read;
+
+	sender.fd = connect_loopback(port);
+	AES_GCM_TEST_CHECK(sender.fd >= 0);
+	AES_GCM_TEST_CHECK(pthread_create(&thread, NULL, run_sender, &sender) == 0);
+
+	while (reply_size < TEST_PAYLOAD_SIZE &&
+	       (nb_read = read(sender.fd, reply + reply_size, TEST_PAYLOAD_SIZE - reply_size)) > 0)
+		reply_size += nb_read;
+	if (reply_size < TEST_PAYLOAD_SIZE)
+		*clean_end = (nb_read == 0);
+	else
+		*clean_end = (read(sender.fd, reply, 1) == 0);
+
+	/* A dropped connection can leave the sender blocked, the reset wakes it up */
+	shutdown(sender.fd, SHUT_RDWR);
+	pthread_join(thread, NULL);
+	close(sender.fd);
+	return reply_size;
+}
+
+/*
+ * Start a relay in a child process
+ *
+ * @mode [in]: AES-GCM mode of the relay
+ * @listen [in]: Endpoint the relay listens on
+ * @target [in]: Endpoint the relay forwards to
+ * @secret_seed [in]: Seed of the traffic secret, relays with the same seed share it
+ * @return: the child process
+ */
+static pid_t start_relay(enum aes_gcm_mode mode,
+			 enum test_endpoint listen,
+			 enum test_endpoint target,
+			 uint8_t secret_seed)
+{
+	static struct aes_gcm_cfg cfg;
+	pid_t pid;
+	uint32_t i;
+
+	pid = fork();
+	AES_GCM_TEST_CHECK(pid >= 0);
+	if (pid != 0)
+		return pid;
+
+	init_aes_gcm_params(&cfg);
+	AES_GCM_TEST_CHECK(aes_gcm_emu_model_parse("devices=2,max_tasks=8,seed=1", &cfg.emu) == DOCA_SUCCESS);
+	cfg.no_numa = true;
+	cfg.caps_cache_path[0] = '\0';
+	cfg.tuning_profile_path[0] = '\0';
+	cfg.tls_secret_len = TEST_SECRET_SIZE;
+	for (i = 0; i < TEST_SECRET_SIZE; i++)
+		cfg.tls_secret[i] = (uint8_t)(secret_seed + i * 7);
+	snprintf(cfg.relay_listen, sizeof(cfg.relay_listen), "127.0.0.1:%u", ports[listen]);
+	snprintf(cfg.relay_target, sizeof(cfg.relay_target), "127.0.0.1:%u", ports[target]);
+	_exit(aes_gcm_relay_run(&cfg, mode) == DOCA_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/*
+ * Wait until a relay listens
+ *
+ * @endpoint [in]: Endpoint of the relay
+ */
+static void wait_relay(enum test_endpoint endpoint)
+{
+	struct timespec poll_time = {0, TEST_POLL_NS};
+	int fd;
+
+	while ((fd = connect_loopback(ports[endpoint])) < 0)
+		nanosleep(&poll_time, NULL);
+	close(fd);
+}
+
+/*
+ * Run an encrypting and a decrypting relay over emulated devices between loopback sockets, in front of an echo
+ * service. A client must get its bytes back through the hello exchange and the sealed records, and the end of its
+ * stream must come back as the end of the reply through the close_notify alerts. A relay with another secret must not
+ * reach the service.
+ *
+ * @return: EXIT_SUCCESS on success and EXIT_FAILURE otherwise
+ */
+int main(void)
+{
+	static char reply[TEST_PAYLOAD_SIZE];
+	pid_t relays[TEST_NUM_ENDPOINTS];
+	int fds[TEST_NUM_ENDPOINTS];
+	pthread_t service;
+	size_t reply_size, i;
+	bool clean_end;
+	int status;
+
+	(void)doca_log_backend_create_standard();
+	alarm(AES_GCM_TEST_TIMEOUT_S);
+	signal(SIGPIPE, SIG_IGN);
+
+	for (i = 0; i < sizeof(payload); i++)
+		payload[i] = (char)(i * 13 + (i >> 10));
+
+	/* The relays listen on the ports the kernel picked for these sockets */
+	for (i = 0; i < TEST_NUM_ENDPOINTS; i++)
+		fds[i] = bind_loopback(&ports[i]);
+	for (i = TEST_DECRYPT; i < TEST_NUM_ENDPOINTS; i++)
+		close(fds[i]);
+
+	relays[TEST_DECRYPT] = start_relay(AES_GCM_MODE_DECRYPT, TEST_DECRYPT, TEST_SERVICE, 1);
+	relays[TEST_ENCRYPT] = start_relay(AES_GCM_MODE_ENCRYPT, TEST_ENCRYPT, TEST_DECRYPT, 1);
+	relays[TEST_ENCRYPT_BAD] = start_relay(AES_GCM_MODE_ENCRYPT, TEST_ENCRYPT_BAD, TEST_DECRYPT, 2);
+
+	AES_GCM_TEST_CHECK(listen(fds[TEST_SERVICE], AES_GCM_RELAY_MAX_CONNECTIONS) == 0);
+	AES_GCM_TEST_CHECK(pthread_create(&service, NULL, run_service, (void *)(intptr_t)fds[TEST_SERVICE]) == 0);
+	for (i = TEST_DECRYPT; i < TEST_NUM_ENDPOINTS; i++)
+		wait_relay(i);
+
+	/* Round trip: hello and salts, sealed records both ways, close_notify both ways */
+	atomic_store(&service_bytes, 0);
+	reply_size = relay_exchange(ports[TEST_ENCRYPT], reply, &clean_end);
+	AES_GCM_TEST_CHECK(reply_size == TEST_PAYLOAD_SIZE && memcmp(reply, payload, TEST_PAYLOAD_SIZE) == 0);
+	AES_GCM_TEST_CHECK(clean_end);
+	AES_GCM_TEST_CHECK(atomic_load(&service_bytes) == TEST_PAYLOAD_SIZE);
+	DOCA_LOG_INFO("Relayed %zu bytes both ways", reply_size);
+
+	/* Mismatched secret: the decrypting relay fails to open the first record and drops the connection */
+	atomic_store(&service_bytes, 0);
+	reply_size = relay_exchange(ports[TEST_ENCRYPT_BAD], reply, &clean_end);
+	AES_GCM_TEST_CHECK(reply_size == 0);
+	AES_GCM_TEST_CHECK(atomic_load(&service_bytes) == 0);
+	DOCA_LOG_INFO("Relay with another secret was rejected");
+
+	/* The relays stop cleanly on SIGTERM */
+	for (i = TEST_DECRYPT; i < TEST_NUM_ENDPOINTS; i++) {
+		AES_GCM_TEST_CHECK(kill(relays[i], SIGTERM) == 0 && waitpid(relays[i], &status, 0) == relays[i]);
+		AES_GCM_TEST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <doca_log.h>
+
+#include "aes_gcm_device_group.h"
+#include "aes_gcm_emu.h"
+#include "aes_gcm_test.h"
+#include "aes_gcm_tls.h"
+
+DOCA_LOG_REGISTER(AES_GCM::TEST_TLS_VECTORS);
+
+#define TEST_MAX_RECORD_SIZE 64 /* Max record size of the vector */
+
+/* Server handshake traffic secret of the RFC 8448 simple 1-RTT handshake */
+static const uint8_t rfc8448_secret[] = {
+	0xb6, 0x7b, 0x7d, 0x69, 0x0c, 0xc1, 0x6c, 0x4e, 0x75, 0xe5, 0x42, 0x13, 0xcb, 0x2d, 0x37, 0xb4,
+	0xe9, 0xc9, 0x12, 0xbc, 0xde, 0xd9, 0x10, 0x5d, 0x42, 0xbe, 0xfd, 0x59, 0xd3, 0x91, 0xad, 0x38,
+};
+
+/* Server handshake traffic key and IV RFC 8448 derives from it */
+static const uint8_t rfc8448_key[] = {
+	0x3f, 0xce, 0x51, 0x60, 0x09, 0xc2, 0x17, 0x27, 0xd0, 0xf2, 0xe4, 0xe8, 0x6e, 0xe4, 0x03, 0xbc,
+};
+static const uint8_t rfc8448_iv[] = {
+	0x5d, 0x31, 0x3e, 0xb2, 0x67, 0x12, 0x76, 0xee, 0x13, 0x00, 0x0b, 0x30,
+};
+
+/* First application data record under that key, sealed by an independent AES-GCM implementation */
+static const char vector_fragment[] = "hello, world";
+static const uint8_t vector_record[] = {
+	0x17, 0x03, 0x03, 0x00, 0x1d, 0xb1, 0x9a, 0x5f, 0x02, 0x39, 0xfb, 0x9f, 0x8b, 0x36, 0x2c, 0x6b, 0xba,
+	0x90, 0xe5, 0xbc, 0x4c, 0x8c, 0xe4, 0xb9, 0x07, 0x28, 0x42, 0x90, 0x55, 0xe5, 0xc8, 0x7b, 0x8a, 0x17,
+};
+
+/*
+ * Run one job on a device group of emulated devices and wait for it
+ *
+ * @session [in]: Session whose traffic key the job runs with
+ * @mode [in]: AES-GCM mode
+ * @src [in]: Source memory, the job source lies in it
+ * @dst [in]: Destination memory, the job destination lies in it
+ * @job [in/out]: The job
+ */
+static void run_job(const struct aes_gcm_tls_session *session,
+		    enum aes_gcm_mode mode,
+		    uint8_t *src,
+		    uint8_t *dst,
+		    struct aes_gcm_job *job)
+{
+	static struct aes_gcm_cfg cfg;
+	struct aes_gcm_device_group *group;
+	struct aes_gcm_group_key key;
+
+	init_aes_gcm_params(&cfg);
+	AES_GCM_TEST_CHECK(aes_gcm_emu_model_parse("devices=1,seed=1", &cfg.emu) == DOCA_SUCCESS);
+	cfg.no_numa = true;
+	cfg.caps_cache_path[0] = '\0';
+	cfg.tuning_profile_path[0] = '\0';
+
+	AES_GCM_TEST_CHECK(aes_gcm_device_group_create(&cfg, mode, &group) == DOCA_SUCCESS);
+	AES_GCM_TEST_CHECK(aes_gcm_device_group_start(group, src, TEST_MAX_RECORD_SIZE, dst, TEST_MAX_RECORD_SIZE) ==
+			   DOCA_SUCCESS);
+	AES_GCM_TEST_CHECK(aes_gcm_device_group_key_create(group, session->key, aes_gcm_tls_key_type(session), &key) ==
+			   DOCA_SUCCESS);
+	aes_gcm_device_group_submit(group, &key, job);
+	aes_gcm_device_group_wait(group);
+	AES_GCM_TEST_CHECK(aes_gcm_device_group_key_destroy(group, &key) == DOCA_SUCCESS);
+	AES_GCM_TEST_CHECK(aes_gcm_device_group_destroy(group) == DOCA_SUCCESS);
+}
+
+/*
+ * Check the TLS 1.3 record protection against known vectors: the software path through the sample selftest, then
+ * the RFC 8448 traffic key derivation and a known record sealed and opened by the devices
+ *
+ * @return: EXIT_SUCCESS on success and EXIT_FAILURE otherwise
+ */
+int main(void)
+{
+	static uint8_t src[TEST_MAX_RECORD_SIZE], dst[TEST_MAX_RECORD_SIZE];
+	struct aes_gcm_tls_session session;
+	struct aes_gcm_job job = {0};
+	const uint8_t *content;
+	size_t content_len;
+	uint8_t content_type;
+
+	(void)doca_log_backend_create_standard();
+	alarm(AES_GCM_TEST_TIMEOUT_S);
+
+	AES_GCM_TEST_CHECK(aes_gcm_tls_selftest() == DOCA_SUCCESS);
+
+	AES_GCM_TEST_CHECK(aes_gcm_tls_session_init(rfc8448_secret, sizeof(rfc8448_secret), 0, &session) ==
+			   DOCA_SUCCESS);
+	AES_GCM_TEST_CHECK(session.suite == AES_GCM_TLS_AES_128_GCM_SHA256);
+	AES_GCM_TEST_CHECK(session.key_len == sizeof(rfc8448_key) &&
+			   memcmp(session.key, rfc8448_key, sizeof(rfc8448_key)) == 0);
+	AES_GCM_TEST_CHECK(memcmp(session.static_iv, rfc8448_iv, sizeof(rfc8448_iv)) == 0);
+
+	/* Seal on the devices, the header is the AAD and the tag follows the ciphertext */
+	AES_GCM_TEST_CHECK(aes_gcm_tls_sealed_size(strlen(vector_fragment), 0) == sizeof(vector_record));
+	AES_GCM_TEST_CHECK(aes_gcm_tls_seal_prepare(&session,
+						    AES_GCM_TLS_CONTENT_APPLICATION_DATA,
+						    vector_fragment,
+						    strlen(vector_fragment),
+						    0,
+						    src,
+						    dst,
+						    &job) == DOCA_SUCCESS);
+	run_job(&session, AES_GCM_MODE_ENCRYPT, src, dst, &job);
+	AES_GCM_TEST_CHECK(job.result == DOCA_SUCCESS);
+	AES_GCM_TEST_CHECK(memcmp(dst, vector_record, sizeof(vector_record)) == 0);
+
+	/* Open the known record on the devices */
+	session.seq = 0;
+	memcpy(src, vector_record, sizeof(vector_record));
+	memset(dst, 0, sizeof(dst));
+	AES_GCM_TEST_CHECK(aes_gcm_tls_open_prepare(&session, src, sizeof(vector_record), dst, &job) == DOCA_SUCCESS);
+	run_job(&session, AES_GCM_MODE_DECRYPT, src, dst, &job);
+	AES_GCM_TEST_CHECK(aes_gcm_tls_open_finish(&job, &content_type, &content, &content_len) == DOCA_SUCCESS);
+	AES_GCM_TEST_CHECK(content_type == AES_GCM_TLS_CONTENT_APPLICATION_DATA);
+	AES_GCM_TEST_CHECK(content_len == strlen(vector_fragment) &&
+			   memcmp(content, vector_fragment, content_len) == 0);
+
+	/* A record with a flipped ciphertext bit fails authentication */
+	session.seq = 0;
+	src[AES_GCM_TLS_HEADER_SIZE] ^= 0x01;
+	AES_GCM_TEST_CHECK(aes_gcm_tls_open_prepare(&session, src, sizeof(vector_record), dst, &job) == DOCA_SUCCESS);
+	run_job(&session, AES_GCM_MODE_DECRYPT, src, dst, &job);
+	AES_GCM_TEST_CHECK(job.result != DOCA_SUCCESS);
+
+	DOCA_LOG_INFO("Devices sealed and opened the RFC 8448 record");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,912 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+#include <doca_log.h>
+#include <doca_error.h>
+
+#include "aes_gcm_device_group.h"
+#include "aes_gcm_hugepage.h"
+#include "aes_gcm_record.h"
+#include "aes_gcm_sw.h"
+#include "aes_gcm_tls.h"
+
+DOCA_LOG_REGISTER(AES_GCM::TLS);
+
+#define TLS_LABEL_PREFIX "tls13 "     /* Prefix of every HKDF label */
+#define TLS_MAX_LABEL_SIZE 255	      /* Max HKDF label length */
+#define TLS_MAX_CONTEXT_SIZE 255      /* Max HKDF context length */
+#define TLS_VECTOR_MAX_RECORD_SIZE 64 /* Max record size of the known vectors */
+
+/* Known TLS 1.3 record protection vector */
+struct tls_vector {
+	uint8_t secret[AES_GCM_TLS_MAX_SECRET_SIZE]; /* Traffic secret */
+	uint32_t secret_len;			     /* Traffic secret length */
+	uint8_t key[MAX_AES_GCM_KEY_SIZE];	     /* Expected traffic key */
+	uint8_t iv[AES_GCM_TLS_IV_SIZE];	     /* Expected traffic IV */
+	uint64_t seq;				     /* Sequence number of the record */
+	const char *fragment;			     /* Application data fragment */
+	uint8_t record[TLS_VECTOR_MAX_RECORD_SIZE];  /* Expected sealed record */
+	size_t record_len;			     /* Expected sealed record length */
+};
+
+/*
+ * The first vector derives the server handshake traffic key and IV of the RFC 8448 simple 1-RTT handshake, the
+ * records were sealed by an independent AES-GCM implementation
+ */
+static const struct tls_vector tls_vectors[] = {
+	{
+		.secret = {
+			0xb6, 0x7b, 0x7d, 0x69, 0x0c, 0xc1, 0x6c, 0x4e, 0x75, 0xe5, 0x42, 0x13,
+			0xcb, 0x2d, 0x37, 0xb4, 0xe9, 0xc9, 0x12, 0xbc, 0xde, 0xd9, 0x10, 0x5d,
+			0x42, 0xbe, 0xfd, 0x59, 0xd3, 0x91, 0xad, 0x38,
+		},
+		.secret_len = 32,
+		.key = {
+			0x3f, 0xce, 0x51, 0x60, 0x09, 0xc2, 0x17, 0x27, 0xd0, 0xf2, 0xe4, 0xe8,
+			0x6e, 0xe4, 0x03, 0xbc,
+		},
+		.iv = {
+			0x5d, 0x31, 0x3e, 0xb2, 0x67, 0x12, 0x76, 0xee, 0x13, 0x00, 0x0b, 0x30,
+		},
+		.seq = 0,
+		.fragment = "hello, world",
+		.record = {
+			0x17, 0x03, 0x03, 0x00, 0x1d, 0xb1, 0x9a, 0x5f, 0x02, 0x39, 0xfb, 0x9f,
+			0x8b, 0x36, 0x2c, 0x6b, 0xba, 0x90, 0xe5, 0xbc, 0x4c, 0x8c, 0xe4, 0xb9,
+			0x07, 0x28, 0x42, 0x90, 0x55, 0xe5, 0xc8, 0x7b, 0x8a, 0x17,
+		},
+		.record_len = 34,
+	},
+	{
+		.secret = {
+			0xb6, 0x7b, 0x7d, 0x69, 0x0c, 0xc1, 0x6c, 0x4e, 0x75, 0xe5, 0x42, 0x13,
+			0xcb, 0x2d, 0x37, 0xb4, 0xe9, 0xc9, 0x12, 0xbc, 0xde, 0xd9, 0x10, 0x5d,
+			0x42, 0xbe, 0xfd, 0x59, 0xd3, 0x91, 0xad, 0x38,
+		},
+		.secret_len = 32,
+		.key = {
+			0x3f, 0xce, 0x51, 0x60, 0x09, 0xc2, 0x17, 0x27, 0xd0, 0xf2, 0xe4, 0xe8,
+			0x6e, 0xe4, 0x03, 0xbc,
+		},
+		.iv = {
+			0x5d, 0x31, 0x3e, 0xb2, 0x67, 0x12, 0x76, 0xee, 0x13, 0x00, 0x0b, 0x30,
+		},
+		.seq = 1,
+		.fragment = "",
+		.record = {
+			0x17, 0x03, 0x03, 0x00, 0x11, 0x6a, 0xe1, 0x27, 0x6c, 0x0e, 0x06, 0xe8,
+			0x0a, 0x56, 0x30, 0xaa, 0x54, 0xe9, 0x87, 0xf3, 0xf6, 0x20,
+		},
+		.record_len = 22,
+	},
+	{
+		.secret = {
+			0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+			0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+			0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23,
+			0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f,
+		},
+		.secret_len = 48,
+		.key = {
+			0x68, 0x77, 0xd0, 0x22, 0xf1, 0xc6, 0x1d, 0x24, 0xeb, 0xb7, 0x48, 0x7c,
+			0x16, 0x75, 0x2d, 0x9a, 0x47, 0x98, 0xe4, 0x04, 0x31, 0xc7, 0x5b, 0x39,
+			0x32, 0x0e, 0x53, 0x7c, 0x90, 0xe2, 0x32, 0x25,
+		},
+		.iv = {
+			0x42, 0x82, 0x25, 0x31, 0xa0, 0xfe, 0x88, 0x64, 0x8f, 0xc0, 0x9e, 0x9f,
+		},
+		.seq = 7,
+		.fragment = "0123456789abcdef0123",
+		.record = {
+			0x17, 0x03, 0x03, 0x00, 0x25, 0xfe, 0x56, 0x00, 0x08, 0xcc, 0xbf, 0xf4,
+			0x79, 0xc2, 0xda, 0x5f, 0x38, 0x6c, 0x3c, 0x56, 0x51, 0x33, 0xa9, 0x09,
+			0xb9, 0x4a, 0x3a, 0x87, 0xc3, 0x3b, 0xbb, 0x88, 0x46, 0x70, 0xca, 0x00,
+			0xcd, 0x96, 0x7f, 0x60, 0xa9, 0xdc,
+		},
+		.record_len = 42,
+	},
+};
+
+/*
+ * HKDF-Expand-Label of RFC 8446, for outputs no longer than the hash
+ *
+ * @md [in]: Hash of the cipher suite
+ * @secret [in]: Secret
+ * @secret_len [in]: Secret length
+ * @label [in]: Label, without the "tls13 " prefix
+ * @context [in]: Context, may be NULL when empty
+ * @context_len [in]: Context length, at most TLS_MAX_CONTEXT_SIZE
+ * @out [out]: Derived bytes
+ * @out_len [in]: Number of bytes to derive
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t hkdf_expand_label(const EVP_MD *md,
+				      const uint8_t *secret,
+				      uint32_t secret_len,
+				      const char *label,
+				      const uint8_t *context,
+				      uint32_t context_len,
+				      uint8_t *out,
+				      uint32_t out_len)
+{
+	uint8_t info[2 + 1 + TLS_MAX_LABEL_SIZE + 1 + TLS_MAX_CONTEXT_SIZE + 1];
+	uint8_t block[EVP_MAX_MD_SIZE];
+	unsigned int block_len = 0;
+	size_t label_len = strlen(TLS_LABEL_PREFIX) + strlen(label), n = 0;
+
+	if (label_len > TLS_MAX_LABEL_SIZE || context_len > TLS_MAX_CONTEXT_SIZE || out_len > (uint32_t)EVP_MD_size(md))
+		return DOCA_ERROR_INVALID_VALUE;
+
+	info[n++] = (uint8_t)(out_len >> 8);
+	info[n++] = (uint8_t)out_len;
+	info[n++] = (uint8_t)label_len;
+	memcpy(info + n, TLS_LABEL_PREFIX, strlen(TLS_LABEL_PREFIX));
+	n += strlen(TLS_LABEL_PREFIX);
+	memcpy(info + n, label, strlen(label));
+	n += strlen(label);
+	info[n++] = (uint8_t)context_len;
+	if (context_len != 0)
+		memcpy(info + n, context, context_len);
+	n += context_len;
+	info[n++] = 1; /* HKDF-Expand block counter, a single block covers the key and the IV */
+
+	if (HMAC(md, secret, secret_len, info, n, block, &block_len) == NULL || block_len < out_len)
+		return DOCA_ERROR_UNEXPECTED;
+	memcpy(out, block, out_len);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Write a record header
+ *
+ * @header [out]: The header, AES_GCM_TLS_HEADER_SIZE bytes
+ * @length [in]: Length of the encrypted record payload, tag included
+ */
+static void write_header(uint8_t *header, size_t length)
+{
+	header[0] = AES_GCM_TLS_CONTENT_APPLICATION_DATA;
+	header[1] = (uint8_t)(AES_GCM_TLS_LEGACY_VERSION >> 8);
+	header[2] = (uint8_t)AES_GCM_TLS_LEGACY_VERSION;
+	header[3] = (uint8_t)(length >> 8);
+	header[4] = (uint8_t)length;
+}
+
+/*
+ * Build the header and the inner plaintext of a record
+ *
+ * @content_type [in]: Content type of the fragment
+ * @fragment [in]: The fragment
+ * @fragment_len [in]: Fragment length
+ * @pad_len [in]: Number of zero padding bytes
+ * @record [out]: The record header followed by the inner plaintext, may hold the fragment already
+ * @inner_len [out]: Inner plaintext length
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t build_inner_plaintext(uint8_t content_type,
+					  const void *fragment,
+					  size_t fragment_len,
+					  size_t pad_len,
+					  uint8_t *record,
+					  size_t *inner_len)
+{
+	if (fragment_len > AES_GCM_TLS_MAX_PLAINTEXT || pad_len > AES_GCM_TLS_MAX_PLAINTEXT - fragment_len) {
+		DOCA_LOG_ERR("Fragment of %zu bytes with %zu padding bytes exceeds the %d bytes record limit",
+			     fragment_len,
+			     pad_len,
+			     AES_GCM_TLS_MAX_PLAINTEXT);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	*inner_len = fragment_len + 1 + pad_len;
+	write_header(record, *inner_len + AES_GCM_TLS_TAG_SIZE);
+	memmove(record + AES_GCM_TLS_HEADER_SIZE, fragment, fragment_len);
+	record[AES_GCM_TLS_HEADER_SIZE + fragment_len] = content_type;
+	memset(record + AES_GCM_TLS_HEADER_SIZE + fragment_len + 1, 0, pad_len);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Strip the padding of an inner plaintext
+ *
+ * @inner [in]: Inner plaintext
+ * @inner_len [in]: Inner plaintext length
+ * @content_type [out]: Content type of the record
+ * @content_len [out]: Content length
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR_INVALID_VALUE if the inner plaintext is all padding
+ */
+static doca_error_t strip_padding(const uint8_t *inner, size_t inner_len, uint8_t *content_type, size_t *content_len)
+{
+	while (inner_len > 0 && inner[inner_len - 1] == 0)
+		inner_len--;
+	if (inner_len == 0)
+		return DOCA_ERROR_INVALID_VALUE;
+
+	*content_type = inner[inner_len - 1];
+	*content_len = inner_len - 1;
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_tls_session_init(const uint8_t *secret,
+				      uint32_t secret_len,
+				      uint64_t seq,
+				      struct aes_gcm_tls_session *session)
+{
+	const EVP_MD *md;
+	doca_error_t result;
+
+	if (secret_len == 32) {
+		session->suite = AES_GCM_TLS_AES_128_GCM_SHA256;
+		session->key_len = AES_GCM_KEY_128_SIZE_IN_BYTES;
+		md = EVP_sha256();
+	} else if (secret_len == AES_GCM_TLS_MAX_SECRET_SIZE) {
+		session->suite = AES_GCM_TLS_AES_256_GCM_SHA384;
+		session->key_len = AES_GCM_KEY_256_SIZE_IN_BYTES;
+		md = EVP_sha384();
+	} else {
+		DOCA_LOG_ERR("Traffic secret of %u bytes does not match an AES-GCM cipher suite", secret_len);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	result = hkdf_expand_label(md, secret, secret_len, "key", NULL, 0, session->key, session->key_len);
+	if (result == DOCA_SUCCESS)
+		result = hkdf_expand_label(md,
+					   secret,
+					   secret_len,
+					   "iv",
+					   NULL,
+					   0,
+					   session->static_iv,
+					   AES_GCM_TLS_IV_SIZE);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to derive the traffic key and IV: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	session->seq = seq;
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_tls_derive_secret(const uint8_t *secret,
+				       uint32_t secret_len,
+				       const char *label,
+				       const uint8_t *context,
+				       uint32_t context_len,
+				       uint8_t *out)
+{
+	const EVP_MD *md;
+
+	if (secret_len == 32) {
+		md = EVP_sha256();
+	} else if (secret_len == AES_GCM_TLS_MAX_SECRET_SIZE) {
+		md = EVP_sha384();
+	} else {
+		DOCA_LOG_ERR("Traffic secret of %u bytes does not match an AES-GCM cipher suite", secret_len);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	return hkdf_expand_label(md, secret, secret_len, label, context, context_len, out, secret_len);
+}
+
+enum doca_aes_gcm_key_type aes_gcm_tls_key_type(const struct aes_gcm_tls_session *session)
+{
+	return (session->key_len == AES_GCM_KEY_128_SIZE_IN_BYTES) ? DOCA_AES_GCM_KEY_128 : DOCA_AES_GCM_KEY_256;
+}
+
+size_t aes_gcm_tls_sealed_size(size_t fragment_len, size_t pad_len)
+{
+	return AES_GCM_TLS_HEADER_SIZE + fragment_len + 1 + pad_len + AES_GCM_TLS_TAG_SIZE;
+}
+
+doca_error_t aes_gcm_tls_record_parse(const uint8_t *data, size_t data_len, size_t *record_len)
+{
+	size_t length;
+
+	if (data_len < AES_GCM_TLS_HEADER_SIZE)
+		return DOCA_ERROR_INVALID_VALUE;
+	if (data[0] != AES_GCM_TLS_CONTENT_APPLICATION_DATA || ((data[1] << 8) | data[2]) != AES_GCM_TLS_LEGACY_VERSION)
+		return DOCA_ERROR_NOT_SUPPORTED;
+
+	/* The payload holds at least the content type and the tag */
+	length = ((size_t)data[3] << 8) | data[4];
+	if (length < 1 + AES_GCM_TLS_TAG_SIZE || length > AES_GCM_TLS_MAX_CIPHERTEXT ||
+	    length > data_len - AES_GCM_TLS_HEADER_SIZE)
+		return DOCA_ERROR_INVALID_VALUE;
+
+	*record_len = AES_GCM_TLS_HEADER_SIZE + length;
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_tls_seal_prepare(struct aes_gcm_tls_session *session,
+				      uint8_t content_type,
+				      const void *fragment,
+				      size_t fragment_len,
+				      size_t pad_len,
+				      void *src,
+				      void *dst,
+				      struct aes_gcm_job *job)
+{
+	size_t inner_len;
+	doca_error_t result;
+
+	result = build_inner_plaintext(content_type, fragment, fragment_len, pad_len, src, &inner_len);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	job->src = src;
+	job->src_len = AES_GCM_TLS_HEADER_SIZE + inner_len;
+	job->dst = dst;
+	job->dst_len = job->src_len + AES_GCM_TLS_TAG_SIZE;
+	aes_gcm_derive_iv(session->static_iv, AES_GCM_TLS_IV_SIZE, session->seq++, job->iv);
+	job->iv_length = AES_GCM_TLS_IV_SIZE;
+	job->tag_size = AES_GCM_TLS_TAG_SIZE;
+	job->aad_size = AES_GCM_TLS_HEADER_SIZE;
+	job->tag = NULL;
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_tls_open_prepare(struct aes_gcm_tls_session *session,
+				      const void *record,
+				      size_t record_len,
+				      void *dst,
+				      struct aes_gcm_job *job)
+{
+	size_t parsed_len;
+	doca_error_t result;
+
+	result = aes_gcm_tls_record_parse(record, record_len, &parsed_len);
+	if (result != DOCA_SUCCESS || parsed_len != record_len) {
+		DOCA_LOG_ERR("Buffer of %zu bytes does not hold exactly one TLS record", record_len);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	job->src = (void *)record;
+	job->src_len = record_len;
+	job->dst = dst;
+	job->dst_len = record_len - AES_GCM_TLS_TAG_SIZE;
+	aes_gcm_derive_iv(session->static_iv, AES_GCM_TLS_IV_SIZE, session->seq++, job->iv);
+	job->iv_length = AES_GCM_TLS_IV_SIZE;
+	job->tag_size = AES_GCM_TLS_TAG_SIZE;
+	job->aad_size = AES_GCM_TLS_HEADER_SIZE;
+	job->tag = NULL;
+	return DOCA_SUCCESS;
+}
+
+doca_error_t aes_gcm_tls_open_finish(const struct aes_gcm_job *job,
+				     uint8_t *content_type,
+				     const uint8_t **content,
+				     size_t *content_len)
+{
+	const uint8_t *inner = (const uint8_t *)job->dst + AES_GCM_TLS_HEADER_SIZE;
+
+	if (job->result != DOCA_SUCCESS)
+		return job->result;
+	if (job->out_len < AES_GCM_TLS_HEADER_SIZE)
+		return DOCA_ERROR_INVALID_VALUE;
+
+	*content = inner;
+	return strip_padding(inner, job->out_len - AES_GCM_TLS_HEADER_SIZE, content_type, content_len);
+}
+
+doca_error_t aes_gcm_tls_seal_sw(struct aes_gcm_tls_session *session,
+				 uint8_t content_type,
+				 const void *fragment,
+				 size_t fragment_len,
+				 size_t pad_len,
+				 uint8_t *record)
+{
+	uint8_t nonce[AES_GCM_TLS_IV_SIZE];
+	size_t inner_len;
+	doca_error_t result;
+
+	result = build_inner_plaintext(content_type, fragment, fragment_len, pad_len, record, &inner_len);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	aes_gcm_derive_iv(session->static_iv, AES_GCM_TLS_IV_SIZE, session->seq++, nonce);
+	return aes_gcm_sw_encrypt(session->key,
+				  session->key_len,
+				  nonce,
+				  AES_GCM_TLS_IV_SIZE,
+				  record,
+				  AES_GCM_TLS_HEADER_SIZE,
+				  record + AES_GCM_TLS_HEADER_SIZE,
+				  inner_len,
+				  record + AES_GCM_TLS_HEADER_SIZE,
+				  record + AES_GCM_TLS_HEADER_SIZE + inner_len,
+				  AES_GCM_TLS_TAG_SIZE);
+}
+
+doca_error_t aes_gcm_tls_open_sw(struct aes_gcm_tls_session *session,
+				 const uint8_t *record,
+				 size_t record_len,
+				 uint8_t *content,
+				 uint8_t *content_type,
+				 size_t *content_len)
+{
+	uint8_t nonce[AES_GCM_TLS_IV_SIZE];
+	size_t parsed_len, inner_len;
+	doca_error_t result;
+
+	result = aes_gcm_tls_record_parse(record, record_len, &parsed_len);
+	if (result != DOCA_SUCCESS || parsed_len != record_len)
+		return DOCA_ERROR_INVALID_VALUE;
+
+	inner_len = record_len - AES_GCM_TLS_HEADER_SIZE - AES_GCM_TLS_TAG_SIZE;
+	aes_gcm_derive_iv(session->static_iv, AES_GCM_TLS_IV_SIZE, session->seq++, nonce);
+	result = aes_gcm_sw_decrypt(session->key,
+				    session->key_len,
+				    nonce,
+				    AES_GCM_TLS_IV_SIZE,
+				    record,
+				    AES_GCM_TLS_HEADER_SIZE,
+				    record + AES_GCM_TLS_HEADER_SIZE,
+				    inner_len,
+				    record + AES_GCM_TLS_HEADER_SIZE + inner_len,
+				    AES_GCM_TLS_TAG_SIZE,
+				    content);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	return strip_padding(content, inner_len, content_type, content_len);
+}
+
+doca_error_t aes_gcm_tls_selftest(void)
+{
+	const struct tls_vector *vector;
+	struct aes_gcm_tls_session session;
+	uint8_t record[TLS_VECTOR_MAX_RECORD_SIZE], content[TLS_VECTOR_MAX_RECORD_SIZE];
+	size_t fragment_len, content_len, i;
+	uint8_t content_type;
+	doca_error_t result;
+
+	for (i = 0; i < sizeof(tls_vectors) / sizeof(tls_vectors[0]); i++) {
+		vector = &tls_vectors[i];
+		fragment_len = strlen(vector->fragment);
+
+		result = aes_gcm_tls_session_init(vector->secret, vector->secret_len, vector->seq, &session);
+		if (result != DOCA_SUCCESS)
+			return result;
+		if (memcmp(session.key, vector->key, session.key_len) != 0 ||
+		    memcmp(session.static_iv, vector->iv, AES_GCM_TLS_IV_SIZE) != 0) {
+			DOCA_LOG_ERR("TLS vector %zu: derived traffic key or IV mismatch", i);
+			return DOCA_ERROR_UNEXPECTED;
+		}
+
+		result = aes_gcm_tls_seal_sw(&session,
+					     AES_GCM_TLS_CONTENT_APPLICATION_DATA,
+					     vector->fragment,
+					     fragment_len,
+					     0,
+					     record);
+		if (result != DOCA_SUCCESS || aes_gcm_tls_sealed_size(fragment_len, 0) != vector->record_len ||
+		    memcmp(record, vector->record, vector->record_len) != 0) {
+			DOCA_LOG_ERR("TLS vector %zu: sealed record mismatch", i);
+			return DOCA_ERROR_UNEXPECTED;
+		}
+
+		session.seq = vector->seq;
+		result = aes_gcm_tls_open_sw(&session,
+					     vector->record,
+					     vector->record_len,
+					     content,
+					     &content_type,
+					     &content_len);
+		if (result != DOCA_SUCCESS || content_type != AES_GCM_TLS_CONTENT_APPLICATION_DATA ||
+		    content_len != fragment_len || memcmp(content, vector->fragment, fragment_len) != 0) {
+			DOCA_LOG_ERR("TLS vector %zu: opened record mismatch", i);
+			return DOCA_ERROR_UNEXPECTED;
+		}
+	}
+
+	DOCA_LOG_INFO("TLS record protection matched %zu known vectors", i);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Check the records sealed by the devices against the software path
+ *
+ * @first_session [in]: The session the records were sealed with, as it was before the first record
+ * @jobs [in]: The completed seal jobs
+ * @fragments [in]: Fragment of every job
+ * @num_records [in]: Number of records
+ * @return: DOCA_SUCCESS if every record matched and DOCA_ERROR otherwise
+ */
+static doca_error_t verify_sealed(const struct aes_gcm_tls_session *first_session,
+				  const struct aes_gcm_job *jobs,
+				  const char **fragments,
+				  size_t num_records)
+{
+	struct aes_gcm_tls_session session = *first_session;
+	uint8_t *record;
+	size_t fragment_len, i;
+	doca_error_t result = DOCA_SUCCESS;
+
+	record = malloc(aes_gcm_tls_sealed_size(AES_GCM_TLS_MAX_PLAINTEXT, 0));
+	if (record == NULL)
+		return DOCA_ERROR_NO_MEMORY;
+
+	for (i = 0; i < num_records && result == DOCA_SUCCESS; i++) {
+		fragment_len = jobs[i].src_len - AES_GCM_TLS_HEADER_SIZE - 1;
+		result = aes_gcm_tls_seal_sw(&session,
+					     AES_GCM_TLS_CONTENT_APPLICATION_DATA,
+					     fragments[i],
+					     fragment_len,
+					     0,
+					     record);
+		if (result == DOCA_SUCCESS &&
+		    (jobs[i].out_len != jobs[i].dst_len || memcmp(record, jobs[i].dst, jobs[i].dst_len) != 0)) {
+			DOCA_LOG_ERR("Record %zu sealed by the device does not match the software AES-GCM", i);
+			result = DOCA_ERROR_UNEXPECTED;
+		}
+	}
+
+	free(record);
+	return result;
+}
+
+/*
+ * Seal a stream of length-prefixed fragments into TLS records
+ *
+ * @cfg [in]: Configuration parameters
+ * @session [in]: The session
+ * @file_data [in]: File data
+ * @file_size [in]: File size
+ * @out_file [in]: Output file
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t seal_records(struct aes_gcm_cfg *cfg,
+				 struct aes_gcm_tls_session *session,
+				 char *file_data,
+				 size_t file_size,
+				 FILE *out_file)
+{
+	struct aes_gcm_tls_session first_session = *session;
+	struct aes_gcm_device_group *group = NULL;
+	struct aes_gcm_group_key key = {0};
+	struct aes_gcm_job *jobs = NULL;
+	const char **fragments = NULL;
+	struct aes_gcm_mem src_mem = {0}, dst_mem = {0};
+	size_t num_records = 0, src_len = 0, dst_len = 0, src_offset, dst_offset, offset, i;
+	uint32_t fragment_len;
+	uint64_t start_ns;
+	doca_error_t result, tmp_result;
+
+	for (offset = 0; offset < file_size; offset += AES_GCM_RECORD_LEN_SIZE + fragment_len) {
+		if (file_size - offset < AES_GCM_RECORD_LEN_SIZE ||
+		    aes_gcm_record_len(file_data + offset) > file_size - offset - AES_GCM_RECORD_LEN_SIZE) {
+			DOCA_LOG_ERR("Fragment %zu at offset %zu is truncated", num_records, offset);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		fragment_len = aes_gcm_record_len(file_data + offset);
+		if (fragment_len > AES_GCM_TLS_MAX_PLAINTEXT) {
+			DOCA_LOG_ERR("Fragment %zu of %u bytes exceeds the %d bytes record limit",
+				     num_records,
+				     fragment_len,
+				     AES_GCM_TLS_MAX_PLAINTEXT);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		src_len += aes_gcm_tls_sealed_size(fragment_len, 0) - AES_GCM_TLS_TAG_SIZE;
+		dst_len += aes_gcm_tls_sealed_size(fragment_len, 0);
+		num_records++;
+	}
+
+	result = aes_gcm_device_group_create(cfg, AES_GCM_MODE_ENCRYPT, &group);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create device group: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	jobs = calloc(num_records, sizeof(*jobs));
+	fragments = calloc(num_records, sizeof(*fragments));
+	if (jobs == NULL || fragments == NULL) {
+		result = DOCA_ERROR_NO_MEMORY;
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(result));
+		goto destroy_group;
+	}
+
+	/* The devices read the record headers and inner plaintexts from registered memory */
+	result = aes_gcm_mem_alloc(cfg->hugepages, src_len, &src_mem);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+	result = aes_gcm_mem_alloc(cfg->hugepages, dst_len, &dst_mem);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+
+	offset = 0;
+	src_offset = 0;
+	dst_offset = 0;
+	for (i = 0; i < num_records; i++) {
+		fragment_len = aes_gcm_record_len(file_data + offset);
+		fragments[i] = file_data + offset + AES_GCM_RECORD_LEN_SIZE;
+		result = aes_gcm_tls_seal_prepare(session,
+						  AES_GCM_TLS_CONTENT_APPLICATION_DATA,
+						  fragments[i],
+						  fragment_len,
+						  0,
+						  (char *)src_mem.addr + src_offset,
+						  (char *)dst_mem.addr + dst_offset,
+						  &jobs[i]);
+		if (result != DOCA_SUCCESS)
+			goto destroy_group;
+		if (jobs[i].dst_len > group->max_buf_size) {
+			DOCA_LOG_ERR("Record %zu of %zu bytes > max buffer size %lu",
+				     i,
+				     jobs[i].dst_len,
+				     group->max_buf_size);
+			result = DOCA_ERROR_INVALID_VALUE;
+			goto destroy_group;
+		}
+		offset += AES_GCM_RECORD_LEN_SIZE + fragment_len;
+		src_offset += jobs[i].src_len;
+		dst_offset += jobs[i].dst_len;
+	}
+
+	result = aes_gcm_device_group_start(group, src_mem.addr, src_len, dst_mem.addr, dst_len);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+
+	result = aes_gcm_device_group_key_create(group, session->key, aes_gcm_tls_key_type(session), &key);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+
+	DOCA_LOG_INFO("Sealing %zu TLS records on %u devices", num_records, group->num_members);
+
+	start_ns = aes_gcm_get_time_ns();
+	aes_gcm_device_group_submit_burst(group, &key, jobs, num_records);
+	aes_gcm_device_group_wait(group);
+	aes_gcm_device_group_report(group, aes_gcm_get_time_ns() - start_ns);
+
+	for (i = 0; i < num_records; i++) {
+		if (jobs[i].result != DOCA_SUCCESS) {
+			result = jobs[i].result;
+			DOCA_LOG_ERR("Record %zu failed: %s", i, doca_error_get_descr(result));
+			goto destroy_key;
+		}
+	}
+
+	if (cfg->tls_verify) {
+		result = verify_sealed(&first_session, jobs, fragments, num_records);
+		if (result != DOCA_SUCCESS)
+			goto destroy_key;
+		DOCA_LOG_INFO("All %zu records match the software AES-GCM", num_records);
+	}
+
+	/* Records carry their own length, they go out back to back */
+	if (fwrite(dst_mem.addr, sizeof(uint8_t), dst_len, out_file) != dst_len) {
+		DOCA_LOG_ERR("Failed to write to output file: %s", cfg->output_path);
+		result = DOCA_ERROR_IO_FAILED;
+	}
+
+destroy_key:
+	tmp_result = aes_gcm_device_group_key_destroy(group, &key);
+	DOCA_ERROR_PROPAGATE(result, tmp_result);
+destroy_group:
+	free(fragments);
+	free(jobs);
+	tmp_result = aes_gcm_device_group_destroy(group);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to destroy device group: %s", doca_error_get_descr(tmp_result));
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+	aes_gcm_mem_free(&dst_mem);
+	aes_gcm_mem_free(&src_mem);
+
+	return result;
+}
+
+/*
+ * Open a stream of TLS records into length-prefixed fragments
+ *
+ * @cfg [in]: Configuration parameters
+ * @session [in]: The session
+ * @file_data [in]: File data
+ * @file_size [in]: File size
+ * @out_file [in]: Output file
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t open_records(struct aes_gcm_cfg *cfg,
+				 struct aes_gcm_tls_session *session,
+				 char *file_data,
+				 size_t file_size,
+				 FILE *out_file)
+{
+	struct aes_gcm_tls_session verify_session = *session;
+	struct aes_gcm_device_group *group = NULL;
+	struct aes_gcm_group_key key = {0};
+	struct aes_gcm_job *jobs = NULL;
+	struct aes_gcm_mem dst_mem = {0};
+	const uint8_t *content;
+	uint8_t *verify_content = NULL;
+	uint8_t content_type, verify_type;
+	size_t num_records = 0, dst_len = 0, record_len, content_len, verify_len, offset, dst_offset, i;
+	uint32_t prefix;
+	uint64_t start_ns;
+	doca_error_t result, tmp_result;
+
+	for (offset = 0; offset < file_size; offset += record_len) {
+		result = aes_gcm_tls_record_parse((uint8_t *)file_data + offset, file_size - offset, &record_len);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Record %zu at offset %zu is truncated or is not a TLS 1.3 application data one",
+				     num_records,
+				     offset);
+			return result;
+		}
+		dst_len += record_len - AES_GCM_TLS_TAG_SIZE;
+		num_records++;
+	}
+
+	result = aes_gcm_device_group_create(cfg, AES_GCM_MODE_DECRYPT, &group);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create device group: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	jobs = calloc(num_records, sizeof(*jobs));
+	verify_content = malloc(AES_GCM_TLS_MAX_CIPHERTEXT);
+	if (jobs == NULL || verify_content == NULL) {
+		result = DOCA_ERROR_NO_MEMORY;
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(result));
+		goto destroy_group;
+	}
+
+	result = aes_gcm_mem_alloc(cfg->hugepages, dst_len, &dst_mem);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+
+	offset = 0;
+	dst_offset = 0;
+	for (i = 0; i < num_records; i++) {
+		(void)aes_gcm_tls_record_parse((uint8_t *)file_data + offset, file_size - offset, &record_len);
+		if (record_len > group->max_buf_size) {
+			DOCA_LOG_ERR("Record %zu of %zu bytes > max buffer size %lu",
+				     i,
+				     record_len,
+				     group->max_buf_size);
+			result = DOCA_ERROR_INVALID_VALUE;
+			goto destroy_group;
+		}
+		result = aes_gcm_tls_open_prepare(session,
+						  file_data + offset,
+						  record_len,
+						  (char *)dst_mem.addr + dst_offset,
+						  &jobs[i]);
+		if (result != DOCA_SUCCESS)
+			goto destroy_group;
+		offset += record_len;
+		dst_offset += jobs[i].dst_len;
+	}
+
+	result = aes_gcm_device_group_start(group, file_data, file_size, dst_mem.addr, dst_len);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+
+	result = aes_gcm_device_group_key_create(group, session->key, aes_gcm_tls_key_type(session), &key);
+	if (result != DOCA_SUCCESS)
+		goto destroy_group;
+
+	DOCA_LOG_INFO("Opening %zu TLS records on %u devices", num_records, group->num_members);
+
+	start_ns = aes_gcm_get_time_ns();
+	aes_gcm_device_group_submit_burst(group, &key, jobs, num_records);
+	aes_gcm_device_group_wait(group);
+	aes_gcm_device_group_report(group, aes_gcm_get_time_ns() - start_ns);
+
+	for (i = 0; i < num_records; i++) {
+		result = aes_gcm_tls_open_finish(&jobs[i], &content_type, &content, &content_len);
+		if (result == DOCA_SUCCESS && content_type != AES_GCM_TLS_CONTENT_APPLICATION_DATA) {
+			DOCA_LOG_ERR("Record %zu carries content type %u, only application data is supported",
+				     i,
+				     content_type);
+			result = DOCA_ERROR_NOT_SUPPORTED;
+		}
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Record %zu failed: %s", i, doca_error_get_descr(result));
+			goto destroy_key;
+		}
+
+		if (cfg->tls_verify) {
+			result = aes_gcm_tls_open_sw(&verify_session,
+						     jobs[i].src,
+						     jobs[i].src_len,
+						     verify_content,
+						     &verify_type,
+						     &verify_len);
+			if (result != DOCA_SUCCESS || verify_type != content_type || verify_len != content_len ||
+			    memcmp(verify_content, content, content_len) != 0) {
+				DOCA_LOG_ERR("Record %zu opened by the device does not match the software AES-GCM", i);
+				result = DOCA_ERROR_UNEXPECTED;
+				goto destroy_key;
+			}
+		}
+
+		prefix = htonl((uint32_t)content_len);
+		if (fwrite(&prefix, sizeof(prefix), 1, out_file) != 1 ||
+		    fwrite(content, sizeof(uint8_t), content_len, out_file) != content_len) {
+			DOCA_LOG_ERR("Failed to write to output file: %s", cfg->output_path);
+			result = DOCA_ERROR_IO_FAILED;
+			goto destroy_key;
+		}
+	}
+	if (cfg->tls_verify)
+		DOCA_LOG_INFO("All %zu records match the software AES-GCM", num_records);
+
+destroy_key:
+	tmp_result = aes_gcm_device_group_key_destroy(group, &key);
+	DOCA_ERROR_PROPAGATE(result, tmp_result);
+destroy_group:
+	free(verify_content);
+	free(jobs);
+	tmp_result = aes_gcm_device_group_destroy(group);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to destroy device group: %s", doca_error_get_descr(tmp_result));
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+	aes_gcm_mem_free(&dst_mem);
+
+	return result;
+}
+
+doca_error_t aes_gcm_tls_stream_file(struct aes_gcm_cfg *cfg,
+				     enum aes_gcm_mode mode,
+				     char *file_data,
+				     size_t file_size)
+{
+	struct aes_gcm_tls_session session;
+	FILE *out_file;
+	doca_error_t result;
+
+	if (file_size == 0) {
+		DOCA_LOG_ERR("Input file is empty");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	if (cfg->tag_index_path[0] != '\0' || cfg->compress_codec[0] != '\0') {
+		DOCA_LOG_ERR("TLS records do not support detached tags or compression");
+		return DOCA_ERROR_NOT_SUPPORTED;
+	}
+
+	result = aes_gcm_tls_selftest();
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	result = aes_gcm_tls_session_init(cfg->tls_secret, cfg->tls_secret_len, 0, &session);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	out_file = fopen(cfg->output_path, "w");
+	if (out_file == NULL) {
+		DOCA_LOG_ERR("Unable to open output file: %s", cfg->output_path);
+		return DOCA_ERROR_NO_MEMORY;
+	}
+
+	if (mode == AES_GCM_MODE_ENCRYPT)
+		result = seal_records(cfg, &session, file_data, file_size, out_file);
+	else
+		result = open_records(cfg, &session, file_data, file_size, out_file);
+	if (result == DOCA_SUCCESS)
+		DOCA_LOG_INFO("TLS records were %s successfully and saved in: %s",
+			      (mode == AES_GCM_MODE_ENCRYPT) ? "sealed" : "opened",
+			      cfg->output_path);
+
+	fclose(out_file);
+	return result;
+}
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+
+#ifndef AES_GCM_TLS_H_
+#define AES_GCM_TLS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <doca_aes_gcm.h>
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+
+#define AES_GCM_TLS_HEADER_SIZE 5				     /* Record header, the AAD of the record */
+#define AES_GCM_TLS_TAG_SIZE AES_GCM_AUTH_TAG_128_SIZE_IN_BYTES	     /* Record tag size */
+#define AES_GCM_TLS_IV_SIZE MAX_AES_GCM_IV_LENGTH		     /* Static IV and nonce size */
+#define AES_GCM_TLS_MAX_PLAINTEXT (1 << 14)			     /* Max fragment size */
+#define AES_GCM_TLS_MAX_CIPHERTEXT (AES_GCM_TLS_MAX_PLAINTEXT + 256) /* Max encrypted record payload */
+#define AES_GCM_TLS_LEGACY_VERSION 0x0303			     /* legacy_record_version */
+#define AES_GCM_TLS_CONTENT_APPLICATION_DATA 23			     /* application_data content type */
+#define AES_GCM_TLS_CONTENT_ALERT 21				     /* alert content type */
+
+/* TLS 1.3 cipher suites built on AES-GCM */
+enum aes_gcm_tls_suite {
+	AES_GCM_TLS_AES_128_GCM_SHA256 = 0x1301, /* 16 bytes key, 32 bytes traffic secret */
+	AES_GCM_TLS_AES_256_GCM_SHA384 = 0x1302, /* 32 bytes key, 48 bytes traffic secret */
+};
+
+/* Record protection state of one direction of a TLS 1.3 connection */
+struct aes_gcm_tls_session {
+	enum aes_gcm_tls_suite suite;		/* Cipher suite */
+	uint8_t key[MAX_AES_GCM_KEY_SIZE];	/* Traffic key */
+	uint32_t key_len;			/* Traffic key length */
+	uint8_t static_iv[AES_GCM_TLS_IV_SIZE];	/* Traffic IV, XORed with the sequence number to get the nonce */
+	uint64_t seq;				/* Sequence number of the next record */
+};
+
+/*
+ * Derive the traffic key and IV of a session from a traffic secret, as HKDF-Expand-Label(secret, "key" / "iv")
+ *
+ * @secret [in]: Traffic secret, its length selects the cipher suite
+ * @secret_len [in]: Traffic secret length, 32 for TLS_AES_128_GCM_SHA256 or 48 for TLS_AES_256_GCM_SHA384
+ * @seq [in]: Sequence number of the first record
+ * @session [out]: The session
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_tls_session_init(const uint8_t *secret,
+				      uint32_t secret_len,
+				      uint64_t seq,
+				      struct aes_gcm_tls_session *session);
+
+/*
+ * Derive a secret of the same size from a traffic secret, as HKDF-Expand-Label(secret, label, context)
+ *
+ * @secret [in]: Traffic secret, its length selects the hash
+ * @secret_len [in]: Traffic secret length, 32 or 48
+ * @label [in]: Label, without the "tls13 " prefix
+ * @context [in]: Context
+ * @context_len [in]: Context length, at most 255
+ * @out [out]: Derived secret, secret_len bytes
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_tls_derive_secret(const uint8_t *secret,
+				       uint32_t secret_len,
+				       const char *label,
+				       const uint8_t *context,
+				       uint32_t context_len,
+				       uint8_t *out);
+
+/*
+ * Get the DOCA key type of the traffic key of a session
+ *
+ * @session [in]: The session
+ * @return: the DOCA key type
+ */
+enum doca_aes_gcm_key_type aes_gcm_tls_key_type(const struct aes_gcm_tls_session *session);
+
+/*
+ * Get the size of a sealed record
+ *
+ * @fragment_len [in]: Fragment length
+ * @pad_len [in]: Number of zero padding bytes
+ * @return: the size of the record, header and tag included
+ */
+size_t aes_gcm_tls_sealed_size(size_t fragment_len, size_t pad_len);
+
+/*
+ * Check the header of the next record of a buffer
+ *
+ * @data [in]: Start of the record
+ * @data_len [in]: Bytes available from data on
+ * @record_len [out]: Size of the record, header included
+ * @return: DOCA_SUCCESS if a complete record with a valid header starts at data, DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_tls_record_parse(const uint8_t *data, size_t data_len, size_t *record_len);
+
+/*
+ * Set up a job that seals a fragment into a record, and move the session to the next record
+ *
+ * The record header and the inner plaintext are built in src, which must be in the memory registered as the source
+ * and hold aes_gcm_tls_sealed_size() - AES_GCM_TLS_TAG_SIZE bytes. Once the job completes, dst holds the record.
+ *
+ * @session [in/out]: The session
+ * @content_type [in]: Content type of the fragment
+ * @fragment [in]: The fragment, at most AES_GCM_TLS_MAX_PLAINTEXT bytes
+ * @fragment_len [in]: Fragment length
+ * @pad_len [in]: Number of zero padding bytes
+ * @src [in]: Job source
+ * @dst [in]: Job destination, must hold aes_gcm_tls_sealed_size() bytes
+ * @job [in/out]: The job, its buffers and AES-GCM parameters are set for the session key
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_tls_seal_prepare(struct aes_gcm_tls_session *session,
+				      uint8_t content_type,
+				      const void *fragment,
+				      size_t fragment_len,
+				      size_t pad_len,
+				      void *src,
+				      void *dst,
+				      struct aes_gcm_job *job);
+
+/*
+ * Set up a job that opens a record, and move the session to the next record
+ *
+ * @session [in/out]: The session
+ * @record [in]: The record, in the memory registered as the source
+ * @record_len [in]: Record length, see aes_gcm_tls_record_parse()
+ * @dst [in]: Job destination, must hold record_len - AES_GCM_TLS_TAG_SIZE bytes
+ * @job [in/out]: The job, its buffers and AES-GCM parameters are set for the session key
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_tls_open_prepare(struct aes_gcm_tls_session *session,
+				      const void *record,
+				      size_t record_len,
+				      void *dst,
+				      struct aes_gcm_job *job);
+
+/*
+ * Get the content of a record opened by a completed job, stripping the padding
+ *
+ * @job [in]: The completed job
+ * @content_type [out]: Content type of the record
+ * @content [out]: The content, inside job->dst
+ * @content_len [out]: Content length
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_tls_open_finish(const struct aes_gcm_job *job,
+				     uint8_t *content_type,
+				     const uint8_t **content,
+				     size_t *content_len);
+
+/*
+ * Seal a fragment into a record on the CPU, and move the session to the next record
+ *
+ * @session [in/out]: The session
+ * @content_type [in]: Content type of the fragment
+ * @fragment [in]: The fragment, at most AES_GCM_TLS_MAX_PLAINTEXT bytes
+ * @fragment_len [in]: Fragment length
+ * @pad_len [in]: Number of zero padding bytes
+ * @record [out]: The record, must hold aes_gcm_tls_sealed_size() bytes
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_tls_seal_sw(struct aes_gcm_tls_session *session,
+				 uint8_t content_type,
+				 const void *fragment,
+				 size_t fragment_len,
+				 size_t pad_len,
+				 uint8_t *record);
+
+/*
+ * Open a record on the CPU, and move the session to the next record
+ *
+ * @session [in/out]: The session
+ * @record [in]: The record
+ * @record_len [in]: Record length
+ * @content [out]: The content, must hold record_len - AES_GCM_TLS_HEADER_SIZE - AES_GCM_TLS_TAG_SIZE bytes
+ * @content_type [out]: Content type of the record
+ * @content_len [out]: Content length
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR_INVALID_VALUE if the record does not authenticate
+ */
+doca_error_t aes_gcm_tls_open_sw(struct aes_gcm_tls_session *session,
+				 const uint8_t *record,
+				 size_t record_len,
+				 uint8_t *content,
+				 uint8_t *content_type,
+				 size_t *content_len);
+
+/*
+ * Check the key derivation and the software record protection against known vectors
+ *
+ * @return: DOCA_SUCCESS if every vector matched and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_tls_selftest(void);
+
+/*
+ * Seal or open a stream of TLS 1.3 application data records over a device group, and save the result in
+ * cfg->output_path
+ *
+ * The session is derived from cfg->tls_secret and starts at sequence number 0. On encrypt the input is a stream of
+ * length-prefixed fragments, see aes_gcm_record.h, and the output is the stream of sealed records. On decrypt the
+ * input is a stream of records and the output holds their content as length-prefixed fragments. Every record is
+ * checked against the software path when cfg->tls_verify is set.
+ *
+ * @cfg [in]: Configuration parameters
+ * @mode [in]: AES-GCM mode - encrypt/decrypt
+ * @file_data [in]: File data
+ * @file_size [in]: File size
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t aes_gcm_tls_stream_file(struct aes_gcm_cfg *cfg,
+				     enum aes_gcm_mode mode,
+				     char *file_data,
+				     size_t file_size);
+
+#endif /* AES_GCM_TLS_H_ */
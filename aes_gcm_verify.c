@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <doca_log.h>
+#include <doca_error.h>
+
+#include "aes_gcm_device_group.h"
+#include "aes_gcm_hugepage.h"
+#include "aes_gcm_stream.h"
+#include "aes_gcm_tag_index.h"
+#include "aes_gcm_verify.h"
+
+DOCA_LOG_REGISTER(AES_GCM::VERIFY);
+
+struct verify_run;
+
+/* Ring slot, holds one chunk in flight in its read window and scratch slots */
+struct verify_slot {
+	struct aes_gcm_job job;	/* Decrypt job of the chunk */
+	struct verify_run *run;	/* The verification the slot belongs to */
+	size_t chunk_idx;	/* Index of the chunk in the file */
+	bool busy;		/* The slot holds a chunk in flight */
+};
+
+/* Verification results */
+struct verify_run {
+	size_t num_passed;	   /* Chunks whose tag matched */
+	size_t num_failed;	   /* Chunks that failed */
+	doca_error_t first_error;  /* Error of the first failed chunk */
+	size_t first_failed_chunk; /* Index of the first failed chunk */
+};
+
+/*
+ * Job done callback - record the chunk result and release its slot
+ *
+ * @job [in]: The completed job
+ */
+static void verify_job_done(struct aes_gcm_job *job)
+{
+	struct verify_slot *slot = (struct verify_slot *)job->user_data;
+	struct verify_run *run = slot->run;
+
+	slot->busy = false;
+	if (job->result == DOCA_SUCCESS) {
+		run->num_passed++;
+		return;
+	}
+
+	DOCA_LOG_ERR("Chunk %zu: FAIL (%s)", slot->chunk_idx, doca_error_get_descr(job->result));
+	if (run->num_failed == 0 || slot->chunk_idx < run->first_failed_chunk) {
+		run->first_error = job->result;
+		run->first_failed_chunk = slot->chunk_idx;
+	}
+	run->num_failed++;
+}
+
+bool aes_gcm_verify_is_requested(const struct aes_gcm_cfg *cfg)
+{
+	return cfg->verify_only;
+}
+
+doca_error_t aes_gcm_verify_run(struct aes_gcm_cfg *cfg)
+{
+	struct aes_gcm_device_group *group = NULL;
+	struct aes_gcm_group_key key = {0};
+	struct aes_gcm_stream_layout layout;
+	struct verify_run run = {0};
+	struct verify_slot *slots = NULL;
+	struct verify_slot *slot;
+	struct aes_gcm_job *job;
+	struct aes_gcm_mem window_mem = {0};
+	struct aes_gcm_mem scratch_mem = {0};
+	struct stat st;
+	char *window, *scratch;
+	uint8_t *tags = NULL;
+	size_t file_size, num_slots, i, offset;
+	uint64_t start_ns;
+	doca_error_t result, tmp_result;
+	int fd;
+
+	if (cfg->compress_codec[0] != '\0') {
+		DOCA_LOG_ERR("Verification of compressed files is not supported");
+		return DOCA_ERROR_NOT_SUPPORTED;
+	}
+
+	fd = open(cfg->file_path, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) != 0) {
+		DOCA_LOG_ERR("Unable to open %s: %s", cfg->file_path, strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return DOCA_ERROR_IO_FAILED;
+	}
+	file_size = st.st_size;
+
+	result = aes_gcm_stream_compute_layout(cfg, AES_GCM_MODE_DECRYPT, file_size, &layout);
+	if (result != DOCA_SUCCESS) {
+		close(fd);
+		return result;
+	}
+
+	result = aes_gcm_device_group_create(cfg, AES_GCM_MODE_DECRYPT, &group);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create device group: %s", doca_error_get_descr(result));
+		close(fd);
+		return result;
+	}
+
+	if (layout.in_chunk_size > group->max_buf_size) {
+		DOCA_LOG_ERR("Chunk size %zu > max buffer size %lu", layout.in_chunk_size, group->max_buf_size);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto destroy_group;
+	}
+
+	/* Enough slots to keep every device busy, never more than the chunks */
+	num_slots = (size_t)cfg->queue_depth * group->num_members;
+	if (num_slots > layout.num_chunks)
+		num_slots = layout.num_chunks;
+
+	slots = calloc(num_slots, sizeof(*slots));
+	if (slots == NULL) {
+		result = DOCA_ERROR_NO_MEMORY;
+		DOCA_LOG_ERR("Failed to allocate memory: %s", doca_error_get_descr(result));
+		goto free_buffers;
+	}
+
+	/* Every ring slot reads its chunk into its own window slot, the file is never loaded as a whole */
+	result = aes_gcm_mem_alloc(cfg->hugepages, num_slots * layout.in_chunk_size, &window_mem);
+	if (result != DOCA_SUCCESS)
+		goto free_buffers;
+	window = window_mem.addr;
+
+	result = aes_gcm_mem_alloc(cfg->hugepages, num_slots * layout.out_chunk_size, &scratch_mem);
+	if (result != DOCA_SUCCESS)
+		goto free_buffers;
+	scratch = scratch_mem.addr;
+
+	if (cfg->tag_index_path[0] != '\0') {
+		result = aes_gcm_tag_index_read(cfg->tag_index_path, cfg, layout.num_chunks, file_size, &tags);
+		if (result != DOCA_SUCCESS)
+			goto free_buffers;
+	}
+
+	result = aes_gcm_device_group_start(group,
+					    window,
+					    num_slots * layout.in_chunk_size,
+					    scratch,
+					    num_slots * layout.out_chunk_size);
+	if (result != DOCA_SUCCESS)
+		goto free_buffers;
+
+	if (tags != NULL) {
+		result = aes_gcm_device_group_register_tags(group, tags, layout.num_chunks * cfg->tag_size);
+		if (result != DOCA_SUCCESS)
+			goto free_buffers;
+	}
+
+	result = aes_gcm_device_group_key_create(group, cfg->raw_key, cfg->raw_key_type, &key);
+	if (result != DOCA_SUCCESS)
+		goto free_buffers;
+
+	DOCA_LOG_INFO("Verifying %zu chunks on %u devices with a %zu slots ring",
+		      layout.num_chunks,
+		      group->num_members,
+		      num_slots);
+
+	start_ns = aes_gcm_get_time_ns();
+	for (i = 0; i < layout.num_chunks; i++) {
+		slot = &slots[i % num_slots];
+		while (slot->busy)
+			aes_gcm_device_group_progress(group);
+
+		job = &slot->job;
+		offset = i * layout.in_chunk_size;
+		*job = (struct aes_gcm_job){0};
+		job->src = window + ((i % num_slots) * layout.in_chunk_size);
+		job->src_len = (file_size - offset < layout.in_chunk_size) ? (file_size - offset) : layout.in_chunk_size;
+		result = aes_gcm_file_io(fd, job->src, job->src_len, offset, false);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to read chunk %zu: %s", i, doca_error_get_descr(result));
+			break;
+		}
+		job->dst = scratch + ((i % num_slots) * layout.out_chunk_size);
+		job->dst_len = layout.out_chunk_size;
+		aes_gcm_derive_iv(cfg->iv, cfg->iv_length, i, job->iv);
+		job->iv_length = cfg->iv_length;
+		job->tag_size = cfg->tag_size;
+		job->aad_size = cfg->aad_size;
+		if (tags != NULL)
+			job->tag = tags + (i * cfg->tag_size);
+		job->done_cb = verify_job_done;
+		job->user_data = slot;
+		slot->run = &run;
+		slot->chunk_idx = i;
+		slot->busy = true;
+		aes_gcm_device_group_submit(group, &key, job);
+	}
+	aes_gcm_device_group_wait(group);
+	aes_gcm_device_group_report(group, aes_gcm_get_time_ns() - start_ns);
+	if (result != DOCA_SUCCESS)
+		goto destroy_key;
+
+	DOCA_LOG_INFO("Verified %zu chunks: %zu passed, %zu failed", layout.num_chunks, run.num_passed, run.num_failed);
+	if (run.num_failed == 0) {
+		DOCA_LOG_INFO("File %s: PASS", cfg->file_path);
+	} else {
+		DOCA_LOG_ERR("File %s: FAIL, first failed chunk is %zu", cfg->file_path, run.first_failed_chunk);
+		result = run.first_error;
+	}
+
+destroy_key:
+	tmp_result = aes_gcm_device_group_key_destroy(group, &key);
+	DOCA_ERROR_PROPAGATE(result, tmp_result);
+free_buffers:
+	free(slots);
+destroy_group:
+	tmp_result = aes_gcm_device_group_destroy(group);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to destroy device group: %s", doca_error_get_descr(tmp_result));
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+	free(tags);
+	aes_gcm_mem_free(&scratch_mem);
+	aes_gcm_mem_free(&window_mem);
+	close(fd);
+
+	return result;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef AES_GCM_VERIFY_H_
+#define AES_GCM_VERIFY_H_
+
+#include <stdbool.h>
+
+#include <doca_error.h>
+
+#include "aes_gcm_common.h"
+
+/*
+ * Check if the configuration asks for the verify only mode
+ *
+ * @cfg [in]: Configuration parameters
+ * @return: true if the run should go through aes_gcm_verify_run()
+ */
+bool aes_gcm_verify_is_requested(const struct aes_gcm_cfg *cfg);
+
+/*
+ * Check the authentication tags of the encrypted file cfg->file_path without keeping the plaintext
+ *
+ * The file is split in chunks as by aes_gcm_stream_file(). Every chunk is read into the window slot of a small ring and
+ * decrypted into its scratch slot, both are reused as soon as the chunk completes, so memory does not grow with the
+ * file. Nothing is written out, and the result of every chunk and of the whole file is logged. Detached tags are read
+ * from cfg->tag_index_path when it is set.
+ *
+ * @cfg [in]: Configuration parameters
+ * @return: DOCA_SUCCESS if every chunk passed, the error of the first failed chunk otherwise
+ */
+doca_error_t aes_gcm_verify_run(struct aes_gcm_cfg *cfg);
+
+#endif /* AES_GCM_VERIFY_H_ */